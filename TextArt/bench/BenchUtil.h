@@ -0,0 +1,59 @@
+#ifndef BENCHUTIL_H_
+#define BENCHUTIL_H_
+
+#include <stdio.h>
+#include <time.h>
+
+#include <string>
+
+/**
+ * Timing, checks and whole-file I/O shared by the host benches.
+ */
+
+inline double
+GetMilliseconds(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+// Reports pWhat when condition does not hold, and passes condition on
+inline bool
+Check(bool condition, const char* pWhat)
+{
+	if(!condition) {
+		fprintf(stderr, "missed: %s\n", pWhat);
+	}
+	return condition;
+}
+
+inline bool
+ReadFile(const std::string& path, std::string& data)
+{
+	FILE* pFile = fopen(path.c_str(), "rb");
+	if(pFile == NULL) {
+		return false;
+	}
+	data.clear();
+	char buffer[4096];
+	size_t read;
+	while((read = fread(buffer, 1, sizeof(buffer), pFile)) > 0) {
+		data.append(buffer, read);
+	}
+	fclose(pFile);
+	return true;
+}
+
+inline bool
+WriteFile(const std::string& path, const std::string& data)
+{
+	FILE* pFile = fopen(path.c_str(), "wb");
+	if(pFile == NULL) {
+		return false;
+	}
+	bool written = fwrite(data.data(), 1, data.size(), pFile) == data.size();
+	return fclose(pFile) == 0 && written;
+}
+
+#endif
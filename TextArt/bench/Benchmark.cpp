@@ -0,0 +1,341 @@
+/**
+ * Host benchmark of the UI-free core: catalog scan, category and item
+ * parsing, title translation and TextArtRegistry operations. Runs against
+ * the shipped Home/catalog and against a copy of it replicated -scale
+ * times, every case is repeated -iterations times and the best run counts.
+ *
+ *   make run
+ *   ./textart-bench -catalog ../Home/catalog -scale 20 -iterations 5
+ */
+
+#include "BenchUtil.h"
+#include "Catalog.h"
+#include "TextArtRegistry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+using namespace Osp::Io;
+
+static const int LANGUAGE_COUNT = 4;
+static const int REGISTRY_OPERATIONS = 200;
+
+static int __iterations = 5;
+
+static void
+Report(const char* pName, int operations, double best, double total)
+{
+	printf("%-30s %8d %12.3f %12.3f %12.2f\n", pName, operations, best, total / __iterations,
+			operations > 0 ? best * 1000.0 / operations : 0.0);
+}
+
+// Every case runs Run(), which returns the number of operations it did
+class Case {
+public:
+	virtual ~Case(void) {}
+	virtual int Run(void) = 0;
+
+	void Measure(const char* pName) {
+		double best = 0;
+		double total = 0;
+		int operations = 0;
+		for(int i = 0; i < __iterations; i++) {
+			double start = GetMilliseconds();
+			operations = Run();
+			double elapsed = GetMilliseconds() - start;
+			total += elapsed;
+			if(i == 0 || elapsed < best) {
+				best = elapsed;
+			}
+		}
+		Report(pName, operations, best, total);
+	}
+};
+
+class ScanCase : public Case {
+public:
+	virtual int Run(void) {
+		int count = 0;
+		ArrayList names;
+		names.Construct();
+		Catalog::GetCategories(names);
+		for(int i = 0; i < names.GetCount(); i++) {
+			ArrayList paths;
+			paths.Construct();
+			Catalog::GetItems(*static_cast<String*>(names.GetAt(i)), paths);
+			count += paths.GetCount() + 1;
+			paths.RemoveAll(true);
+		}
+		names.RemoveAll(true);
+		return count;
+	}
+};
+
+class CategoryCase : public Case {
+public:
+	CategoryCase(ArrayList& names): __names(names) {}
+
+	virtual int Run(void) {
+		for(int i = 0; i < __names.GetCount(); i++) {
+			String title, desc, preview;
+			Catalog::ReadCategory(*static_cast<String*>(__names.GetAt(i)), 1, title, desc, preview);
+		}
+		return __names.GetCount();
+	}
+
+private:
+	ArrayList& __names;
+};
+
+class ItemCase : public Case {
+public:
+	ItemCase(ArrayList& paths): __paths(paths), parsed(0) {}
+
+	virtual int Run(void) {
+		parsed = 0;
+		for(int i = 0; i < __paths.GetCount(); i++) {
+			String title, art;
+			int linecount = 0;
+			if(!IsFailed(Catalog::ReadItem(*static_cast<String*>(__paths.GetAt(i)), 1, title, art, linecount))) {
+				parsed++;
+			}
+		}
+		return __paths.GetCount();
+	}
+
+private:
+	ArrayList& __paths;
+
+public:
+	int parsed;
+};
+
+class TranslateCase : public Case {
+public:
+	TranslateCase(std::vector<String>& lines): __lines(lines) {}
+
+	virtual int Run(void) {
+		for(size_t i = 0; i < __lines.size(); i++) {
+			for(int language = 0; language < LANGUAGE_COUNT; language++) {
+				String line(__lines[i]);
+				Catalog::GetTranslated(line, language);
+			}
+		}
+		return (int)__lines.size() * LANGUAGE_COUNT;
+	}
+
+private:
+	std::vector<String>& __lines;
+};
+
+class RegistryCase : public Case {
+public:
+	enum Operation {
+		ADD_RECENT,
+		GET_RECENT,
+		ADD_FAVOURITE,
+		GET_FAVOURITES,
+		REMOVE_FAVOURITE
+	};
+
+	RegistryCase(ArrayList& paths, Operation operation): __paths(paths), __operation(operation) {}
+
+	virtual int Run(void) {
+		int count = __paths.GetCount() < REGISTRY_OPERATIONS ? __paths.GetCount() : REGISTRY_OPERATIONS;
+		for(int i = 0; i < count; i++) {
+			const String& path = *static_cast<String*>(__paths.GetAt(i));
+			switch(__operation) {
+			case ADD_RECENT:
+				TextArtRegistry::AddRecent(path);
+				break;
+			case ADD_FAVOURITE:
+				TextArtRegistry::AddFavourite(path);
+				break;
+			case REMOVE_FAVOURITE:
+				TextArtRegistry::RemoveFavourite(path);
+				TextArtRegistry::AddFavourite(path);
+				break;
+			case GET_RECENT: {
+				ArrayList* pData = TextArtRegistry::GetRecent();
+				pData->RemoveAll(true);
+				delete pData;
+				break;
+			}
+			case GET_FAVOURITES: {
+				ArrayList* pData = TextArtRegistry::GetFavourites();
+				pData->RemoveAll(true);
+				delete pData;
+				break;
+			}
+			}
+		}
+		return count;
+	}
+
+private:
+	ArrayList& __paths;
+	Operation __operation;
+};
+
+static void
+CollectItems(ArrayList& names, ArrayList& paths)
+{
+	names.Construct();
+	paths.Construct();
+	Catalog::GetCategories(names);
+	for(int i = 0; i < names.GetCount(); i++) {
+		Catalog::GetItems(*static_cast<String*>(names.GetAt(i)), paths);
+	}
+}
+
+static void
+CollectTitles(ArrayList& paths, std::vector<String>& lines)
+{
+	for(int i = 0; i < paths.GetCount(); i++) {
+		String text;
+		if(IsFailed(Catalog::ReadText(*static_cast<String*>(paths.GetAt(i)), text))) {
+			continue;
+		}
+		int end = 0;
+		if(text.IndexOf(L'\n', 0, end) != E_SUCCESS) {
+			end = text.GetLength();
+		}
+		String line;
+		text.SubString(0, end, line);
+		lines.push_back(line);
+	}
+}
+
+static void
+RunCatalog(const char* pLabel)
+{
+	ArrayList names, paths;
+	CollectItems(names, paths);
+	std::vector<String> titles;
+	CollectTitles(paths, titles);
+
+	printf("\n%s: %d categories, %d items\n", pLabel, names.GetCount(), paths.GetCount());
+	printf("%-30s %8s %12s %12s %12s\n", "case", "ops", "best ms", "mean ms", "best us/op");
+
+	ScanCase scan;
+	scan.Measure("catalog scan");
+	CategoryCase categories(names);
+	categories.Measure("category parse");
+	ItemCase items(paths);
+	items.Measure("item parse");
+	TranslateCase translate(titles);
+	translate.Measure("title translation");
+	printf("%-30s %8d of %d items shown\n", "parsed", items.parsed, paths.GetCount());
+
+	names.RemoveAll(true);
+	paths.RemoveAll(true);
+}
+
+static void
+RunRegistry(void)
+{
+	ArrayList names, paths;
+	CollectItems(names, paths);
+
+	printf("\nregistry: %d operations per case\n", paths.GetCount() < REGISTRY_OPERATIONS ? paths.GetCount() : REGISTRY_OPERATIONS);
+	printf("%-30s %8s %12s %12s %12s\n", "case", "ops", "best ms", "mean ms", "best us/op");
+
+	double start = GetMilliseconds();
+	TextArtRegistry::Setup();
+	printf("%-30s %8d %12.3f\n", "registry setup", 1, GetMilliseconds() - start);
+
+	RegistryCase addRecent(paths, RegistryCase::ADD_RECENT);
+	addRecent.Measure("add recent");
+	RegistryCase getRecent(paths, RegistryCase::GET_RECENT);
+	getRecent.Measure("get recent");
+	RegistryCase addFavourite(paths, RegistryCase::ADD_FAVOURITE);
+	addFavourite.Measure("add favourite");
+	RegistryCase getFavourites(paths, RegistryCase::GET_FAVOURITES);
+	getFavourites.Measure("get favourites");
+	RegistryCase removeFavourite(paths, RegistryCase::REMOVE_FAVOURITE);
+	removeFavourite.Measure("remove + add favourite");
+
+	names.RemoveAll(true);
+	paths.RemoveAll(true);
+}
+
+// Copies the catalog scale times under root, category names get a copy suffix
+static bool
+Replicate(const std::string& source, const std::string& root, int scale)
+{
+	std::string command = "mkdir -p '" + root + "'";
+	for(int copy = 0; copy < scale; copy++) {
+		char suffix[16];
+		snprintf(suffix, sizeof(suffix), "%d", copy);
+		command += " && for d in '" + source + "'/*/; do cp -r \"$d\" '" + root + "'/$(basename \"$d\")_" + suffix + "; done";
+	}
+	return system(command.c_str()) == 0;
+}
+
+static void
+Usage(const char* pName)
+{
+	fprintf(stderr, "usage: %s [-catalog DIR] [-scale N] [-iterations N]\n", pName);
+}
+
+int
+main(int argc, char** argv)
+{
+	std::string catalog = "../Home/catalog";
+	int scale = 10;
+
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-catalog") == 0 && i + 1 < argc) {
+			catalog = argv[++i];
+		} else if(strcmp(argv[i], "-scale") == 0 && i + 1 < argc) {
+			scale = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-iterations") == 0 && i + 1 < argc) {
+			__iterations = atoi(argv[++i]);
+		} else {
+			Usage(argv[0]);
+			return 1;
+		}
+	}
+	if(__iterations < 1) {
+		__iterations = 1;
+	}
+
+	char workTemplate[] = "/tmp/textart-bench-XXXXXX";
+	char* pWork = mkdtemp(workTemplate);
+	if(pWork == null) {
+		perror("mkdtemp");
+		return 1;
+	}
+	std::string work = pWork;
+	HostFileSystem::Mount("/Home", work.c_str());
+
+	HostFileSystem::Mount("/Home/catalog", catalog.c_str());
+	Directory dir;
+	if(IsFailed(dir.Construct(L"/Home/catalog"))) {
+		fprintf(stderr, "catalog %s not found\n", catalog.c_str());
+		return 1;
+	}
+	RunCatalog("shipped catalog");
+	RunRegistry();
+
+	if(scale > 1) {
+		std::string synthetic = work + "/synthetic";
+		if(Replicate(catalog, synthetic, scale)) {
+			HostFileSystem::Mount("/Home/catalog", synthetic.c_str());
+			char label[64];
+			snprintf(label, sizeof(label), "catalog x%d", scale);
+			RunCatalog(label);
+		}
+	}
+
+	std::string cleanup = "rm -rf '" + work + "'";
+	system(cleanup.c_str());
+	return 0;
+}
@@ -0,0 +1,291 @@
+#include "CatalogGenerator.h"
+
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <vector>
+
+// Shares of the shipped catalog, in percent
+static const int UTF8_BOM_PERCENT = 3;
+static const int CP1251_PERCENT = 2;
+static const int UTF16_PERCENT = 1;
+static const int CRLF_PERCENT = 1;
+static const int VARIANT_PERCENT = 10;
+static const int EMPTY_COLUMN_PERCENT = 8;
+
+struct Quantile {
+	int percent;
+	int value;
+};
+
+// Art lines per item and characters per line of the shipped catalog
+static const Quantile LINE_COUNTS[] = {
+	{ 0, 1 }, { 10, 3 }, { 25, 3 }, { 50, 4 }, { 75, 5 }, { 90, 7 }, { 99, 13 }, { 100, 40 }
+};
+static const Quantile LINE_WIDTHS[] = {
+	{ 0, 1 }, { 10, 7 }, { 25, 9 }, { 50, 12 }, { 75, 20 }, { 90, 26 }, { 99, 51 }, { 100, 156 }
+};
+
+static const char* const NOUNS[][4] = {
+	{ "Кот", "Cat", "Katze", "Chat" },
+	{ "Собака", "Dog", "Hund", "Chien" },
+	{ "Лошадь", "Horse", "Pferd", "Cheval" },
+	{ "Медведь", "Bear", "Bär", "Ours" },
+	{ "Заяц", "Hare", "Hase", "Lièvre" },
+	{ "Машина", "Car", "Auto", "Voiture" },
+	{ "Сердце", "Heart", "Herz", "Cœur" },
+	{ "Цветок", "Flower", "Blume", "Fleur" },
+	{ "Дом", "House", "Haus", "Maison" },
+	{ "Рыба", "Fish", "Fisch", "Poisson" },
+	{ "Птица", "Bird", "Vogel", "Oiseau" },
+	{ "Звезда", "Star", "Stern", "Étoile" }
+};
+static const char* const ADJECTIVES[][4] = {
+	{ "Большой", "Big", "Großer", "Grand" },
+	{ "Маленький", "Small", "Kleiner", "Petit" },
+	{ "Весёлый", "Happy", "Fröhlicher", "Joyeux" },
+	{ "Старый", "Old", "Alter", "Vieux" },
+	{ "Быстрый", "Fast", "Schneller", "Rapide" },
+	{ "Сонный", "Sleepy", "Müder", "Endormi" }
+};
+static const char* const LANGUAGE_SUFFIXES[] = { "ru", "en", "de", "fr" };
+static const char ART_GLYPHS[] = "  ..,,::;;--==++**##%%@@//\\\\||__()<>^'\"o0O~`";
+
+static const int NOUN_COUNT = sizeof(NOUNS) / sizeof(NOUNS[0]);
+static const int ADJECTIVE_COUNT = sizeof(ADJECTIVES) / sizeof(ADJECTIVES[0]);
+
+class Random {
+public:
+	Random(unsigned int seed): __state(seed ? seed : 1) {}
+
+	unsigned int Next(void) {
+		// xorshift32
+		__state ^= __state << 13;
+		__state ^= __state >> 17;
+		__state ^= __state << 5;
+		return __state;
+	}
+
+	int Below(int bound) {
+		return (int)(Next() % (unsigned int)bound);
+	}
+
+	bool Percent(int percent) {
+		return Below(100) < percent;
+	}
+
+	int Sample(const Quantile* pTable, int count) {
+		int p = Below(10000);
+		for(int i = 1; i < count; i++) {
+			if(p <= pTable[i].percent * 100) {
+				int span = pTable[i].percent * 100 - pTable[i - 1].percent * 100;
+				int offset = p - pTable[i - 1].percent * 100;
+				return pTable[i - 1].value + (pTable[i].value - pTable[i - 1].value) * offset / (span > 0 ? span : 1);
+			}
+		}
+		return pTable[count - 1].value;
+	}
+
+private:
+	unsigned int __state;
+};
+
+enum Encoding {
+	ENCODING_UTF8,
+	ENCODING_UTF8_BOM,
+	ENCODING_CP1251,
+	ENCODING_UTF16
+};
+
+static void
+DecodeUtf8(const std::string& text, std::vector<unsigned int>& out)
+{
+	for(size_t i = 0; i < text.size();) {
+		unsigned char c = (unsigned char)text[i];
+		int extra = c < 0x80 ? 0 : (c < 0xE0 ? 1 : (c < 0xF0 ? 2 : 3));
+		unsigned int code = extra == 0 ? c : (c & (0x3F >> extra));
+		for(int k = 1; k <= extra && i + k < text.size(); k++) {
+			code = (code << 6) | ((unsigned char)text[i + k] & 0x3F);
+		}
+		out.push_back(code);
+		i += extra + 1;
+	}
+}
+
+static std::string
+Encode(const std::string& utf8, Encoding encoding)
+{
+	if(encoding == ENCODING_UTF8) {
+		return utf8;
+	}
+	if(encoding == ENCODING_UTF8_BOM) {
+		return "\xEF\xBB\xBF" + utf8;
+	}
+
+	std::vector<unsigned int> codes;
+	DecodeUtf8(utf8, codes);
+	std::string out;
+	if(encoding == ENCODING_UTF16) {
+		out += "\xFF\xFE";
+		for(size_t i = 0; i < codes.size(); i++) {
+			out.push_back((char)(codes[i] & 0xFF));
+			out.push_back((char)((codes[i] >> 8) & 0xFF));
+		}
+		return out;
+	}
+
+	for(size_t i = 0; i < codes.size(); i++) {
+		unsigned int c = codes[i];
+		if(c < 0x80) {
+			out.push_back((char)c);
+		} else if(c >= 0x410 && c <= 0x44F) {
+			out.push_back((char)(0xC0 + c - 0x410));
+		} else if(c == 0x401) {
+			out.push_back((char)0xA8);
+		} else if(c == 0x451) {
+			out.push_back((char)0xB8);
+		} else {
+			out.push_back('?');
+		}
+	}
+	return out;
+}
+
+static bool
+WriteFile(const std::string& path, const std::string& data, CatalogGenerator::Stats& stats)
+{
+	FILE* pFile = fopen(path.c_str(), "wb");
+	if(pFile == NULL) {
+		return false;
+	}
+	bool written = fwrite(data.data(), 1, data.size(), pFile) == data.size();
+	written = fclose(pFile) == 0 && written;
+	stats.files++;
+	stats.bytes += data.size();
+	return written;
+}
+
+static std::string
+MakeArt(Random& random, bool crlf)
+{
+	const char* pLineBreak = crlf ? "\r\n" : "\n";
+	std::string art;
+	int lines = random.Sample(LINE_COUNTS, sizeof(LINE_COUNTS) / sizeof(LINE_COUNTS[0]));
+	for(int line = 0; line < lines; line++) {
+		int width = random.Sample(LINE_WIDTHS, sizeof(LINE_WIDTHS) / sizeof(LINE_WIDTHS[0]));
+		// art is mostly short runs of one glyph after some indentation
+		std::string row(random.Below(width / 3 + 1), ' ');
+		while((int)row.size() < width) {
+			row.append(1 + random.Below(3), ART_GLYPHS[random.Below(sizeof(ART_GLYPHS) - 1)]);
+		}
+		row.resize(width);
+		art += row;
+		art += pLineBreak;
+	}
+	// shipped files end with an empty line
+	art += pLineBreak;
+	return art;
+}
+
+static std::string
+MakeTitle(int noun, int adjective, int onlyLanguage, Random& random)
+{
+	std::string title;
+	for(int language = 0; language < 4; language++) {
+		if(language > 0) {
+			title += '|';
+		}
+		bool filled = onlyLanguage < 0 ? !random.Percent(EMPTY_COLUMN_PERCENT) : language == onlyLanguage;
+		if(filled) {
+			title += ADJECTIVES[adjective][language];
+			title += ' ';
+			title += NOUNS[noun][language];
+		}
+	}
+	return title;
+}
+
+static Encoding
+PickEncoding(Random& random)
+{
+	int p = random.Below(100);
+	if(p < UTF16_PERCENT) {
+		return ENCODING_UTF16;
+	}
+	if(p < UTF16_PERCENT + CP1251_PERCENT) {
+		return ENCODING_CP1251;
+	}
+	if(p < UTF16_PERCENT + CP1251_PERCENT + UTF8_BOM_PERCENT) {
+		return ENCODING_UTF8_BOM;
+	}
+	return ENCODING_UTF8;
+}
+
+bool
+CatalogGenerator::Generate(const std::string& root, const Options& options, Stats& stats)
+{
+	stats.files = 0;
+	stats.items = 0;
+	stats.bytes = 0;
+	if(mkdir(root.c_str(), 0755) != 0) {
+		struct stat info;
+		if(stat(root.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+			return false;
+		}
+	}
+
+	Random random(options.seed);
+	int categories = options.categories > 0 ? options.categories : 1;
+	for(int category = 0; category < categories; category++) {
+		char name[32];
+		snprintf(name, sizeof(name), "category%d", category);
+		std::string dir = root + "/" + name;
+		if(mkdir(dir.c_str(), 0755) != 0) {
+			return false;
+		}
+
+		int noun = category % NOUN_COUNT;
+		std::string info = std::string(NOUNS[noun][0]) + "|" + NOUNS[noun][1] + "|" + NOUNS[noun][2] + "|" + NOUNS[noun][3] + "\n";
+		info += std::string(ADJECTIVES[0][0]) + " " + NOUNS[noun][0] + "|" + ADJECTIVES[0][1] + " " + NOUNS[noun][1] + "|"
+				+ ADJECTIVES[0][2] + " " + NOUNS[noun][2] + "|" + ADJECTIVES[0][3] + " " + NOUNS[noun][3] + "\n";
+		info += MakeArt(random, false);
+		if(!WriteFile(dir + "/category.info", info, stats)) {
+			return false;
+		}
+
+		// items are spread evenly, the first categories take the remainder
+		int count = options.items / categories + (category < options.items % categories ? 1 : 0);
+		for(int item = 1; item <= count; item++) {
+			int itemNoun = random.Below(NOUN_COUNT);
+			int adjective = random.Below(ADJECTIVE_COUNT);
+			bool crlf = random.Percent(CRLF_PERCENT);
+			std::string art = MakeArt(random, crlf);
+			char file[32];
+			snprintf(file, sizeof(file), "/%d", item);
+
+			if(random.Percent(VARIANT_PERCENT)) {
+				// a legacy single column base file plus one file per language
+				std::string base = std::string(NOUNS[itemNoun][0]) + (crlf ? "\r\n" : "\n") + art;
+				if(!WriteFile(dir + file + ".txt", Encode(base, random.Percent(50) ? ENCODING_CP1251 : ENCODING_UTF8), stats)) {
+					return false;
+				}
+				for(int language = 0; language < 4; language++) {
+					if(language > 0 && random.Percent(50)) {
+						continue;
+					}
+					std::string variant = MakeTitle(itemNoun, adjective, language, random) + (crlf ? "\r\n" : "\n") + art;
+					if(!WriteFile(dir + file + "_" + LANGUAGE_SUFFIXES[language] + ".txt", Encode(variant, ENCODING_UTF8_BOM), stats)) {
+						return false;
+					}
+				}
+			} else {
+				std::string text = MakeTitle(itemNoun, adjective, -1, random) + (crlf ? "\r\n" : "\n") + art;
+				if(!WriteFile(dir + file + ".txt", Encode(text, PickEncoding(random)), stats)) {
+					return false;
+				}
+			}
+			stats.items++;
+		}
+	}
+	return true;
+}
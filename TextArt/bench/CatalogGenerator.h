@@ -0,0 +1,33 @@
+#ifndef CATALOGGENERATOR_H_
+#define CATALOGGENERATOR_H_
+
+#include <string>
+
+/**
+ * Writes a synthetic catalog in the Home/catalog layout: one directory per
+ * category with category.info and N.txt items, titles in four '|' separated
+ * languages, NN_xx.txt language variants and the encoding mix, line count
+ * and line width distributions measured on the shipped catalog. Output is
+ * deterministic for a given seed.
+ */
+class CatalogGenerator {
+public:
+	struct Options {
+		int categories;
+		int items;
+		unsigned int seed;
+
+		Options(): categories(10), items(1000), seed(1) {}
+	};
+
+	struct Stats {
+		int files;
+		int items;
+		long long bytes;
+	};
+
+	// root must not exist yet or be empty
+	static bool Generate(const std::string& root, const Options& options, Stats& stats);
+};
+
+#endif
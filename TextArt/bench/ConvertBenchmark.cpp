@@ -0,0 +1,194 @@
+/**
+ * Picture to text art benchmark: ArtConverter on a synthetic 320x480 picture
+ * (or a binary PPM), its band by band downsampling and the whole conversion
+ * with the default ramp. The downsampling must agree cell by cell with a
+ * plain cell by cell reference. Every case is repeated -iterations times and
+ * the best run counts.
+ *
+ *   make convert
+ *   ./textart-convert -columns 32 -iterations 50 -ppm photo.ppm -print
+ */
+
+#include "ArtConverter.h"
+#include "BenchUtil.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+using namespace Osp::Base;
+
+static const int SYNTHETIC_WIDTH = 320;
+static const int SYNTHETIC_HEIGHT = 480;
+
+// Diagonal gradient with a dark disc and noise, so every glyph of the ramp is used
+static void
+MakeSynthetic(int width, int height, std::vector<unsigned int>& pixels)
+{
+	pixels.resize(width * height);
+	unsigned int seed = 1;
+	for(int y = 0; y < height; y++) {
+		for(int x = 0; x < width; x++) {
+			int dx = x - width / 2;
+			int dy = y - height / 2;
+			int value = (x * 255 / width + y * 255 / height) / 2;
+			if(dx * dx + dy * dy < width * width / 9) {
+				value = 255 - value;
+			}
+			seed = seed * 1103515245 + 12345;
+			value += (int)((seed >> 16) & 15) - 8;
+			value = value < 0 ? 0 : (value > 255 ? 255 : value);
+			unsigned int red = value;
+			unsigned int green = (value * 3 + 128) / 4;
+			unsigned int blue = 255 - value / 2;
+			pixels[y * width + x] = 0xFF000000 | (red << 16) | (green << 8) | blue;
+		}
+	}
+}
+
+// Each cell summed on its own, the order ArtConverter::Downsample avoids
+static void
+DownsampleCells(const unsigned int* pPixels, int width, int height, int pitch, int columns, int rows, byte* pLuma)
+{
+	for(int row = 0; row < rows; row++) {
+		int top = row * height / rows;
+		int bottom = (row + 1) * height / rows;
+		for(int column = 0; column < columns; column++) {
+			int left = column * width / columns;
+			int right = (column + 1) * width / columns;
+			long long red = 0;
+			long long green = 0;
+			long long blue = 0;
+			for(int y = top; y < bottom; y++) {
+				for(int x = left; x < right; x++) {
+					unsigned int pixel = pPixels[y * pitch + x];
+					red += (pixel >> 16) & 0xFF;
+					green += (pixel >> 8) & 0xFF;
+					blue += pixel & 0xFF;
+				}
+			}
+			long long pixels = (long long)(right - left) * (bottom - top) * 256;
+			*pLuma++ = (byte)((77 * red + 150 * green + 29 * blue) / pixels);
+		}
+	}
+}
+
+static bool
+ReadPpm(const char* pPath, int& width, int& height, std::vector<unsigned int>& pixels)
+{
+	FILE* pFile = fopen(pPath, "rb");
+	if(pFile == NULL) {
+		return false;
+	}
+	int maxValue = 0;
+	bool ok = fscanf(pFile, "P6 %d %d %d", &width, &height, &maxValue) == 3 && maxValue == 255 && width > 0 && height > 0;
+	if(ok) {
+		fgetc(pFile);
+		std::vector<unsigned char> rgb(width * height * 3);
+		ok = fread(&rgb[0], 1, rgb.size(), pFile) == rgb.size();
+		pixels.resize(width * height);
+		for(int i = 0; ok && i < width * height; i++) {
+			pixels[i] = 0xFF000000 | (rgb[i * 3] << 16) | (rgb[i * 3 + 1] << 8) | rgb[i * 3 + 2];
+		}
+	}
+	fclose(pFile);
+	return ok;
+}
+
+int
+main(int argc, char** argv)
+{
+	int columns = ArtConverter::DEFAULT_COLUMNS;
+	int iterations = 50;
+	const char* pPpm = NULL;
+	bool print = false;
+
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-columns") == 0 && i + 1 < argc) {
+			columns = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-iterations") == 0 && i + 1 < argc) {
+			iterations = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-ppm") == 0 && i + 1 < argc) {
+			pPpm = argv[++i];
+		} else if(strcmp(argv[i], "-print") == 0) {
+			print = true;
+		} else {
+			fprintf(stderr, "usage: %s [-columns N] [-iterations N] [-ppm FILE] [-print]\n", argv[0]);
+			return 1;
+		}
+	}
+	if(columns <= 0 || columns > ArtConverter::MAX_COLUMNS || iterations <= 0) {
+		fprintf(stderr, "columns must be 1..%d, iterations positive\n", ArtConverter::MAX_COLUMNS);
+		return 1;
+	}
+
+	int width = SYNTHETIC_WIDTH;
+	int height = SYNTHETIC_HEIGHT;
+	std::vector<unsigned int> pixels;
+	if(pPpm != NULL) {
+		if(!ReadPpm(pPpm, width, height, pixels)) {
+			fprintf(stderr, "cannot read %s as binary PPM\n", pPpm);
+			return 1;
+		}
+	} else {
+		MakeSynthetic(width, height, pixels);
+	}
+	if(columns > width) {
+		columns = width;
+	}
+
+	int rows = ArtConverter::GetRows(width, height, columns);
+	std::vector<byte> reference(columns * rows);
+	std::vector<byte> luma(columns * rows);
+
+	double bestReference = 1e9;
+	double bestBands = 1e9;
+	for(int i = 0; i < iterations; i++) {
+		double start = GetMilliseconds();
+		DownsampleCells(&pixels[0], width, height, width, columns, rows, &reference[0]);
+		double middle = GetMilliseconds();
+		ArtConverter::Downsample(&pixels[0], width, height, width, columns, rows, &luma[0]);
+		double end = GetMilliseconds();
+		bestReference = middle - start < bestReference ? middle - start : bestReference;
+		bestBands = end - middle < bestBands ? end - middle : bestBands;
+	}
+	int mismatches = 0;
+	for(int i = 0; i < columns * rows; i++) {
+		mismatches += reference[i] != luma[i] ? 1 : 0;
+	}
+
+	ArtConverter converter;
+	if(IsFailed(converter.Construct())) {
+		fprintf(stderr, "default ramp rejected\n");
+		return 1;
+	}
+	String art;
+	int linecount = 0;
+	double bestConvert = 1e9;
+	for(int i = 0; i < iterations; i++) {
+		double start = GetMilliseconds();
+		result r = converter.Convert(&pixels[0], width, height, width, columns, art, linecount);
+		double elapsed = GetMilliseconds() - start;
+		if(IsFailed(r)) {
+			fprintf(stderr, "conversion failed by %s\n", GetErrorMessage(r));
+			return 1;
+		}
+		bestConvert = elapsed < bestConvert ? elapsed : bestConvert;
+	}
+
+	double megapixels = width * (double)height / 1000000.0;
+	printf("%dx%d picture, %dx%d cells, best of %d\n", width, height, columns, linecount, iterations);
+	printf("%-30s %12s %12s\n", "case", "best ms", "Mpixel/s");
+	printf("%-30s %12.3f %12.1f\n", "downsample per cell", bestReference, megapixels / (bestReference / 1000.0));
+	printf("%-30s %12.3f %12.1f\n", "downsample by bands", bestBands, megapixels / (bestBands / 1000.0));
+	printf("%-30s %12.3f %12.1f\n", "convert", bestConvert, megapixels / (bestConvert / 1000.0));
+	printf("%-30s %12d\n", "cell mismatches", mismatches);
+
+	if(print) {
+		printf("\n%ls", art.GetPointer());
+	}
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,238 @@
+/**
+ * JournalStore benchmark: the cost of one recent item written as a journal
+ * record against the three SQLite transactions the registry ran for it
+ * before, and of replaying a journal of -records records at startup. Checks
+ * the recent bound, the refused favourite over the limit, the counters,
+ * that a reopen sees the same lists, that a torn last record costs only
+ * itself, and that a compaction cut off before or after its snapshot moved
+ * in loses nothing.
+ *
+ *   make journal
+ *   ./textart-journal -records 2000
+ */
+
+#include "BenchUtil.h"
+#include "JournalStore.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+
+using namespace Osp::Base;
+using namespace Osp::Io;
+
+static const int RECENT = 0;
+static const int FAVOURITES = 1;
+static const int COUNTERS = 2;
+static const int MAX_RECENT = 9;
+static const int MAX_FAVOURITES = 500;
+static const mchar STORE_PATH[] = L"/Home/store";
+
+static String
+ItemPath(int index)
+{
+	String path(L"/Home/catalog/category");
+	path.Append(index % 17);
+	path.Append(L"/item");
+	path.Append(index);
+	path.Append(L".txt");
+	return path;
+}
+
+static result
+Open(JournalStore& store)
+{
+	store.SetLimit(RECENT, MAX_RECENT, JournalStore::LIMIT_DROP_OLDEST);
+	store.SetLimit(FAVOURITES, MAX_FAVOURITES, JournalStore::LIMIT_REFUSE);
+	return store.Construct(STORE_PATH);
+}
+
+static long
+FileSize(const std::string& path)
+{
+	FILE* pFile = fopen(path.c_str(), "rb");
+	if(pFile == NULL) {
+		return -1;
+	}
+	fseek(pFile, 0, SEEK_END);
+	long size = ftell(pFile);
+	fclose(pFile);
+	return size;
+}
+
+static bool
+SameLists(const JournalStore& a, const JournalStore& b)
+{
+	for(int collection = RECENT; collection <= COUNTERS; collection++) {
+		if(a.GetCount(collection) != b.GetCount(collection)) {
+			return false;
+		}
+		for(int i = 0; i < a.GetCount(collection); i++) {
+			if(a.GetKey(collection, i) != b.GetKey(collection, i) || a.GetValue(collection, i) != b.GetValue(collection, i)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// What TextArtRegistry::InsertRecent did per item
+static double
+MeasureSql(int records)
+{
+	Database database;
+	database.Construct(L"/Home/textart", true);
+	database.ExecuteSql(L"CREATE TABLE IF NOT EXISTS recent ( id INTEGER PRIMARY KEY AUTOINCREMENT, ancii TEXT )", true);
+	double start = GetMilliseconds();
+	for(int i = 0; i < records; i++) {
+		String path = ItemPath(i % 40);
+		database.BeginTransaction();
+		DbStatement* pStmt = database.CreateStatementN(L"DELETE FROM recent WHERE ancii = ?");
+		pStmt->BindString(0, path);
+		delete database.ExecuteStatementN(*pStmt);
+		delete pStmt;
+		database.CommitTransaction();
+
+		database.BeginTransaction();
+		pStmt = database.CreateStatementN(L"INSERT INTO recent (ancii) VALUES (?)");
+		pStmt->BindString(0, path);
+		delete database.ExecuteStatementN(*pStmt);
+		delete pStmt;
+		database.CommitTransaction();
+
+		database.BeginTransaction();
+		database.ExecuteSql(L"DELETE FROM recent WHERE id in (SELECT id FROM recent ORDER BY id DESC LIMIT 9, 1)", true);
+		database.CommitTransaction();
+	}
+	return GetMilliseconds() - start;
+}
+
+int
+main(int argc, char** argv)
+{
+	int records = 2000;
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-records") == 0 && i + 1 < argc) {
+			records = atoi(argv[++i]);
+		} else {
+			fprintf(stderr, "usage: %s [-records N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if(records < MAX_FAVOURITES + 100) {
+		records = MAX_FAVOURITES + 100;
+	}
+
+	char workTemplate[] = "/tmp/textart-journal-XXXXXX";
+	char* pWork = mkdtemp(workTemplate);
+	if(pWork == NULL) {
+		perror("mkdtemp");
+		return 1;
+	}
+	std::string work = pWork;
+	std::string snapshot = work + "/store.snapshot";
+	std::string journal = work + "/store.journal";
+	HostFileSystem::Mount("/Home", work.c_str());
+	bool passed = true;
+
+	printf("%-30s %8s %12s %12s\n", "case", "ops", "ms", "us/op");
+	double sqlMs = MeasureSql(records);
+	printf("%-30s %8d %12.3f %12.1f\n", "sqlite recent (before)", records, sqlMs, sqlMs * 1000 / records);
+
+	// Appends, with the compactions they bring
+	JournalStore store;
+	passed = Check(!IsFailed(Open(store)), "opening an empty store") && passed;
+	double start = GetMilliseconds();
+	for(int i = 0; i < records; i++) {
+		store.Put(RECENT, ItemPath(i % 40));
+	}
+	double appendMs = GetMilliseconds() - start;
+	printf("%-30s %8d %12.3f %12.1f\n", "journal recent", records, appendMs, appendMs * 1000 / records);
+	passed = Check(store.GetCount(RECENT) == MAX_RECENT && store.GetKey(RECENT, 0) == ItemPath((records - 1) % 40)
+			&& store.GetKey(RECENT, MAX_RECENT - 1) == ItemPath((records - MAX_RECENT) % 40), "the newest nine recent") && passed;
+	passed = Check(store.GetJournalRecords() < 256, "the journal compacted") && passed;
+
+	int refused = 0;
+	for(int i = 0; i < MAX_FAVOURITES + 20; i++) {
+		if(store.Put(FAVOURITES, ItemPath(i)) == E_OVERFLOW) {
+			refused++;
+		}
+	}
+	passed = Check(refused == 20 && store.GetCount(FAVOURITES) == MAX_FAVOURITES, "favourites over the limit refused") && passed;
+	passed = Check(!IsFailed(store.Remove(FAVOURITES, ItemPath(3))) && store.Remove(FAVOURITES, ItemPath(3)) == E_OBJ_NOT_FOUND
+			&& !IsFailed(store.Put(FAVOURITES, ItemPath(MAX_FAVOURITES))), "a favourite removed makes room") && passed;
+	for(int i = 0; i < 30; i++) {
+		store.Increment(COUNTERS, ItemPath(i % 3), i % 3 + 1);
+	}
+	passed = Check(store.GetCount(COUNTERS) == 3 && store.GetValue(COUNTERS, store.Find(COUNTERS, ItemPath(2))) == 30, "the counters") && passed;
+
+	// Replay of a journal left long
+	store.Compact();
+	for(int i = 0; i < 200; i++) {
+		store.Increment(COUNTERS, ItemPath(i % 3), 1);
+	}
+	long journalBytes = FileSize(journal);
+	start = GetMilliseconds();
+	JournalStore reopened;
+	passed = Check(!IsFailed(Open(reopened)), "reopening") && passed;
+	double replayMs = GetMilliseconds() - start;
+	printf("%-30s %8d %12.3f\n", "reopen", reopened.GetJournalRecords(), replayMs);
+	printf("%-30s %8ld %8ld bytes\n", "snapshot, journal", FileSize(snapshot), journalBytes);
+	passed = Check(SameLists(store, reopened), "the lists after a reopen") && passed;
+	reopened.Close();
+
+	// An exit in the middle of an append: the last record is cut short
+	store.Put(RECENT, ItemPath(1000));
+	store.Put(RECENT, ItemPath(1001));
+	store.Close();
+	passed = Check(truncate(journal.c_str(), FileSize(journal) - 3) == 0, "cutting the journal") && passed;
+	{
+		JournalStore torn;
+		passed = Check(!IsFailed(Open(torn)) && torn.GetKey(RECENT, 0) == ItemPath(1000), "only the torn record lost") && passed;
+		torn.Put(RECENT, ItemPath(1002));
+	}
+	{
+		JournalStore after;
+		passed = Check(!IsFailed(Open(after)) && after.GetKey(RECENT, 0) == ItemPath(1002)
+				&& after.GetKey(RECENT, 1) == ItemPath(1000), "appends after the torn record kept") && passed;
+		after.Close();
+	}
+
+	// An exit in a compaction after the old snapshot was removed: the new one waits aside, the old journal is still there
+	std::string temp = snapshot + ".tmp";
+	std::string oldJournal = journal + ".old";
+	JournalStore expected;
+	Open(expected);
+	expected.Put(RECENT, ItemPath(1003));
+	passed = Check(system(("cp '" + journal + "' '" + oldJournal + "'").c_str()) == 0, "copying the journal") && passed;
+	expected.Compact();
+	expected.Close();
+	passed = Check(rename(snapshot.c_str(), temp.c_str()) == 0 && rename(oldJournal.c_str(), journal.c_str()) == 0,
+			"the files of the cut compaction") && passed;
+	{
+		JournalStore moved;
+		passed = Check(!IsFailed(Open(moved)) && SameLists(expected, moved), "a compaction finished at open") && passed;
+	}
+	// and one before: the partial file aside goes
+	FILE* pTemp = fopen(temp.c_str(), "wb");
+	if(pTemp != NULL) {
+		fputs("TXJS", pTemp);
+		fclose(pTemp);
+	}
+	{
+		JournalStore partial;
+		passed = Check(!IsFailed(Open(partial)) && SameLists(expected, partial) && access(temp.c_str(), F_OK) != 0,
+				"a partial compaction dropped") && passed;
+	}
+
+	std::string cleanup = "rm -rf '" + work + "'";
+	if(system(cleanup.c_str()) != 0) {
+		fprintf(stderr, "cannot remove %s\n", work.c_str());
+	}
+	printf("%s\n", passed ? "passed" : "FAILED");
+	return passed ? 0 : 1;
+}
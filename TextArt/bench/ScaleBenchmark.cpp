@@ -0,0 +1,287 @@
+/**
+ * Scaling benchmark: generates synthetic catalogs of growing size with
+ * CatalogGenerator and loads each the way the forms do. CategoryListForm
+ * reads every category.info, CategoryItemForm reads one category and keeps
+ * art, title and path of every item in its ItemStore until the next category
+ * is opened. The store footprint of the largest category shows the bytes per
+ * item the form keeps beyond the text itself, arts the distinct bodies it
+ * holds once for all items sharing them, and the switch time is what a
+ * language change costs there: every column in turn, no file access.
+ * Every scale runs in its own process so peak RSS is per scale.
+ *
+ *   make scale
+ *   ./textart-scale -scales 1000,10000,100000 -categories 10
+ */
+
+#include "BenchUtil.h"
+#include "Catalog.h"
+#include "CatalogGenerator.h"
+#include "ItemStore.h"
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+
+// Per-item cost this much above the smallest scale counts as non-linear
+static const double LINEARITY_LIMIT = 1.25;
+
+struct Result {
+	int items;
+	int shown;
+	double generateMs;
+	double listMs;
+	double openMs;
+	double largestOpenMs;
+	long heapPeak;
+	long rssPeak;
+	int largestItems;
+	int largestStore;
+	int largestArts;
+	double largestSwitchMs;
+};
+
+static long
+GetHeapInUse(void)
+{
+	struct mallinfo2 info = mallinfo2();
+	return (long)info.uordblks;
+}
+
+// What CategoryItemForm holds while a category is open
+class OpenCategory {
+public:
+	OpenCategory(void) {
+		items.Construct();
+		items.SetLanguage(1);
+		switchShown = 0;
+	}
+
+	int Load(const String& name) {
+		ArrayList paths;
+		paths.Construct();
+		Catalog::GetItems(name, paths);
+		for(int i = 0; i < paths.GetCount(); i++) {
+			const String& fileName = *static_cast<String*>(paths.GetAt(i));
+			String titles[Catalog::LANGUAGE_COUNT];
+			String art;
+			int linecount = 0;
+			if(IsFailed(Catalog::ReadItem(fileName, titles, art, linecount))) {
+				continue;
+			}
+			items.Add(titles, art, fileName, linecount);
+		}
+		paths.RemoveAll(true);
+
+		int shown = 0;
+		for(int i = 0; i < items.GetCount(); i++) {
+			shown += items.IsTranslated(i) ? 1 : 0;
+		}
+		return shown;
+	}
+
+	// What ItemListForm::RebuildList reads per item, for every language
+	double SwitchLanguages(void) {
+		double start = GetMilliseconds();
+		for(int language = 0; language < Catalog::LANGUAGE_COUNT; language++) {
+			items.SetLanguage(language);
+			for(int i = 0; i < items.GetCount(); i++) {
+				ItemStore::Item item;
+				if(items.IsTranslated(i) && !IsFailed(items.GetItem(i, item))) {
+					switchShown += item.linecount;
+				}
+			}
+		}
+		items.SetLanguage(1);
+		return (GetMilliseconds() - start) / Catalog::LANGUAGE_COUNT;
+	}
+
+	ItemStore items;
+	// keeps the switch loop from being optimized away
+	int switchShown;
+};
+
+static void
+Load(Result& result)
+{
+	long heapBase = GetHeapInUse();
+	result.heapPeak = 0;
+
+	// CategoryListForm
+	double start = GetMilliseconds();
+	ArrayList names;
+	names.Construct();
+	Catalog::GetCategories(names);
+	ArrayList titles;
+	titles.Construct();
+	for(int i = 0; i < names.GetCount(); i++) {
+		String title, desc, preview;
+		if(!IsFailed(Catalog::ReadCategory(*static_cast<String*>(names.GetAt(i)), 1, title, desc, preview))) {
+			titles.Add(*(new String(title)));
+		}
+	}
+	result.listMs = GetMilliseconds() - start;
+
+	// CategoryItemForm, one category open at a time
+	result.openMs = 0;
+	result.largestOpenMs = 0;
+	result.shown = 0;
+	for(int i = 0; i < names.GetCount(); i++) {
+		OpenCategory* pCategory = new OpenCategory();
+		start = GetMilliseconds();
+		result.shown += pCategory->Load(*static_cast<String*>(names.GetAt(i)));
+		double elapsed = GetMilliseconds() - start;
+		result.openMs += elapsed;
+		if(elapsed > result.largestOpenMs) {
+			result.largestOpenMs = elapsed;
+			result.largestItems = pCategory->items.GetCount();
+			result.largestStore = pCategory->items.GetMemoryUsage();
+			result.largestArts = pCategory->items.GetArtCount();
+			result.largestSwitchMs = pCategory->SwitchLanguages();
+		}
+		long heap = GetHeapInUse() - heapBase;
+		if(heap > result.heapPeak) {
+			result.heapPeak = heap;
+		}
+		delete pCategory;
+	}
+
+	names.RemoveAll(true);
+	titles.RemoveAll(true);
+}
+
+static bool
+RunScale(const std::string& work, int items, int categories, unsigned int seed, Result& result)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "/catalog%d", items);
+	std::string root = work + name;
+
+	CatalogGenerator::Options options;
+	options.items = items;
+	options.categories = categories;
+	options.seed = seed;
+	CatalogGenerator::Stats stats;
+	double start = GetMilliseconds();
+	if(!CatalogGenerator::Generate(root, options, stats)) {
+		fprintf(stderr, "generating %s failed\n", root.c_str());
+		return false;
+	}
+	double generateMs = GetMilliseconds() - start;
+
+	int pipeFds[2];
+	if(pipe(pipeFds) != 0) {
+		return false;
+	}
+	pid_t child = fork();
+	if(child == 0) {
+		close(pipeFds[0]);
+		HostFileSystem::Mount("/Home/catalog", root.c_str());
+		Result childResult;
+		memset(&childResult, 0, sizeof(childResult));
+		Load(childResult);
+		ssize_t written = write(pipeFds[1], &childResult, sizeof(childResult));
+		_exit(written == (ssize_t)sizeof(childResult) ? 0 : 1);
+	}
+	close(pipeFds[1]);
+	ssize_t received = read(pipeFds[0], &result, sizeof(result));
+	close(pipeFds[0]);
+
+	int status = 0;
+	struct rusage usage;
+	if(child < 0 || wait4(child, &status, 0, &usage) < 0 || received != (ssize_t)sizeof(result) || status != 0) {
+		return false;
+	}
+	result.items = stats.items;
+	result.generateMs = generateMs;
+	result.rssPeak = usage.ru_maxrss;
+
+	std::string cleanup = "rm -rf '" + root + "'";
+	return system(cleanup.c_str()) == 0;
+}
+
+static void
+ParseScales(const char* pList, std::vector<int>& scales)
+{
+	scales.clear();
+	const char* p = pList;
+	while(*p) {
+		char* pEnd = NULL;
+		long value = strtol(p, &pEnd, 10);
+		if(pEnd == p) {
+			break;
+		}
+		if(value > 0) {
+			scales.push_back((int)value);
+		}
+		p = *pEnd == ',' ? pEnd + 1 : pEnd;
+	}
+}
+
+int
+main(int argc, char** argv)
+{
+	std::vector<int> scales;
+	ParseScales("1000,10000,100000", scales);
+	int categories = 10;
+	unsigned int seed = 1;
+
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-scales") == 0 && i + 1 < argc) {
+			ParseScales(argv[++i], scales);
+		} else if(strcmp(argv[i], "-categories") == 0 && i + 1 < argc) {
+			categories = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-seed") == 0 && i + 1 < argc) {
+			seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+		} else {
+			fprintf(stderr, "usage: %s [-scales N,N,...] [-categories N] [-seed N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	char workTemplate[] = "/tmp/textart-scale-XXXXXX";
+	char* pWork = mkdtemp(workTemplate);
+	if(pWork == NULL) {
+		perror("mkdtemp");
+		return 1;
+	}
+	std::string work = pWork;
+
+	printf("%9s %9s %10s %10s %10s %12s %10s %10s %10s %9s %9s %13s %9s %10s\n", "items", "shown", "gen ms", "list ms", "open ms",
+			"largest ms", "us/item", "heap KB", "B/item", "rss KB", "store KB", "store B/item", "arts", "switch ms");
+
+	double baseCost = 0;
+	for(size_t i = 0; i < scales.size(); i++) {
+		Result result;
+		if(!RunScale(work, scales[i], categories, seed, result)) {
+			fprintf(stderr, "scale %d failed\n", scales[i]);
+			continue;
+		}
+		double cost = result.items > 0 ? (result.listMs + result.openMs) * 1000.0 / result.items : 0;
+		int perCategory = (result.items + categories - 1) / (categories > 0 ? categories : 1);
+		printf("%9d %9d %10.1f %10.2f %10.1f %12.1f %10.2f %10ld %10ld %9ld %9d %13d %9d %10.3f", result.items, result.shown,
+				result.generateMs, result.listMs, result.openMs, result.largestOpenMs, cost, result.heapPeak / 1024,
+				perCategory > 0 ? result.heapPeak / perCategory : 0, result.rssPeak, result.largestStore / 1024,
+				result.largestItems > 0 ? result.largestStore / result.largestItems : 0, result.largestArts, result.largestSwitchMs);
+		if(baseCost == 0) {
+			baseCost = cost;
+		} else if(cost > baseCost * LINEARITY_LIMIT) {
+			printf("  non-linear: x%.2f per item", cost / baseCost);
+		}
+		printf("\n");
+	}
+
+	rmdir(work.c_str());
+	return 0;
+}
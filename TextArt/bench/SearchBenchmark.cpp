@@ -0,0 +1,263 @@
+/**
+ * Search benchmark: builds the SearchIndex over a synthetic catalog of
+ * -items items (or over -catalog DIR), saves and reloads it, then types
+ * pieces of random item titles one character at a time the way the SearchBar
+ * sends them. Every keystroke is timed against the frame budget, and
+ * the results are checked against a full scan of the titles: every item
+ * whose title holds the query must be found. A query typed after blanks
+ * must find what it finds on its own, and a file with damaged postings must
+ * be refused.
+ *
+ *   make search
+ *   ./textart-search -items 100000 -queries 200
+ */
+
+#include "BenchUtil.h"
+#include "Catalog.h"
+#include "CatalogGenerator.h"
+#include "SearchIndex.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+
+// One frame at 60 Hz
+static const double FRAME_BUDGET_MS = 16.7;
+static const int MAX_RESULTS = 50;
+static const int MAX_QUERY_LENGTH = 12;
+
+static mchar
+Fold(mchar c)
+{
+	String value(c);
+	value.ToLowerCase();
+	return value[0];
+}
+
+static bool
+Contains(const mchar* pText, const std::vector<mchar>& query)
+{
+	for(const mchar* p = pText; *p != 0; p++) {
+		size_t matched = 0;
+		while(matched < query.size() && p[matched] != 0 && Fold(p[matched]) == Fold(query[matched])) {
+			matched++;
+		}
+		if(matched == query.size()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// A piece of a title, as someone might remember it
+static void
+PickQuery(const SearchIndex& index, unsigned int& seed, String& query)
+{
+	const mchar* pTitle = null;
+	int length = 0;
+	while(length == 0) {
+		seed = seed * 1103515245 + 12345;
+		int item = (int)((seed >> 8) % index.GetCount());
+		seed = seed * 1103515245 + 12345;
+		pTitle = index.GetTitle(item, (seed >> 8) % Catalog::LANGUAGE_COUNT);
+		while(pTitle[length] != 0) {
+			length++;
+		}
+	}
+	seed = seed * 1103515245 + 12345;
+	int start = length > 3 ? (int)((seed >> 8) % (length - 3)) : 0;
+	query.Clear();
+	for(int i = start; i < length && i - start < MAX_QUERY_LENGTH; i++) {
+		query.Append(pTitle[i]);
+	}
+}
+
+int
+main(int argc, char** argv)
+{
+	int items = 10000;
+	int queries = 100;
+	std::string catalog;
+
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-items") == 0 && i + 1 < argc) {
+			items = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-queries") == 0 && i + 1 < argc) {
+			queries = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-catalog") == 0 && i + 1 < argc) {
+			catalog = argv[++i];
+		} else {
+			fprintf(stderr, "usage: %s [-items N | -catalog DIR] [-queries N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	std::string work;
+	if(catalog.empty()) {
+		char workTemplate[] = "/tmp/textart-search-XXXXXX";
+		char* pWork = mkdtemp(workTemplate);
+		if(pWork == NULL) {
+			perror("mkdtemp");
+			return 1;
+		}
+		work = pWork;
+		catalog = work + "/catalog";
+		CatalogGenerator::Options options;
+		options.items = items;
+		CatalogGenerator::Stats stats;
+		if(!CatalogGenerator::Generate(catalog, options, stats)) {
+			fprintf(stderr, "generating %s failed\n", catalog.c_str());
+			return 1;
+		}
+	}
+	HostFileSystem::Mount("/Home/catalog", catalog.c_str());
+
+	SearchIndex index;
+	double start = GetMilliseconds();
+	result r = index.Build();
+	double buildMs = GetMilliseconds() - start;
+	if(IsFailed(r) || index.GetCount() == 0) {
+		fprintf(stderr, "building the index failed by %s\n", GetErrorMessage(r));
+		return 1;
+	}
+
+	String path = L"/Home/catalog/search.idx";
+	start = GetMilliseconds();
+	r = index.Save(path);
+	double saveMs = GetMilliseconds() - start;
+	start = GetMilliseconds();
+	if(!IsFailed(r)) {
+		r = index.Load(path);
+	}
+	double loadMs = GetMilliseconds() - start;
+	if(IsFailed(r)) {
+		fprintf(stderr, "saving or loading the index failed by %s\n", GetErrorMessage(r));
+		return 1;
+	}
+	FILE* pFile = fopen(HostFileSystem::Resolve(path.GetPointer()).c_str(), "rb");
+	long fileSize = 0;
+	if(pFile != NULL) {
+		fseek(pFile, 0, SEEK_END);
+		fileSize = ftell(pFile);
+		fclose(pFile);
+	}
+
+	printf("%d items, %d trigrams, index %ld KB on disk, %d KB in memory\n", index.GetCount(), index.GetTrigramCount(),
+			fileSize / 1024, index.GetMemoryUsage() / 1024);
+	printf("%-30s %12.1f\n", "build ms", buildMs);
+	printf("%-30s %12.1f\n", "save ms", saveMs);
+	printf("%-30s %12.1f\n", "load ms", loadMs);
+
+	std::vector<double> keystrokes;
+	std::vector<SearchIndex::Result> results(index.GetCount());
+	unsigned int seed = 1;
+	int misses = 0;
+	int checked = 0;
+	for(int q = 0; q < queries; q++) {
+		String query;
+		PickQuery(index, seed, query);
+		String typed;
+		for(int i = 0; i < query.GetLength(); i++) {
+			typed.Append(query[i]);
+			SearchIndex::Result top[MAX_RESULTS];
+			start = GetMilliseconds();
+			index.Search(typed, 1, top, MAX_RESULTS);
+			keystrokes.push_back(GetMilliseconds() - start);
+		}
+
+		// Full result list against a scan of every title, on the complete query
+		int found = index.Search(query, 1, &results[0], index.GetCount());
+		std::vector<bool> hit(index.GetCount(), false);
+		for(int i = 0; i < found; i++) {
+			hit[results[i].item] = true;
+		}
+		std::vector<mchar> folded(query.GetPointer(), query.GetPointer() + query.GetLength());
+		for(int item = 0; item < index.GetCount(); item++) {
+			bool expected = false;
+			for(int language = 0; language < Catalog::LANGUAGE_COUNT && !expected; language++) {
+				expected = Contains(index.GetTitle(item, language), folded);
+			}
+			if(expected) {
+				checked++;
+				misses += hit[item] ? 0 : 1;
+			}
+		}
+	}
+
+	std::sort(keystrokes.begin(), keystrokes.end());
+	double total = 0;
+	int overBudget = 0;
+	for(size_t i = 0; i < keystrokes.size(); i++) {
+		total += keystrokes[i];
+		overBudget += keystrokes[i] > FRAME_BUDGET_MS ? 1 : 0;
+	}
+	if(!keystrokes.empty()) {
+		printf("%-30s %12d\n", "keystrokes", (int)keystrokes.size());
+		printf("%-30s %12.3f\n", "mean ms", total / keystrokes.size());
+		printf("%-30s %12.3f\n", "p50 ms", keystrokes[keystrokes.size() / 2]);
+		printf("%-30s %12.3f\n", "p99 ms", keystrokes[keystrokes.size() * 99 / 100]);
+		printf("%-30s %12.3f\n", "max ms", keystrokes.back());
+		printf("%-30s %12d\n", "over frame budget", overBudget);
+	}
+	printf("%-30s %12d of %d\n", "title matches missed", misses, checked);
+
+	// A query of blanks has no trigram and must not leave an empty set to narrow
+	int blankMisses = 0;
+	for(int q = 0; q < 20; q++) {
+		String query;
+		PickQuery(index, seed, query);
+		String blanked(L"   ");
+		blanked.Append(query);
+		SearchIndex::Result top[MAX_RESULTS];
+		index.Search(L"x", 1, top, MAX_RESULTS);
+		int fresh = index.Search(blanked, 1, top, MAX_RESULTS);
+		index.Search(L"   ", 1, top, MAX_RESULTS);
+		blankMisses += index.Search(blanked, 1, top, MAX_RESULTS) != fresh ? 1 : 0;
+	}
+	printf("%-30s %12d of 20\n", "typed after blanks missed", blankMisses);
+
+	// Postings cut off in the middle of a list are refused at load
+	std::string saved = HostFileSystem::Resolve(path.GetPointer());
+	std::string corrupt = saved + ".corrupt";
+	bool refused = false;
+	FILE* pIn = fopen(saved.c_str(), "rb");
+	FILE* pOut = fopen(corrupt.c_str(), "wb");
+	if(pIn != NULL && pOut != NULL) {
+		std::vector<unsigned char> bytes(fileSize);
+		if(fread(&bytes[0], 1, bytes.size(), pIn) == bytes.size() && bytes.size() > 4) {
+			memset(&bytes[bytes.size() - 4], 0xFF, 4);
+			fwrite(&bytes[0], 1, bytes.size(), pOut);
+		}
+	}
+	if(pIn != NULL) {
+		fclose(pIn);
+	}
+	if(pOut != NULL) {
+		fclose(pOut);
+		SearchIndex damaged;
+		String corruptPath(path);
+		corruptPath.Append(L".corrupt");
+		refused = damaged.Load(corruptPath) == E_INVALID_FORMAT;
+		unlink(corrupt.c_str());
+	}
+	printf("%-30s %12s\n", "damaged postings refused", refused ? "yes" : "no");
+
+	if(!work.empty()) {
+		std::string cleanup = "rm -rf '" + work + "'";
+		if(system(cleanup.c_str()) != 0) {
+			fprintf(stderr, "cannot remove %s\n", work.c_str());
+		}
+	} else {
+		unlink(HostFileSystem::Resolve(path.GetPointer()).c_str());
+	}
+	return misses == 0 && blankMisses == 0 && refused ? 0 : 1;
+}
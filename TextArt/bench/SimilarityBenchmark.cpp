@@ -0,0 +1,238 @@
+/**
+ * Similarity benchmark: builds the SimilarityIndex over a synthetic catalog
+ * of -items items (or over -catalog DIR), saves and reloads it, then looks
+ * up the matches of every item the way the popup does, path first. For
+ * -sample items the stored matches are checked against a scan of every
+ * signature (recall of the matches at or above -threshold percent) and the
+ * estimated similarity against the exact share of common shingles.
+ *
+ *   make similar
+ *   ./textart-similar -items 100000 -sample 200
+ */
+
+#include "BenchUtil.h"
+#include "Catalog.h"
+#include "CatalogGenerator.h"
+#include "SimilarityIndex.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+
+// Shingles the way SimilarityIndex::Sign cuts them
+static void
+GetShingles(const String& art, std::set<std::wstring>& shingles)
+{
+	const mchar* pArt = art.GetPointer();
+	for(int i = 0; i + SimilarityIndex::SHINGLE_LENGTH <= art.GetLength(); i++) {
+		bool blank = true;
+		bool broken = false;
+		for(int c = 0; c < SimilarityIndex::SHINGLE_LENGTH; c++) {
+			broken = broken || pArt[i + c] == L'\n' || pArt[i + c] == L'\r';
+			blank = blank && (pArt[i + c] == L' ' || pArt[i + c] == L'\t');
+		}
+		if(!broken && !blank) {
+			shingles.insert(std::wstring(pArt + i, SimilarityIndex::SHINGLE_LENGTH));
+		}
+	}
+}
+
+static int
+GetJaccard(const std::set<std::wstring>& left, const std::set<std::wstring>& right)
+{
+	int common = 0;
+	for(std::set<std::wstring>::const_iterator i = left.begin(); i != left.end(); ++i) {
+		common += right.count(*i) > 0 ? 1 : 0;
+	}
+	int all = (int)(left.size() + right.size()) - common;
+	return all > 0 ? common * 100 / all : 0;
+}
+
+static bool
+ReadArt(const SimilarityIndex& index, int item, String& art)
+{
+	String path;
+	String titles[Catalog::LANGUAGE_COUNT];
+	int linecount = 0;
+	return !IsFailed(index.GetPath(item, path)) && !IsFailed(Catalog::ReadItem(path, titles, art, linecount));
+}
+
+int
+main(int argc, char** argv)
+{
+	int items = 10000;
+	int sample = 100;
+	int threshold = 50;
+	std::string catalog;
+
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-items") == 0 && i + 1 < argc) {
+			items = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-sample") == 0 && i + 1 < argc) {
+			sample = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-threshold") == 0 && i + 1 < argc) {
+			threshold = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-catalog") == 0 && i + 1 < argc) {
+			catalog = argv[++i];
+		} else {
+			fprintf(stderr, "usage: %s [-items N | -catalog DIR] [-sample N] [-threshold PERCENT]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	std::string work;
+	if(catalog.empty()) {
+		char workTemplate[] = "/tmp/textart-similar-XXXXXX";
+		char* pWork = mkdtemp(workTemplate);
+		if(pWork == NULL) {
+			perror("mkdtemp");
+			return 1;
+		}
+		work = pWork;
+		catalog = work + "/catalog";
+		CatalogGenerator::Options options;
+		options.items = items;
+		CatalogGenerator::Stats stats;
+		if(!CatalogGenerator::Generate(catalog, options, stats)) {
+			fprintf(stderr, "generating %s failed\n", catalog.c_str());
+			return 1;
+		}
+	}
+	HostFileSystem::Mount("/Home/catalog", catalog.c_str());
+
+	SimilarityIndex index;
+	double start = GetMilliseconds();
+	result r = index.Build();
+	double buildMs = GetMilliseconds() - start;
+	if(IsFailed(r) || index.GetCount() == 0) {
+		fprintf(stderr, "building the index failed by %s\n", GetErrorMessage(r));
+		return 1;
+	}
+
+	String path = L"/Home/catalog/similar.idx";
+	start = GetMilliseconds();
+	r = index.Save(path);
+	double saveMs = GetMilliseconds() - start;
+	start = GetMilliseconds();
+	if(!IsFailed(r)) {
+		r = index.Load(path);
+	}
+	double loadMs = GetMilliseconds() - start;
+	if(IsFailed(r)) {
+		fprintf(stderr, "saving or loading the index failed by %s\n", GetErrorMessage(r));
+		return 1;
+	}
+	FILE* pFile = fopen(HostFileSystem::Resolve(path.GetPointer()).c_str(), "rb");
+	long fileSize = 0;
+	if(pFile != NULL) {
+		fseek(pFile, 0, SEEK_END);
+		fileSize = ftell(pFile);
+		fclose(pFile);
+	}
+
+	printf("%d items, index %ld KB on disk, %d KB in memory\n", index.GetCount(), fileSize / 1024, index.GetMemoryUsage() / 1024);
+	printf("%-30s %12.1f\n", "build ms", buildMs);
+	printf("%-30s %12.1f\n", "save ms", saveMs);
+	printf("%-30s %12.1f\n", "load ms", loadMs);
+
+	// Every item by path, as the popup asks
+	std::vector<String> paths(index.GetCount());
+	for(int item = 0; item < index.GetCount(); item++) {
+		index.GetPath(item, paths[item]);
+	}
+	SimilarityIndex::Match matches[SimilarityIndex::MAX_SIMILAR];
+	int notFound = 0;
+	int withMatches = 0;
+	double worst = 0;
+	start = GetMilliseconds();
+	for(int item = 0; item < index.GetCount(); item++) {
+		double lookupStart = GetMilliseconds();
+		int found = index.Find(paths[item]);
+		int count = index.GetSimilar(found, matches, SimilarityIndex::MAX_SIMILAR);
+		double elapsed = GetMilliseconds() - lookupStart;
+		worst = elapsed > worst ? elapsed : worst;
+		notFound += found == item ? 0 : 1;
+		withMatches += count > 0 ? 1 : 0;
+	}
+	double lookupMs = GetMilliseconds() - start;
+	printf("%-30s %12.3f\n", "lookup mean us", lookupMs * 1000.0 / index.GetCount());
+	printf("%-30s %12.3f\n", "lookup max us", worst * 1000.0);
+	printf("%-30s %12d\n", "items with matches", withMatches);
+	printf("%-30s %12d\n", "paths not found", notFound);
+
+	// Every signature for the scan, read back from the files
+	std::vector<unsigned int> signatures(index.GetCount() * SimilarityIndex::SIGNATURE_SIZE);
+	for(int item = 0; item < index.GetCount(); item++) {
+		String art;
+		ReadArt(index, item, art);
+		SimilarityIndex::Sign(art.GetPointer(), art.GetLength(), &signatures[item * SimilarityIndex::SIGNATURE_SIZE]);
+	}
+
+	int expected = 0;
+	int recalled = 0;
+	int compared = 0;
+	double error = 0;
+	unsigned int seed = 1;
+	for(int s = 0; s < sample && s < index.GetCount(); s++) {
+		seed = seed * 1103515245 + 12345;
+		int item = (int)((seed >> 8) % index.GetCount());
+		int count = index.GetSimilar(item, matches, SimilarityIndex::MAX_SIMILAR);
+
+		// Best matches by scan, the stored list must hold them or be full of better ones
+		const unsigned int* pSignature = &signatures[item * SimilarityIndex::SIGNATURE_SIZE];
+		if(pSignature[0] != 0xFFFFFFFF) {
+			std::vector<int> best;
+			for(int other = 0; other < index.GetCount(); other++) {
+				if(other != item && signatures[other * SimilarityIndex::SIGNATURE_SIZE] != 0xFFFFFFFF) {
+					int similarity = SimilarityIndex::Compare(pSignature, &signatures[other * SimilarityIndex::SIGNATURE_SIZE]);
+					if(similarity >= threshold) {
+						best.push_back(similarity);
+					}
+				}
+			}
+			std::sort(best.begin(), best.end());
+			std::reverse(best.begin(), best.end());
+			for(size_t i = 0; i < best.size() && i < (size_t)SimilarityIndex::MAX_SIMILAR; i++) {
+				expected++;
+				recalled += (int)i < count && matches[i].similarity >= best[i] ? 1 : 0;
+			}
+		}
+
+		// Estimate against the exact share of shingles
+		String art;
+		ReadArt(index, item, art);
+		std::set<std::wstring> shingles;
+		GetShingles(art, shingles);
+		for(int i = 0; i < count; i++) {
+			String other;
+			ReadArt(index, matches[i].item, other);
+			std::set<std::wstring> otherShingles;
+			GetShingles(other, otherShingles);
+			error += fabs((double)(matches[i].similarity - GetJaccard(shingles, otherShingles)));
+			compared++;
+		}
+	}
+	printf("%-30s %12d of %d\n", "scan matches recalled", recalled, expected);
+	printf("%-30s %12.1f\n", "mean estimate error %", compared > 0 ? error / compared : 0.0);
+
+	if(!work.empty()) {
+		std::string cleanup = "rm -rf '" + work + "'";
+		if(system(cleanup.c_str()) != 0) {
+			fprintf(stderr, "cannot remove %s\n", work.c_str());
+		}
+	} else {
+		unlink(HostFileSystem::Resolve(path.GetPointer()).c_str());
+	}
+	return notFound == 0 ? 0 : 1;
+}
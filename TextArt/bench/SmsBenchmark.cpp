@@ -0,0 +1,201 @@
+/**
+ * SMS segmentation benchmark: SmsSegmenter::Prepare on the art of every
+ * item of -catalog, as the item popup runs it, against the 80-character
+ * guess it replaced. Checks that -sendable items of the shipped catalog fit
+ * into MAX_SEGMENTS, and fixed vectors: an extension character that does
+ * not fit at the end of a part moves whole into the next one, the Greek
+ * capitals and the euro sign stay GSM-7, and UCS-2 splits at 70 units
+ * single and 67 per part.
+ *
+ *   make sms
+ *   ./textart-sms -catalog ../Home/catalog -sendable 165
+ */
+
+#include "BenchUtil.h"
+#include "Catalog.h"
+#include "SmsSegmenter.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+using namespace Osp::Io;
+
+// What the popup offered SMS for before SmsSegmenter
+static const int OLD_SMS_LENGTH = 80;
+
+static String
+Repeat(mchar ch, int count)
+{
+	String text;
+	for(int i = 0; i < count; i++) {
+		text.Append(ch);
+	}
+	return text;
+}
+
+static bool
+Classified(const String& text, SmsSegmenter::Encoding encoding, int units, int segments, const char* pWhat)
+{
+	SmsSegmenter::Info info;
+	SmsSegmenter::Classify(text, info);
+	if(info.encoding != encoding || info.units != units || info.segments != segments) {
+		fprintf(stderr, "missed: %s, encoding %d, %d units, %d segments\n", pWhat, info.encoding, info.units, info.segments);
+		return false;
+	}
+	return true;
+}
+
+static bool
+CheckVectors(void)
+{
+	bool passed = true;
+	const mchar EURO = 0x20AC;
+
+	// GSM-7 limits
+	passed = Classified(Repeat(L'a', 160), SmsSegmenter::ENCODING_GSM7, 160, 1, "160 septets in one part") && passed;
+	passed = Classified(Repeat(L'a', 161), SmsSegmenter::ENCODING_GSM7, 161, 2, "161 septets in two parts") && passed;
+	passed = Classified(Repeat(L'a', 306), SmsSegmenter::ENCODING_GSM7, 306, 2, "306 septets in two parts") && passed;
+	passed = Classified(Repeat(L'a', 307), SmsSegmenter::ENCODING_GSM7, 307, 3, "307 septets in three parts") && passed;
+
+	// Extension characters take two septets and are never split
+	passed = Classified(Repeat(L'a', 158) + L"{", SmsSegmenter::ENCODING_GSM7, 160, 1, "an extension character ending a single part") && passed;
+	String boundary = Repeat(L'a', 152);
+	boundary.Append(EURO);
+	boundary.Append(Repeat(L'a', 152));
+	// 152 + 2 does not fit 153, the euro opens the second part: 152 | 2 + 151 | 1
+	passed = Classified(boundary, SmsSegmenter::ENCODING_GSM7, 306, 3, "an escape pair moved to the next part") && passed;
+	String fits = Repeat(L'a', 151);
+	fits.Append(EURO);
+	fits.Append(Repeat(L'a', 153));
+	passed = Classified(fits, SmsSegmenter::ENCODING_GSM7, 306, 2, "an escape pair ending a part") && passed;
+
+	// Greek capitals of the basic table and the euro of the extension table
+	String greek;
+	const mchar GREEK[] = { 0x0393, 0x0394, 0x0398, 0x039B, 0x039E, 0x03A0, 0x03A3, 0x03A6, 0x03A8, 0x03A9 };
+	for(int i = 0; i < 10; i++) {
+		greek.Append(GREEK[i]);
+	}
+	greek.Append(EURO);
+	passed = Classified(greek, SmsSegmenter::ENCODING_GSM7, 12, 1, "Greek capitals and the euro") && passed;
+	String alpha(L"a");
+	alpha.Append((mchar)0x03B1);
+	passed = Classified(alpha, SmsSegmenter::ENCODING_UCS2, 2, 1, "a small Greek letter needs UCS-2") && passed;
+
+	// UCS-2 limits
+	const mchar ZHE = 0x0416;
+	passed = Classified(Repeat(ZHE, 70), SmsSegmenter::ENCODING_UCS2, 70, 1, "70 units in one part") && passed;
+	passed = Classified(Repeat(ZHE, 71), SmsSegmenter::ENCODING_UCS2, 71, 2, "71 units in two parts") && passed;
+	passed = Classified(Repeat(ZHE, 134), SmsSegmenter::ENCODING_UCS2, 134, 2, "134 units in two parts") && passed;
+	passed = Classified(Repeat(ZHE, 135), SmsSegmenter::ENCODING_UCS2, 135, 3, "135 units in three parts") && passed;
+
+	// Cyrillic look-alikes go out as GSM-7, a text with other letters stays UCS-2
+	String lookalike;
+	lookalike.Append((mchar)0x0410);
+	lookalike.Append((mchar)0x0412);
+	lookalike.Append((mchar)0x0421);
+	String out;
+	SmsSegmenter::Info info;
+	passed = Check(SmsSegmenter::Prepare(lookalike, out, info) && info.encoding == SmsSegmenter::ENCODING_GSM7
+			&& out == L"ABC", "Cyrillic look-alikes transliterated") && passed;
+	passed = Check(SmsSegmenter::Prepare(Repeat(ZHE, 5), out, info) && info.encoding == SmsSegmenter::ENCODING_UCS2,
+			"other Cyrillic kept as UCS-2") && passed;
+	passed = Check(!SmsSegmenter::Prepare(Repeat(ZHE, 67 * SmsSegmenter::MAX_SEGMENTS + 1), out, info),
+			"a text over MAX_SEGMENTS refused") && passed;
+	return passed;
+}
+
+int
+main(int argc, char** argv)
+{
+	std::string catalog = "../Home/catalog";
+	int expected = 165;
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-catalog") == 0 && i + 1 < argc) {
+			catalog = argv[++i];
+		} else if(strcmp(argv[i], "-sendable") == 0 && i + 1 < argc) {
+			expected = atoi(argv[++i]);
+		} else {
+			fprintf(stderr, "usage: %s [-catalog DIR] [-sendable N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	char workTemplate[] = "/tmp/textart-sms-XXXXXX";
+	char* pWork = mkdtemp(workTemplate);
+	if(pWork == NULL) {
+		perror("mkdtemp");
+		return 1;
+	}
+	std::string work = pWork;
+	HostFileSystem::Mount("/Home", work.c_str());
+	HostFileSystem::Mount("/Home/catalog", catalog.c_str());
+
+	bool passed = CheckVectors();
+
+	ArrayList names;
+	names.Construct();
+	if(IsFailed(Catalog::GetCategories(names))) {
+		fprintf(stderr, "catalog %s not found\n", catalog.c_str());
+		return 1;
+	}
+	int items = 0;
+	int sendable = 0;
+	int oldSendable = 0;
+	int gsm = 0;
+	int transliterated = 0;
+	int segments[SmsSegmenter::MAX_SEGMENTS + 2] = { 0 };
+	double prepareMs = 0;
+	for(int i = 0; i < names.GetCount(); i++) {
+		ArrayList paths;
+		paths.Construct();
+		Catalog::GetItems(*static_cast<String*>(names.GetAt(i)), paths);
+		for(int n = 0; n < paths.GetCount(); n++) {
+			String titles[Catalog::LANGUAGE_COUNT];
+			String art;
+			int linecount = 0;
+			if(IsFailed(Catalog::ReadItem(*static_cast<String*>(paths.GetAt(n)), titles, art, linecount))) {
+				continue;
+			}
+			items++;
+			String out;
+			SmsSegmenter::Info info;
+			double start = GetMilliseconds();
+			bool fits = SmsSegmenter::Prepare(art, out, info);
+			prepareMs += GetMilliseconds() - start;
+			sendable += fits ? 1 : 0;
+			oldSendable += art.GetLength() <= OLD_SMS_LENGTH ? 1 : 0;
+			if(info.encoding == SmsSegmenter::ENCODING_GSM7) {
+				gsm++;
+				transliterated += out != art ? 1 : 0;
+			}
+			segments[info.segments <= SmsSegmenter::MAX_SEGMENTS ? info.segments : SmsSegmenter::MAX_SEGMENTS + 1]++;
+		}
+		paths.RemoveAll(true);
+	}
+	names.RemoveAll(true);
+
+	printf("%-30s %8d\n", "items", items);
+	printf("%-30s %8d\n", "sendable, 80 characters", oldSendable);
+	printf("%-30s %8d\n", "sendable, segments", sendable);
+	printf("%-30s %8d\n", "GSM-7", gsm);
+	printf("%-30s %8d\n", "of them transliterated", transliterated);
+	for(int i = 1; i <= SmsSegmenter::MAX_SEGMENTS; i++) {
+		printf("%-26s %3d %8d\n", "segments", i, segments[i]);
+	}
+	printf("%-26s %3s %8d\n", "segments", "more", segments[SmsSegmenter::MAX_SEGMENTS + 1]);
+	printf("%-30s %8.1f\n", "us per item", items > 0 ? prepareMs * 1000 / items : 0.0);
+	passed = Check(sendable == expected, "the sendable items of the catalog") && passed;
+
+	std::string cleanup = "rm -rf '" + work + "'";
+	if(system(cleanup.c_str()) != 0) {
+		fprintf(stderr, "cannot remove %s\n", work.c_str());
+	}
+	printf("%s\n", passed ? "passed" : "FAILED");
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,622 @@
+/**
+ * Delta sync benchmark: runs ContentSync against a local stand-in content
+ * server forked from here. The client starts from a copy of -catalog (the
+ * shipped one by default) and the manifest of it; the server release
+ * rewrites some items, adds a category and items and drops others. The
+ * first sync is cut off half way through the objects and the second one
+ * resumes it. Checks that the client catalog then matches the signed
+ * manifest of the server, that an item made on the device in the way of a
+ * new one and an item edited on the device survive, and that a journal left
+ * by an exit during the apply is completed by Recover(). Then the server
+ * turns hostile: a manifest with a byte flipped, one unsigned, one with a
+ * path out of the catalog, one older than the applied and an object that
+ * does not match its hash are all refused, with the catalog and the staged
+ * objects untouched. Reports the bytes transferred against the whole catalog.
+ *
+ *   make sync
+ *   ./textart-sync -catalog ../Home/catalog
+ */
+
+#include "BenchUtil.h"
+#include "ContentManifest.h"
+#include "ContentSync.h"
+
+#include <dirent.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <openssl/evp.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Utility;
+
+static const int CHANGED_ITEMS = 10;
+static const int ADDED_ITEMS = 5;
+static const int REMOVED_ITEMS = 5;
+static const int PACK_ITEMS = 20;
+
+static std::vector<std::string>
+ListDirectory(const std::string& path, bool directories)
+{
+	std::vector<std::string> names;
+	DIR* pDir = opendir(path.c_str());
+	if(pDir == NULL) {
+		return names;
+	}
+	struct dirent* pEntry;
+	while((pEntry = readdir(pDir)) != NULL) {
+		if(pEntry->d_name[0] != '.' && (pEntry->d_type == DT_DIR) == directories) {
+			names.push_back(pEntry->d_name);
+		}
+	}
+	closedir(pDir);
+	std::sort(names.begin(), names.end());
+	return names;
+}
+
+static int
+GetMaxNumber(const std::string& dir)
+{
+	std::vector<std::string> names = ListDirectory(dir, false);
+	int max = 0;
+	for(size_t i = 0; i < names.size(); i++) {
+		max = std::max(max, atoi(names[i].c_str()));
+	}
+	return max;
+}
+
+static std::string
+ToHex(const unsigned char* pData, size_t length)
+{
+	static const char HEX_DIGITS[] = "0123456789abcdef";
+	std::string hex;
+	for(size_t i = 0; i < length; i++) {
+		hex.push_back(HEX_DIGITS[pData[i] >> 4]);
+		hex.push_back(HEX_DIGITS[pData[i] & 0x0F]);
+	}
+	return hex;
+}
+
+static std::string
+HashPath(const std::string& path)
+{
+	String devicePath;
+	StringUtil::Utf8ToString(path.c_str(), devicePath);
+	byte hash[ContentManifest::HASH_SIZE];
+	long long size = 0;
+	if(IsFailed(ContentManifest::HashFile(devicePath, hash, size))) {
+		return "";
+	}
+	return ToHex(hash, ContentManifest::HASH_SIZE);
+}
+
+static std::string
+ToUtf8(const mchar* pValue)
+{
+	ByteBuffer* pBuffer = StringUtil::StringToUtf8N(String(pValue));
+	std::string utf8 = reinterpret_cast<const char*>(pBuffer->GetPointer());
+	delete pBuffer;
+	return utf8;
+}
+
+// Appends the signature line
+static bool
+Sign(EVP_PKEY* pKey, std::string& text)
+{
+	EVP_MD_CTX* pContext = EVP_MD_CTX_new();
+	size_t length = 0;
+	bool signedText = false;
+	if(EVP_DigestSignInit(pContext, NULL, EVP_sha1(), NULL, pKey) == 1
+			&& EVP_DigestSign(pContext, NULL, &length, (const unsigned char*)text.data(), text.size()) == 1) {
+		std::vector<unsigned char> signature(length);
+		if(EVP_DigestSign(pContext, &signature[0], &length, (const unsigned char*)text.data(), text.size()) == 1) {
+			text += "signature " + ToHex(&signature[0], length) + "\n";
+			signedText = true;
+		}
+	}
+	EVP_MD_CTX_free(pContext);
+	return signedText;
+}
+
+// Manifest of the catalog mounted at /Home/catalog, signed when a key is given
+static bool
+FormatManifest(int serial, EVP_PKEY* pKey, std::string& text)
+{
+	ContentManifest manifest;
+	if(IsFailed(manifest.Scan())) {
+		return false;
+	}
+	manifest.SetSerial(serial);
+	ByteBuffer* pText = manifest.FormatN();
+	if(pText == NULL) {
+		return false;
+	}
+	text.assign(reinterpret_cast<const char*>(pText->GetPointer()), pText->GetRemaining());
+	delete pText;
+	return pKey == NULL || Sign(pKey, text);
+}
+
+// The text of a signed manifest under another serial, without the signature
+static std::string
+Unsigned(const std::string& text, int serial)
+{
+	char header[64];
+	snprintf(header, sizeof(header), "textart-manifest 1 %d\n", serial);
+	std::string body = text.substr(0, text.find("\nsignature ") + 1);
+	return header + body.substr(body.find('\n') + 1);
+}
+
+static std::string
+HashData(const std::string& data)
+{
+	unsigned char hash[EVP_MAX_MD_SIZE];
+	unsigned int length = 0;
+	EVP_Digest(data.data(), data.size(), hash, &length, EVP_sha1(), NULL);
+	return ToHex(hash, length);
+}
+
+static bool
+SameCatalog(const ContentManifest& before, const ContentManifest& after)
+{
+	bool same = after.GetCount() == before.GetCount();
+	for(int i = 0; i < after.GetCount() && same; i++) {
+		int index = before.Find(after.GetPath(i));
+		same = index >= 0 && memcmp(before.GetHash(index), after.GetHash(i), ContentManifest::HASH_SIZE) == 0;
+	}
+	return same;
+}
+
+/**
+ * The content server: manifest.txt and the objects of its catalog by hash,
+ * read again for every request. Once, after cutAfter object bytes, a
+ * response is cut off half way.
+ */
+class StandInServer {
+public:
+	StandInServer(const std::string& root, long long cutAfter):
+		__root(root),
+		__cutAfter(cutAfter),
+		__served(0)
+	{
+	}
+
+	void Run(int listenFd)
+	{
+		for(;;) {
+			int fd = accept(listenFd, NULL, NULL);
+			if(fd >= 0) {
+				Load();
+				Serve(fd);
+				close(fd);
+			}
+		}
+	}
+
+private:
+	void Load(void)
+	{
+		ReadFile(__root + "/manifest.txt", __manifest);
+		__objects.clear();
+		size_t start = __manifest.find('\n') + 1;
+		while(start < __manifest.size() && __manifest.compare(start, 10, "signature ") != 0) {
+			size_t end = __manifest.find('\n', start);
+			std::string line = __manifest.substr(start, end - start);
+			size_t pathStart = line.find(' ', ContentManifest::HASH_HEX_LENGTH + 1) + 1;
+			__objects[line.substr(0, ContentManifest::HASH_HEX_LENGTH)] = __root + "/catalog/" + line.substr(pathStart);
+			start = end + 1;
+		}
+	}
+
+	void Serve(int fd)
+	{
+		std::string request;
+		char buffer[4096];
+		while(request.find("\r\n\r\n") == std::string::npos) {
+			ssize_t count = recv(fd, buffer, sizeof(buffer), 0);
+			if(count <= 0) {
+				return;
+			}
+			request.append(buffer, count);
+		}
+		size_t pathStart = request.find(' ') + 1;
+		std::string path = request.substr(pathStart, request.find(' ', pathStart) - pathStart);
+
+		std::string body;
+		const char* pStatus = "200 OK";
+		bool objects = false;
+		if(path == "/content/manifest.txt") {
+			std::string tag = "\"" + __manifest.substr(19, __manifest.find('\n') - 19) + "\"";
+			if(request.find("If-None-Match: " + tag + "\r\n") != std::string::npos) {
+				pStatus = "304 Not Modified";
+			} else {
+				body = __manifest;
+			}
+		} else if(path.compare(0, 19, "/content/objects?h=") == 0) {
+			objects = true;
+			std::string hashes = path.substr(19) + ",";
+			for(size_t start = 0, end; (end = hashes.find(',', start)) != std::string::npos; start = end + 1) {
+				std::string hash = hashes.substr(start, end - start);
+				std::string data;
+				if(__objects.count(hash) != 0 && ReadFile(__objects[hash], data)) {
+					char header[64];
+					snprintf(header, sizeof(header), " %lu\n", (unsigned long)data.size());
+					body += hash + header + data;
+				}
+			}
+		} else {
+			pStatus = "404 Not Found";
+		}
+
+		size_t length = body.size();
+		if(objects && __cutAfter >= 0 && __served + (long long)body.size() > __cutAfter) {
+			length = (size_t)std::max(1LL, __cutAfter - __served);
+			__cutAfter = -1;
+		}
+		char header[128];
+		snprintf(header, sizeof(header), "HTTP/1.1 %s\r\nContent-Length: %lu\r\nConnection: close\r\n\r\n",
+				pStatus, (unsigned long)body.size());
+		std::string response = header + body.substr(0, length);
+		for(size_t sent = 0; sent < response.size();) {
+			ssize_t count = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+			if(count <= 0) {
+				break;
+			}
+			sent += count;
+		}
+		if(objects) {
+			__served += length;
+		}
+	}
+
+	std::string __root;
+	std::string __manifest;
+	std::map<std::string, std::string> __objects;
+	long long __cutAfter;
+	long long __served;
+};
+
+class SyncListener : public IContentSyncListener {
+public:
+	SyncListener(): completed(false), r(E_SUCCESS), updated(0), removed(0) {}
+
+	void OnContentSyncCompleted(int updatedCount, int removedCount)
+	{
+		completed = true;
+		r = E_SUCCESS;
+		updated = updatedCount;
+		removed = removedCount;
+	}
+
+	void OnContentSyncFailed(result failure)
+	{
+		completed = false;
+		r = failure;
+	}
+
+	bool completed;
+	result r;
+	int updated;
+	int removed;
+};
+
+static bool
+RunSync(ContentSync& sync, SyncListener& listener, const char* pName)
+{
+	listener = SyncListener();
+	double start = GetMilliseconds();
+	result r = sync.Start();
+	while(!IsFailed(r) && sync.IsBusy() && HostNetwork::RunPending() > 0) {
+	}
+	double elapsed = GetMilliseconds() - start;
+	if(IsFailed(r)) {
+		listener.r = r;
+	}
+	printf("%-14s %8.1f ms %9lld bytes  %s, %d updated, %d removed\n", pName, elapsed, sync.GetReceivedBytes(),
+			listener.completed ? "completed" : GetErrorMessage(listener.r), listener.updated, listener.removed);
+	return listener.completed;
+}
+
+/**
+ * Serves the manifest text and syncs: the sync fails by expected, leaving the
+ * catalog and the applied manifest as they were and no object staged.
+ */
+static bool
+CheckRejected(ContentSync& sync, SyncListener& listener, const std::string& server, const std::string& client,
+		const char* pName, const std::string& manifest, result expected)
+{
+	std::string applied;
+	ReadFile(client + "/sync/manifest.txt", applied);
+	ContentManifest before;
+	before.Scan();
+	bool passed = Check(WriteFile(server + "/manifest.txt", manifest), "serving the manifest");
+	bool rejected = !RunSync(sync, listener, pName) && listener.r == expected;
+	ContentManifest after;
+	after.Scan();
+	std::string appliedAfter;
+	ReadFile(client + "/sync/manifest.txt", appliedAfter);
+	// A manifest verified and newer stays pending, objects only once they match their hash
+	std::vector<std::string> staged = ListDirectory(client + "/sync", false);
+	staged.erase(std::remove(staged.begin(), staged.end(), std::string("pending.txt")), staged.end());
+
+	char what[96];
+	snprintf(what, sizeof(what), "the %s manifest refused", pName);
+	passed = Check(rejected, what) && passed;
+	snprintf(what, sizeof(what), "the catalog untouched by the %s manifest", pName);
+	passed = Check(SameCatalog(before, after) && applied == appliedAfter
+			&& staged == std::vector<std::string>(1, "manifest.txt"), what) && passed;
+	return passed;
+}
+
+// The server release: items rewritten, added and dropped, and a new category
+static bool
+MakeRelease(const std::string& catalog, const std::vector<std::string>& categories, std::string& addedItem)
+{
+	bool made = true;
+	std::vector<std::string> items = ListDirectory(catalog + "/" + categories[0], false);
+	for(int i = 0, changed = 0; i < (int)items.size() && changed < CHANGED_ITEMS; i++) {
+		std::string path = catalog + "/" + categories[0] + "/" + items[i];
+		std::string data;
+		if(items[i] != "category.info" && ReadFile(path, data)) {
+			made = WriteFile(path, data + "\n  ~ v2 ~\n") && made;
+			changed++;
+		}
+	}
+
+	int next = GetMaxNumber(catalog + "/" + categories[1]) + 1;
+	for(int i = 0; i < ADDED_ITEMS; i++) {
+		char name[32];
+		snprintf(name, sizeof(name), "/%d.txt", next + i);
+		char art[64];
+		snprintf(art, sizeof(art), "New %d|New %d|New %d|New %d\n(>'-')> #%d\n", i, i, i, i, i);
+		made = WriteFile(catalog + "/" + categories[1] + name, art) && made;
+		if(i == 0) {
+			addedItem = categories[1] + name;
+		}
+	}
+
+	items = ListDirectory(catalog + "/" + categories[2], false);
+	for(int i = (int)items.size() - 1, removed = 0; i >= 0 && removed < REMOVED_ITEMS; i--) {
+		if(items[i] != "category.info") {
+			made = unlink((catalog + "/" + categories[2] + "/" + items[i]).c_str()) == 0 && made;
+			removed++;
+		}
+	}
+
+	std::string pack = catalog + "/pack";
+	made = mkdir(pack.c_str(), 0755) == 0 && made;
+	made = WriteFile(pack + "/category.info", "Pack|Pack|Pack|Pack\nFresh|Fresh|Fresh|Fresh\n\\(^o^)/\n") && made;
+	for(int i = 0; i < PACK_ITEMS; i++) {
+		char name[32];
+		snprintf(name, sizeof(name), "/%d.txt", i + 1);
+		// Every other item repeats one art, fetched once
+		char art[128];
+		snprintf(art, sizeof(art), "Pack|Pack|Pack|Pack\n%s\n", i % 2 == 0 ? "<(o.o<) (>o.o)>" : "^(;,;)^ ^(;,;)^");
+		if(i < 2) {
+			snprintf(art, sizeof(art), "Pack %d|Pack %d|Pack %d|Pack %d\n\\(o_o)/ %d\n", i, i, i, i, i);
+		}
+		made = WriteFile(pack + name, art) && made;
+	}
+	return made;
+}
+
+int
+main(int argc, char** argv)
+{
+	std::string source = "../Home/catalog";
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-catalog") == 0 && i + 1 < argc) {
+			source = argv[++i];
+		} else {
+			fprintf(stderr, "usage: %s [-catalog DIR]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	char workTemplate[] = "/tmp/textart-sync-XXXXXX";
+	char* pWork = mkdtemp(workTemplate);
+	if(pWork == NULL) {
+		perror("mkdtemp");
+		return 1;
+	}
+	std::string work = pWork;
+	std::string client = work + "/client";
+	std::string server = work + "/server";
+	std::string setup = "mkdir -p '" + client + "/sync' '" + server + "' && cp -R '" + source + "' '" + client + "/catalog' && cp -R '"
+			+ source + "' '" + server + "/catalog'";
+	if(system(setup.c_str()) != 0) {
+		fprintf(stderr, "copying %s failed\n", source.c_str());
+		return 1;
+	}
+	std::vector<std::string> categories = ListDirectory(client + "/catalog", true);
+	if(categories.size() < 4) {
+		fprintf(stderr, "the catalog needs four categories\n");
+		return 1;
+	}
+
+	EVP_PKEY* pKey = EVP_RSA_gen(2048);
+	unsigned char* pPublicKey = NULL;
+	int publicKeyLength = pKey != NULL ? i2d_PUBKEY(pKey, &pPublicKey) : -1;
+	if(publicKeyLength <= 0) {
+		fprintf(stderr, "generating a key failed\n");
+		return 1;
+	}
+
+	// What the device shipped with, then the release of the server
+	HostFileSystem::Mount("/Home", client.c_str());
+	std::string text;
+	bool passed = Check(FormatManifest(1, NULL, text) && WriteFile(client + "/sync/manifest.txt", text), "the shipped manifest");
+	std::string shipped = text;
+	std::string addedItem;
+	passed = Check(MakeRelease(server + "/catalog", categories, addedItem), "making the release") && passed;
+	HostFileSystem::Mount("/Home/catalog", (server + "/catalog").c_str());
+	passed = Check(FormatManifest(2, pKey, text) && WriteFile(server + "/manifest.txt", text), "the release manifest") && passed;
+	HostFileSystem::Mount("/Home/catalog", (client + "/catalog").c_str());
+	long long catalogBytes = 0;
+	long long deltaBytes = 0;
+	for(size_t start = text.find('\n') + 1; start < text.size() && text.compare(start, 10, "signature ") != 0; start = text.find('\n', start) + 1) {
+		long long size = atoll(text.c_str() + start + ContentManifest::HASH_HEX_LENGTH + 1);
+		catalogBytes += size;
+		if(shipped.find(text.substr(start, ContentManifest::HASH_HEX_LENGTH)) == std::string::npos) {
+			deltaBytes += size;
+		}
+	}
+
+	// Made on the device: an item in the way of a new one, and a shipped item edited
+	std::string userArt = "Mine|Mine|Mine|Mine\n(=^.^=) made here\n";
+	passed = Check(WriteFile(client + "/catalog/" + addedItem, userArt), "the item made on the device") && passed;
+	std::vector<std::string> editedItems = ListDirectory(client + "/catalog/" + categories[3], false);
+	std::string editedItem = categories[3] + "/" + editedItems[0];
+	std::string editedArt = "Edited|Edited|Edited|Edited\n(-_-) edited here\n";
+	passed = Check(WriteFile(client + "/catalog/" + editedItem, editedArt), "the item edited on the device") && passed;
+	if(!passed) {
+		return 1;
+	}
+
+	int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t addressLength = sizeof(address);
+	if(listenFd < 0 || bind(listenFd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listenFd, 8) != 0
+			|| getsockname(listenFd, (struct sockaddr*)&address, &addressLength) != 0) {
+		perror("listen");
+		return 1;
+	}
+	// Half of the new content comes through before the cut
+	long long cutAfter = deltaBytes / 2;
+	pid_t serverPid = fork();
+	if(serverPid == 0) {
+		StandInServer(server, cutAfter).Run(listenFd);
+		_exit(0);
+	}
+	close(listenFd);
+
+	char host[64];
+	snprintf(host, sizeof(host), "http://127.0.0.1:%d", ntohs(address.sin_port));
+	String hostAddr(host);
+	String uri(hostAddr);
+	uri.Append(L"/content/");
+	ByteBuffer publicKey;
+	publicKey.Construct(publicKeyLength);
+	publicKey.SetArray(pPublicKey, 0, publicKeyLength);
+	publicKey.Flip();
+
+	SyncListener listener;
+	ContentSync sync;
+	sync.Construct(hostAddr, uri, publicKey, listener);
+	printf("%d files, %lld bytes in the release, %lld bytes new\n", (int)std::count(text.begin(), text.end(), '\n') - 2, catalogBytes, deltaBytes);
+
+	ContentManifest before;
+	before.Scan();
+	bool cut = RunSync(sync, listener, "cut off");
+	long long received = sync.GetReceivedBytes();
+	passed = Check(!cut && listener.r == E_NETWORK_FAILED, "the cut off sync fails") && passed;
+	ContentManifest after;
+	after.Scan();
+	passed = Check(SameCatalog(before, after), "the catalog untouched by the cut off sync") && passed;
+
+	passed = Check(RunSync(sync, listener, "resumed"), "the resumed sync") && passed;
+	received += sync.GetReceivedBytes();
+	passed = Check(listener.updated == CHANGED_ITEMS + ADDED_ITEMS + PACK_ITEMS + 1, "the updated count") && passed;
+	passed = Check(listener.removed == REMOVED_ITEMS, "the removed count") && passed;
+
+	// The catalog is the release, but for what the device made
+	ContentManifest release;
+	ContentManifest local;
+	ByteBuffer releaseText;
+	releaseText.Construct((int)text.size());
+	releaseText.SetArray((const byte*)text.data(), 0, (int)text.size());
+	releaseText.Flip();
+	passed = Check(!IsFailed(release.Parse(releaseText, &publicKey)), "parsing the release") && passed;
+	passed = Check(!IsFailed(local.Scan()), "scanning the catalog") && passed;
+	bool matches = true;
+	for(int i = 0; i < release.GetCount(); i++) {
+		std::string path = ToUtf8(release.GetPath(i));
+		int index = local.Find(release.GetPath(i));
+		bool same = index >= 0 && memcmp(local.GetHash(index), release.GetHash(i), ContentManifest::HASH_SIZE) == 0;
+		if(path == editedItem) {
+			std::string data;
+			passed = Check(ReadFile(client + "/catalog/" + path, data) && data == editedArt, "the edit made on the device") && passed;
+		} else if(!same) {
+			fprintf(stderr, "differs: %s\n", path.c_str());
+			matches = false;
+		}
+	}
+	passed = Check(matches, "the catalog matching the release") && passed;
+	int extra = 0;
+	for(int i = 0; i < local.GetCount(); i++) {
+		if(release.Find(local.GetPath(i)) < 0) {
+			std::string data;
+			passed = Check(ReadFile(client + "/catalog/" + ToUtf8(local.GetPath(i)), data) && data == userArt, "the item made on the device moved aside") && passed;
+			extra++;
+		}
+	}
+	passed = Check(extra == 1, "one item kept aside") && passed;
+	passed = Check(ListDirectory(client + "/sync", false) == std::vector<std::string>(1, "manifest.txt"), "the staging emptied") && passed;
+
+	passed = Check(RunSync(sync, listener, "up to date") && listener.updated == 0 && listener.removed == 0
+			&& sync.GetReceivedBytes() == 0, "the sync up to date") && passed;
+
+	// An exit half way through an apply, with one put left to do
+	std::string hash = HashPath("/Home/catalog/pack/1.txt");
+	std::string recovered = client + "/catalog/pack/1.txt";
+	passed = Check(!hash.empty() && system(("cp '" + recovered + "' '" + client + "/sync/" + hash + "'").c_str()) == 0
+			&& unlink(recovered.c_str()) == 0 && WriteFile(client + "/sync/apply.txt", "put " + hash + " pack/1.txt\nend\n"), "an interrupted apply") && passed;
+	passed = Check(!IsFailed(ContentSync::Recover()) && HashPath("/Home/catalog/pack/1.txt") == hash, "the recovered apply") && passed;
+	passed = Check(ListDirectory(client + "/sync", false) == std::vector<std::string>(1, "manifest.txt"), "the journal removed") && passed;
+
+	// What a hostile or broken server may send
+	passed = Check(!ContentManifest::IsValidPath(L"../x") && !ContentManifest::IsValidPath(L"a/b/c")
+			&& !ContentManifest::IsValidPath(L"a/..") && ContentManifest::IsValidPath(L"pack/1.txt"), "the paths out of the catalog") && passed;
+	// A digit of the first size, in a release newer than the applied
+	std::string flipped = Unsigned(text, 3);
+	passed = Check(Sign(pKey, flipped), "signing") && passed;
+	flipped[flipped.find('\n') + ContentManifest::HASH_HEX_LENGTH + 2] ^= 1;
+	passed = CheckRejected(sync, listener, server, client, "flipped byte", flipped, E_INVALID_DATA) && passed;
+	passed = CheckRejected(sync, listener, server, client, "unsigned", Unsigned(text, 3), E_INVALID_DATA) && passed;
+	std::string escaping = Unsigned(text, 3) + HashData(userArt) + " 1 ../x\n";
+	passed = Check(Sign(pKey, escaping), "signing") && CheckRejected(sync, listener, server, client, "path out", escaping, E_INVALID_FORMAT) && passed;
+	std::string older = Unsigned(text, 1);
+	passed = Check(Sign(pKey, older), "signing") && CheckRejected(sync, listener, server, client, "older", older, E_INVALID_DATA) && passed;
+	// Signed for one art, served with another of the same length
+	std::string signedArt = "Pack|Pack|Pack|Pack\n(o_o) signed\n";
+	std::string forgedArt = "Pack|Pack|Pack|Pack\n(x_x) forged\n";
+	std::string forgedHash = HashData(signedArt);
+	char forgedLine[128];
+	snprintf(forgedLine, sizeof(forgedLine), "%s %lu pack/forged.txt\n", forgedHash.c_str(), (unsigned long)signedArt.size());
+	std::string forged = Unsigned(text, 3) + forgedLine;
+	passed = Check(WriteFile(server + "/catalog/pack/forged.txt", forgedArt) && Sign(pKey, forged), "the forged object")
+			&& CheckRejected(sync, listener, server, client, "forged object", forged, E_INVALID_DATA) && passed;
+	passed = Check(access((client + "/catalog/pack/forged.txt").c_str(), F_OK) != 0
+			&& access((client + "/sync/" + forgedHash).c_str(), F_OK) != 0, "the forged object not staged") && passed;
+
+	printf("%-30s %12lld\n", "bytes received", received);
+	printf("%-30s %11.1f%%\n", "of the release", catalogBytes > 0 ? received * 100.0 / catalogBytes : 0.0);
+
+	kill(serverPid, SIGTERM);
+	waitpid(serverPid, NULL, 0);
+	OPENSSL_free(pPublicKey);
+	EVP_PKEY_free(pKey);
+	std::string cleanup = "rm -rf '" + work + "'";
+	if(system(cleanup.c_str()) != 0) {
+		fprintf(stderr, "cannot remove %s\n", work.c_str());
+	}
+	printf("%s\n", passed ? "passed" : "FAILED");
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,370 @@
+/**
+ * Task scheduler benchmark: opens a category of a synthetic catalog while
+ * -writes registry writes are still queued, the way a share followed by a
+ * tap on a category looks. Every STALL_EVERY writes the registry strand
+ * also stalls for STALL_MS, as flash storage does, so the background work
+ * outlasts the load however fast the writes themselves are. Run inline, as
+ * before the scheduler, the UI thread is blocked for the writes and the item
+ * reads in a row; with the scheduler it only posts and takes the results.
+ * Reports when the items of the category and the recent list are ready and
+ * the longest time the UI thread spent in one call, and checks the
+ * scheduler's guarantees: the visible load does not wait for the background
+ * writes, the recent list sees every write queued before it, a cancelled
+ * load is never delivered and Shutdown() finishes the queued writes.
+ *
+ *   make tasks
+ *   ./textart-tasks -items 5000 -writes 200
+ */
+
+#include "BenchUtil.h"
+#include "Catalog.h"
+#include "CatalogGenerator.h"
+#include "TaskScheduler.h"
+#include "TextArtRegistry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+using namespace Osp::Base::Runtime;
+
+static const int STALL_EVERY = 10;
+static const int STALL_MS = 5;
+
+static double __start = 0;
+
+// What a form gets back from its load, on the UI thread
+struct Delivery {
+	bool done;
+	int count;
+	double readyMs;
+	String first;
+
+	Delivery(): done(false), count(0), readyMs(0) {}
+};
+
+// The reads of CategoryItemForm's load
+class CategoryLoadTask :
+	public ITask
+{
+public:
+	CategoryLoadTask(const String& name, Delivery& delivery):
+		__name(name),
+		__delivery(delivery),
+		__count(0)
+	{
+	}
+
+	result Run(const CancelToken& token)
+	{
+		ArrayList paths;
+		paths.Construct();
+		result r = Catalog::GetItems(__name, paths);
+		for(int n = 0; n < paths.GetCount() && !token.IsCancelled(); n++) {
+			String titles[Catalog::LANGUAGE_COUNT];
+			String art;
+			int linecount = 0;
+			if(!IsFailed(Catalog::ReadItem(*static_cast<String*>(paths.GetAt(n)), titles, art, linecount))) {
+				__count++;
+			}
+		}
+		paths.RemoveAll(true);
+		return r;
+	}
+
+	void OnTaskCompleted(result r)
+	{
+		__delivery.done = true;
+		__delivery.count = __count;
+		__delivery.readyMs = GetMilliseconds() - __start;
+	}
+
+private:
+	String __name;
+	Delivery& __delivery;
+	int __count;
+};
+
+// The registry query of RecentForm's load
+class RecentLoadTask :
+	public ITask
+{
+public:
+	RecentLoadTask(Delivery& delivery):
+		__delivery(delivery),
+		__count(0)
+	{
+	}
+
+	result Run(const CancelToken& token)
+	{
+		ArrayList* pData = TextArtRegistry::GetRecent();
+		__count = pData->GetCount();
+		if(__count > 0) {
+			__first = *static_cast<String*>(pData->GetAt(0));
+		}
+		pData->RemoveAll(true);
+		delete pData;
+		return E_SUCCESS;
+	}
+
+	void OnTaskCompleted(result r)
+	{
+		__delivery.done = true;
+		__delivery.count = __count;
+		__delivery.first = __first;
+		__delivery.readyMs = GetMilliseconds() - __start;
+	}
+
+private:
+	Delivery& __delivery;
+	int __count;
+	String __first;
+};
+
+// Stands in for the application's event loop: one wake-up per batch of completions
+class EventLoop :
+	public ITaskCompletionPoster
+{
+public:
+	EventLoop(): __posted(false), __events(0), __longestMs(0)
+	{
+		__monitor.Construct();
+	}
+
+	void PostTaskCompletion(void)
+	{
+		__monitor.Enter();
+		__posted = true;
+		__events++;
+		__monitor.Notify();
+		__monitor.Exit();
+	}
+
+	// Waits for the next event and delivers, as TextPic::OnUserEventReceivedN does
+	void RunOnce(void)
+	{
+		__monitor.Enter();
+		while(!__posted) {
+			__monitor.Wait();
+		}
+		__posted = false;
+		__monitor.Exit();
+
+		double start = GetMilliseconds();
+		TaskScheduler::DeliverCompleted();
+		Measure(GetMilliseconds() - start);
+	}
+
+	void Measure(double ms)
+	{
+		if(ms > __longestMs) {
+			__longestMs = ms;
+		}
+	}
+
+	int GetEventCount(void) const { return __events; }
+	double GetLongestMs(void) const { return __longestMs; }
+
+private:
+	Monitor __monitor;
+	bool __posted;
+	int __events;
+	double __longestMs;
+};
+
+// A storage stall on the registry strand, so the writes outlast the load
+class StallTask :
+	public ITask
+{
+public:
+	result Run(const CancelToken& token)
+	{
+		return Thread::Sleep(STALL_MS);
+	}
+
+	void OnTaskCompleted(result r)
+	{
+	}
+};
+
+// The writes of -writes shares, recent and favourite in turn; returns the last recent path
+static void
+QueueWrites(const ArrayList& paths, int writes, String& lastRecent, EventLoop* pLoop)
+{
+	for(int i = 0; i < writes; i++) {
+		const String& path = *static_cast<const String*>(paths.GetAt(i % paths.GetCount()));
+		double start = GetMilliseconds();
+		if(i % 2 == 0) {
+			TextArtRegistry::AddRecent(path);
+			lastRecent = path;
+		} else {
+			TextArtRegistry::AddFavourite(path);
+		}
+		if(i % STALL_EVERY == 0) {
+			TaskScheduler::Post(new StallTask(), TaskScheduler::LANE_BACKGROUND, TaskScheduler::STRAND_REGISTRY);
+		}
+		if(pLoop != null) {
+			pLoop->Measure(GetMilliseconds() - start);
+		}
+	}
+}
+
+static bool
+ResetRegistry(const std::string& work)
+{
+	TextArtRegistry::Shutdown();
+	std::string snapshot = work + "/registry.snapshot";
+	std::string journal = work + "/registry.journal";
+	unlink(snapshot.c_str());
+	unlink(journal.c_str());
+	TextArtRegistry::Setup();
+	return true;
+}
+
+int
+main(int argc, char** argv)
+{
+	int items = 5000;
+	int writes = 200;
+
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-items") == 0 && i + 1 < argc) {
+			items = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-writes") == 0 && i + 1 < argc) {
+			writes = atoi(argv[++i]);
+		} else {
+			fprintf(stderr, "usage: %s [-items N] [-writes N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	char workTemplate[] = "/tmp/textart-tasks-XXXXXX";
+	char* pWork = mkdtemp(workTemplate);
+	if(pWork == NULL) {
+		perror("mkdtemp");
+		return 1;
+	}
+	std::string work = pWork;
+	std::string catalog = work + "/catalog";
+	CatalogGenerator::Options options;
+	options.items = items;
+	CatalogGenerator::Stats stats;
+	if(!CatalogGenerator::Generate(catalog, options, stats)) {
+		fprintf(stderr, "generating %s failed\n", catalog.c_str());
+		return 1;
+	}
+	HostFileSystem::Mount("/Home", work.c_str());
+	HostFileSystem::Mount("/Home/catalog", catalog.c_str());
+
+	ArrayList names;
+	names.Construct();
+	Catalog::GetCategories(names);
+	if(names.GetCount() == 0) {
+		fprintf(stderr, "no categories in %s\n", catalog.c_str());
+		return 1;
+	}
+	String category = *static_cast<String*>(names.GetAt(0));
+	// shared from another category than the one opened
+	ArrayList shared;
+	shared.Construct();
+	Catalog::GetItems(*static_cast<String*>(names.GetAt(names.GetCount() - 1)), shared);
+	bool passed = true;
+
+	// Before the scheduler: everything on the UI thread, in the order it was asked for
+	ResetRegistry(work);
+	Delivery inlineItems;
+	Delivery inlineRecent;
+	String lastRecent;
+	__start = GetMilliseconds();
+	QueueWrites(shared, writes, lastRecent, null);
+	double inlineWritesMs = GetMilliseconds() - __start;
+	TaskScheduler::Post(new CategoryLoadTask(category, inlineItems), TaskScheduler::LANE_VISIBLE);
+	TaskScheduler::Post(new RecentLoadTask(inlineRecent), TaskScheduler::LANE_VISIBLE, TaskScheduler::STRAND_REGISTRY);
+	double inlineMs = GetMilliseconds() - __start;
+
+	// With the scheduler: the UI thread posts, the workers read and write
+	ResetRegistry(work);
+	EventLoop loop;
+	result r = TaskScheduler::Setup(loop);
+	if(IsFailed(r)) {
+		fprintf(stderr, "scheduler setup failed by %s\n", GetErrorMessage(r));
+		return 1;
+	}
+	Delivery items1;
+	Delivery recent;
+	Delivery cancelled;
+	__start = GetMilliseconds();
+	QueueWrites(shared, writes, lastRecent, &loop);
+	double start = GetMilliseconds();
+	TaskScheduler::Post(new CategoryLoadTask(category, items1), TaskScheduler::LANE_VISIBLE);
+	TaskScheduler::Post(new RecentLoadTask(recent), TaskScheduler::LANE_VISIBLE, TaskScheduler::STRAND_REGISTRY);
+	// a form closed right after it asked for its items
+	TaskScheduler::TaskId id = TaskScheduler::Post(new CategoryLoadTask(category, cancelled), TaskScheduler::LANE_VISIBLE);
+	TaskScheduler::Cancel(id);
+	loop.Measure(GetMilliseconds() - start);
+	int pendingAtItems = -1;
+	while(!items1.done || !recent.done || TaskScheduler::GetPendingCount() > 0) {
+		loop.RunOnce();
+		if(items1.done && pendingAtItems < 0) {
+			pendingAtItems = TaskScheduler::GetPendingCount();
+		}
+	}
+	double drainMs = GetMilliseconds() - __start;
+
+	// Shutdown right after queueing: the writes still land
+	String shutdownRecent;
+	QueueWrites(shared, 20, shutdownRecent, null);
+	TaskScheduler::Shutdown();
+	ArrayList* pData = TextArtRegistry::GetRecent();
+	bool shutdownWritten = pData->GetCount() > 0 && static_cast<String*>(pData->GetAt(0))->Equals(shutdownRecent);
+	pData->RemoveAll(true);
+	delete pData;
+
+	printf("%d items in %d categories, %d in the category opened, %d registry writes\n",
+			stats.items, names.GetCount(), items1.count, writes);
+	printf("%-34s %12s %12s\n", "", "inline", "scheduler");
+	printf("%-34s %12.1f\n", "registry writes ms", inlineWritesMs);
+	printf("%-34s %12.1f %12.1f\n", "category items ready ms", inlineItems.readyMs, items1.readyMs);
+	printf("%-34s %12.1f %12.1f\n", "recent list ready ms", inlineRecent.readyMs, recent.readyMs);
+	printf("%-34s %12.1f %12.3f\n", "longest UI thread call ms", inlineMs, loop.GetLongestMs());
+	printf("%-34s %12s %12.1f\n", "all work done ms", "", drainMs);
+	printf("%-34s %12s %12d\n", "UI wake-ups", "", loop.GetEventCount());
+	printf("%-34s %12s %12d\n", "tasks left when items shown", "", pendingAtItems);
+
+	if(items1.count != inlineItems.count || items1.count == 0) {
+		printf("FAILED: %d items loaded, %d inline\n", items1.count, inlineItems.count);
+		passed = false;
+	}
+	if(pendingAtItems <= 0) {
+		printf("FAILED: the visible load waited for the background writes\n");
+		passed = false;
+	}
+	if(!recent.first.Equals(lastRecent) || recent.count != inlineRecent.count) {
+		printf("FAILED: the recent list missed writes queued before it\n");
+		passed = false;
+	}
+	if(cancelled.done) {
+		printf("FAILED: a cancelled load was delivered\n");
+		passed = false;
+	}
+	if(!shutdownWritten) {
+		printf("FAILED: writes queued before Shutdown were lost\n");
+		passed = false;
+	}
+	printf("%s\n", passed ? "passed" : "FAILED");
+
+	names.RemoveAll(true);
+	shared.RemoveAll(true);
+	std::string cleanup = "rm -rf '" + work + "'";
+	if(system(cleanup.c_str()) != 0) {
+		fprintf(stderr, "cannot remove %s\n", work.c_str());
+	}
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,345 @@
+/**
+ * Telemetry benchmark: Track, the queue file and the batched upload against
+ * a local stand-in stats server forked from here, with the timers expired
+ * by HostTimer so the delays cost nothing. Checks that a queue goes out in
+ * batches of at most 20 events and 4 KB, in order and each event once; that
+ * failed posts back off 30 s, 60 s, 120 s... up to the cap and start over
+ * after a success; that events queued, or posted and not answered, before
+ * an exit go out after the restart; and that the queue compacts to its
+ * newest events at 32 KB. Reports the cost of an append.
+ *
+ *   make telemetry
+ *   ./textart-telemetry -events 1500
+ */
+
+#include "BenchUtil.h"
+#include "Telemetry.h"
+
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+using namespace Osp::Base;
+
+// As in Telemetry
+static const int BATCH_SIZE = 20;
+static const int MAX_BATCH_BYTES = 4 * 1024;
+static const int MAX_QUEUE_BYTES = 32 * 1024;
+static const long long FLUSH_DELAY = 10 * 1000;
+static const long long BACKOFF_BASE = 30 * 1000;
+static const long long BACKOFF_MAX = 30 * 60 * 1000;
+
+static long
+FileSize(const std::string& path)
+{
+	struct stat info;
+	return stat(path.c_str(), &info) == 0 ? (long)info.st_size : 0;
+}
+
+/**
+ * The stats server: answers every POST with the status in <root>/status,
+ * 200 when there is none, and appends the bodies it accepts to
+ * <root>/delivered, one per line.
+ */
+static void
+RunServer(const std::string& root, int listenFd)
+{
+	for(;;) {
+		int fd = accept(listenFd, NULL, NULL);
+		if(fd < 0) {
+			continue;
+		}
+		std::string request;
+		char buffer[4096];
+		size_t headerEnd;
+		while((headerEnd = request.find("\r\n\r\n")) == std::string::npos) {
+			ssize_t count = recv(fd, buffer, sizeof(buffer), 0);
+			if(count <= 0) {
+				break;
+			}
+			request.append(buffer, count);
+		}
+		size_t lengthAt = request.find("Content-Length: ");
+		size_t length = lengthAt != std::string::npos ? strtoul(request.c_str() + lengthAt + 16, NULL, 10) : 0;
+		while(headerEnd != std::string::npos && request.size() < headerEnd + 4 + length) {
+			ssize_t count = recv(fd, buffer, sizeof(buffer), 0);
+			if(count <= 0) {
+				break;
+			}
+			request.append(buffer, count);
+		}
+
+		std::string status;
+		int code = ReadFile(root + "/status", status) ? atoi(status.c_str()) : 200;
+		if(code >= 200 && code < 300 && headerEnd != std::string::npos) {
+			FILE* pFile = fopen((root + "/delivered").c_str(), "ab");
+			if(pFile != NULL) {
+				fprintf(pFile, "%s\n", request.substr(headerEnd + 4).c_str());
+				fclose(pFile);
+			}
+		}
+		char response[128];
+		snprintf(response, sizeof(response), "HTTP/1.1 %d Stand-in\r\nContent-Length: 0\r\nConnection: close\r\n\r\n", code);
+		send(fd, response, strlen(response), MSG_NOSIGNAL);
+		close(fd);
+	}
+}
+
+// The events of one post, by item
+struct Batch {
+	size_t bytes;
+	std::vector<std::string> items;
+};
+
+// What the server accepted since the last call
+static std::vector<Batch>
+TakeDelivered(const std::string& root)
+{
+	std::vector<Batch> batches;
+	std::string data;
+	if(!ReadFile(root + "/delivered", data)) {
+		return batches;
+	}
+	unlink((root + "/delivered").c_str());
+	for(size_t start = 0, end; (end = data.find('\n', start)) != std::string::npos; start = end + 1) {
+		Batch batch;
+		batch.bytes = end - start;
+		std::string body = data.substr(start, end - start);
+		for(size_t at = 0; (at = body.find("\"item\":\"", at)) != std::string::npos;) {
+			at += 8;
+			batch.items.push_back(body.substr(at, body.find('"', at) - at));
+		}
+		batches.push_back(batch);
+	}
+	return batches;
+}
+
+// Every item of the batches, in the order they arrived
+static std::vector<std::string>
+GetItems(const std::vector<Batch>& batches)
+{
+	std::vector<std::string> items;
+	for(size_t i = 0; i < batches.size(); i++) {
+		items.insert(items.end(), batches[i].items.begin(), batches[i].items.end());
+	}
+	return items;
+}
+
+static std::string
+ItemName(int index, int padding)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "bench/%d", index);
+	return std::string(name) + std::string(padding, 'x') + ".txt";
+}
+
+static void
+Track(int index, int padding)
+{
+	String path(L"/Home/catalog/");
+	std::string name = ItemName(index, padding);
+	for(size_t i = 0; i < name.size(); i++) {
+		path.Append((mchar)name[i]);
+	}
+	Telemetry::Track(Telemetry::EVENT_VIEW, path);
+}
+
+static std::vector<std::string>
+ItemRange(int first, int end, int padding)
+{
+	std::vector<std::string> items;
+	for(int i = first; i < end; i++) {
+		items.push_back(ItemName(i, padding));
+	}
+	return items;
+}
+
+// Expires the flush timers and runs the posts, up to a delay longer than a flush: a backoff
+static void
+Drain(void)
+{
+	while(HostTimer::GetNextTimeout() >= 0 && HostTimer::GetNextTimeout() <= FLUSH_DELAY) {
+		HostTimer::ExpireNext();
+		HostNetwork::RunPending();
+	}
+}
+
+static bool
+CheckBatches(const std::vector<Batch>& batches, int events, const char* pWhat)
+{
+	bool within = true;
+	int full = 0;
+	for(size_t i = 0; i < batches.size(); i++) {
+		within = within && !batches[i].items.empty() && (int)batches[i].items.size() <= BATCH_SIZE
+				&& batches[i].bytes <= (size_t)MAX_BATCH_BYTES;
+		full += (int)batches[i].items.size() == BATCH_SIZE ? 1 : 0;
+	}
+	printf("%-30s %8d %8d %8d\n", pWhat, events, (int)batches.size(), full);
+	return Check(within, pWhat);
+}
+
+int
+main(int argc, char** argv)
+{
+	int events = 1500;
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-events") == 0 && i + 1 < argc) {
+			events = atoi(argv[++i]);
+		} else {
+			fprintf(stderr, "usage: %s [-events N]\n", argv[0]);
+			return 1;
+		}
+	}
+	// Enough to go over the cap of the queue
+	if(events < MAX_QUEUE_BYTES / 32) {
+		events = MAX_QUEUE_BYTES / 32;
+	}
+
+	char workTemplate[] = "/tmp/textart-telemetry-XXXXXX";
+	char* pWork = mkdtemp(workTemplate);
+	if(pWork == NULL) {
+		perror("mkdtemp");
+		return 1;
+	}
+	std::string work = pWork;
+	std::string client = work + "/client";
+	std::string server = work + "/server";
+	std::string queue = client + "/telemetry.queue";
+	if(mkdir(client.c_str(), 0755) != 0 || mkdir(server.c_str(), 0755) != 0) {
+		perror("mkdir");
+		return 1;
+	}
+	HostFileSystem::Mount("/Home", client.c_str());
+
+	int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t addressLength = sizeof(address);
+	if(listenFd < 0 || bind(listenFd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listenFd, 8) != 0
+			|| getsockname(listenFd, (struct sockaddr*)&address, &addressLength) != 0) {
+		perror("listen");
+		return 1;
+	}
+	pid_t serverPid = fork();
+	if(serverPid == 0) {
+		RunServer(server, listenFd);
+		_exit(0);
+	}
+	close(listenFd);
+
+	char endpoint[128];
+	snprintf(endpoint, sizeof(endpoint), "http://127.0.0.1:%d\nhttp://127.0.0.1:%d/stats\n", ntohs(address.sin_port), ntohs(address.sin_port));
+	bool passed = Check(WriteFile(client + "/telemetry.endpoint", endpoint), "the endpoint");
+	passed = Check(!IsFailed(Telemetry::Setup()), "setting up") && passed;
+	printf("%-30s %8s %8s %8s\n", "case", "events", "posts", "full");
+
+	// Batches of 20, and of less when the events are long
+	for(int i = 0; i < 45; i++) {
+		Track(i, 0);
+	}
+	passed = Check(HostTimer::GetNextTimeout() == FLUSH_DELAY, "the flush delay") && passed;
+	Drain();
+	std::vector<Batch> batches = TakeDelivered(server);
+	passed = CheckBatches(batches, 45, "short events") && passed;
+	passed = Check(batches.size() == 3 && GetItems(batches) == ItemRange(0, 45, 0), "three batches in order") && passed;
+	passed = Check(FileSize(queue) == 0 && HostTimer::GetNextTimeout() < 0, "the queue drained") && passed;
+
+	for(int i = 0; i < 40; i++) {
+		Track(i, 400);
+	}
+	Drain();
+	batches = TakeDelivered(server);
+	passed = CheckBatches(batches, 40, "long events") && passed;
+	passed = Check(batches.size() > 2 && GetItems(batches) == ItemRange(0, 40, 400), "long events in batches under 4 KB") && passed;
+
+	// Failed posts: the event stays queued and the retries back off
+	WriteFile(server + "/status", "503");
+	Track(100, 0);
+	std::vector<long long> delays;
+	for(int i = 0; i < 10; i++) {
+		HostTimer::ExpireNext();
+		HostNetwork::RunPending();
+		delays.push_back(HostTimer::GetNextTimeout());
+	}
+	bool doubling = true;
+	for(size_t i = 0; i < delays.size(); i++) {
+		long long expected = BACKOFF_BASE << i;
+		doubling = doubling && delays[i] == (expected < BACKOFF_MAX ? expected : BACKOFF_MAX);
+	}
+	printf("%-30s %lld %lld %lld ... %lld ms\n", "backoff", delays[0], delays[1], delays[2], delays.back());
+	passed = Check(doubling, "the backoff doubling up to the cap") && passed;
+	passed = Check(TakeDelivered(server).empty(), "nothing accepted while failing") && passed;
+	unlink((server + "/status").c_str());
+	HostTimer::ExpireNext();
+	HostNetwork::RunPending();
+	passed = Check(GetItems(TakeDelivered(server)) == ItemRange(100, 101, 0), "the event sent once after the failures") && passed;
+	WriteFile(server + "/status", "500");
+	Track(101, 0);
+	HostTimer::ExpireNext();
+	HostNetwork::RunPending();
+	passed = Check(HostTimer::GetNextTimeout() == BACKOFF_BASE, "the backoff reset by a success") && passed;
+	unlink((server + "/status").c_str());
+	HostTimer::ExpireNext();
+	HostNetwork::RunPending();
+	TakeDelivered(server);
+
+	// An exit with events queued, and one with a post in flight
+	for(int i = 200; i < 205; i++) {
+		Track(i, 0);
+	}
+	Telemetry::Shutdown();
+	passed = Check(FileSize(queue) > 0 && HostTimer::GetNextTimeout() < 0, "the queue kept over an exit") && passed;
+	passed = Check(!IsFailed(Telemetry::Setup()), "setting up again") && passed;
+	Telemetry::Flush();
+	Drain();
+	passed = Check(GetItems(TakeDelivered(server)) == ItemRange(200, 205, 0), "the queue sent after the restart") && passed;
+	for(int i = 300; i < 303; i++) {
+		Track(i, 0);
+	}
+	HostTimer::ExpireNext();
+	Telemetry::Shutdown();
+	HostNetwork::RunPending();
+	Telemetry::Setup();
+	Telemetry::Flush();
+	Drain();
+	passed = Check(GetItems(TakeDelivered(server)) == ItemRange(300, 303, 0), "a post cut by an exit sent again") && passed;
+
+	// Offline: the queue stays under the cap with the newest events
+	long maxQueue = 0;
+	double start = GetMilliseconds();
+	for(int i = 0; i < events; i++) {
+		Track(1000 + i, 0);
+		maxQueue = std::max(maxQueue, FileSize(queue));
+	}
+	double appendMs = GetMilliseconds() - start;
+	long compacted = FileSize(queue);
+	Drain();
+	std::vector<std::string> kept = GetItems(TakeDelivered(server));
+	printf("%-30s %8d %8.1f us\n", "append", events, appendMs * 1000 / events);
+	printf("%-30s %8ld %8ld bytes, %d events kept\n", "queue max, left", maxQueue, compacted, (int)kept.size());
+	passed = Check(maxQueue <= MAX_QUEUE_BYTES, "the queue under the cap") && passed;
+	passed = Check(!kept.empty() && (int)kept.size() < events && kept == ItemRange(1000 + events - (int)kept.size(), 1000 + events, 0),
+			"the newest events kept") && passed;
+
+	Telemetry::Shutdown();
+	kill(serverPid, SIGTERM);
+	waitpid(serverPid, NULL, 0);
+	std::string cleanup = "rm -rf '" + work + "'";
+	if(system(cleanup.c_str()) != 0) {
+		fprintf(stderr, "cannot remove %s\n", work.c_str());
+	}
+	printf("%s\n", passed ? "passed" : "FAILED");
+	return passed ? 0 : 1;
+}
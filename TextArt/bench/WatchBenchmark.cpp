@@ -0,0 +1,238 @@
+/**
+ * Hot-reload benchmark: records a synthetic catalog of -items items (or
+ * -catalog DIR, left unchanged) with the CatalogWatcher and times a scan of
+ * the unchanged catalog, which is what every return to the foreground costs.
+ * On a generated catalog it then drops in a content pack the way a user
+ * copying files would: a new category, new items in an existing one, one
+ * item rewritten, one removed and one category deleted, and checks that the
+ * next scan reports exactly those.
+ *
+ *   make watch
+ *   ./textart-watch -items 100000
+ */
+
+#include "BenchUtil.h"
+#include "Catalog.h"
+#include "CatalogGenerator.h"
+#include "CatalogWatcher.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+using namespace Osp::Io;
+
+static const int PACK_ITEMS = 20;
+
+static const CatalogChange*
+FindChange(const ArrayList& changes, const String& name)
+{
+	for(int i = 0; i < changes.GetCount(); i++) {
+		const CatalogChange* pChange = static_cast<const CatalogChange*>(changes.GetAt(i));
+		if(pChange->name.Equals(name, true)) {
+			return pChange;
+		}
+	}
+	return null;
+}
+
+static bool
+Contains(const ArrayList& paths, const String& path)
+{
+	for(int i = 0; i < paths.GetCount(); i++) {
+		if(static_cast<const String*>(paths.GetAt(i))->Equals(path, true)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Drops the pack into the catalog and checks the scan against it
+static bool
+RunPack(CatalogWatcher& watcher)
+{
+	ArrayList names;
+	names.Construct();
+	Catalog::GetCategories(names);
+	if(names.GetCount() < 3) {
+		fprintf(stderr, "the catalog needs three categories\n");
+		names.RemoveAll(true);
+		return false;
+	}
+	String extended = *static_cast<String*>(names.GetAt(0));
+	String rewritten = *static_cast<String*>(names.GetAt(1));
+	String deleted = *static_cast<String*>(names.GetAt(2));
+	names.RemoveAll(true);
+
+	String titles[Catalog::LANGUAGE_COUNT];
+	String descs[Catalog::LANGUAGE_COUNT];
+	for(int l = 0; l < Catalog::LANGUAGE_COUNT; l++) {
+		titles[l] = L"Pack";
+		descs[l] = L"Added while away";
+	}
+	String added = L"pack";
+	bool passed = Check(!IsFailed(Catalog::CreateCategory(added, titles, descs, L"(o_o)\n")), "creating the pack category");
+	for(int i = 0; i < PACK_ITEMS && passed; i++) {
+		String path;
+		passed = Check(!IsFailed(Catalog::WriteItem(added, titles, L"\\(^_^)/\n", path)), "writing a pack item");
+	}
+
+	ArrayList newPaths;
+	newPaths.Construct();
+	for(int i = 0; i < PACK_ITEMS && passed; i++) {
+		String* pPath = new String();
+		passed = Check(!IsFailed(Catalog::WriteItem(extended, titles, L"<:3 )~\n", *pPath)), "extending a category");
+		newPaths.Add(*pPath);
+	}
+
+	ArrayList paths;
+	paths.Construct();
+	Catalog::GetItems(rewritten, paths);
+	passed = passed && Check(paths.GetCount() >= 2, "two items to rewrite and remove");
+	String changedPath;
+	String removedPath;
+	if(passed) {
+		changedPath = *static_cast<String*>(paths.GetAt(0));
+		removedPath = *static_cast<String*>(paths.GetAt(1));
+		File file;
+		passed = Check(!IsFailed(file.Construct(changedPath, L"a")) && !IsFailed(file.Write(String(L"~~~\n"))), "rewriting an item");
+	}
+	paths.RemoveAll(true);
+	passed = passed && Check(!IsFailed(File::Remove(removedPath)), "removing an item");
+	String deletedPath;
+	Catalog::GetCategoryPath(deleted, deletedPath);
+	passed = passed && Check(!IsFailed(Directory::Remove(deletedPath, true)), "removing a category");
+	if(!passed) {
+		newPaths.RemoveAll(true);
+		return false;
+	}
+
+	ArrayList changes;
+	changes.Construct();
+	double start = GetMilliseconds();
+	result r = watcher.Scan(changes);
+	double scanMs = GetMilliseconds() - start;
+	printf("%-30s %12.1f\n", "scan after pack ms", scanMs);
+	printf("%-30s %12d\n", "categories changed", changes.GetCount());
+
+	const CatalogChange* pAdded = FindChange(changes, added);
+	const CatalogChange* pExtended = FindChange(changes, extended);
+	const CatalogChange* pRewritten = FindChange(changes, rewritten);
+	const CatalogChange* pDeleted = FindChange(changes, deleted);
+	passed = Check(!IsFailed(r), "scanning") && Check(changes.GetCount() == 4, "four changed categories");
+	passed = Check(pAdded != null && pAdded->kind == CatalogChange::CATEGORY_ADDED, "the added category") && passed;
+	passed = Check(pDeleted != null && pDeleted->kind == CatalogChange::CATEGORY_REMOVED, "the removed category") && passed;
+	if(Check(pExtended != null && pExtended->kind == CatalogChange::CATEGORY_CHANGED, "the extended category")) {
+		bool all = pExtended->items.GetCount() == PACK_ITEMS && pExtended->removedItems.GetCount() == 0 && !pExtended->infoChanged;
+		for(int i = 0; i < newPaths.GetCount(); i++) {
+			all = all && Contains(pExtended->items, *static_cast<String*>(newPaths.GetAt(i)));
+		}
+		passed = Check(all, "the new items") && passed;
+	} else {
+		passed = false;
+	}
+	if(Check(pRewritten != null && pRewritten->kind == CatalogChange::CATEGORY_CHANGED, "the rewritten category")) {
+		passed = Check(pRewritten->items.GetCount() == 1 && Contains(pRewritten->items, changedPath), "the rewritten item") && passed;
+		passed = Check(pRewritten->removedItems.GetCount() == 1 && Contains(pRewritten->removedItems, removedPath), "the removed item") && passed;
+	} else {
+		passed = false;
+	}
+	changes.RemoveAll(true);
+	newPaths.RemoveAll(true);
+
+	// Recorded by the scan, so nothing is left to report
+	watcher.Scan(changes);
+	passed = Check(changes.GetCount() == 0, "a quiet scan after the pack") && passed;
+	changes.RemoveAll(true);
+	return passed;
+}
+
+int
+main(int argc, char** argv)
+{
+	int items = 10000;
+	int categories = 10;
+	int rounds = 10;
+	std::string catalog;
+
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-items") == 0 && i + 1 < argc) {
+			items = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-categories") == 0 && i + 1 < argc) {
+			categories = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-rounds") == 0 && i + 1 < argc) {
+			rounds = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-catalog") == 0 && i + 1 < argc) {
+			catalog = argv[++i];
+		} else {
+			fprintf(stderr, "usage: %s [-items N [-categories N] | -catalog DIR] [-rounds N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	std::string work;
+	if(catalog.empty()) {
+		char workTemplate[] = "/tmp/textart-watch-XXXXXX";
+		char* pWork = mkdtemp(workTemplate);
+		if(pWork == NULL) {
+			perror("mkdtemp");
+			return 1;
+		}
+		work = pWork;
+		catalog = work + "/catalog";
+		CatalogGenerator::Options options;
+		options.items = items;
+		options.categories = categories;
+		CatalogGenerator::Stats stats;
+		if(!CatalogGenerator::Generate(catalog, options, stats)) {
+			fprintf(stderr, "generating %s failed\n", catalog.c_str());
+			return 1;
+		}
+	}
+	HostFileSystem::Mount("/Home/catalog", catalog.c_str());
+
+	CatalogWatcher watcher;
+	double start = GetMilliseconds();
+	result r = watcher.Record();
+	double recordMs = GetMilliseconds() - start;
+	if(IsFailed(r)) {
+		fprintf(stderr, "recording the catalog failed by %s\n", GetErrorMessage(r));
+		return 1;
+	}
+	printf("%d categories, %d entries\n", watcher.GetCategoryCount(), watcher.GetEntryCount());
+	printf("%-30s %12.1f\n", "record ms", recordMs);
+
+	ArrayList changes;
+	changes.Construct();
+	double total = 0;
+	double worst = 0;
+	for(int i = 0; i < rounds; i++) {
+		start = GetMilliseconds();
+		watcher.Scan(changes);
+		double elapsed = GetMilliseconds() - start;
+		total += elapsed;
+		worst = elapsed > worst ? elapsed : worst;
+	}
+	int unchanged = changes.GetCount();
+	changes.RemoveAll(true);
+	printf("%-30s %12.1f\n", "quiet scan mean ms", rounds > 0 ? total / rounds : 0.0);
+	printf("%-30s %12.1f\n", "quiet scan max ms", worst);
+	printf("%-30s %12d\n", "changes on a quiet catalog", unchanged);
+
+	bool passed = unchanged == 0;
+	if(!work.empty()) {
+		passed = RunPack(watcher) && passed;
+		std::string cleanup = "rm -rf '" + work + "'";
+		if(system(cleanup.c_str()) != 0) {
+			fprintf(stderr, "cannot remove %s\n", work.c_str());
+		}
+	}
+	printf("%s\n", passed ? "passed" : "FAILED");
+	return passed ? 0 : 1;
+}
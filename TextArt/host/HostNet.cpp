@@ -0,0 +1,485 @@
+#include "HostOsp.h"
+
+#include <errno.h>
+#include <netdb.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Utility;
+using namespace Osp::Net::Http;
+
+static const int READ_CHUNK = 16 * 1024;
+
+// Submitted and not yet run, in order
+static std::vector<HttpTransaction*>&
+GetPending(void)
+{
+	static std::vector<HttpTransaction*> pending;
+	return pending;
+}
+
+// Cleared when the listener deletes the transaction that is running
+static HttpTransaction* __pRunning = null;
+
+static std::string
+ToUtf8(const String& value)
+{
+	ByteBuffer* pBuffer = StringUtil::StringToUtf8N(value);
+	std::string utf8;
+	if(pBuffer != null) {
+		utf8 = reinterpret_cast<const char*>(pBuffer->GetPointer());
+		delete pBuffer;
+	}
+	return utf8;
+}
+
+static void
+Remove(std::vector<HttpTransaction*>& transactions, HttpTransaction* pTransaction)
+{
+	transactions.erase(std::remove(transactions.begin(), transactions.end(), pTransaction), transactions.end());
+}
+
+// "http://host:port/path" or "host:port/path" into its parts, port 80 by default
+static bool
+ParseUri(const std::string& uri, std::string& host, std::string& port, std::string& path)
+{
+	std::string rest = uri;
+	if(rest.compare(0, 7, "http://") == 0) {
+		rest = rest.substr(7);
+	}
+	size_t slash = rest.find('/');
+	std::string authority = rest.substr(0, slash);
+	path = slash == std::string::npos ? "/" : rest.substr(slash);
+	size_t colon = authority.find(':');
+	host = authority.substr(0, colon);
+	port = colon == std::string::npos ? "80" : authority.substr(colon + 1);
+	return !host.empty();
+}
+
+static int
+Connect(const std::string& host, const std::string& port)
+{
+	struct addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	struct addrinfo* pAddresses = null;
+	if(getaddrinfo(host.c_str(), port.c_str(), &hints, &pAddresses) != 0) {
+		return -1;
+	}
+	int socketFd = -1;
+	for(struct addrinfo* pAddress = pAddresses; pAddress != null && socketFd < 0; pAddress = pAddress->ai_next) {
+		socketFd = socket(pAddress->ai_family, pAddress->ai_socktype, pAddress->ai_protocol);
+		if(socketFd >= 0 && connect(socketFd, pAddress->ai_addr, pAddress->ai_addrlen) != 0) {
+			close(socketFd);
+			socketFd = -1;
+		}
+	}
+	freeaddrinfo(pAddresses);
+	return socketFd;
+}
+
+static bool
+SendAll(int socketFd, const std::string& data)
+{
+	size_t sent = 0;
+	while(sent < data.size()) {
+		ssize_t count = send(socketFd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+		if(count <= 0) {
+			return false;
+		}
+		sent += count;
+	}
+	return true;
+}
+
+// HostNetwork
+
+int
+HostNetwork::RunPending(void)
+{
+	int count = 0;
+	std::vector<HttpTransaction*>& pending = GetPending();
+	while(!pending.empty()) {
+		HttpTransaction* pTransaction = pending.front();
+		pending.erase(pending.begin());
+		pTransaction->Run();
+		count++;
+	}
+	return count;
+}
+
+namespace Osp {
+namespace Net {
+namespace Http {
+
+// HttpHeader
+
+HttpHeader::HttpHeader(void)
+{
+}
+
+HttpHeader::~HttpHeader(void)
+{
+}
+
+result
+HttpHeader::AddField(const String& fieldName, const String& fieldValue)
+{
+	if(fieldName.IsEmpty()) {
+		return E_INVALID_ARG;
+	}
+	__fields.push_back(std::make_pair(ToUtf8(fieldName), ToUtf8(fieldValue)));
+	return E_SUCCESS;
+}
+
+result
+HttpHeader::RemoveField(const String& fieldName)
+{
+	std::string name = ToUtf8(fieldName);
+	size_t count = __fields.size();
+	for(size_t i = count; i > 0; i--) {
+		if(strcasecmp(__fields[i - 1].first.c_str(), name.c_str()) == 0) {
+			__fields.erase(__fields.begin() + (i - 1));
+		}
+	}
+	return __fields.size() < count ? E_SUCCESS : E_OBJ_NOT_FOUND;
+}
+
+void
+HttpHeader::RemoveAll(void)
+{
+	__fields.clear();
+}
+
+// HttpRequest
+
+HttpRequest::HttpRequest(void):
+	__method(NET_HTTP_METHOD_GET),
+	__pHeader(new HttpHeader())
+{
+}
+
+HttpRequest::~HttpRequest(void)
+{
+	delete __pHeader;
+}
+
+result
+HttpRequest::SetMethod(NetHttpMethod method)
+{
+	__method = method;
+	return E_SUCCESS;
+}
+
+result
+HttpRequest::SetUri(const String& uri)
+{
+	__uri = ToUtf8(uri);
+	return E_SUCCESS;
+}
+
+result
+HttpRequest::WriteBody(const ByteBuffer& body)
+{
+	const char* pBody = reinterpret_cast<const char*>(body.GetPointer());
+	if(pBody != null) {
+		__body.append(pBody + body.GetPosition(), body.GetRemaining());
+	}
+	return E_SUCCESS;
+}
+
+HttpHeader*
+HttpRequest::GetHeader(void) const
+{
+	return __pHeader;
+}
+
+// HttpResponse
+
+HttpResponse::HttpResponse(void):
+	__statusCode(0),
+	__pHeader(new HttpHeader())
+{
+}
+
+HttpResponse::~HttpResponse(void)
+{
+	delete __pHeader;
+}
+
+NetHttpStatusCode
+HttpResponse::GetStatusCode(void) const
+{
+	return (NetHttpStatusCode)__statusCode;
+}
+
+int
+HttpResponse::GetHttpStatusCode(void) const
+{
+	return __statusCode;
+}
+
+HttpHeader*
+HttpResponse::GetHeader(void) const
+{
+	return __pHeader;
+}
+
+ByteBuffer*
+HttpResponse::ReadBodyN(void)
+{
+	ByteBuffer* pBody = new ByteBuffer();
+	pBody->Construct((int)__available.size());
+	if(!__available.empty()) {
+		pBody->SetArray(reinterpret_cast<const byte*>(__available.data()), 0, (int)__available.size());
+	}
+	pBody->Flip();
+	__available.clear();
+	SetLastResult(E_SUCCESS);
+	return pBody;
+}
+
+// HttpTransaction
+
+HttpTransaction::HttpTransaction(HttpSession& session):
+	__pSession(&session),
+	__pListener(null),
+	__pUserObject(null)
+{
+}
+
+HttpTransaction::~HttpTransaction(void)
+{
+	Remove(GetPending(), this);
+	if(__pSession != null) {
+		Remove(__pSession->__transactions, this);
+	}
+	if(__pRunning == this) {
+		__pRunning = null;
+	}
+}
+
+result
+HttpTransaction::Submit(void)
+{
+	if(__request.__uri.empty()) {
+		return E_INVALID_STATE;
+	}
+	GetPending().push_back(this);
+	return E_SUCCESS;
+}
+
+HttpRequest*
+HttpTransaction::GetRequest(void) const
+{
+	return const_cast<HttpRequest*>(&__request);
+}
+
+HttpResponse*
+HttpTransaction::GetResponse(void) const
+{
+	return const_cast<HttpResponse*>(&__response);
+}
+
+result
+HttpTransaction::AddHttpTransactionListener(const IHttpTransactionEventListener& listener)
+{
+	__pListener = const_cast<IHttpTransactionEventListener*>(&listener);
+	return E_SUCCESS;
+}
+
+result
+HttpTransaction::SetUserObject(const Object* pUserData)
+{
+	__pUserObject = const_cast<Object*>(pUserData);
+	return E_SUCCESS;
+}
+
+Object*
+HttpTransaction::GetUserObject(void) const
+{
+	return __pUserObject;
+}
+
+bool
+HttpTransaction::Run(void)
+{
+	if(__pListener == null || __pSession == null) {
+		return true;
+	}
+	HttpSession& session = *__pSession;
+	IHttpTransactionEventListener& listener = *__pListener;
+	__pRunning = this;
+
+	std::string host;
+	std::string port;
+	std::string path;
+	std::string uri = __request.__uri.compare(0, 1, "/") == 0 ? session.__host + __request.__uri : __request.__uri;
+	int socketFd = ParseUri(uri, host, port, path) ? Connect(host, port) : -1;
+	if(socketFd < 0) {
+		listener.OnTransactionAborted(session, *this, E_CONNECTION_FAILED);
+		return false;
+	}
+
+	std::string request = __request.__method == NET_HTTP_METHOD_POST ? "POST " : "GET ";
+	request += path + " HTTP/1.1\r\nHost: " + host + "\r\nConnection: close\r\n";
+	bool length = false;
+	const std::vector<std::pair<std::string, std::string> >& fields = __request.__pHeader->__fields;
+	for(size_t i = 0; i < fields.size(); i++) {
+		length = length || strcasecmp(fields[i].first.c_str(), "Content-Length") == 0;
+		request += fields[i].first + ": " + fields[i].second + "\r\n";
+	}
+	if(!length && !__request.__body.empty()) {
+		char value[32];
+		snprintf(value, sizeof(value), "%u", (unsigned int)__request.__body.size());
+		request += std::string("Content-Length: ") + value + "\r\n";
+	}
+	request += "\r\n" + __request.__body;
+	if(!SendAll(socketFd, request)) {
+		close(socketFd);
+		listener.OnTransactionAborted(session, *this, E_NETWORK_FAILED);
+		return false;
+	}
+
+	// Status line and fields
+	std::string received;
+	size_t headerEnd = std::string::npos;
+	char buffer[READ_CHUNK];
+	while(headerEnd == std::string::npos) {
+		ssize_t count = recv(socketFd, buffer, sizeof(buffer), 0);
+		if(count <= 0) {
+			close(socketFd);
+			listener.OnTransactionAborted(session, *this, E_NETWORK_FAILED);
+			return false;
+		}
+		received.append(buffer, count);
+		headerEnd = received.find("\r\n\r\n");
+	}
+	std::string header = received.substr(0, headerEnd);
+	received.erase(0, headerEnd + 4);
+	size_t space = header.find(' ');
+	__response.__statusCode = space == std::string::npos ? 0 : atoi(header.c_str() + space + 1);
+	long long contentLength = -1;
+	size_t lineStart = header.find("\r\n");
+	while(lineStart != std::string::npos) {
+		lineStart += 2;
+		size_t lineEnd = header.find("\r\n", lineStart);
+		std::string line = header.substr(lineStart, lineEnd == std::string::npos ? std::string::npos : lineEnd - lineStart);
+		size_t colon = line.find(':');
+		if(colon != std::string::npos) {
+			std::string name = line.substr(0, colon);
+			size_t valueStart = line.find_first_not_of(' ', colon + 1);
+			std::string value = valueStart == std::string::npos ? "" : line.substr(valueStart);
+			__response.__pHeader->__fields.push_back(std::make_pair(name, value));
+			if(strcasecmp(name.c_str(), "Content-Length") == 0) {
+				contentLength = atoll(value.c_str());
+			}
+		}
+		lineStart = lineEnd;
+	}
+	listener.OnTransactionHeaderCompleted(session, *this, (int)headerEnd + 4, false);
+	if(__pRunning != this) {
+		close(socketFd);
+		return false;
+	}
+
+	// Body as it arrives, a connection closing early aborts
+	long long bodyLength = 0;
+	for(;;) {
+		if(!received.empty()) {
+			bodyLength += received.size();
+			__response.__available += received;
+			received.clear();
+			listener.OnTransactionReadyToRead(session, *this, (int)__response.__available.size());
+			if(__pRunning != this) {
+				close(socketFd);
+				return false;
+			}
+		}
+		if(contentLength >= 0 && bodyLength >= contentLength) {
+			break;
+		}
+		ssize_t count = recv(socketFd, buffer, sizeof(buffer), 0);
+		if(count < 0 || (count == 0 && contentLength >= 0)) {
+			close(socketFd);
+			listener.OnTransactionAborted(session, *this, E_NETWORK_FAILED);
+			return false;
+		}
+		if(count == 0) {
+			break;
+		}
+		received.append(buffer, count);
+	}
+	close(socketFd);
+	listener.OnTransactionCompleted(session, *this);
+	bool alive = __pRunning == this;
+	__pRunning = null;
+	return alive;
+}
+
+// HttpSession
+
+HttpSession::HttpSession(void)
+{
+}
+
+HttpSession::~HttpSession(void)
+{
+	CloseAllTransactions();
+}
+
+result
+HttpSession::Construct(NetHttpSessionMode sessionMode, const String* pProxyAddr, const String& hostAddr,
+		const HttpHeader* pCommonHeader, NetHttpCookieFlag flag)
+{
+	__host = ToUtf8(hostAddr);
+	if(!__host.empty() && __host[__host.size() - 1] == '/') {
+		__host.erase(__host.size() - 1);
+	}
+	return __host.empty() ? E_INVALID_ARG : E_SUCCESS;
+}
+
+HttpTransaction*
+HttpSession::OpenTransactionN(void)
+{
+	HttpTransaction* pTransaction = new HttpTransaction(*this);
+	__transactions.push_back(pTransaction);
+	SetLastResult(E_SUCCESS);
+	return pTransaction;
+}
+
+result
+HttpSession::CancelTransaction(HttpTransaction& httpTransaction)
+{
+	Remove(GetPending(), &httpTransaction);
+	return E_SUCCESS;
+}
+
+result
+HttpSession::CloseTransaction(HttpTransaction& httpTransaction)
+{
+	delete &httpTransaction;
+	return E_SUCCESS;
+}
+
+result
+HttpSession::CloseAllTransactions(void)
+{
+	while(!__transactions.empty()) {
+		delete __transactions.back();
+	}
+	return E_SUCCESS;
+}
+
+}
+
+}
+
+}
@@ -0,0 +1,1880 @@
+#include "HostOsp.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <wchar.h>
+#include <wctype.h>
+
+#include <sqlite3.h>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+using namespace Osp::Base::Utility;
+using namespace Osp::Io;
+
+// Per thread, as on the device
+static __thread result __lastResult = E_SUCCESS;
+
+const char*
+GetErrorMessage(result r)
+{
+	switch(r) {
+	case E_SUCCESS: return "E_SUCCESS";
+	case E_FAILURE: return "E_FAILURE";
+	case E_OUT_OF_MEMORY: return "E_OUT_OF_MEMORY";
+	case E_INVALID_ARG: return "E_INVALID_ARG";
+	case E_INVALID_STATE: return "E_INVALID_STATE";
+	case E_OUT_OF_RANGE: return "E_OUT_OF_RANGE";
+	case E_OBJ_NOT_FOUND: return "E_OBJ_NOT_FOUND";
+	case E_OBJ_ALREADY_EXIST: return "E_OBJ_ALREADY_EXIST";
+	case E_UNDERFLOW: return "E_UNDERFLOW";
+	case E_OVERFLOW: return "E_OVERFLOW";
+	case E_INVALID_FORMAT: return "E_INVALID_FORMAT";
+	case E_END_OF_FILE: return "E_END_OF_FILE";
+	case E_FILE_NOT_FOUND: return "E_FILE_NOT_FOUND";
+	case E_FILE_ALREADY_EXIST: return "E_FILE_ALREADY_EXIST";
+	case E_ILLEGAL_ACCESS: return "E_ILLEGAL_ACCESS";
+	case E_IO: return "E_IO";
+	case E_STORAGE_FULL: return "E_STORAGE_FULL";
+	case E_DATABASE: return "E_DATABASE";
+	case E_SYSTEM: return "E_SYSTEM";
+	case E_IN_PROGRESS: return "E_IN_PROGRESS";
+	case E_INVALID_DATA: return "E_INVALID_DATA";
+	case E_CONNECTION_FAILED: return "E_CONNECTION_FAILED";
+	case E_NETWORK_FAILED: return "E_NETWORK_FAILED";
+	case E_NUM_FORMAT: return "E_NUM_FORMAT";
+	}
+	return "E_UNKNOWN";
+}
+
+result
+GetLastResult(void)
+{
+	return __lastResult;
+}
+
+void
+SetLastResult(result r)
+{
+	__lastResult = r;
+}
+
+void
+HostLog(const char* pFormat, ...)
+{
+	static int enabled = -1;
+	if(enabled < 0) {
+		enabled = getenv("TEXTART_LOG") != null ? 1 : 0;
+	}
+	if(!enabled) {
+		return;
+	}
+	va_list args;
+	va_start(args, pFormat);
+	vfprintf(stderr, pFormat, args);
+	va_end(args);
+	fputc('\n', stderr);
+}
+
+// UTF-8 <-> UTF-16 code units, the device's mchar representation
+
+static bool
+DecodeUtf8(const char* p, size_t length, std::wstring& out, bool strict)
+{
+	out.clear();
+	out.reserve(length);
+	const unsigned char* s = (const unsigned char*)p;
+	size_t i = 0;
+	while(i < length) {
+		unsigned int c = s[i];
+		int extra = 0;
+		unsigned int min = 0;
+		if(c < 0x80) {
+			out.push_back((mchar)c);
+			i++;
+			continue;
+		} else if((c & 0xE0) == 0xC0) {
+			extra = 1; min = 0x80; c &= 0x1F;
+		} else if((c & 0xF0) == 0xE0) {
+			extra = 2; min = 0x800; c &= 0x0F;
+		} else if((c & 0xF8) == 0xF0) {
+			extra = 3; min = 0x10000; c &= 0x07;
+		} else {
+			extra = -1;
+		}
+
+		bool valid = extra > 0;
+		for(int k = 1; valid && k <= extra; k++) {
+			if(i + k >= length || (s[i + k] & 0xC0) != 0x80) {
+				valid = false;
+			} else {
+				c = (c << 6) | (s[i + k] & 0x3F);
+			}
+		}
+		if(valid && (c < min || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF))) {
+			valid = false;
+		}
+
+		if(!valid) {
+			if(strict) {
+				return false;
+			}
+			// lenient callers take stray bytes as Latin-1
+			out.push_back((mchar)s[i]);
+			i++;
+			continue;
+		}
+
+		if(c >= 0x10000) {
+			c -= 0x10000;
+			out.push_back((mchar)(0xD800 + (c >> 10)));
+			out.push_back((mchar)(0xDC00 + (c & 0x3FF)));
+		} else {
+			out.push_back((mchar)c);
+		}
+		i += extra + 1;
+	}
+	return true;
+}
+
+static void
+EncodeUtf8(const mchar* p, int length, std::string& out)
+{
+	out.clear();
+	out.reserve(length);
+	for(int i = 0; i < length; i++) {
+		unsigned int c = (unsigned int)p[i] & 0xFFFF;
+		if(c >= 0xD800 && c <= 0xDBFF && i + 1 < length
+				&& ((unsigned int)p[i + 1] & 0xFFFF) >= 0xDC00 && ((unsigned int)p[i + 1] & 0xFFFF) <= 0xDFFF) {
+			c = 0x10000 + ((c - 0xD800) << 10) + (((unsigned int)p[i + 1] & 0xFFFF) - 0xDC00);
+			i++;
+		}
+		if(c < 0x80) {
+			out.push_back((char)c);
+		} else if(c < 0x800) {
+			out.push_back((char)(0xC0 | (c >> 6)));
+			out.push_back((char)(0x80 | (c & 0x3F)));
+		} else if(c < 0x10000) {
+			out.push_back((char)(0xE0 | (c >> 12)));
+			out.push_back((char)(0x80 | ((c >> 6) & 0x3F)));
+			out.push_back((char)(0x80 | (c & 0x3F)));
+		} else {
+			out.push_back((char)(0xF0 | (c >> 18)));
+			out.push_back((char)(0x80 | ((c >> 12) & 0x3F)));
+			out.push_back((char)(0x80 | ((c >> 6) & 0x3F)));
+			out.push_back((char)(0x80 | (c & 0x3F)));
+		}
+	}
+}
+
+// HostFileSystem
+
+struct Mount {
+	std::string device;
+	std::string host;
+};
+
+static std::vector<Mount>&
+GetMounts(void)
+{
+	static std::vector<Mount> mounts;
+	return mounts;
+}
+
+void
+HostFileSystem::Mount(const char* pDevicePrefix, const char* pHostPath)
+{
+	std::vector< ::Mount>& mounts = GetMounts();
+	for(size_t i = 0; i < mounts.size(); i++) {
+		if(mounts[i].device == pDevicePrefix) {
+			mounts[i].host = pHostPath;
+			return;
+		}
+	}
+	::Mount mount;
+	mount.device = pDevicePrefix;
+	mount.host = pHostPath;
+	mounts.push_back(mount);
+}
+
+std::string
+HostFileSystem::Resolve(const mchar* pDevicePath)
+{
+	std::string path;
+	EncodeUtf8(pDevicePath, (int)wcslen(pDevicePath), path);
+
+	std::vector< ::Mount>& mounts = GetMounts();
+	size_t best = mounts.size();
+	for(size_t i = 0; i < mounts.size(); i++) {
+		const std::string& prefix = mounts[i].device;
+		if(path.compare(0, prefix.size(), prefix) == 0
+				&& (path.size() == prefix.size() || path[prefix.size()] == '/' || prefix[prefix.size() - 1] == '/')
+				&& (best == mounts.size() || prefix.size() > mounts[best].device.size())) {
+			best = i;
+		}
+	}
+	if(best == mounts.size()) {
+		return path;
+	}
+	return mounts[best].host + path.substr(mounts[best].device.size());
+}
+
+static result
+ErrnoToResult(int error)
+{
+	switch(error) {
+	case ENOENT: case ENOTDIR: return E_FILE_NOT_FOUND;
+	case EEXIST: return E_FILE_ALREADY_EXIST;
+	case EACCES: case EPERM: case EROFS: return E_ILLEGAL_ACCESS;
+	case ENOSPC: return E_STORAGE_FULL;
+	case ENOMEM: return E_OUT_OF_MEMORY;
+	case EINVAL: return E_INVALID_ARG;
+	}
+	return E_IO;
+}
+
+// Milliseconds, so a rewrite within the same second still shows
+static long long
+GetModified(const struct stat& info)
+{
+	return (long long)info.st_mtim.tv_sec * 1000 + info.st_mtim.tv_nsec / 1000000;
+}
+
+static result
+MakeDirectories(const std::string& path)
+{
+	std::string partial;
+	size_t start = 0;
+	while(start <= path.size()) {
+		size_t slash = path.find('/', start);
+		if(slash == std::string::npos) {
+			slash = path.size();
+		}
+		partial = path.substr(0, slash);
+		if(!partial.empty() && mkdir(partial.c_str(), 0755) != 0 && errno != EEXIST) {
+			return ErrnoToResult(errno);
+		}
+		start = slash + 1;
+	}
+	return E_SUCCESS;
+}
+
+namespace Osp {
+namespace Base {
+
+// Object
+
+Object::Object(void)
+{
+}
+
+Object::~Object(void)
+{
+}
+
+bool
+Object::Equals(const Object& obj) const
+{
+	return this == &obj;
+}
+
+int
+Object::GetHashCode(void) const
+{
+	return (int)(long)this;
+}
+
+// String
+
+String::String(void)
+{
+}
+
+String::String(int capacity)
+{
+	__value.reserve(capacity > 0 ? capacity : 0);
+}
+
+String::String(const mchar ch):
+	__value(1, ch)
+{
+}
+
+String::String(const mchar* pValue)
+{
+	if(pValue != null) {
+		__value = pValue;
+	}
+}
+
+String::String(const char* pValue)
+{
+	if(pValue != null) {
+		DecodeUtf8(pValue, strlen(pValue), __value, false);
+	}
+}
+
+String::String(const String& value):
+	Object(),
+	__value(value.__value)
+{
+}
+
+String::~String(void)
+{
+}
+
+mchar&
+String::operator [](int index) const
+{
+	return __value[index];
+}
+
+String&
+String::operator =(const mchar* pRhs)
+{
+	__value = pRhs != null ? pRhs : L"";
+	return *this;
+}
+
+String&
+String::operator =(const String& rhs)
+{
+	__value = rhs.__value;
+	return *this;
+}
+
+String&
+String::operator +=(const mchar* pRhs)
+{
+	Append(pRhs);
+	return *this;
+}
+
+String&
+String::operator +=(const String& rhs)
+{
+	__value += rhs.__value;
+	return *this;
+}
+
+String
+operator +(const String& lhs, const String& rhs)
+{
+	String out(lhs);
+	out.__value += rhs.__value;
+	return out;
+}
+
+bool
+String::operator ==(const String& rhs) const
+{
+	return __value == rhs.__value;
+}
+
+bool
+String::operator !=(const String& rhs) const
+{
+	return __value != rhs.__value;
+}
+
+bool
+String::IsEmpty(void) const
+{
+	return __value.empty();
+}
+
+result
+String::Append(mchar ch)
+{
+	__value.push_back(ch);
+	return E_SUCCESS;
+}
+
+result
+String::Append(char ch)
+{
+	__value.push_back((mchar)(unsigned char)ch);
+	return E_SUCCESS;
+}
+
+result
+String::Append(int i)
+{
+	return Append((long long)i);
+}
+
+result
+String::Append(short s)
+{
+	return Append((long long)s);
+}
+
+result
+String::Append(long l)
+{
+	return Append((long long)l);
+}
+
+result
+String::Append(long long ll)
+{
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%lld", ll);
+	for(const char* p = buffer; *p; p++) {
+		__value.push_back((mchar)*p);
+	}
+	return E_SUCCESS;
+}
+
+result
+String::Append(float f)
+{
+	return Append((double)f);
+}
+
+result
+String::Append(double d)
+{
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "%g", d);
+	for(const char* p = buffer; *p; p++) {
+		__value.push_back((mchar)*p);
+	}
+	return E_SUCCESS;
+}
+
+result
+String::Append(const mchar* p)
+{
+	if(p == null) {
+		return E_INVALID_ARG;
+	}
+	__value += p;
+	return E_SUCCESS;
+}
+
+result
+String::Append(const String& str)
+{
+	__value += str.__value;
+	return E_SUCCESS;
+}
+
+void
+String::Clear(void)
+{
+	__value.clear();
+}
+
+int
+String::Compare(const String& str0, const String& str1)
+{
+	return str0.__value.compare(str1.__value);
+}
+
+int
+String::CompareTo(const String& str) const
+{
+	return __value.compare(str.__value);
+}
+
+result
+String::EnsureCapacity(int minLength)
+{
+	if(minLength < 0) {
+		return E_INVALID_ARG;
+	}
+	__value.reserve(minLength);
+	return E_SUCCESS;
+}
+
+bool
+String::Equals(const Object& obj) const
+{
+	const String* pOther = dynamic_cast<const String*>(&obj);
+	return pOther != null && pOther->__value == __value;
+}
+
+bool
+String::Equals(const String& str, bool caseSensitive) const
+{
+	if(caseSensitive) {
+		return __value == str.__value;
+	}
+	if(__value.size() != str.__value.size()) {
+		return false;
+	}
+	for(size_t i = 0; i < __value.size(); i++) {
+		if(towlower(__value[i]) != towlower(str.__value[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int
+String::GetHashCode(void) const
+{
+	unsigned int hash = 0;
+	for(size_t i = 0; i < __value.size(); i++) {
+		hash = hash * 31 + (unsigned int)__value[i];
+	}
+	return (int)hash;
+}
+
+result
+String::GetCharAt(int indexAt, mchar& ch) const
+{
+	if(indexAt < 0 || indexAt >= GetLength()) {
+		return E_OUT_OF_RANGE;
+	}
+	ch = __value[indexAt];
+	return E_SUCCESS;
+}
+
+result
+String::IndexOf(mchar ch, int startIndex, int& indexOf) const
+{
+	if(startIndex < 0 || startIndex >= GetLength()) {
+		return E_OUT_OF_RANGE;
+	}
+	size_t found = __value.find(ch, startIndex);
+	if(found == std::wstring::npos) {
+		indexOf = -1;
+		return E_OBJ_NOT_FOUND;
+	}
+	indexOf = (int)found;
+	return E_SUCCESS;
+}
+
+result
+String::IndexOf(const String& str, int startIndex, int& indexOf) const
+{
+	if(startIndex < 0 || startIndex >= GetLength()) {
+		return E_OUT_OF_RANGE;
+	}
+	size_t found = __value.find(str.__value, startIndex);
+	if(found == std::wstring::npos) {
+		indexOf = -1;
+		return E_OBJ_NOT_FOUND;
+	}
+	indexOf = (int)found;
+	return E_SUCCESS;
+}
+
+result
+String::Insert(mchar ch, int indexAt)
+{
+	if(indexAt < 0 || indexAt > GetLength()) {
+		return E_OUT_OF_RANGE;
+	}
+	__value.insert(__value.begin() + indexAt, ch);
+	return E_SUCCESS;
+}
+
+result
+String::Insert(const mchar* p, int indexAt)
+{
+	if(p == null) {
+		return E_INVALID_ARG;
+	}
+	if(indexAt < 0 || indexAt > GetLength()) {
+		return E_OUT_OF_RANGE;
+	}
+	__value.insert(indexAt, p);
+	return E_SUCCESS;
+}
+
+result
+String::Insert(const String& str, int indexAt)
+{
+	return Insert(str.GetPointer(), indexAt);
+}
+
+result
+String::LastIndexOf(mchar ch, int startIndex, int& indexOf) const
+{
+	if(startIndex < 0 || startIndex >= GetLength()) {
+		return E_OUT_OF_RANGE;
+	}
+	size_t found = __value.rfind(ch, startIndex);
+	if(found == std::wstring::npos) {
+		indexOf = -1;
+		return E_OBJ_NOT_FOUND;
+	}
+	indexOf = (int)found;
+	return E_SUCCESS;
+}
+
+result
+String::Remove(int startIndex, int length)
+{
+	if(startIndex < 0 || length < 0 || startIndex + length > GetLength()) {
+		return E_OUT_OF_RANGE;
+	}
+	__value.erase(startIndex, length);
+	return E_SUCCESS;
+}
+
+void
+String::Replace(mchar original, mchar replace)
+{
+	for(size_t i = 0; i < __value.size(); i++) {
+		if(__value[i] == original) {
+			__value[i] = replace;
+		}
+	}
+}
+
+result
+String::Replace(const String& original, const String& replace)
+{
+	if(original.IsEmpty()) {
+		return E_INVALID_ARG;
+	}
+	size_t position = 0;
+	while((position = __value.find(original.__value, position)) != std::wstring::npos) {
+		__value.replace(position, original.__value.size(), replace.__value);
+		position += replace.__value.size();
+	}
+	return E_SUCCESS;
+}
+
+result
+String::SetCapacity(int newCapacity)
+{
+	return EnsureCapacity(newCapacity);
+}
+
+result
+String::SetCharAt(mchar ch, int indexAt)
+{
+	if(indexAt < 0 || indexAt >= GetLength()) {
+		return E_OUT_OF_RANGE;
+	}
+	__value[indexAt] = ch;
+	return E_SUCCESS;
+}
+
+result
+String::SetLength(int newLength)
+{
+	if(newLength < 0) {
+		return E_INVALID_ARG;
+	}
+	__value.resize(newLength, L' ');
+	return E_SUCCESS;
+}
+
+result
+String::SubString(int startIndex, String& out) const
+{
+	if(startIndex < 0 || startIndex > GetLength()) {
+		return E_OUT_OF_RANGE;
+	}
+	out.__value = __value.substr(startIndex);
+	return E_SUCCESS;
+}
+
+result
+String::SubString(int startIndex, int length, String& out) const
+{
+	if(startIndex < 0 || length < 0 || startIndex + length > GetLength()) {
+		return E_OUT_OF_RANGE;
+	}
+	out.__value = __value.substr(startIndex, length);
+	return E_SUCCESS;
+}
+
+bool
+String::StartsWith(const String& str, int startIndex) const
+{
+	if(startIndex < 0 || startIndex > GetLength()) {
+		return false;
+	}
+	return __value.compare(startIndex, str.__value.size(), str.__value) == 0;
+}
+
+bool
+String::EndsWith(const String& str) const
+{
+	if(str.__value.size() > __value.size()) {
+		return false;
+	}
+	return __value.compare(__value.size() - str.__value.size(), str.__value.size(), str.__value) == 0;
+}
+
+result
+String::ToLowerCase(String& out) const
+{
+	out = *this;
+	out.ToLowerCase();
+	return E_SUCCESS;
+}
+
+void
+String::ToLowerCase(void)
+{
+	for(size_t i = 0; i < __value.size(); i++) {
+		__value[i] = (mchar)towlower(__value[i]);
+	}
+}
+
+result
+String::ToUpperCase(String& out) const
+{
+	out = *this;
+	out.ToUpperCase();
+	return E_SUCCESS;
+}
+
+void
+String::ToUpperCase(void)
+{
+	for(size_t i = 0; i < __value.size(); i++) {
+		__value[i] = (mchar)towupper(__value[i]);
+	}
+}
+
+void
+String::Trim(void)
+{
+	size_t start = 0;
+	while(start < __value.size() && __value[start] <= L' ') {
+		start++;
+	}
+	size_t end = __value.size();
+	while(end > start && __value[end - 1] <= L' ') {
+		end--;
+	}
+	__value = __value.substr(start, end - start);
+}
+
+int
+String::GetCapacity(void) const
+{
+	return (int)__value.capacity();
+}
+
+int
+String::GetLength(void) const
+{
+	return (int)__value.size();
+}
+
+const mchar*
+String::GetPointer(void) const
+{
+	return __value.c_str();
+}
+
+// ByteBuffer
+
+ByteBuffer::ByteBuffer(void):
+	__position(0),
+	__limit(0)
+{
+}
+
+ByteBuffer::~ByteBuffer(void)
+{
+}
+
+result
+ByteBuffer::Construct(int capacity)
+{
+	if(capacity < 0) {
+		return E_INVALID_ARG;
+	}
+	__data.assign(capacity, 0);
+	__position = 0;
+	__limit = capacity;
+	return E_SUCCESS;
+}
+
+result
+ByteBuffer::Construct(const ByteBuffer& buffer)
+{
+	__data = buffer.__data;
+	__position = buffer.__position;
+	__limit = buffer.__limit;
+	return E_SUCCESS;
+}
+
+result
+ByteBuffer::GetArray(byte* pArray, int index, int length)
+{
+	if(pArray == null || index < 0 || length < 0) {
+		return E_INVALID_ARG;
+	}
+	if(length > GetRemaining()) {
+		return E_UNDERFLOW;
+	}
+	if(length > 0) {
+		memcpy(pArray + index, &__data[__position], length);
+	}
+	__position += length;
+	return E_SUCCESS;
+}
+
+result
+ByteBuffer::SetArray(const byte* pArray, int index, int length)
+{
+	if(pArray == null || index < 0 || length < 0) {
+		return E_INVALID_ARG;
+	}
+	if(length > GetRemaining()) {
+		return E_OVERFLOW;
+	}
+	if(length > 0) {
+		memcpy(&__data[__position], pArray + index, length);
+	}
+	__position += length;
+	return E_SUCCESS;
+}
+
+result
+ByteBuffer::GetByte(byte& value)
+{
+	if(__position >= __limit) {
+		return E_UNDERFLOW;
+	}
+	value = __data[__position++];
+	return E_SUCCESS;
+}
+
+result
+ByteBuffer::GetByte(int index, byte& value) const
+{
+	if(index < 0 || index >= __limit) {
+		return E_OUT_OF_RANGE;
+	}
+	value = __data[index];
+	return E_SUCCESS;
+}
+
+result
+ByteBuffer::SetByte(byte value)
+{
+	if(__position >= __limit) {
+		return E_OVERFLOW;
+	}
+	__data[__position++] = value;
+	return E_SUCCESS;
+}
+
+result
+ByteBuffer::SetByte(int index, byte value)
+{
+	if(index < 0 || index >= __limit) {
+		return E_OUT_OF_RANGE;
+	}
+	__data[index] = value;
+	return E_SUCCESS;
+}
+
+const byte*
+ByteBuffer::GetPointer(void) const
+{
+	return __data.empty() ? null : &__data[0];
+}
+
+void
+ByteBuffer::Clear(void)
+{
+	__position = 0;
+	__limit = GetCapacity();
+}
+
+void
+ByteBuffer::Flip(void)
+{
+	__limit = __position;
+	__position = 0;
+}
+
+void
+ByteBuffer::Rewind(void)
+{
+	__position = 0;
+}
+
+int
+ByteBuffer::GetCapacity(void) const
+{
+	return (int)__data.size();
+}
+
+int
+ByteBuffer::GetLimit(void) const
+{
+	return __limit;
+}
+
+result
+ByteBuffer::SetLimit(int limit)
+{
+	if(limit < 0 || limit > GetCapacity()) {
+		return E_OUT_OF_RANGE;
+	}
+	__limit = limit;
+	if(__position > __limit) {
+		__position = __limit;
+	}
+	return E_SUCCESS;
+}
+
+int
+ByteBuffer::GetPosition(void) const
+{
+	return __position;
+}
+
+result
+ByteBuffer::SetPosition(int position)
+{
+	if(position < 0 || position > __limit) {
+		return E_OUT_OF_RANGE;
+	}
+	__position = position;
+	return E_SUCCESS;
+}
+
+int
+ByteBuffer::GetRemaining(void) const
+{
+	return __limit - __position;
+}
+
+bool
+ByteBuffer::HasRemaining(void) const
+{
+	return __position < __limit;
+}
+
+// TimeSpan, DateTime
+
+TimeSpan::TimeSpan(long long ticks):
+	__ticks(ticks)
+{
+}
+
+long long
+TimeSpan::GetTicks(void) const
+{
+	return __ticks;
+}
+
+DateTime::DateTime(void):
+	__ticks(0)
+{
+}
+
+DateTime::DateTime(long long ticks):
+	__ticks(ticks)
+{
+}
+
+TimeSpan
+DateTime::GetTime(void) const
+{
+	return TimeSpan(__ticks);
+}
+
+// LongLong
+
+result
+LongLong::Parse(const String& s, long long& ret)
+{
+	const mchar* pValue = s.GetPointer();
+	mchar* pEnd = null;
+	errno = 0;
+	long long value = wcstoll(pValue, &pEnd, 10);
+	if(pEnd == pValue || *pEnd != 0 || errno == ERANGE) {
+		return E_NUM_FORMAT;
+	}
+	ret = value;
+	return E_SUCCESS;
+}
+
+namespace Collection {
+
+// ArrayList
+
+ArrayList::ArrayList(void)
+{
+}
+
+ArrayList::~ArrayList(void)
+{
+}
+
+result
+ArrayList::Construct(int capacity)
+{
+	if(capacity < 0) {
+		return E_INVALID_ARG;
+	}
+	__items.reserve(capacity);
+	return E_SUCCESS;
+}
+
+result
+ArrayList::Add(const Object& obj)
+{
+	__items.push_back(const_cast<Object*>(&obj));
+	return E_SUCCESS;
+}
+
+const Object*
+ArrayList::GetAt(int index) const
+{
+	if(index < 0 || index >= GetCount()) {
+		SetLastResult(E_OUT_OF_RANGE);
+		return null;
+	}
+	return __items[index];
+}
+
+Object*
+ArrayList::GetAt(int index)
+{
+	if(index < 0 || index >= GetCount()) {
+		SetLastResult(E_OUT_OF_RANGE);
+		return null;
+	}
+	return __items[index];
+}
+
+result
+ArrayList::IndexOf(const Object& obj, int& index) const
+{
+	for(size_t i = 0; i < __items.size(); i++) {
+		if(__items[i]->Equals(obj)) {
+			index = (int)i;
+			return E_SUCCESS;
+		}
+	}
+	return E_OBJ_NOT_FOUND;
+}
+
+result
+ArrayList::InsertAt(const Object& obj, int index)
+{
+	if(index < 0 || index > GetCount()) {
+		return E_OUT_OF_RANGE;
+	}
+	__items.insert(__items.begin() + index, const_cast<Object*>(&obj));
+	return E_SUCCESS;
+}
+
+result
+ArrayList::Remove(const Object& obj, bool deallocate)
+{
+	int index = -1;
+	result r = IndexOf(obj, index);
+	if(IsFailed(r)) {
+		return r;
+	}
+	return RemoveAt(index, deallocate);
+}
+
+result
+ArrayList::RemoveAt(int index, bool deallocate)
+{
+	if(index < 0 || index >= GetCount()) {
+		return E_OUT_OF_RANGE;
+	}
+	if(deallocate) {
+		delete __items[index];
+	}
+	__items.erase(__items.begin() + index);
+	return E_SUCCESS;
+}
+
+void
+ArrayList::RemoveAll(bool deallocate)
+{
+	if(deallocate) {
+		for(size_t i = 0; i < __items.size(); i++) {
+			delete __items[i];
+		}
+	}
+	__items.clear();
+}
+
+result
+ArrayList::SetAt(const Object& obj, int index, bool deallocate)
+{
+	if(index < 0 || index >= GetCount()) {
+		return E_OUT_OF_RANGE;
+	}
+	if(deallocate) {
+		delete __items[index];
+	}
+	__items[index] = const_cast<Object*>(&obj);
+	return E_SUCCESS;
+}
+
+int
+ArrayList::GetCount(void) const
+{
+	return (int)__items.size();
+}
+
+bool
+ArrayList::Contains(const Object& obj) const
+{
+	int index = -1;
+	return IndexOf(obj, index) == E_SUCCESS;
+}
+
+}
+
+namespace Utility {
+
+// StringUtil
+
+result
+StringUtil::Utf8ToString(const char* pUtf8String, String& unicodeString)
+{
+	if(pUtf8String == null) {
+		return E_INVALID_ARG;
+	}
+	std::wstring value;
+	if(!DecodeUtf8(pUtf8String, strlen(pUtf8String), value, true)) {
+		return E_INVALID_ARG;
+	}
+	unicodeString = value.c_str();
+	return E_SUCCESS;
+}
+
+ByteBuffer*
+StringUtil::StringToUtf8N(const String& unicodeString)
+{
+	std::string utf8;
+	EncodeUtf8(unicodeString.GetPointer(), unicodeString.GetLength(), utf8);
+
+	ByteBuffer* pBuffer = new ByteBuffer();
+	pBuffer->Construct((int)utf8.size() + 1);
+	pBuffer->SetArray((const byte*)utf8.c_str(), 0, (int)utf8.size() + 1);
+	pBuffer->Flip();
+	return pBuffer;
+}
+
+}
+
+}
+
+namespace Io {
+
+// FileAttributes
+
+FileAttributes::FileAttributes(void):
+	__fileSize(0),
+	__directory(false),
+	__hidden(false),
+	__modified(0)
+{
+}
+
+FileAttributes::FileAttributes(long long fileSize, bool directory, bool hidden, long long modified):
+	__fileSize(fileSize),
+	__directory(directory),
+	__hidden(hidden),
+	__modified(modified)
+{
+}
+
+long long
+FileAttributes::GetFileSize(void) const
+{
+	return __fileSize;
+}
+
+DateTime
+FileAttributes::GetLastModifiedTime(void) const
+{
+	return DateTime(__modified);
+}
+
+bool
+FileAttributes::IsDirectory(void) const
+{
+	return __directory;
+}
+
+bool
+FileAttributes::IsHidden(void) const
+{
+	return __hidden;
+}
+
+bool
+FileAttributes::IsReadOnly(void) const
+{
+	return false;
+}
+
+bool
+FileAttributes::IsNomalFile(void) const
+{
+	return !__directory;
+}
+
+// File
+
+File::File(void):
+	__pFile(null)
+{
+}
+
+File::~File(void)
+{
+	if(__pFile != null) {
+		fclose(__pFile);
+	}
+}
+
+result
+File::Construct(const String& filePath, const String& openMode, bool createParentDirectories)
+{
+	std::string path = HostFileSystem::Resolve(filePath.GetPointer());
+	std::string mode;
+	EncodeUtf8(openMode.GetPointer(), openMode.GetLength(), mode);
+	if(mode != "r" && mode != "r+" && mode != "w" && mode != "w+" && mode != "a" && mode != "a+") {
+		return E_INVALID_ARG;
+	}
+	if(createParentDirectories) {
+		size_t slash = path.rfind('/');
+		if(slash != std::string::npos && slash > 0) {
+			MakeDirectories(path.substr(0, slash));
+		}
+	}
+	mode.push_back('b');
+	__pFile = fopen(path.c_str(), mode.c_str());
+	if(__pFile == null) {
+		return ErrnoToResult(errno);
+	}
+	return E_SUCCESS;
+}
+
+result
+File::Read(ByteBuffer& buffer)
+{
+	int remaining = buffer.GetRemaining();
+	if(remaining <= 0) {
+		return E_INVALID_ARG;
+	}
+	byte* p = const_cast<byte*>(buffer.GetPointer()) + buffer.GetPosition();
+	size_t read = fread(p, 1, remaining, __pFile);
+	if(read == 0) {
+		return ferror(__pFile) ? E_IO : E_END_OF_FILE;
+	}
+	buffer.SetPosition(buffer.GetPosition() + (int)read);
+	return E_SUCCESS;
+}
+
+int
+File::Read(void* buffer, int length)
+{
+	size_t read = fread(buffer, 1, length, __pFile);
+	SetLastResult(read == 0 && length > 0 ? (ferror(__pFile) ? E_IO : E_END_OF_FILE) : E_SUCCESS);
+	return (int)read;
+}
+
+result
+File::Read(String& buffer)
+{
+	std::string line;
+	int c;
+	while((c = fgetc(__pFile)) != EOF) {
+		line.push_back((char)c);
+		if(c == '\n') {
+			break;
+		}
+	}
+	if(line.empty()) {
+		buffer.Clear();
+		return E_END_OF_FILE;
+	}
+	std::wstring value;
+	DecodeUtf8(line.c_str(), line.size(), value, false);
+	buffer = value.c_str();
+	return E_SUCCESS;
+}
+
+result
+File::Write(const ByteBuffer& buffer)
+{
+	return Write(buffer.GetPointer() + buffer.GetPosition(), buffer.GetRemaining());
+}
+
+result
+File::Write(const void* buffer, int length)
+{
+	if(length > 0 && fwrite(buffer, 1, length, __pFile) != (size_t)length) {
+		return ErrnoToResult(errno);
+	}
+	return E_SUCCESS;
+}
+
+result
+File::Write(const String& buffer)
+{
+	std::string utf8;
+	EncodeUtf8(buffer.GetPointer(), buffer.GetLength(), utf8);
+	return Write(utf8.c_str(), (int)utf8.size());
+}
+
+result
+File::Flush(void)
+{
+	return fflush(__pFile) == 0 ? E_SUCCESS : E_IO;
+}
+
+int
+File::Tell(void) const
+{
+	return (int)ftell(__pFile);
+}
+
+result
+File::Seek(FileSeekPosition position, long offset)
+{
+	int whence = position == FILESEEKPOSITION_BEGIN ? SEEK_SET : (position == FILESEEKPOSITION_CURRENT ? SEEK_CUR : SEEK_END);
+	return fseek(__pFile, offset, whence) == 0 ? E_SUCCESS : E_INVALID_ARG;
+}
+
+result
+File::Truncate(int length)
+{
+	fflush(__pFile);
+	return ftruncate(fileno(__pFile), length) == 0 ? E_SUCCESS : ErrnoToResult(errno);
+}
+
+result
+File::Remove(const String& filePath)
+{
+	std::string path = HostFileSystem::Resolve(filePath.GetPointer());
+	return unlink(path.c_str()) == 0 ? E_SUCCESS : ErrnoToResult(errno);
+}
+
+result
+File::Move(const String& oldFilePath, const String& newFilePath)
+{
+	std::string oldPath = HostFileSystem::Resolve(oldFilePath.GetPointer());
+	std::string newPath = HostFileSystem::Resolve(newFilePath.GetPointer());
+	// rename() would replace it, the device refuses
+	if(access(newPath.c_str(), F_OK) == 0) {
+		return E_FILE_ALREADY_EXIST;
+	}
+	return rename(oldPath.c_str(), newPath.c_str()) == 0 ? E_SUCCESS : ErrnoToResult(errno);
+}
+
+result
+File::Copy(const String& srcFilePath, const String& destFilePath, bool failIfExist)
+{
+	if(failIfExist && IsFileExist(destFilePath)) {
+		return E_FILE_ALREADY_EXIST;
+	}
+	File source;
+	result r = source.Construct(srcFilePath, L"r");
+	if(IsFailed(r)) {
+		return r;
+	}
+	File dest;
+	r = dest.Construct(destFilePath, L"w");
+	if(IsFailed(r)) {
+		return r;
+	}
+	char buffer[4096];
+	int read;
+	while((read = source.Read(buffer, sizeof(buffer))) > 0) {
+		r = dest.Write(buffer, read);
+		if(IsFailed(r)) {
+			return r;
+		}
+	}
+	return E_SUCCESS;
+}
+
+result
+File::GetAttributes(const String& filePath, FileAttributes& attribute)
+{
+	std::string path = HostFileSystem::Resolve(filePath.GetPointer());
+	struct stat info;
+	if(stat(path.c_str(), &info) != 0) {
+		return ErrnoToResult(errno);
+	}
+	size_t slash = path.rfind('/');
+	bool hidden = path.size() > slash + 1 && path[slash + 1] == '.';
+	attribute = FileAttributes(info.st_size, S_ISDIR(info.st_mode), hidden, GetModified(info));
+	return E_SUCCESS;
+}
+
+bool
+File::IsFileExist(const String& filePath)
+{
+	std::string path = HostFileSystem::Resolve(filePath.GetPointer());
+	struct stat info;
+	return stat(path.c_str(), &info) == 0;
+}
+
+// DirEntry, DirEnumerator
+
+DirEntry::DirEntry(void)
+{
+}
+
+DirEntry::DirEntry(const String& name, const FileAttributes& attributes):
+	__name(name),
+	__attributes(attributes)
+{
+}
+
+const String
+DirEntry::GetName(void) const
+{
+	return __name;
+}
+
+unsigned long
+DirEntry::GetFileSize(void) const
+{
+	return (unsigned long)__attributes.GetFileSize();
+}
+
+DateTime
+DirEntry::GetDateTime(void) const
+{
+	return __attributes.GetLastModifiedTime();
+}
+
+bool
+DirEntry::IsDirectory(void) const
+{
+	return __attributes.IsDirectory();
+}
+
+bool
+DirEntry::IsHidden(void) const
+{
+	return __attributes.IsHidden();
+}
+
+bool
+DirEntry::IsReadOnly(void) const
+{
+	return __attributes.IsReadOnly();
+}
+
+bool
+DirEntry::IsNomalFile(void) const
+{
+	return __attributes.IsNomalFile();
+}
+
+DirEnumerator::DirEnumerator(void):
+	__current(-1)
+{
+}
+
+DirEnumerator::~DirEnumerator(void)
+{
+}
+
+DirEntry&
+DirEnumerator::GetCurrentDirEntry(void) const
+{
+	return __entries[__current];
+}
+
+Object*
+DirEnumerator::GetCurrent(void) const
+{
+	if(__current < 0 || __current >= (int)__entries.size()) {
+		SetLastResult(E_INVALID_STATE);
+		return null;
+	}
+	return &__entries[__current];
+}
+
+result
+DirEnumerator::MoveNext(void)
+{
+	if(__current + 1 >= (int)__entries.size()) {
+		return E_OUT_OF_RANGE;
+	}
+	__current++;
+	return E_SUCCESS;
+}
+
+result
+DirEnumerator::Reset(void)
+{
+	__current = -1;
+	return E_SUCCESS;
+}
+
+// Directory
+
+Directory::Directory(void)
+{
+}
+
+Directory::~Directory(void)
+{
+}
+
+result
+Directory::Construct(const String& dirPath)
+{
+	__path = HostFileSystem::Resolve(dirPath.GetPointer());
+	struct stat info;
+	if(stat(__path.c_str(), &info) != 0) {
+		return ErrnoToResult(errno);
+	}
+	return S_ISDIR(info.st_mode) ? E_SUCCESS : E_FILE_NOT_FOUND;
+}
+
+DirEnumerator*
+Directory::ReadN(void)
+{
+	DIR* pDir = opendir(__path.c_str());
+	if(pDir == null) {
+		SetLastResult(ErrnoToResult(errno));
+		return null;
+	}
+
+	DirEnumerator* pEnum = new DirEnumerator();
+	struct dirent* pEntry;
+	while((pEntry = readdir(pDir)) != null) {
+		std::string path = __path + "/" + pEntry->d_name;
+		struct stat info;
+		if(stat(path.c_str(), &info) != 0) {
+			continue;
+		}
+		std::wstring name;
+		DecodeUtf8(pEntry->d_name, strlen(pEntry->d_name), name, false);
+		bool hidden = pEntry->d_name[0] == '.' && strcmp(pEntry->d_name, ".") != 0 && strcmp(pEntry->d_name, "..") != 0;
+		pEnum->__entries.push_back(DirEntry(String(name.c_str()), FileAttributes(info.st_size, S_ISDIR(info.st_mode), hidden, GetModified(info))));
+	}
+	closedir(pDir);
+	SetLastResult(E_SUCCESS);
+	return pEnum;
+}
+
+result
+Directory::Create(const String& dirPath, bool createParentDirectories)
+{
+	std::string path = HostFileSystem::Resolve(dirPath.GetPointer());
+	if(createParentDirectories) {
+		return MakeDirectories(path);
+	}
+	return mkdir(path.c_str(), 0755) == 0 ? E_SUCCESS : ErrnoToResult(errno);
+}
+
+static result
+RemoveTree(const std::string& path)
+{
+	DIR* pDir = opendir(path.c_str());
+	if(pDir == null) {
+		return ErrnoToResult(errno);
+	}
+	struct dirent* pEntry;
+	while((pEntry = readdir(pDir)) != null) {
+		if(strcmp(pEntry->d_name, ".") == 0 || strcmp(pEntry->d_name, "..") == 0) {
+			continue;
+		}
+		std::string child = path + "/" + pEntry->d_name;
+		struct stat info;
+		if(lstat(child.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+			RemoveTree(child);
+		} else {
+			unlink(child.c_str());
+		}
+	}
+	closedir(pDir);
+	return rmdir(path.c_str()) == 0 ? E_SUCCESS : ErrnoToResult(errno);
+}
+
+result
+Directory::Remove(const String& dirPath, bool recursive)
+{
+	std::string path = HostFileSystem::Resolve(dirPath.GetPointer());
+	if(recursive) {
+		return RemoveTree(path);
+	}
+	return rmdir(path.c_str()) == 0 ? E_SUCCESS : ErrnoToResult(errno);
+}
+
+result
+Directory::Rename(const String& orgDirPath, const String& newDirPath)
+{
+	std::string oldPath = HostFileSystem::Resolve(orgDirPath.GetPointer());
+	std::string newPath = HostFileSystem::Resolve(newDirPath.GetPointer());
+	return rename(oldPath.c_str(), newPath.c_str()) == 0 ? E_SUCCESS : ErrnoToResult(errno);
+}
+
+// DbStatement, DbEnumerator
+
+DbStatement::DbStatement(sqlite3_stmt* pStmt):
+	__pStmt(pStmt)
+{
+}
+
+DbStatement::~DbStatement(void)
+{
+	sqlite3_finalize(__pStmt);
+}
+
+// bada binds are zero based, sqlite's one based
+result
+DbStatement::BindInt(int columnIndex, int value)
+{
+	return sqlite3_bind_int(__pStmt, columnIndex + 1, value) == SQLITE_OK ? E_SUCCESS : E_INVALID_ARG;
+}
+
+result
+DbStatement::BindDouble(int columnIndex, double value)
+{
+	return sqlite3_bind_double(__pStmt, columnIndex + 1, value) == SQLITE_OK ? E_SUCCESS : E_INVALID_ARG;
+}
+
+result
+DbStatement::BindString(int columnIndex, const String& value)
+{
+	std::string utf8;
+	EncodeUtf8(value.GetPointer(), value.GetLength(), utf8);
+	return sqlite3_bind_text(__pStmt, columnIndex + 1, utf8.c_str(), (int)utf8.size(), SQLITE_TRANSIENT) == SQLITE_OK
+			? E_SUCCESS : E_INVALID_ARG;
+}
+
+result
+DbStatement::BindBlob(int columnIndex, const void* buffer, int size)
+{
+	return sqlite3_bind_blob(__pStmt, columnIndex + 1, buffer, size, SQLITE_TRANSIENT) == SQLITE_OK ? E_SUCCESS : E_INVALID_ARG;
+}
+
+result
+DbStatement::BindNull(int columnIndex)
+{
+	return sqlite3_bind_null(__pStmt, columnIndex + 1) == SQLITE_OK ? E_SUCCESS : E_INVALID_ARG;
+}
+
+DbEnumerator::DbEnumerator(sqlite3_stmt* pStmt, bool owner):
+	__pStmt(pStmt),
+	__owner(owner)
+{
+}
+
+DbEnumerator::~DbEnumerator(void)
+{
+	// a borrowed statement is reset by the next ExecuteStatementN
+	if(__owner) {
+		sqlite3_finalize(__pStmt);
+	}
+}
+
+result
+DbEnumerator::MoveNext(void)
+{
+	int rc = sqlite3_step(__pStmt);
+	if(rc == SQLITE_ROW) {
+		return E_SUCCESS;
+	}
+	return rc == SQLITE_DONE ? E_OUT_OF_RANGE : E_DATABASE;
+}
+
+result
+DbEnumerator::Reset(void)
+{
+	return sqlite3_reset(__pStmt) == SQLITE_OK ? E_SUCCESS : E_DATABASE;
+}
+
+result
+DbEnumerator::GetIntAt(int columnIndex, int& value) const
+{
+	if(columnIndex < 0 || columnIndex >= GetColumnCount()) {
+		return E_INVALID_ARG;
+	}
+	value = sqlite3_column_int(__pStmt, columnIndex);
+	return E_SUCCESS;
+}
+
+result
+DbEnumerator::GetDoubleAt(int columnIndex, double& value) const
+{
+	if(columnIndex < 0 || columnIndex >= GetColumnCount()) {
+		return E_INVALID_ARG;
+	}
+	value = sqlite3_column_double(__pStmt, columnIndex);
+	return E_SUCCESS;
+}
+
+result
+DbEnumerator::GetStringAt(int columnIndex, String& value) const
+{
+	if(columnIndex < 0 || columnIndex >= GetColumnCount()) {
+		return E_INVALID_ARG;
+	}
+	const char* pText = (const char*)sqlite3_column_text(__pStmt, columnIndex);
+	std::wstring text;
+	if(pText != null) {
+		DecodeUtf8(pText, sqlite3_column_bytes(__pStmt, columnIndex), text, false);
+	}
+	value = text.c_str();
+	return E_SUCCESS;
+}
+
+result
+DbEnumerator::GetBlobAt(int columnIndex, ByteBuffer& value) const
+{
+	if(columnIndex < 0 || columnIndex >= GetColumnCount()) {
+		return E_INVALID_ARG;
+	}
+	const void* pBlob = sqlite3_column_blob(__pStmt, columnIndex);
+	int size = sqlite3_column_bytes(__pStmt, columnIndex);
+	if(size > value.GetRemaining()) {
+		return E_OVERFLOW;
+	}
+	return size > 0 ? value.SetArray((const byte*)pBlob, 0, size) : E_SUCCESS;
+}
+
+int
+DbEnumerator::GetColumnCount(void) const
+{
+	return sqlite3_column_count(__pStmt);
+}
+
+// Database
+
+Database::Database(void):
+	__pDb(null)
+{
+}
+
+Database::~Database(void)
+{
+	// statements the caller still holds are finalized when they go, v2 defers the close
+	sqlite3_close_v2(__pDb);
+}
+
+result
+Database::Construct(const String& databasePath, bool createIfNotExist)
+{
+	std::string path = HostFileSystem::Resolve(databasePath.GetPointer());
+	int flags = SQLITE_OPEN_READWRITE | (createIfNotExist ? SQLITE_OPEN_CREATE : 0);
+	if(sqlite3_open_v2(path.c_str(), &__pDb, flags, null) != SQLITE_OK) {
+		sqlite3_close_v2(__pDb);
+		__pDb = null;
+		return createIfNotExist ? E_IO : E_FILE_NOT_FOUND;
+	}
+	return E_SUCCESS;
+}
+
+DbStatement*
+Database::CreateStatementN(const String& statement)
+{
+	if(__pDb == null) {
+		SetLastResult(E_INVALID_STATE);
+		return null;
+	}
+	std::string sql;
+	EncodeUtf8(statement.GetPointer(), statement.GetLength(), sql);
+	sqlite3_stmt* pStmt = null;
+	if(sqlite3_prepare_v2(__pDb, sql.c_str(), (int)sql.size(), &pStmt, null) != SQLITE_OK) {
+		SetLastResult(E_INVALID_ARG);
+		return null;
+	}
+	SetLastResult(E_SUCCESS);
+	return new DbStatement(pStmt);
+}
+
+DbEnumerator*
+Database::ExecuteStatementN(const DbStatement& statement)
+{
+	sqlite3_stmt* pStmt = statement.__pStmt;
+	sqlite3_reset(pStmt);
+	int rc = sqlite3_step(pStmt);
+	if(rc == SQLITE_ROW) {
+		// the enumerator starts before the first row, as on the device
+		sqlite3_reset(pStmt);
+		SetLastResult(E_SUCCESS);
+		return new DbEnumerator(pStmt, false);
+	}
+	sqlite3_reset(pStmt);
+	SetLastResult(rc == SQLITE_DONE ? E_SUCCESS : E_DATABASE);
+	return null;
+}
+
+result
+Database::ExecuteSql(const String& sql, bool autoCommit)
+{
+	if(__pDb == null) {
+		return E_INVALID_STATE;
+	}
+	std::string utf8;
+	EncodeUtf8(sql.GetPointer(), sql.GetLength(), utf8);
+	return sqlite3_exec(__pDb, utf8.c_str(), null, null, null) == SQLITE_OK ? E_SUCCESS : E_DATABASE;
+}
+
+DbEnumerator*
+Database::QueryN(const String& query)
+{
+	DbStatement* pStatement = CreateStatementN(query);
+	if(pStatement == null) {
+		return null;
+	}
+	sqlite3_stmt* pStmt = pStatement->__pStmt;
+	pStatement->__pStmt = null;
+	delete pStatement;
+
+	if(sqlite3_step(pStmt) != SQLITE_ROW) {
+		sqlite3_finalize(pStmt);
+		return null;
+	}
+	sqlite3_reset(pStmt);
+	return new DbEnumerator(pStmt, true);
+}
+
+result
+Database::BeginTransaction(void)
+{
+	return ExecuteSql(L"BEGIN", false);
+}
+
+result
+Database::CommitTransaction(void)
+{
+	return ExecuteSql(L"COMMIT", false);
+}
+
+result
+Database::RollbackTransaction(void)
+{
+	return ExecuteSql(L"ROLLBACK", false);
+}
+
+result
+Database::Delete(const String& databasePath)
+{
+	return File::Remove(databasePath);
+}
+
+bool
+Database::Exists(const String& databasePath)
+{
+	return File::IsFileExist(databasePath);
+}
+
+}
+
+}
@@ -0,0 +1,816 @@
+#ifndef HOSTOSP_H_
+#define HOSTOSP_H_
+
+/**
+ * Desktop implementation of the Osp surface the core uses, pulled in by
+ * Port.h for TEXTART_HOST builds. Names, signatures and result codes follow
+ * the SDK headers in BADA/; strings hold UTF-16 code units like mchar on the
+ * device. Device paths (/Home, /Res) are mapped to host directories with
+ * HostFileSystem::Mount, Database runs on sqlite3 as it does on the device.
+ * Http speaks HTTP/1.1 over plain sockets and delivers its events from
+ * HostNetwork::RunPending(), the crypto classes run on OpenSSL and the
+ * worker threads on pthreads. Timers expire from HostTimer on a clock of
+ * their own; the device identity (application, platform, MAC address) is
+ * fixed.
+ */
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+typedef unsigned char byte;
+typedef wchar_t mchar;
+typedef unsigned long result;
+
+#ifndef null
+#define null 0
+#endif
+
+#define E_SUCCESS				((result)0x00000000)
+#define E_FAILURE				((result)0x80000001)
+#define E_OUT_OF_MEMORY			((result)0x80000002)
+#define E_INVALID_ARG			((result)0x80000003)
+#define E_INVALID_STATE			((result)0x80000004)
+#define E_OUT_OF_RANGE			((result)0x80000005)
+#define E_OBJ_NOT_FOUND			((result)0x80000006)
+#define E_OBJ_ALREADY_EXIST		((result)0x80000007)
+#define E_UNDERFLOW				((result)0x80000008)
+#define E_OVERFLOW				((result)0x80000009)
+#define E_INVALID_FORMAT		((result)0x8000000A)
+#define E_END_OF_FILE			((result)0x8000000B)
+#define E_FILE_NOT_FOUND		((result)0x8000000C)
+#define E_FILE_ALREADY_EXIST	((result)0x8000000D)
+#define E_ILLEGAL_ACCESS		((result)0x8000000E)
+#define E_IO					((result)0x8000000F)
+#define E_STORAGE_FULL			((result)0x80000010)
+#define E_DATABASE				((result)0x80000011)
+#define E_SYSTEM				((result)0x80000012)
+#define E_IN_PROGRESS			((result)0x80000013)
+#define E_INVALID_DATA			((result)0x80000014)
+#define E_CONNECTION_FAILED		((result)0x80000015)
+#define E_NETWORK_FAILED		((result)0x80000016)
+#define E_NUM_FORMAT			((result)0x80000017)
+
+#define IsFailed(r) (((r) & 0x80000000) != 0)
+
+const char* GetErrorMessage(result r);
+result GetLastResult(void);
+void SetLastResult(result r);
+
+// Printed to stderr only when TEXTART_LOG is set, benchmarks stay quiet
+void HostLog(const char* pFormat, ...);
+
+#define AppLog(...) HostLog(__VA_ARGS__)
+#define AppLogException(...) HostLog(__VA_ARGS__)
+#define AppAssert(condition) ((void) 0)
+#define TryCatch(condition, cleanup, ...) \
+	if(!(condition)) { AppLogException(__VA_ARGS__); cleanup; goto CATCH; } else {;}
+
+/**
+ * Maps device path prefixes to host directories, the longest prefix wins.
+ * Unmapped paths are used as they are.
+ */
+class HostFileSystem {
+public:
+	static void Mount(const char* pDevicePrefix, const char* pHostPath);
+	static std::string Resolve(const mchar* pDevicePath);
+};
+
+/**
+ * Stands in for the device event loop of Http: submitted transactions are
+ * run and their listener called from here.
+ */
+class HostNetwork {
+public:
+	// Runs every transaction submitted so far, returns how many ran
+	static int RunPending(void);
+};
+
+namespace Osp { namespace Base { namespace Runtime { class Timer; } } }
+
+/**
+ * Stands in for the device event loop of Timer: the clock of the timers
+ * moves only here, so a backoff of minutes is checked without the wait.
+ */
+class HostTimer {
+public:
+	// Milliseconds to the first started timer, -1 when none is started
+	static long long GetNextTimeout(void);
+	// Moves the clock to the first started timer and expires it, false when none is started
+	static bool ExpireNext(void);
+
+private:
+	static Osp::Base::Runtime::Timer* GetFirst(void);
+};
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace Osp {
+namespace Base {
+
+class Object {
+public:
+	Object(void);
+	virtual ~Object(void);
+
+	virtual bool Equals(const Object& obj) const;
+	virtual int GetHashCode(void) const;
+};
+
+class String : public Object {
+public:
+	String(void);
+	String(int capacity);
+	String(const mchar ch);
+	String(const mchar* pValue);
+	String(const char* pValue);
+	String(const String& value);
+	virtual ~String(void);
+
+	mchar& operator [](int index) const;
+	String& operator =(const mchar* pRhs);
+	String& operator =(const String& rhs);
+	String& operator +=(const mchar* pRhs);
+	String& operator +=(const String& rhs);
+	friend String operator +(const String& lhs, const String& rhs);
+	bool operator ==(const String& rhs) const;
+	bool operator !=(const String& rhs) const;
+
+	bool IsEmpty(void) const;
+	result Append(mchar ch);
+	result Append(char ch);
+	result Append(int i);
+	result Append(short s);
+	result Append(long l);
+	result Append(long long ll);
+	result Append(float f);
+	result Append(double d);
+	result Append(const mchar* p);
+	result Append(const String& str);
+	void Clear(void);
+	static int Compare(const String& str0, const String& str1);
+	int CompareTo(const String& str) const;
+	result EnsureCapacity(int minLength);
+	virtual bool Equals(const Object& obj) const;
+	bool Equals(const String& str, bool caseSensitive) const;
+	virtual int GetHashCode(void) const;
+	result GetCharAt(int indexAt, mchar& ch) const;
+	result IndexOf(mchar ch, int startIndex, int& indexOf) const;
+	result IndexOf(const String& str, int startIndex, int& indexOf) const;
+	result Insert(mchar ch, int indexAt);
+	result Insert(const mchar* p, int indexAt);
+	result Insert(const String& str, int indexAt);
+	result LastIndexOf(mchar ch, int startIndex, int& indexOf) const;
+	result Remove(int startIndex, int length);
+	void Replace(mchar original, mchar replace);
+	result Replace(const String& original, const String& replace);
+	result SetCapacity(int newCapacity);
+	result SetCharAt(mchar ch, int indexAt);
+	result SetLength(int newLength);
+	result SubString(int startIndex, String& out) const;
+	result SubString(int startIndex, int length, String& out) const;
+	bool StartsWith(const String& str, int startIndex) const;
+	bool EndsWith(const String& str) const;
+	result ToLowerCase(String& out) const;
+	void ToLowerCase(void);
+	result ToUpperCase(String& out) const;
+	void ToUpperCase(void);
+	void Trim(void);
+	int GetCapacity(void) const;
+	int GetLength(void) const;
+	const mchar* GetPointer(void) const;
+
+private:
+	mutable std::wstring __value;
+};
+
+class ByteBuffer : public Object {
+public:
+	ByteBuffer(void);
+	virtual ~ByteBuffer(void);
+
+	result Construct(int capacity);
+	result Construct(const ByteBuffer& buffer);
+
+	result GetArray(byte* pArray, int index, int length);
+	result SetArray(const byte* pArray, int index, int length);
+	result GetByte(byte& value);
+	result GetByte(int index, byte& value) const;
+	result SetByte(byte value);
+	result SetByte(int index, byte value);
+	const byte* GetPointer(void) const;
+
+	void Clear(void);
+	void Flip(void);
+	void Rewind(void);
+	int GetCapacity(void) const;
+	int GetLimit(void) const;
+	result SetLimit(int limit);
+	int GetPosition(void) const;
+	result SetPosition(int position);
+	int GetRemaining(void) const;
+	bool HasRemaining(void) const;
+
+private:
+	std::vector<byte> __data;
+	int __position;
+	int __limit;
+};
+
+class TimeSpan : public Object {
+public:
+	TimeSpan(long long ticks);
+
+	// Milliseconds
+	long long GetTicks(void) const;
+
+private:
+	long long __ticks;
+};
+
+class DateTime : public Object {
+public:
+	DateTime(void);
+	// Host only, milliseconds since the epoch rather than since year 1
+	explicit DateTime(long long ticks);
+
+	TimeSpan GetTime(void) const;
+
+private:
+	long long __ticks;
+};
+
+class LongLong : public Object {
+public:
+	static result Parse(const String& s, long long& ret);
+};
+
+namespace Collection {
+
+class IList;
+
+class ArrayList : public Object {
+public:
+	ArrayList(void);
+	virtual ~ArrayList(void);
+
+	result Construct(int capacity = 10);
+	virtual result Add(const Object& obj);
+	virtual const Object* GetAt(int index) const;
+	virtual Object* GetAt(int index);
+	virtual result IndexOf(const Object& obj, int& index) const;
+	virtual result InsertAt(const Object& obj, int index);
+	virtual result Remove(const Object& obj, bool deallocate = false);
+	virtual result RemoveAt(int index, bool deallocate = false);
+	virtual void RemoveAll(bool deallocate = false);
+	virtual result SetAt(const Object& obj, int index, bool deallocate = false);
+	virtual int GetCount(void) const;
+	virtual bool Contains(const Object& obj) const;
+
+private:
+	ArrayList(const ArrayList& list);
+	ArrayList& operator =(const ArrayList& list);
+
+	std::vector<Object*> __items;
+};
+
+}
+
+namespace Utility {
+
+class StringUtil {
+public:
+	// Fails with E_INVALID_ARG on malformed UTF-8, as on the device
+	static result Utf8ToString(const char* pUtf8String, String& unicodeString);
+	// The buffer ends with the terminating zero, its limit includes it
+	static ByteBuffer* StringToUtf8N(const String& unicodeString);
+};
+
+}
+
+namespace Runtime {
+
+enum ThreadType {
+	THREAD_TYPE_WORKER,
+	THREAD_TYPE_EVENT_DRIVEN
+};
+
+enum ThreadPriority {
+	THREAD_PRIORITY_HIGH,
+	THREAD_PRIORITY_MID,
+	THREAD_PRIORITY_LOW
+};
+
+// Worker threads only, Run() is overridden; the priority is not applied on the host
+class Thread : public Object {
+public:
+	static const unsigned long DEFAULT_STACK_SIZE = 64 * 1024;
+
+	static result Sleep(long milliSeconds);
+
+	Thread(void);
+	virtual ~Thread(void);
+
+	result Construct(ThreadType threadType = THREAD_TYPE_WORKER, long stackSize = DEFAULT_STACK_SIZE, ThreadPriority priority = THREAD_PRIORITY_MID);
+	result Start(void);
+	result Join(void);
+
+	virtual Object* Run(void);
+
+private:
+	Thread(const Thread& thread);
+	Thread& operator =(const Thread& thread);
+
+	static void* Main(void* pThread);
+
+	void* __pHandle;
+	bool __started;
+};
+
+// Mutex and condition in one, as on the device
+class Monitor : public Object {
+public:
+	Monitor(void);
+	~Monitor(void);
+
+	result Construct(void);
+	result Enter(void);
+	result Exit(void);
+	result Wait(void);
+	result Notify(void);
+	result NotifyAll(void);
+
+private:
+	Monitor(const Monitor& monitor);
+	Monitor& operator =(const Monitor& monitor);
+
+	void* __pMutex;
+	void* __pCondition;
+};
+
+class Timer;
+
+class ITimerEventListener {
+public:
+	virtual ~ITimerEventListener(void) {}
+
+	virtual void OnTimerExpired(Timer& timer) = 0;
+};
+
+// One shot, expired by HostTimer on the thread that calls it
+class Timer : public Object {
+public:
+	Timer(void);
+	virtual ~Timer(void);
+
+	result Construct(const ITimerEventListener& listener);
+	result Start(int timeout);
+	result Cancel(void);
+
+private:
+	friend class ::HostTimer;
+	Timer(const Timer& timer);
+	Timer& operator =(const Timer& timer);
+
+	ITimerEventListener* __pListener;
+	// On the clock of HostTimer, -1 when not started
+	long long __deadline;
+};
+
+}
+
+}
+
+namespace Io {
+
+enum FileSeekPosition {
+	FILESEEKPOSITION_BEGIN,
+	FILESEEKPOSITION_CURRENT,
+	FILESEEKPOSITION_END
+};
+
+class FileAttributes : public Osp::Base::Object {
+public:
+	FileAttributes(void);
+	FileAttributes(long long fileSize, bool directory, bool hidden, long long modified = 0);
+
+	long long GetFileSize(void) const;
+	Osp::Base::DateTime GetLastModifiedTime(void) const;
+	bool IsDirectory(void) const;
+	bool IsHidden(void) const;
+	bool IsReadOnly(void) const;
+	bool IsNomalFile(void) const;
+
+private:
+	long long __fileSize;
+	bool __directory;
+	bool __hidden;
+	long long __modified;
+};
+
+class File : public Osp::Base::Object {
+public:
+	File(void);
+	virtual ~File(void);
+
+	result Construct(const Osp::Base::String& filePath, const Osp::Base::String& openMode, bool createParentDirectories = false);
+
+	result Read(Osp::Base::ByteBuffer& buffer);
+	int Read(void* buffer, int length);
+	result Read(Osp::Base::String& buffer);
+	result Write(const Osp::Base::ByteBuffer& buffer);
+	result Write(const void* buffer, int length);
+	result Write(const Osp::Base::String& buffer);
+	result Flush(void);
+	int Tell(void) const;
+	result Seek(FileSeekPosition position, long offset);
+	result Truncate(int length);
+
+	static result Remove(const Osp::Base::String& filePath);
+	static result Move(const Osp::Base::String& oldFilePath, const Osp::Base::String& newFilePath);
+	static result Copy(const Osp::Base::String& srcFilePath, const Osp::Base::String& destFilePath, bool failIfExist);
+	static result GetAttributes(const Osp::Base::String& filePath, FileAttributes& attribute);
+	static bool IsFileExist(const Osp::Base::String& filePath);
+
+private:
+	File(const File& file);
+	File& operator =(const File& file);
+
+	FILE* __pFile;
+};
+
+class DirEntry : public Osp::Base::Object {
+public:
+	DirEntry(void);
+	DirEntry(const Osp::Base::String& name, const FileAttributes& attributes);
+
+	const Osp::Base::String GetName(void) const;
+	unsigned long GetFileSize(void) const;
+	Osp::Base::DateTime GetDateTime(void) const;
+	bool IsDirectory(void) const;
+	bool IsHidden(void) const;
+	bool IsReadOnly(void) const;
+	bool IsNomalFile(void) const;
+
+private:
+	Osp::Base::String __name;
+	FileAttributes __attributes;
+};
+
+class DirEnumerator : public Osp::Base::Object {
+public:
+	DirEnumerator(void);
+	virtual ~DirEnumerator(void);
+
+	DirEntry& GetCurrentDirEntry(void) const;
+	Osp::Base::Object* GetCurrent(void) const;
+	result MoveNext(void);
+	result Reset(void);
+
+private:
+	friend class Directory;
+	mutable std::vector<DirEntry> __entries;
+	int __current;
+};
+
+class Directory : public Osp::Base::Object {
+public:
+	Directory(void);
+	virtual ~Directory(void);
+
+	result Construct(const Osp::Base::String& dirPath);
+	DirEnumerator* ReadN(void);
+
+	static result Create(const Osp::Base::String& dirPath, bool createParentDirectories = false);
+	static result Remove(const Osp::Base::String& dirPath, bool recursive = false);
+	static result Rename(const Osp::Base::String& orgDirPath, const Osp::Base::String& newDirPath);
+
+private:
+	std::string __path;
+};
+
+class DbStatement : public Osp::Base::Object {
+public:
+	virtual ~DbStatement(void);
+
+	result BindInt(int columnIndex, int value);
+	result BindDouble(int columnIndex, double value);
+	result BindString(int columnIndex, const Osp::Base::String& value);
+	result BindBlob(int columnIndex, const void* buffer, int size);
+	result BindNull(int columnIndex);
+
+private:
+	friend class Database;
+	DbStatement(sqlite3_stmt* pStmt);
+
+	sqlite3_stmt* __pStmt;
+};
+
+class DbEnumerator : public Osp::Base::Object {
+public:
+	virtual ~DbEnumerator(void);
+
+	result MoveNext(void);
+	result Reset(void);
+	result GetIntAt(int columnIndex, int& value) const;
+	result GetDoubleAt(int columnIndex, double& value) const;
+	result GetStringAt(int columnIndex, Osp::Base::String& value) const;
+	result GetBlobAt(int columnIndex, Osp::Base::ByteBuffer& value) const;
+	int GetColumnCount(void) const;
+
+private:
+	friend class Database;
+	DbEnumerator(sqlite3_stmt* pStmt, bool owner);
+
+	sqlite3_stmt* __pStmt;
+	bool __owner;
+};
+
+class Database : public Osp::Base::Object {
+public:
+	Database(void);
+	virtual ~Database(void);
+
+	result Construct(const Osp::Base::String& databasePath, bool createIfNotExist);
+	DbStatement* CreateStatementN(const Osp::Base::String& statement);
+	DbEnumerator* ExecuteStatementN(const DbStatement& statement);
+	result ExecuteSql(const Osp::Base::String& sql, bool autoCommit);
+	DbEnumerator* QueryN(const Osp::Base::String& query);
+	result BeginTransaction(void);
+	result CommitTransaction(void);
+	result RollbackTransaction(void);
+
+	static result Delete(const Osp::Base::String& databasePath);
+	static bool Exists(const Osp::Base::String& databasePath);
+
+private:
+	Database(const Database& database);
+	Database& operator =(const Database& database);
+
+	sqlite3* __pDb;
+};
+
+}
+
+namespace Net {
+namespace Http {
+
+enum NetHttpMethod {
+	NET_HTTP_METHOD_GET = 0x40,
+	NET_HTTP_METHOD_POST = 0x60
+};
+
+enum NetHttpSessionMode {
+	NET_HTTP_SESSION_MODE_NORMAL,
+	NET_HTTP_SESSION_MODE_PIPELINING
+};
+
+enum NetHttpCookieFlag {
+	NET_HTTP_COOKIE_FLAG_NONE,
+	NET_HTTP_COOKIE_FLAG_ALWAYS_AUTOMATIC,
+	NET_HTTP_COOKIE_FLAG_ALWAYS_MANUAL
+};
+
+enum NetHttpStatusCode {
+	NET_HTTP_STATUS_OK = 200,
+	NET_HTTP_STATUS_NOT_MODIFIED = 304,
+	NET_HTTP_STATUS_NOT_FOUND = 404
+};
+
+class HttpSession;
+class HttpTransaction;
+
+class HttpHeader : public Osp::Base::Object {
+public:
+	HttpHeader(void);
+	virtual ~HttpHeader(void);
+
+	result AddField(const Osp::Base::String& fieldName, const Osp::Base::String& fieldValue);
+	result RemoveField(const Osp::Base::String& fieldName);
+	void RemoveAll(void);
+
+private:
+	friend class HttpTransaction;
+	std::vector<std::pair<std::string, std::string> > __fields;
+};
+
+class HttpRequest : public Osp::Base::Object {
+public:
+	HttpRequest(void);
+	virtual ~HttpRequest(void);
+
+	result SetMethod(NetHttpMethod method);
+	result SetUri(const Osp::Base::String& uri);
+	result WriteBody(const Osp::Base::ByteBuffer& body);
+	HttpHeader* GetHeader(void) const;
+
+private:
+	friend class HttpTransaction;
+	NetHttpMethod __method;
+	std::string __uri;
+	std::string __body;
+	HttpHeader* __pHeader;
+};
+
+class HttpResponse : public Osp::Base::Object {
+public:
+	HttpResponse(void);
+	virtual ~HttpResponse(void);
+
+	NetHttpStatusCode GetStatusCode(void) const;
+	int GetHttpStatusCode(void) const;
+	HttpHeader* GetHeader(void) const;
+	// The part of the body that arrived since the last read
+	Osp::Base::ByteBuffer* ReadBodyN(void);
+
+private:
+	friend class HttpTransaction;
+	int __statusCode;
+	std::string __available;
+	HttpHeader* __pHeader;
+};
+
+class IHttpTransactionEventListener {
+public:
+	virtual ~IHttpTransactionEventListener(void) {}
+
+	virtual void OnTransactionReadyToRead(HttpSession& httpSession, HttpTransaction& httpTransaction, int availableBodyLen) = 0;
+	virtual void OnTransactionAborted(HttpSession& httpSession, HttpTransaction& httpTransaction, result r) = 0;
+	virtual void OnTransactionReadyToWrite(HttpSession& httpSession, HttpTransaction& httpTransaction, int recommendedChunkSize) = 0;
+	virtual void OnTransactionHeaderCompleted(HttpSession& httpSession, HttpTransaction& httpTransaction, int headerLen, bool bAuthRequired) = 0;
+	virtual void OnTransactionCompleted(HttpSession& httpSession, HttpTransaction& httpTransaction) = 0;
+	virtual void OnTransactionCertVerificationRequiredN(HttpSession& httpSession, HttpTransaction& httpTransaction, Osp::Base::String* pCert) = 0;
+};
+
+class HttpTransaction : public Osp::Base::Object {
+public:
+	virtual ~HttpTransaction(void);
+
+	result Submit(void);
+	HttpRequest* GetRequest(void) const;
+	HttpResponse* GetResponse(void) const;
+	result AddHttpTransactionListener(const IHttpTransactionEventListener& listener);
+	result SetUserObject(const Osp::Base::Object* pUserData);
+	Osp::Base::Object* GetUserObject(void) const;
+
+private:
+	friend class HttpSession;
+	friend class ::HostNetwork;
+	HttpTransaction(HttpSession& session);
+	HttpTransaction(const HttpTransaction& transaction);
+	HttpTransaction& operator =(const HttpTransaction& transaction);
+
+	// Runs the exchange, false once the transaction is gone
+	bool Run(void);
+
+	HttpSession* __pSession;
+	HttpRequest __request;
+	HttpResponse __response;
+	IHttpTransactionEventListener* __pListener;
+	Osp::Base::Object* __pUserObject;
+};
+
+class HttpSession : public Osp::Base::Object {
+public:
+	HttpSession(void);
+	virtual ~HttpSession(void);
+
+	result Construct(NetHttpSessionMode sessionMode, const Osp::Base::String* pProxyAddr, const Osp::Base::String& hostAddr,
+			const HttpHeader* pCommonHeader, NetHttpCookieFlag flag = NET_HTTP_COOKIE_FLAG_ALWAYS_MANUAL);
+	HttpTransaction* OpenTransactionN(void);
+	result CancelTransaction(HttpTransaction& httpTransaction);
+	result CloseTransaction(HttpTransaction& httpTransaction);
+	result CloseAllTransactions(void);
+
+private:
+	friend class HttpTransaction;
+	HttpSession(const HttpSession& session);
+	HttpSession& operator =(const HttpSession& session);
+
+	std::string __host;
+	std::vector<HttpTransaction*> __transactions;
+};
+
+}
+
+namespace Wifi {
+
+class IWifiManagerEventListener {
+public:
+	virtual ~IWifiManagerEventListener(void) {}
+
+	virtual void OnWifiActivated(result r) = 0;
+	virtual void OnWifiDeactivated(result r) = 0;
+	virtual void OnWifiConnected(const Osp::Base::String& ssid, result r) = 0;
+	virtual void OnWifiDisconnected(void) = 0;
+	virtual void OnWifiRssiChanged(long rssi) = 0;
+	virtual void OnWifiScanCompletedN(const Osp::Base::Collection::IList* pWifiBssInfoList, result r) = 0;
+};
+
+// The MAC address only, no events are sent
+class WifiManager : public Osp::Base::Object {
+public:
+	WifiManager(void);
+	virtual ~WifiManager(void);
+
+	result Construct(const IWifiManagerEventListener& listener);
+	Osp::Base::String GetMacAddress(void) const;
+};
+
+}
+
+}
+
+namespace Security {
+
+class IKey {
+public:
+	virtual ~IKey(void) {}
+
+	virtual Osp::Base::String GetFormat(void) const = 0;
+	virtual Osp::Base::ByteBuffer* GetEncodedN(void) const = 0;
+	virtual result SetKey(const Osp::Base::ByteBuffer& keyBuffer) = 0;
+};
+
+class PublicKey : public Osp::Base::Object, public IKey {
+public:
+	PublicKey(void);
+	virtual ~PublicKey(void);
+
+	virtual Osp::Base::String GetFormat(void) const;
+	virtual Osp::Base::ByteBuffer* GetEncodedN(void) const;
+	// DER, SubjectPublicKeyInfo or PKCS #1
+	virtual result SetKey(const Osp::Base::ByteBuffer& keyBuffer);
+
+private:
+	std::string __key;
+};
+
+namespace Crypto {
+
+class Sha1Hash : public Osp::Base::Object {
+public:
+	Sha1Hash(void);
+	virtual ~Sha1Hash(void);
+
+	Osp::Base::ByteBuffer* GetHashN(const Osp::Base::ByteBuffer& input);
+	result Initialize(void);
+	result Update(const Osp::Base::ByteBuffer& input);
+	Osp::Base::ByteBuffer* FinalizeN(void);
+
+private:
+	Sha1Hash(const Sha1Hash& hash);
+	Sha1Hash& operator =(const Sha1Hash& hash);
+
+	void* __pContext;
+};
+
+// PKCS #1 v1.5 signatures over SHA-1, as on the device
+class RsaSignature : public Osp::Base::Object {
+public:
+	RsaSignature(void);
+	virtual ~RsaSignature(void);
+
+	result SetPublicKey(const IKey& key);
+	bool Verify(const Osp::Base::ByteBuffer& data, const Osp::Base::ByteBuffer& signedData);
+
+private:
+	std::string __key;
+};
+
+}
+
+}
+
+namespace System {
+
+class SystemTime {
+public:
+	// Milliseconds of the host clock
+	static result GetTicks(long long& ticks);
+};
+
+class SystemInfo {
+public:
+	// PlatformVersion only, E_OBJ_NOT_FOUND for the other keys
+	static result GetValue(const Osp::Base::String& key, Osp::Base::String& value);
+};
+
+}
+
+namespace App {
+
+class Application : public Osp::Base::Object {
+public:
+	static Application* GetInstance(void);
+
+	virtual Osp::Base::String GetAppName(void) const;
+	Osp::Base::String GetAppVersion(void) const;
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,198 @@
+#include "HostOsp.h"
+
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+using namespace Osp::Base;
+
+static ByteBuffer*
+NewBuffer(const unsigned char* pData, int length)
+{
+	ByteBuffer* pBuffer = new ByteBuffer();
+	pBuffer->Construct(length);
+	if(length > 0) {
+		pBuffer->SetArray(pData, 0, length);
+	}
+	pBuffer->Flip();
+	return pBuffer;
+}
+
+// The remaining bytes of the buffer, [position, limit)
+static const unsigned char*
+GetRemainingBytes(const ByteBuffer& buffer)
+{
+	const byte* pData = buffer.GetPointer();
+	return pData == null ? null : pData + buffer.GetPosition();
+}
+
+namespace Osp {
+namespace Security {
+
+// PublicKey
+
+PublicKey::PublicKey(void)
+{
+}
+
+PublicKey::~PublicKey(void)
+{
+}
+
+String
+PublicKey::GetFormat(void) const
+{
+	return String(L"X509");
+}
+
+ByteBuffer*
+PublicKey::GetEncodedN(void) const
+{
+	if(__key.empty()) {
+		SetLastResult(E_INVALID_STATE);
+		return null;
+	}
+	SetLastResult(E_SUCCESS);
+	return NewBuffer(reinterpret_cast<const unsigned char*>(__key.data()), (int)__key.size());
+}
+
+result
+PublicKey::SetKey(const ByteBuffer& keyBuffer)
+{
+	const unsigned char* pData = GetRemainingBytes(keyBuffer);
+	if(pData == null || keyBuffer.GetRemaining() == 0) {
+		return E_INVALID_ARG;
+	}
+	__key.assign(reinterpret_cast<const char*>(pData), keyBuffer.GetRemaining());
+	return E_SUCCESS;
+}
+
+namespace Crypto {
+
+// Sha1Hash
+
+Sha1Hash::Sha1Hash(void):
+	__pContext(null)
+{
+}
+
+Sha1Hash::~Sha1Hash(void)
+{
+	EVP_MD_CTX_free(static_cast<EVP_MD_CTX*>(__pContext));
+}
+
+ByteBuffer*
+Sha1Hash::GetHashN(const ByteBuffer& input)
+{
+	unsigned char digest[EVP_MAX_MD_SIZE];
+	unsigned int length = 0;
+	const unsigned char* pData = GetRemainingBytes(input);
+	if(!EVP_Digest(pData != null ? pData : digest, input.GetRemaining(), digest, &length, EVP_sha1(), null)) {
+		SetLastResult(E_SYSTEM);
+		return null;
+	}
+	SetLastResult(E_SUCCESS);
+	return NewBuffer(digest, (int)length);
+}
+
+result
+Sha1Hash::Initialize(void)
+{
+	if(__pContext == null) {
+		__pContext = EVP_MD_CTX_new();
+		if(__pContext == null) {
+			return E_OUT_OF_MEMORY;
+		}
+	}
+	return EVP_DigestInit_ex(static_cast<EVP_MD_CTX*>(__pContext), EVP_sha1(), null) ? E_SUCCESS : E_SYSTEM;
+}
+
+result
+Sha1Hash::Update(const ByteBuffer& input)
+{
+	if(__pContext == null) {
+		return E_INVALID_STATE;
+	}
+	const unsigned char* pData = GetRemainingBytes(input);
+	if(pData == null || input.GetRemaining() == 0) {
+		return E_SUCCESS;
+	}
+	return EVP_DigestUpdate(static_cast<EVP_MD_CTX*>(__pContext), pData, input.GetRemaining()) ? E_SUCCESS : E_SYSTEM;
+}
+
+ByteBuffer*
+Sha1Hash::FinalizeN(void)
+{
+	if(__pContext == null) {
+		SetLastResult(E_INVALID_STATE);
+		return null;
+	}
+	unsigned char digest[EVP_MAX_MD_SIZE];
+	unsigned int length = 0;
+	if(!EVP_DigestFinal_ex(static_cast<EVP_MD_CTX*>(__pContext), digest, &length)) {
+		SetLastResult(E_SYSTEM);
+		return null;
+	}
+	SetLastResult(E_SUCCESS);
+	return NewBuffer(digest, (int)length);
+}
+
+// RsaSignature
+
+RsaSignature::RsaSignature(void)
+{
+}
+
+RsaSignature::~RsaSignature(void)
+{
+}
+
+result
+RsaSignature::SetPublicKey(const IKey& key)
+{
+	ByteBuffer* pEncoded = key.GetEncodedN();
+	if(pEncoded == null) {
+		return E_INVALID_ARG;
+	}
+	__key.assign(reinterpret_cast<const char*>(GetRemainingBytes(*pEncoded)), pEncoded->GetRemaining());
+	delete pEncoded;
+	return E_SUCCESS;
+}
+
+bool
+RsaSignature::Verify(const ByteBuffer& data, const ByteBuffer& signedData)
+{
+	if(__key.empty()) {
+		SetLastResult(E_INVALID_STATE);
+		return false;
+	}
+	const unsigned char* pKey = reinterpret_cast<const unsigned char*>(__key.data());
+	EVP_PKEY* pPublicKey = d2i_PUBKEY(null, &pKey, (long)__key.size());
+	if(pPublicKey == null) {
+		pKey = reinterpret_cast<const unsigned char*>(__key.data());
+		pPublicKey = d2i_PublicKey(EVP_PKEY_RSA, null, &pKey, (long)__key.size());
+	}
+	if(pPublicKey == null) {
+		SetLastResult(E_INVALID_ARG);
+		return false;
+	}
+
+	bool verified = false;
+	EVP_MD_CTX* pContext = EVP_MD_CTX_new();
+	const unsigned char* pData = GetRemainingBytes(data);
+	const unsigned char* pSigned = GetRemainingBytes(signedData);
+	if(pContext != null && pSigned != null && EVP_DigestVerifyInit(pContext, null, EVP_sha1(), null, pPublicKey) == 1) {
+		static const unsigned char empty = 0;
+		verified = EVP_DigestVerify(pContext, pSigned, signedData.GetRemaining(),
+				pData != null ? pData : &empty, data.GetRemaining()) == 1;
+	}
+	EVP_MD_CTX_free(pContext);
+	EVP_PKEY_free(pPublicKey);
+	SetLastResult(E_SUCCESS);
+	return verified;
+}
+
+}
+
+}
+
+}
@@ -0,0 +1,200 @@
+#include "HostOsp.h"
+
+#include <sys/time.h>
+
+#include <algorithm>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Runtime;
+
+// Started and not yet expired
+static std::vector<Timer*>&
+GetStarted(void)
+{
+	static std::vector<Timer*> started;
+	return started;
+}
+
+// The clock of the timers, moved by HostTimer::ExpireNext() only
+static long long __now = 0;
+
+static void
+Remove(Timer* pTimer)
+{
+	std::vector<Timer*>& started = GetStarted();
+	started.erase(std::remove(started.begin(), started.end(), pTimer), started.end());
+}
+
+// HostTimer
+
+Timer*
+HostTimer::GetFirst(void)
+{
+	Timer* pFirst = null;
+	std::vector<Timer*>& started = GetStarted();
+	for(size_t i = 0; i < started.size(); i++) {
+		if(pFirst == null || started[i]->__deadline < pFirst->__deadline) {
+			pFirst = started[i];
+		}
+	}
+	return pFirst;
+}
+
+long long
+HostTimer::GetNextTimeout(void)
+{
+	Timer* pFirst = GetFirst();
+	return pFirst != null ? pFirst->__deadline - __now : -1;
+}
+
+bool
+HostTimer::ExpireNext(void)
+{
+	Timer* pFirst = GetFirst();
+	if(pFirst == null) {
+		return false;
+	}
+	__now = pFirst->__deadline;
+	pFirst->__deadline = -1;
+	Remove(pFirst);
+	// the listener may start the timer again
+	pFirst->__pListener->OnTimerExpired(*pFirst);
+	return true;
+}
+
+namespace Osp {
+namespace Base {
+namespace Runtime {
+
+// Timer
+
+Timer::Timer(void):
+	__pListener(null),
+	__deadline(-1)
+{
+}
+
+Timer::~Timer(void)
+{
+	Remove(this);
+}
+
+result
+Timer::Construct(const ITimerEventListener& listener)
+{
+	if(__pListener != null) {
+		return E_INVALID_STATE;
+	}
+	__pListener = const_cast<ITimerEventListener*>(&listener);
+	return E_SUCCESS;
+}
+
+result
+Timer::Start(int timeout)
+{
+	if(__pListener == null || __deadline >= 0) {
+		return E_INVALID_STATE;
+	}
+	if(timeout <= 0) {
+		return E_INVALID_ARG;
+	}
+	__deadline = __now + timeout;
+	GetStarted().push_back(this);
+	return E_SUCCESS;
+}
+
+result
+Timer::Cancel(void)
+{
+	if(__deadline < 0) {
+		return E_INVALID_STATE;
+	}
+	__deadline = -1;
+	Remove(this);
+	return E_SUCCESS;
+}
+
+}
+
+}
+
+namespace Net {
+namespace Wifi {
+
+// WifiManager
+
+WifiManager::WifiManager(void)
+{
+}
+
+WifiManager::~WifiManager(void)
+{
+}
+
+result
+WifiManager::Construct(const IWifiManagerEventListener& listener)
+{
+	return E_SUCCESS;
+}
+
+String
+WifiManager::GetMacAddress(void) const
+{
+	return String(L"02-00-00-00-00-01");
+}
+
+}
+
+}
+
+namespace System {
+
+// SystemTime, SystemInfo
+
+result
+SystemTime::GetTicks(long long& ticks)
+{
+	struct timeval now;
+	gettimeofday(&now, null);
+	ticks = (long long)now.tv_sec * 1000 + now.tv_usec / 1000;
+	return E_SUCCESS;
+}
+
+result
+SystemInfo::GetValue(const String& key, String& value)
+{
+	if(key != L"PlatformVersion") {
+		return E_OBJ_NOT_FOUND;
+	}
+	value = L"2.0.0";
+	return E_SUCCESS;
+}
+
+}
+
+namespace App {
+
+// Application
+
+Application*
+Application::GetInstance(void)
+{
+	static Application application;
+	return &application;
+}
+
+String
+Application::GetAppName(void) const
+{
+	return String(L"TextArt");
+}
+
+String
+Application::GetAppVersion(void) const
+{
+	return String(L"1.2.0");
+}
+
+}
+
+}
@@ -0,0 +1,147 @@
+#include "HostOsp.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+namespace Osp {
+namespace Base {
+namespace Runtime {
+
+// Thread
+
+result
+Thread::Sleep(long milliSeconds)
+{
+	struct timespec delay;
+	delay.tv_sec = milliSeconds / 1000;
+	delay.tv_nsec = (milliSeconds % 1000) * 1000000L;
+	while(nanosleep(&delay, &delay) != 0 && errno == EINTR) {
+	}
+	return E_SUCCESS;
+}
+
+Thread::Thread(void):
+	__pHandle(null),
+	__started(false)
+{
+}
+
+Thread::~Thread(void)
+{
+	delete static_cast<pthread_t*>(__pHandle);
+}
+
+result
+Thread::Construct(ThreadType threadType, long stackSize, ThreadPriority priority)
+{
+	if(__pHandle != null) {
+		return E_INVALID_STATE;
+	}
+	if(threadType != THREAD_TYPE_WORKER) {
+		return E_INVALID_ARG;
+	}
+	__pHandle = new pthread_t();
+	return E_SUCCESS;
+}
+
+void*
+Thread::Main(void* pThread)
+{
+	static_cast<Thread*>(pThread)->Run();
+	return null;
+}
+
+result
+Thread::Start(void)
+{
+	if(__pHandle == null || __started) {
+		return E_INVALID_STATE;
+	}
+	if(pthread_create(static_cast<pthread_t*>(__pHandle), null, Main, this) != 0) {
+		return E_SYSTEM;
+	}
+	__started = true;
+	return E_SUCCESS;
+}
+
+result
+Thread::Join(void)
+{
+	if(!__started) {
+		return E_INVALID_STATE;
+	}
+	__started = false;
+	return pthread_join(*static_cast<pthread_t*>(__pHandle), null) == 0 ? E_SUCCESS : E_SYSTEM;
+}
+
+Object*
+Thread::Run(void)
+{
+	return null;
+}
+
+// Monitor
+
+Monitor::Monitor(void):
+	__pMutex(null),
+	__pCondition(null)
+{
+}
+
+Monitor::~Monitor(void)
+{
+	if(__pMutex != null) {
+		pthread_cond_destroy(static_cast<pthread_cond_t*>(__pCondition));
+		pthread_mutex_destroy(static_cast<pthread_mutex_t*>(__pMutex));
+	}
+	delete static_cast<pthread_cond_t*>(__pCondition);
+	delete static_cast<pthread_mutex_t*>(__pMutex);
+}
+
+result
+Monitor::Construct(void)
+{
+	if(__pMutex != null) {
+		return E_INVALID_STATE;
+	}
+	__pMutex = new pthread_mutex_t();
+	__pCondition = new pthread_cond_t();
+	pthread_mutex_init(static_cast<pthread_mutex_t*>(__pMutex), null);
+	pthread_cond_init(static_cast<pthread_cond_t*>(__pCondition), null);
+	return E_SUCCESS;
+}
+
+result
+Monitor::Enter(void)
+{
+	return pthread_mutex_lock(static_cast<pthread_mutex_t*>(__pMutex)) == 0 ? E_SUCCESS : E_SYSTEM;
+}
+
+result
+Monitor::Exit(void)
+{
+	return pthread_mutex_unlock(static_cast<pthread_mutex_t*>(__pMutex)) == 0 ? E_SUCCESS : E_SYSTEM;
+}
+
+result
+Monitor::Wait(void)
+{
+	return pthread_cond_wait(static_cast<pthread_cond_t*>(__pCondition), static_cast<pthread_mutex_t*>(__pMutex)) == 0 ? E_SUCCESS : E_SYSTEM;
+}
+
+result
+Monitor::Notify(void)
+{
+	return pthread_cond_signal(static_cast<pthread_cond_t*>(__pCondition)) == 0 ? E_SUCCESS : E_SYSTEM;
+}
+
+result
+Monitor::NotifyAll(void)
+{
+	return pthread_cond_broadcast(static_cast<pthread_cond_t*>(__pCondition)) == 0 ? E_SUCCESS : E_SYSTEM;
+}
+
+}
+}
+}
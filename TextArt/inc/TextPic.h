@@ -6,13 +6,16 @@
 #include <FSystem.h>
 #include <FUi.h>
 
+#include "TaskScheduler.h"
+
 /**
  * [TextPic] application must inherit from Application class
  * which provides basic features necessary to define an application.
  */
 class TextPic :
 	public Osp::App::Application,
-	public Osp::System::IScreenEventListener
+	public Osp::System::IScreenEventListener,
+	public ITaskCompletionPoster
 {
 public:
 		enum InternalAppLanguageEnum {
@@ -59,7 +62,22 @@ public:
 	// Called when the screen turns off.
 	void OnScreenOff (void);
 
+	// Called on a worker thread when tasks completed, hands them to the UI thread.
+	void PostTaskCompletion(void);
+
+	// Called with the events sent to the application itself.
+	void OnUserEventReceivedN(RequestId requestId, Osp::Base::Collection::IList* pArgs);
+
 	static result GetTranslated(Osp::Base::String& fullString);
+
+	// Switches catalog column and UI strings, the forms are refreshed by FormManager
+	static void SetLanguage(InternalAppLanguageEnum language);
+
+private:
+	static const RequestId REQUEST_TASKSCOMPLETED = 600;
+
+	// Posted to FormManager so the directory listing runs outside the lifecycle callback
+	void SendCatalogRequest(RequestId requestId);
 };
 
 #endif
@@ -1,6 +1,10 @@
 #include <FBase.h>
 #include <FUi.h>
 
+#include "Debug.h"
+#include "FrameMonitor.h"
+#include "ItemStore.h"
+
 using namespace Osp::Base;
 using namespace Osp::Graphics;
 using namespace Osp::Ui::Controls;
@@ -11,18 +15,36 @@ private:
 	String pic;
 	int fontsize;
 	Font* __pFont;
+	bool __ownFont;
+	const ItemStore* __pStore;
+	int __index;
 public:
 	AnciiListElement(String& picture, int fs) {
 		pic = picture;
 		fontsize = fs;
 		__pFont = new Font();
 		__pFont->Construct(FONT_STYLE_PLAIN, fontsize);
+		__ownFont = true;
+		__pStore = null;
+		__index = 0;
+	}
+	// text is read from the store when drawn, store and font must outlive the element
+	AnciiListElement(const ItemStore& store, int index, Font& font) {
+		__pStore = &store;
+		__index = index;
+		fontsize = font.GetSize();
+		__pFont = &font;
+		__ownFont = false;
 	}
 	~AnciiListElement() {
-		delete __pFont;
+		if(__ownFont) {
+			delete __pFont;
+		}
 	}
 
 	result DrawElement(const Osp::Graphics::Canvas& canvas, const Osp::Graphics::Rectangle& rect, CustomListItemStatus itemStatus) {
+		PROFILE_SCOPE("AnciiListElement::DrawElement");
+		FRAME_ELEMENT(FrameMonitor::ELEMENT_ART, __pStore, __index);
 		result r = E_SUCCESS;
 		Canvas* pCanvas = const_cast<Canvas*> (&canvas);
 
@@ -31,7 +53,13 @@ public:
 		titleText.SetTextWrapStyle(TEXT_WRAP_WORD_WRAP);
 
 		TextElement titleTextElement;
-		titleTextElement.Construct(pic);
+		if(__pStore != null) {
+			String art;
+			__pStore->GetArt(__index, art);
+			titleTextElement.Construct(art);
+		} else {
+			titleTextElement.Construct(pic);
+		}
 
 		if (itemStatus == CUSTOM_LIST_ITEM_STATUS_SELECTED) {
 			titleTextElement.SetTextColor(Osp::Ui::Controls::SYSTEM_COLOR_LIST_ITEM_PRESSED_TEXT);
@@ -0,0 +1,131 @@
+#include "Arena.h"
+
+#include <string.h>
+
+// Block header rounded up so the first allocation stays aligned
+static const int HEADER_SIZE = (sizeof(void*) + 2 * sizeof(int) + Arena::ALIGNMENT - 1) & ~(Arena::ALIGNMENT - 1);
+
+Arena::Arena():
+	__pFirst(null),
+	__pCurrent(null),
+	__pFinalizers(null),
+	__blockSize(DEFAULT_BLOCK_SIZE)
+{
+	memset(&__stats, 0, sizeof(__stats));
+}
+
+Arena::~Arena()
+{
+	Reset();
+	if(__pFirst != null) {
+		delete[] reinterpret_cast<byte*>(__pFirst);
+	}
+}
+
+result
+Arena::Construct(int blockSize)
+{
+	if(blockSize <= 0) {
+		return E_INVALID_ARG;
+	}
+	__blockSize = blockSize;
+	return E_SUCCESS;
+}
+
+Arena::Block*
+Arena::AddBlock(int size)
+{
+	byte* pMemory = new byte[HEADER_SIZE + size];
+	if(pMemory == null) {
+		return null;
+	}
+	Block* pBlock = reinterpret_cast<Block*>(pMemory);
+	pBlock->pNext = null;
+	pBlock->size = size;
+	pBlock->used = 0;
+
+	__stats.blocks++;
+	__stats.bytesReserved += size;
+	return pBlock;
+}
+
+void*
+Arena::Allocate(int size)
+{
+	size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+	if(__pCurrent == null || __pCurrent->used + size > __pCurrent->size) {
+		Block* pNext = (__pCurrent != null) ? __pCurrent->pNext : __pFirst;
+		// the first block survives Reset() and is reused when big enough
+		if(pNext == null || pNext->size < size) {
+			Block* pBlock = AddBlock(size > __blockSize ? size : __blockSize);
+			if(pBlock == null) {
+				SetLastResult(E_OUT_OF_MEMORY);
+				return null;
+			}
+			if(__pCurrent == null) {
+				if(__pFirst != null) {
+					delete[] reinterpret_cast<byte*>(__pFirst);
+				}
+				__pFirst = pBlock;
+			} else {
+				pBlock->pNext = __pCurrent->pNext;
+				__pCurrent->pNext = pBlock;
+			}
+			pNext = pBlock;
+		}
+		__pCurrent = pNext;
+	}
+
+	void* pObject = reinterpret_cast<byte*>(__pCurrent) + HEADER_SIZE + __pCurrent->used;
+	__pCurrent->used += size;
+	__stats.allocations++;
+	__stats.bytesUsed += size;
+	return pObject;
+}
+
+void
+Arena::AddFinalizer(void* pObject, void (*pDestroy)(void*))
+{
+	Finalizer* pFinalizer = static_cast<Finalizer*>(Allocate(sizeof(Finalizer)));
+	if(pFinalizer == null) {
+		// better to leak the object's resources than to lose track of the arena
+		return;
+	}
+	pFinalizer->pDestroy = pDestroy;
+	pFinalizer->pObject = pObject;
+	pFinalizer->pNext = __pFinalizers;
+	__pFinalizers = pFinalizer;
+	__stats.finalizers++;
+	// finalizer records are bookkeeping, not objects served
+	__stats.allocations--;
+}
+
+void
+Arena::Reset(void)
+{
+	while(__pFinalizers != null) {
+		Finalizer* pFinalizer = __pFinalizers;
+		__pFinalizers = pFinalizer->pNext;
+		pFinalizer->pDestroy(pFinalizer->pObject);
+	}
+
+	// keep the first block, drop the rest
+	if(__pFirst != null) {
+		Block* pBlock = __pFirst->pNext;
+		while(pBlock != null) {
+			Block* pNext = pBlock->pNext;
+			delete[] reinterpret_cast<byte*>(pBlock);
+			pBlock = pNext;
+		}
+		__pFirst->pNext = null;
+		__pFirst->used = 0;
+	}
+	__pCurrent = __pFirst;
+
+	memset(&__stats, 0, sizeof(__stats));
+	if(__pFirst != null) {
+		__stats.blocks = 1;
+		__stats.bytesReserved = __pFirst->size;
+	}
+}
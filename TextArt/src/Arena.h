@@ -0,0 +1,97 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <stddef.h>
+
+#include "Port.h"
+
+using namespace Osp::Base;
+
+/**
+ * Bump allocator for objects that share one lifetime, like the items of a
+ * list form. Memory comes from large blocks, objects with destructors are
+ * registered with Own() and destroyed in reverse order by Reset(), which
+ * then rewinds to the first block in one step. Not thread safe.
+ *
+ *   String* pTitle = arena.Own(new (arena) String(title));
+ */
+class Arena {
+public:
+	struct Stats {
+		// objects served since the last Reset() and the heap blocks backing them
+		int allocations;
+		int blocks;
+		int finalizers;
+		int bytesUsed;
+		int bytesReserved;
+	};
+
+	static const int DEFAULT_BLOCK_SIZE = 16 * 1024;
+	static const int ALIGNMENT = 8;
+
+	Arena();
+	~Arena();
+
+	result Construct(int blockSize = DEFAULT_BLOCK_SIZE);
+
+	// null when out of memory
+	void* Allocate(int size);
+
+	template<class T>
+	T* Own(T* pObject)
+	{
+		if(pObject != null) {
+			AddFinalizer(pObject, &Destroy<T>);
+		}
+		return pObject;
+	}
+
+	void Reset(void);
+
+	const Stats& GetStats(void) const { return __stats; }
+
+private:
+	struct Block {
+		Block* pNext;
+		int size;
+		int used;
+	};
+
+	struct Finalizer {
+		void (*pDestroy)(void*);
+		void* pObject;
+		Finalizer* pNext;
+	};
+
+	template<class T>
+	static void Destroy(void* pObject)
+	{
+		static_cast<T*>(pObject)->~T();
+	}
+
+	Block* AddBlock(int size);
+	void AddFinalizer(void* pObject, void (*pDestroy)(void*));
+
+	Arena(const Arena& arena);
+	Arena& operator =(const Arena& arena);
+
+	Block* __pFirst;
+	Block* __pCurrent;
+	Finalizer* __pFinalizers;
+	int __blockSize;
+	Stats __stats;
+};
+
+inline void*
+operator new(size_t size, Arena& arena) throw()
+{
+	return arena.Allocate((int)size);
+}
+
+// only called when a constructor throws, the arena keeps the memory
+inline void
+operator delete(void*, Arena&) throw()
+{
+}
+
+#endif
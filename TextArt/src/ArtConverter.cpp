@@ -0,0 +1,217 @@
+#include "ArtConverter.h"
+
+#include <string.h>
+
+using namespace Osp::Base;
+
+// Blank to full, for when no coverage was measured
+static const mchar DEFAULT_RAMP[] = { L' ', L'.', L':', L'-', L'=', L'+', L'*', L'#', L'%', L'@' };
+static const int DEFAULT_RAMP_LENGTH = sizeof(DEFAULT_RAMP) / sizeof(DEFAULT_RAMP[0]);
+
+// Share of the darkest and the brightest cells clipped by the contrast stretch, in percent
+static const int CLIP_PERCENT = 2;
+
+// Rec. 601 weights in 1/256, they add up to 256
+static const int LUMA_RED = 77;
+static const int LUMA_GREEN = 150;
+static const int LUMA_BLUE = 29;
+
+ArtConverter::ArtConverter():
+	__constructed(false),
+	__pLuma(null),
+	__lumaCapacity(0),
+	__pText(null),
+	__textCapacity(0)
+{
+	memset(__ramp, 0, sizeof(__ramp));
+}
+
+ArtConverter::~ArtConverter()
+{
+	delete[] __pLuma;
+	delete[] __pText;
+}
+
+result
+ArtConverter::Construct(void)
+{
+	int coverage[DEFAULT_RAMP_LENGTH];
+	for(int i = 0; i < DEFAULT_RAMP_LENGTH; i++) {
+		coverage[i] = i;
+	}
+	return Construct(DEFAULT_RAMP, coverage, DEFAULT_RAMP_LENGTH);
+}
+
+result
+ArtConverter::Construct(const mchar* pGlyphs, const int* pCoverage, int count)
+{
+	if(pGlyphs == null || pCoverage == null || count < 2) {
+		return E_INVALID_ARG;
+	}
+	int least = pCoverage[0];
+	int most = pCoverage[0];
+	for(int i = 1; i < count; i++) {
+		least = pCoverage[i] < least ? pCoverage[i] : least;
+		most = pCoverage[i] > most ? pCoverage[i] : most;
+	}
+	if(most <= least) {
+		return E_INVALID_ARG;
+	}
+
+	// Nearest coverage per darkness, the earlier glyph wins a tie
+	for(int darkness = 0; darkness < 256; darkness++) {
+		int best = 0;
+		int bestDistance = 0x7FFFFFFF;
+		for(int i = 0; i < count; i++) {
+			int level = (int)((long long)(pCoverage[i] - least) * 255 / (most - least));
+			int distance = level > darkness ? level - darkness : darkness - level;
+			if(distance < bestDistance) {
+				best = i;
+				bestDistance = distance;
+			}
+		}
+		__ramp[darkness] = pGlyphs[best];
+	}
+	__constructed = true;
+	return E_SUCCESS;
+}
+
+int
+ArtConverter::GetRows(int width, int height, int columns)
+{
+	if(width <= 0 || height <= 0 || columns <= 0) {
+		return 0;
+	}
+	int rows = (int)(((long long)height * columns + width * CELL_ASPECT / 2) / (width * CELL_ASPECT));
+	if(rows < 1) {
+		rows = 1;
+	}
+	if(rows > height) {
+		rows = height;
+	}
+	return rows > MAX_ROWS ? MAX_ROWS : rows;
+}
+
+// Band by band: the source rows of one cell row are summed per cell, then weighted once per cell
+void
+ArtConverter::Downsample(const unsigned int* pPixels, int width, int height, int pitch, int columns, int rows, byte* pLuma)
+{
+	int edges[MAX_COLUMNS + 1];
+	for(int column = 0; column <= columns; column++) {
+		edges[column] = column * width / columns;
+	}
+
+	unsigned int sums[MAX_COLUMNS * 3];
+	for(int row = 0; row < rows; row++) {
+		int top = row * height / rows;
+		int bottom = (row + 1) * height / rows;
+		memset(sums, 0, columns * 3 * sizeof(unsigned int));
+
+		for(int y = top; y < bottom; y++) {
+			const unsigned int* pLine = pPixels + y * pitch;
+			for(int column = 0; column < columns; column++) {
+				unsigned int* pSum = sums + column * 3;
+				for(int x = edges[column]; x < edges[column + 1]; x++) {
+					pSum[0] += (pLine[x] >> 16) & 0xFF;
+					pSum[1] += (pLine[x] >> 8) & 0xFF;
+					pSum[2] += pLine[x] & 0xFF;
+				}
+			}
+		}
+
+		for(int column = 0; column < columns; column++) {
+			const unsigned int* pSum = sums + column * 3;
+			long long weighted = (long long)LUMA_RED * pSum[0] + (long long)LUMA_GREEN * pSum[1] + (long long)LUMA_BLUE * pSum[2];
+			long long pixels = (long long)(edges[column + 1] - edges[column]) * (bottom - top) * 256;
+			*pLuma++ = (byte)(weighted / pixels);
+		}
+	}
+}
+
+result
+ArtConverter::Convert(const unsigned int* pPixels, int width, int height, int pitch, int columns, String& art, int& linecount)
+{
+	if(!__constructed) {
+		return E_INVALID_STATE;
+	}
+	if(pPixels == null || width <= 0 || height <= 0 || pitch < width || columns <= 0) {
+		return E_INVALID_ARG;
+	}
+	if(columns > MAX_COLUMNS) {
+		columns = MAX_COLUMNS;
+	}
+	if(columns > width) {
+		columns = width;
+	}
+	int rows = GetRows(width, height, columns);
+
+	int cells = columns * rows;
+	if(cells > __lumaCapacity) {
+		byte* pLuma = new byte[cells];
+		if(pLuma == null) {
+			return E_OUT_OF_MEMORY;
+		}
+		delete[] __pLuma;
+		__pLuma = pLuma;
+		__lumaCapacity = cells;
+	}
+	int textLength = rows * (columns + 1) + 1;
+	if(textLength > __textCapacity) {
+		mchar* pText = new mchar[textLength];
+		if(pText == null) {
+			return E_OUT_OF_MEMORY;
+		}
+		delete[] __pText;
+		__pText = pText;
+		__textCapacity = textLength;
+	}
+
+	Downsample(pPixels, width, height, pitch, columns, rows, __pLuma);
+
+	// Stretch the cells between the clipped extremes over the whole ramp
+	int histogram[256];
+	memset(histogram, 0, sizeof(histogram));
+	for(int i = 0; i < cells; i++) {
+		histogram[__pLuma[i]]++;
+	}
+	int clip = cells * CLIP_PERCENT / 100;
+	int low = 0;
+	int seen = histogram[0];
+	while(low < 255 && seen <= clip) {
+		seen += histogram[++low];
+	}
+	int high = 255;
+	seen = histogram[255];
+	while(high > 0 && seen <= clip) {
+		seen += histogram[--high];
+	}
+	if(high <= low) {
+		low = 0;
+		high = 255;
+	}
+
+	// Luminance straight to glyph, bright cells get little ink
+	mchar glyphs[256];
+	for(int value = 0; value < 256; value++) {
+		int level = value <= low ? 0 : (value >= high ? 255 : (value - low) * 255 / (high - low));
+		glyphs[value] = __ramp[255 - level];
+	}
+
+	mchar* pOut = __pText;
+	const byte* pCell = __pLuma;
+	for(int row = 0; row < rows; row++) {
+		mchar* pLineStart = pOut;
+		for(int column = 0; column < columns; column++) {
+			*pOut++ = glyphs[*pCell++];
+		}
+		while(pOut > pLineStart && pOut[-1] == L' ') {
+			pOut--;
+		}
+		*pOut++ = L'\n';
+	}
+	*pOut = 0;
+
+	art = __pText;
+	linecount = rows;
+	return E_SUCCESS;
+}
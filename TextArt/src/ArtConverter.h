@@ -0,0 +1,54 @@
+#ifndef ARTCONVERTER_H_
+#define ARTCONVERTER_H_
+
+#include "Port.h"
+
+using namespace Osp::Base;
+
+/**
+ * Turns a decoded picture into text art. The picture is box filtered down to
+ * one luminance value per character cell, the values are stretched over the
+ * full range and every cell becomes the glyph whose ink coverage matches its
+ * darkness best. The ramp comes from coverages measured on the device font
+ * (ArtExporter::MeasureCoverage) or from a built-in default. Works on
+ * ARGB8888 pixels.
+ */
+class ArtConverter {
+public:
+	static const int DEFAULT_COLUMNS = 32;
+	static const int MAX_COLUMNS = 80;
+	static const int MAX_ROWS = 120;
+	// Character cells are about twice as tall as wide
+	static const int CELL_ASPECT = 2;
+
+	ArtConverter();
+	~ArtConverter();
+
+	// Built-in ramp ordered from blank to full
+	result Construct(void);
+	// Candidate glyphs with their measured ink coverage in any unit, in any order
+	result Construct(const mchar* pGlyphs, const int* pCoverage, int count);
+
+	// pitch is the scan-line length in pixels; art gets one line per row, trailing blanks cut
+	result Convert(const unsigned int* pPixels, int width, int height, int pitch, int columns, String& art, int& linecount);
+
+	static int GetRows(int width, int height, int columns);
+
+	// Mean luminance of every cell, columns * rows values row by row
+	static void Downsample(const unsigned int* pPixels, int width, int height, int pitch, int columns, int rows, byte* pLuma);
+
+private:
+	ArtConverter(const ArtConverter& converter);
+	ArtConverter& operator =(const ArtConverter& converter);
+
+	// Glyph per darkness 0..255
+	mchar __ramp[256];
+	bool __constructed;
+
+	byte* __pLuma;
+	int __lumaCapacity;
+	mchar* __pText;
+	int __textCapacity;
+};
+
+#endif
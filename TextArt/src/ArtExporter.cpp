@@ -0,0 +1,295 @@
+#include "ArtExporter.h"
+
+#include "Catalog.h"
+#include "Debug.h"
+#include "TaskScheduler.h"
+
+#include <FIo.h>
+#include <FMedia.h>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+using namespace Osp::Graphics;
+using namespace Osp::Io;
+using namespace Osp::Media;
+
+static const wchar_t* CACHE_DIR = L"/Home/Share/";
+static const wchar_t* CACHE_PREFIX = L"textart_";
+
+// Removes the oldest exported files over the limits
+class ArtExporter::PruneTask :
+	public ITask
+{
+public:
+	result Run(const CancelToken& token)
+	{
+		PROFILE_SCOPE("ArtExporter::PruneCache");
+		Directory dir;
+		result r = dir.Construct(CACHE_DIR);
+		if(IsFailed(r)) {
+			// nothing shared yet
+			return E_SUCCESS;
+		}
+		DirEnumerator* pDirEnum = dir.ReadN();
+		if(pDirEnum == null) {
+			return GetLastResult();
+		}
+
+		CachedFile* pFiles = null;
+		int count = 0;
+		int capacity = 0;
+		while(pDirEnum->MoveNext() == E_SUCCESS) {
+			DirEntry& dirEntry = pDirEnum->GetCurrentDirEntry();
+			String name = dirEntry.GetName();
+			if(!dirEntry.IsNomalFile() || !name.StartsWith(CACHE_PREFIX, 0)) {
+				continue;
+			}
+			if(count == capacity) {
+				capacity = capacity > 0 ? capacity * 2 : MAX_CACHE_FILES * 2;
+				CachedFile* pGrown = new CachedFile[capacity];
+				for(int i = 0; i < count; i++) {
+					pGrown[i] = pFiles[i];
+				}
+				delete[] pFiles;
+				pFiles = pGrown;
+			}
+			// newest first, by insertion as the directory is short
+			CachedFile file;
+			file.name = name;
+			file.size = dirEntry.GetFileSize();
+			file.modified = dirEntry.GetDateTime().GetTime().GetTicks();
+			int position = count++;
+			while(position > 0 && pFiles[position - 1].modified < file.modified) {
+				pFiles[position] = pFiles[position - 1];
+				position--;
+			}
+			pFiles[position] = file;
+		}
+		delete pDirEnum;
+
+		long long bytes = 0;
+		int kept = 0;
+		int removed = 0;
+		for(int i = 0; i < count; i++) {
+			bytes += pFiles[i].size;
+			if(kept < MAX_CACHE_FILES && bytes <= MAX_CACHE_BYTES) {
+				kept++;
+				continue;
+			}
+			String path(CACHE_DIR);
+			path.Append(pFiles[i].name);
+			if(!IsFailed(File::Remove(path))) {
+				removed++;
+			}
+		}
+		delete[] pFiles;
+		if(removed > 0) {
+			AppLog("Share cache pruned by %d files, %d left", removed, kept);
+		}
+		return E_SUCCESS;
+	}
+
+	void OnTaskCompleted(result r)
+	{
+		if(IsFailed(r)) {
+			AppLog("Share cache not pruned: %s", GetErrorMessage(r));
+		}
+	}
+
+private:
+	struct CachedFile {
+		String name;
+		long long size;
+		long long modified;
+	};
+};
+
+void
+ArtExporter::PruneCache(void)
+{
+	TaskScheduler::Post(new PruneTask(), TaskScheduler::LANE_BACKGROUND);
+}
+
+void
+ArtExporter::GetCachePath(const String& art, int fontSize, String& path)
+{
+	// bodies are read normalized, so the copies of one body share a file
+	path = CACHE_DIR;
+	path.Append(CACHE_PREFIX);
+	path.Append((long long)Catalog::HashArt(art.GetPointer(), art.GetLength()));
+	path.Append(L'_');
+	path.Append(art.GetLength());
+	path.Append(L'_');
+	path.Append(fontSize);
+	path.Append(L".png");
+}
+
+result
+ArtExporter::ExportPng(const String& art, int fontSize, String& outPath)
+{
+	GetCachePath(art, fontSize, outPath);
+	if(File::IsFileExist(outPath)) {
+		return E_SUCCESS;
+	}
+
+	Bitmap* pBitmap = RenderN(art, fontSize);
+	if(pBitmap == null) {
+		return E_FAILURE;
+	}
+
+	Image image;
+	result r = image.Construct();
+	if(!IsFailed(r)) {
+		r = image.EncodeToFile(*pBitmap, IMG_FORMAT_PNG, outPath, true);
+	}
+	delete pBitmap;
+
+	if(IsFailed(r)) {
+		AppLog("PNG export failed by %s", GetErrorMessage(r));
+		// a partial file would be taken for the cached one next time
+		if(File::IsFileExist(outPath)) {
+			File::Remove(outPath);
+		}
+	}
+	return r;
+}
+
+Bitmap*
+ArtExporter::RenderN(const String& art, int fontSize)
+{
+	// Split into lines once; the grid size follows from them
+	ArrayList lines;
+	lines.Construct();
+	int columns = 0;
+	int start = 0;
+	int length = art.GetLength();
+	while(start <= length) {
+		int end = -1;
+		if(art.IndexOf(L'\n', start, end) != E_SUCCESS) {
+			end = length;
+		}
+		String* pLine = new String();
+		art.SubString(start, end - start, *pLine);
+		pLine->Replace(L"\r", L"");
+		if(pLine->GetLength() > columns) {
+			columns = pLine->GetLength();
+		}
+		lines.Add(*pLine);
+		start = end + 1;
+	}
+	// drop the empty tail after the final newline
+	while(lines.GetCount() > 0 && static_cast<String*>(lines.GetAt(lines.GetCount() - 1))->GetLength() == 0) {
+		lines.RemoveAt(lines.GetCount() - 1, true);
+	}
+	int rows = lines.GetCount();
+	if(rows == 0 || columns == 0) {
+		lines.RemoveAll(true);
+		return null;
+	}
+
+	// Shrink the font until the grid fits into the size limit
+	Font font;
+	Dimension cell;
+	int lineHeight = 0;
+	for(;;) {
+		font.Construct(FONT_STYLE_PLAIN, fontSize);
+		font.GetTextExtent(L"W", 1, cell);
+		lineHeight = font.GetAscender() + font.GetDescender();
+		if((columns * cell.width + 2 * PADDING <= MAX_WIDTH && rows * lineHeight + 2 * PADDING <= MAX_HEIGHT)
+				|| fontSize <= MIN_FONT_SIZE) {
+			break;
+		}
+		fontSize--;
+	}
+
+	Rectangle bounds(0, 0, columns * cell.width + 2 * PADDING, rows * lineHeight + 2 * PADDING);
+	Canvas canvas;
+	if(IsFailed(canvas.Construct(bounds))) {
+		lines.RemoveAll(true);
+		return null;
+	}
+	canvas.SetBackgroundColor(Color::COLOR_WHITE);
+	canvas.SetForegroundColor(Color::COLOR_BLACK);
+	canvas.Clear();
+	canvas.SetFont(font);
+
+	// Every character gets its own cell, independent of the font's own advance widths
+	String glyph(L" ");
+	for(int row = 0; row < rows; row++) {
+		const String* pLine = static_cast<String*>(lines.GetAt(row));
+		const mchar* p = pLine->GetPointer();
+		int y = PADDING + row * lineHeight;
+		for(int col = 0; col < pLine->GetLength(); col++) {
+			if(p[col] == L' ' || p[col] == L'\t') {
+				continue;
+			}
+			glyph.SetCharAt(p[col], 0);
+			canvas.DrawText(Point(PADDING + col * cell.width, y), glyph);
+		}
+	}
+	lines.RemoveAll(true);
+
+	Bitmap* pBitmap = new Bitmap();
+	if(IsFailed(pBitmap->Construct(canvas, bounds))) {
+		delete pBitmap;
+		return null;
+	}
+	return pBitmap;
+}
+
+result
+ArtExporter::MeasureCoverage(int fontSize, const mchar* pGlyphs, int count, int* pCoverage)
+{
+	Font font;
+	result r = font.Construct(FONT_STYLE_PLAIN, fontSize);
+	if(IsFailed(r)) {
+		return r;
+	}
+	int lineHeight = font.GetAscender() + font.GetDescender();
+
+	// One canvas wide enough for the widest glyph, every glyph is drawn into its top left corner
+	String glyph(L" ");
+	Dimension extent;
+	int cellWidth = 1;
+	for(int i = 0; i < count; i++) {
+		glyph.SetCharAt(pGlyphs[i], 0);
+		font.GetTextExtent(glyph, 1, extent);
+		if(extent.width > cellWidth) {
+			cellWidth = extent.width;
+		}
+	}
+
+	Canvas canvas;
+	r = canvas.Construct(Rectangle(0, 0, cellWidth, lineHeight));
+	if(IsFailed(r)) {
+		return r;
+	}
+	canvas.SetBackgroundColor(Color::COLOR_WHITE);
+	canvas.SetForegroundColor(Color::COLOR_BLACK);
+	canvas.SetFont(font);
+
+	for(int i = 0; i < count; i++) {
+		glyph.SetCharAt(pGlyphs[i], 0);
+		font.GetTextExtent(glyph, 1, extent);
+		int width = extent.width < 1 ? 1 : (extent.width > cellWidth ? cellWidth : extent.width);
+		canvas.Clear();
+		canvas.DrawText(Point(0, 0), glyph);
+
+		BufferInfo info;
+		r = canvas.Lock(info);
+		if(IsFailed(r)) {
+			return r;
+		}
+		// darkness of the green channel, the text is grey on white anyway
+		long long ink = 0;
+		for(int y = 0; y < lineHeight && y < info.height; y++) {
+			const unsigned int* pLine = reinterpret_cast<const unsigned int*>(static_cast<const byte*>(info.pPixels) + y * info.pitch);
+			for(int x = 0; x < width && x < info.width; x++) {
+				ink += 255 - ((pLine[x] >> 8) & 0xFF);
+			}
+		}
+		canvas.Unlock();
+		pCoverage[i] = (int)(ink * 256 / (255 * width * lineHeight));
+	}
+	return E_SUCCESS;
+}
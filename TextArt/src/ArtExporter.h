@@ -0,0 +1,45 @@
+#ifndef ARTEXPORTER_H_
+#define ARTEXPORTER_H_
+
+#include <FBase.h>
+#include <FGraphics.h>
+
+using namespace Osp::Base;
+using namespace Osp::Graphics;
+
+/**
+ * Renders a piece of art on a fixed character grid into an offscreen bitmap
+ * and encodes it as PNG, so it survives proportional fonts of mail and MMS
+ * clients. Encoded files are kept in /Home/Share keyed by the art body and
+ * font size, so repeated shares and every item sharing the body reuse them.
+ * PruneCache() keeps that directory under MAX_CACHE_FILES and
+ * MAX_CACHE_BYTES, oldest out first.
+ */
+class ArtExporter {
+public:
+	static const int DEFAULT_FONT_SIZE = 16;
+
+	// outPath receives the PNG path
+	static result ExportPng(const String& art, int fontSize, String& outPath);
+
+	static void GetCachePath(const String& art, int fontSize, String& path);
+	// Queued on the background lane, at start before anything is shared
+	static void PruneCache(void);
+
+	// Ink of every glyph per pixel of its own box in 1/256, for ArtConverter's ramp
+	static result MeasureCoverage(int fontSize, const mchar* pGlyphs, int count, int* pCoverage);
+
+private:
+	static Bitmap* RenderN(const String& art, int fontSize);
+
+	static const int PADDING = 8;
+	static const int MAX_WIDTH = 1024;
+	static const int MAX_HEIGHT = 2048;
+	static const int MIN_FONT_SIZE = 8;
+	static const int MAX_CACHE_FILES = 32;
+	static const int MAX_CACHE_BYTES = 2 * 1024 * 1024;
+
+	class PruneTask;
+};
+
+#endif
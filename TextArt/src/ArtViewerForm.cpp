@@ -0,0 +1,423 @@
+#include "ArtViewerForm.h"
+
+#include "Catalog.h"
+#include "FormManager.h"
+#include "Retina.h"
+#include "TextPic.h"
+#include "Debug.h"
+
+#include <FApp.h>
+
+#include <math.h>
+
+using namespace Osp::App;
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+using namespace Osp::Graphics;
+using namespace Osp::Ui;
+using namespace Osp::Ui::Controls;
+
+const int ArtViewerForm::LEVEL_SCALES[LEVEL_COUNT] = { 250, 500, 1000, 2000, 4000 };
+
+// The background of the lists
+static const Color BACKGROUND(239, 239, 239);
+
+ArtViewerForm::ArtViewerForm(void):
+	__pLines(null),
+	__lineCount(0),
+	__level(NORMAL_LEVEL),
+	__pFont(null),
+	__lineHeight(1),
+	__pWidths(null),
+	__contentWidth(0),
+	__contentHeight(0),
+	__offsetX(0),
+	__offsetY(0),
+	__tileSize(1),
+	__frame(0),
+	__pinchDistance(0)
+{
+	for(int i = 0; i < MAX_TILES; i++) {
+		__tiles[i].pBitmap = null;
+	}
+}
+
+ArtViewerForm::~ArtViewerForm(void)
+{
+}
+
+bool
+ArtViewerForm::Initialize(void)
+{
+	Form::Construct(FORM_STYLE_INDICATOR | FORM_STYLE_TITLE | FORM_STYLE_FOOTER);
+	SetName(L"ArtViewerForm");
+
+	Footer* pFooter = GetFooter();
+	pFooter->SetStyle(FOOTER_STYLE_SEGMENTED_ICON);
+	pFooter->SetBackButton();
+	SetFormBackEventListener(this);
+
+	AddTouchEventListener(*this);
+	Touch touch;
+	touch.SetMultipointEnabled(*this, true);
+
+	// a screen is three tiles wide at any density
+	__tileSize = Retina::GetInt(80);
+	return true;
+}
+
+result
+ArtViewerForm::OnTerminating(void)
+{
+	ReleaseTiles();
+	ReleaseArt();
+	return E_SUCCESS;
+}
+
+void
+ArtViewerForm::OnFormBackRequested(Osp::Ui::Controls::Form& form)
+{
+	FormManager::Navigate(FormManager::REQUEST_VIEWERBACK);
+}
+
+void
+ArtViewerForm::ReleaseArt(void)
+{
+	delete[] __pLines;
+	__pLines = null;
+	__lineCount = 0;
+	delete[] __pWidths;
+	__pWidths = null;
+	delete __pFont;
+	__pFont = null;
+}
+
+void
+ArtViewerForm::ReleaseTiles(void)
+{
+	for(int i = 0; i < MAX_TILES; i++) {
+		delete __tiles[i].pBitmap;
+		__tiles[i].pBitmap = null;
+	}
+}
+
+result
+ArtViewerForm::ShowArt(const String& path)
+{
+	PROFILE_SCOPE("ArtViewerForm::ShowArt");
+	String titles[Catalog::LANGUAGE_COUNT];
+	String art;
+	int linecount = 0;
+	result r = Catalog::ReadItem(path, titles, art, linecount);
+	if(IsFailed(r)) {
+		AppLog("Art of %ls not read: %s", path.GetPointer(), GetErrorMessage(r));
+		return r;
+	}
+	SetTitleText(titles[TextPic::__InternalAppLanguageIndex]);
+
+	ReleaseTiles();
+	ReleaseArt();
+	__lineCount = 1;
+	for(int i = 0; i < art.GetLength(); i++) {
+		if(art[i] == L'\n') {
+			__lineCount++;
+		}
+	}
+	__pLines = new String[__lineCount];
+	__pWidths = new int[__lineCount];
+	int start = 0;
+	for(int line = 0; line < __lineCount; line++) {
+		int end = start;
+		if(IsFailed(art.IndexOf(L'\n', start, end))) {
+			end = art.GetLength();
+		}
+		art.SubString(start, end - start, __pLines[line]);
+		start = end + 1;
+	}
+
+	// Start as large as fits the width, up to the size of the list
+	__offsetX = 0;
+	__offsetY = 0;
+	r = SetLevel(NORMAL_LEVEL, Point(0, 0));
+	if(IsFailed(r)) {
+		return r;
+	}
+	int normalWidth = __contentWidth;
+	int viewWidth = GetClientAreaBounds().width;
+	int level = NORMAL_LEVEL;
+	while(level > 0 && normalWidth * LEVEL_SCALES[level] / LEVEL_SCALES[NORMAL_LEVEL] > viewWidth) {
+		level--;
+	}
+	if(level != __level) {
+		r = SetLevel(level, Point(0, 0));
+	}
+	__offsetX = 0;
+	__offsetY = 0;
+	ClampOffset();
+	return r;
+}
+
+result
+ArtViewerForm::SetLevel(int level, const Point& anchor)
+{
+	int size = Retina::GetSize(Retina::SIZE_ITEM_ART_FONT) * LEVEL_SCALES[level] / Retina::SCALE_ONE;
+	Font* pFont = new Font();
+	result r = pFont->Construct(FONT_STYLE_PLAIN, size > MIN_FONT_SIZE ? size : MIN_FONT_SIZE);
+	if(IsFailed(r)) {
+		delete pFont;
+		return r;
+	}
+	int previous = __level;
+	delete __pFont;
+	__pFont = pFont;
+	__level = level;
+	// the lines of the list are as high as its font
+	__lineHeight = pFont->GetSize();
+
+	PROFILE_SCOPE("ArtViewerForm::MeasureLines");
+	__contentWidth = 0;
+	for(int i = 0; i < __lineCount; i++) {
+		Dimension dim;
+		__pWidths[i] = 0;
+		if(!IsFailed(pFont->GetTextExtent(__pLines[i], __pLines[i].GetLength(), dim))) {
+			__pWidths[i] = dim.width;
+		}
+		if(__pWidths[i] > __contentWidth) {
+			__contentWidth = __pWidths[i];
+		}
+	}
+	__contentHeight = __lineCount * __lineHeight;
+
+	// the art under the anchor stays there
+	long long x = (long long)(__offsetX + anchor.x) * LEVEL_SCALES[level] / LEVEL_SCALES[previous];
+	long long y = (long long)(__offsetY + anchor.y) * LEVEL_SCALES[level] / LEVEL_SCALES[previous];
+	__offsetX = (int)x - anchor.x;
+	__offsetY = (int)y - anchor.y;
+	ClampOffset();
+	return E_SUCCESS;
+}
+
+void
+ArtViewerForm::ClampOffset(void)
+{
+	Rectangle view = GetClientAreaBounds();
+	if(__contentWidth <= view.width) {
+		__offsetX = (__contentWidth - view.width) / 2;
+	} else if(__offsetX < 0) {
+		__offsetX = 0;
+	} else if(__offsetX > __contentWidth - view.width) {
+		__offsetX = __contentWidth - view.width;
+	}
+	if(__contentHeight <= view.height) {
+		__offsetY = (__contentHeight - view.height) / 2;
+	} else if(__offsetY < 0) {
+		__offsetY = 0;
+	} else if(__offsetY > __contentHeight - view.height) {
+		__offsetY = __contentHeight - view.height;
+	}
+}
+
+void
+ArtViewerForm::ScrollBy(int dx, int dy)
+{
+	int x = __offsetX;
+	int y = __offsetY;
+	__offsetX += dx;
+	__offsetY += dy;
+	ClampOffset();
+	if(x != __offsetX || y != __offsetY) {
+		RequestRedraw(true);
+	}
+}
+
+result
+ArtViewerForm::OnDraw(void)
+{
+	PROFILE_SCOPE("ArtViewerForm::OnDraw");
+	Canvas* pCanvas = GetClientAreaCanvasN();
+	if(pCanvas == null) {
+		return GetLastResult();
+	}
+	Rectangle view = GetClientAreaBounds();
+	pCanvas->FillRectangle(BACKGROUND, Rectangle(0, 0, view.width, view.height));
+
+	if(__lineCount > 0) {
+		__frame++;
+		// the tiles under the client area, none outside the art
+		int left = __offsetX > 0 ? __offsetX : 0;
+		int top = __offsetY > 0 ? __offsetY : 0;
+		int right = __offsetX + view.width < __contentWidth ? __offsetX + view.width : __contentWidth;
+		int bottom = __offsetY + view.height < __contentHeight ? __offsetY + view.height : __contentHeight;
+		for(int row = top / __tileSize; row * __tileSize < bottom; row++) {
+			for(int column = left / __tileSize; column * __tileSize < right; column++) {
+				const Bitmap* pTile = GetTile(column, row);
+				if(pTile != null) {
+					pCanvas->DrawBitmap(Point(column * __tileSize - __offsetX, row * __tileSize - __offsetY), *pTile);
+				}
+			}
+		}
+	}
+	delete pCanvas;
+	return E_SUCCESS;
+}
+
+const Bitmap*
+ArtViewerForm::GetTile(int column, int row)
+{
+	// an empty slot, or else the one drawn longest ago
+	Tile* pVictim = null;
+	for(int i = 0; i < MAX_TILES; i++) {
+		Tile& tile = __tiles[i];
+		if(tile.pBitmap == null) {
+			if(pVictim == null || pVictim->pBitmap != null) {
+				pVictim = &tile;
+			}
+			continue;
+		}
+		if(tile.level == __level && tile.column == column && tile.row == row) {
+			tile.used = __frame;
+			return tile.pBitmap;
+		}
+		if(pVictim == null || (pVictim->pBitmap != null && tile.used < pVictim->used)) {
+			pVictim = &tile;
+		}
+	}
+	// every tile is on screen already, only when the screen is larger than planned for
+	if(pVictim->pBitmap != null && pVictim->used == __frame) {
+		return null;
+	}
+
+	Bitmap* pBitmap = RenderTileN(column, row);
+	if(pBitmap == null) {
+		return null;
+	}
+	delete pVictim->pBitmap;
+	pVictim->pBitmap = pBitmap;
+	pVictim->level = __level;
+	pVictim->column = column;
+	pVictim->row = row;
+	pVictim->used = __frame;
+	return pBitmap;
+}
+
+Bitmap*
+ArtViewerForm::RenderTileN(int column, int row)
+{
+	PROFILE_SCOPE("ArtViewerForm::RenderTile");
+	Canvas canvas;
+	result r = canvas.Construct(Rectangle(0, 0, __tileSize, __tileSize));
+	if(IsFailed(r)) {
+		return null;
+	}
+	canvas.SetBackgroundColor(BACKGROUND);
+	canvas.Clear();
+	canvas.SetFont(*__pFont);
+	canvas.SetForegroundColor(Color::COLOR_BLACK);
+
+	// whole lines, the canvas clips them to the tile
+	int x = column * __tileSize;
+	int y = row * __tileSize;
+	int last = (y + __tileSize - 1) / __lineHeight;
+	for(int line = y / __lineHeight; line <= last && line < __lineCount; line++) {
+		if(__pWidths[line] > x) {
+			canvas.DrawText(Point(-x, line * __lineHeight - y), __pLines[line]);
+		}
+	}
+
+	Bitmap* pBitmap = new Bitmap();
+	r = pBitmap->Construct(canvas, Rectangle(0, 0, __tileSize, __tileSize));
+	if(IsFailed(r)) {
+		AppLog("Art tile not rendered: %s", GetErrorMessage(r));
+		delete pBitmap;
+		return null;
+	}
+	return pBitmap;
+}
+
+Point
+ArtViewerForm::ToClient(const Point& point) const
+{
+	Rectangle client = GetClientAreaBounds();
+	return Point(point.x - client.x, point.y - client.y);
+}
+
+bool
+ArtViewerForm::GetPinch(const Control& source, int& distance, Point& center) const
+{
+	Touch touch;
+	IList* pList = touch.GetTouchInfoListN(source);
+	if(pList == null) {
+		return false;
+	}
+	Point points[2];
+	int count = 0;
+	for(int i = 0; i < pList->GetCount() && count < 2; i++) {
+		const TouchInfo* pInfo = static_cast<const TouchInfo*>(pList->GetAt(i));
+		if(pInfo->status == TOUCH_PRESSED) {
+			points[count++] = pInfo->position;
+		}
+	}
+	pList->RemoveAll(true);
+	delete pList;
+	if(count < 2) {
+		return false;
+	}
+	int dx = points[1].x - points[0].x;
+	int dy = points[1].y - points[0].y;
+	distance = (int)sqrt((double)(dx * dx + dy * dy));
+	center = ToClient(Point((points[0].x + points[1].x) / 2, (points[0].y + points[1].y) / 2));
+	return true;
+}
+
+void
+ArtViewerForm::OnTouchPressed(const Control& source, const Point& currentPosition, const TouchEventInfo& touchInfo)
+{
+	__lastPoint = currentPosition;
+}
+
+void
+ArtViewerForm::OnTouchMoved(const Control& source, const Point& currentPosition, const TouchEventInfo& touchInfo)
+{
+	int distance = 0;
+	Point center;
+	if(!GetPinch(source, distance, center)) {
+		// a finger left over from a pinch pans from where it is
+		if(__pinchDistance == 0) {
+			ScrollBy(__lastPoint.x - currentPosition.x, __lastPoint.y - currentPosition.y);
+		}
+		__lastPoint = currentPosition;
+		__pinchDistance = 0;
+		return;
+	}
+
+	if(__pinchDistance == 0 || distance == 0) {
+		__pinchDistance = distance > 0 ? distance : 1;
+		return;
+	}
+	int level = __level;
+	if(distance * Retina::SCALE_ONE >= __pinchDistance * PINCH_STEP && level + 1 < LEVEL_COUNT) {
+		level++;
+	} else if(distance * PINCH_STEP <= __pinchDistance * Retina::SCALE_ONE && level > 0) {
+		level--;
+	}
+	if(level != __level && !IsFailed(SetLevel(level, center))) {
+		__pinchDistance = distance;
+		RequestRedraw(true);
+	}
+}
+
+void
+ArtViewerForm::OnTouchReleased(const Control& source, const Point& currentPosition, const TouchEventInfo& touchInfo)
+{
+	__lastPoint = currentPosition;
+}
+
+void
+ArtViewerForm::OnTouchDoublePressed(const Control& source, const Point& currentPosition, const TouchEventInfo& touchInfo)
+{
+	// in a step at a time, from the largest back to the smallest
+	int level = __level + 1 < LEVEL_COUNT ? __level + 1 : 0;
+	if(!IsFailed(SetLevel(level, ToClient(currentPosition)))) {
+		RequestRedraw(true);
+	}
+}
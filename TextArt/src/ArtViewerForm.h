@@ -0,0 +1,98 @@
+#ifndef ARTVIEWERFORM_H_
+#define ARTVIEWERFORM_H_
+
+#include <FBase.h>
+#include <FGraphics.h>
+#include <FUi.h>
+
+/**
+ * Full screen view of one item's art, unwrapped, with pan by drag and zoom
+ * by pinch or double tap. The art is drawn at a few fixed zoom levels into
+ * square tiles that are kept in a small cache, least recently drawn out
+ * first, so a frame of panning only renders the tiles that just came into
+ * view and draws bitmaps for the rest.
+ */
+class ArtViewerForm :
+	public Osp::Ui::Controls::Form,
+	public Osp::Ui::ITouchEventListener,
+	public Osp::Ui::Controls::IFormBackEventListener
+{
+public:
+	ArtViewerForm(void);
+	virtual ~ArtViewerForm(void);
+
+	bool Initialize(void);
+
+	// Reads the item at path and shows its art whole, or as wide as fits
+	result ShowArt(const Osp::Base::String& path);
+
+private:
+	// Art font of the list, in thousandths
+	static const int LEVEL_COUNT = 5;
+	static const int LEVEL_SCALES[LEVEL_COUNT];
+	static const int NORMAL_LEVEL = 2;
+	static const int MIN_FONT_SIZE = 4;
+	// Fingers this much further apart, or closer, change the level by one
+	static const int PINCH_STEP = 1500;
+	// Twice the tiles of a screen at the largest
+	static const int MAX_TILES = 36;
+
+	struct Tile {
+		int level;
+		int column;
+		int row;
+		// of the last frame it was drawn in
+		unsigned int used;
+		Osp::Graphics::Bitmap* pBitmap;
+	};
+
+	Osp::Base::String* __pLines;
+	int __lineCount;
+
+	int __level;
+	Osp::Graphics::Font* __pFont;
+	int __lineHeight;
+	// Of every line at the current level
+	int* __pWidths;
+	int __contentWidth;
+	int __contentHeight;
+
+	// Content pixel at the top left of the client area, negative to center
+	int __offsetX;
+	int __offsetY;
+	int __tileSize;
+	Tile __tiles[MAX_TILES];
+	unsigned int __frame;
+
+	Osp::Graphics::Point __lastPoint;
+	// Distance of the two fingers at the last level change, 0 without a pinch
+	int __pinchDistance;
+
+	void ReleaseArt(void);
+	void ReleaseTiles(void);
+	result SetLevel(int level, const Osp::Graphics::Point& anchor);
+	void ScrollBy(int dx, int dy);
+	void ClampOffset(void);
+	const Osp::Graphics::Bitmap* GetTile(int column, int row);
+	Osp::Graphics::Bitmap* RenderTileN(int column, int row);
+	// In the client area
+	Osp::Graphics::Point ToClient(const Osp::Graphics::Point& point) const;
+	// Of the first two fingers down, false with fewer
+	bool GetPinch(const Osp::Ui::Control& source, int& distance, Osp::Graphics::Point& center) const;
+
+public:
+	virtual result OnDraw(void);
+	virtual result OnTerminating(void);
+
+	virtual void OnFormBackRequested(Osp::Ui::Controls::Form& source);
+
+	virtual void OnTouchPressed(const Osp::Ui::Control& source, const Osp::Graphics::Point& currentPosition, const Osp::Ui::TouchEventInfo& touchInfo);
+	virtual void OnTouchLongPressed(const Osp::Ui::Control& source, const Osp::Graphics::Point& currentPosition, const Osp::Ui::TouchEventInfo& touchInfo) {}
+	virtual void OnTouchReleased(const Osp::Ui::Control& source, const Osp::Graphics::Point& currentPosition, const Osp::Ui::TouchEventInfo& touchInfo);
+	virtual void OnTouchMoved(const Osp::Ui::Control& source, const Osp::Graphics::Point& currentPosition, const Osp::Ui::TouchEventInfo& touchInfo);
+	virtual void OnTouchDoublePressed(const Osp::Ui::Control& source, const Osp::Graphics::Point& currentPosition, const Osp::Ui::TouchEventInfo& touchInfo);
+	virtual void OnTouchFocusIn(const Osp::Ui::Control& source, const Osp::Graphics::Point& currentPosition, const Osp::Ui::TouchEventInfo& touchInfo) {}
+	virtual void OnTouchFocusOut(const Osp::Ui::Control& source, const Osp::Graphics::Point& currentPosition, const Osp::Ui::TouchEventInfo& touchInfo) {}
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include "Atlas.h"
+
+#include <FApp.h>
+
+#include "BitmapCache.h"
+#include "Debug.h"
+
+using namespace Osp::App;
+using namespace Osp::Base;
+using namespace Osp::Graphics;
+
+#include "AtlasData.h"
+
+static const mchar CACHE_PATH[] = L"/Home/atlas.cache";
+
+Bitmap* Atlas::__pAtlas = null;
+Bitmap* Atlas::__pImages[ATLAS_IMAGE_COUNT] = { null };
+bool Atlas::__loaded = false;
+
+const Bitmap*
+Atlas::GetBitmap(AtlasImage id)
+{
+	if(!__loaded) {
+		Load();
+	}
+	if(__pAtlas == null || id < 0 || id >= ATLAS_IMAGE_COUNT) {
+		return null;
+	}
+	if(__pImages[id] == null) {
+		// the platform may have scaled the atlas to the screen, the rectangles are for the file
+		const short* pRect = ATLAS_RECTS[id];
+		int width = __pAtlas->GetWidth();
+		int height = __pAtlas->GetHeight();
+		Rectangle rect(pRect[0] * width / ATLAS_WIDTH, pRect[1] * height / ATLAS_HEIGHT,
+				pRect[2] * width / ATLAS_WIDTH, pRect[3] * height / ATLAS_HEIGHT);
+		Bitmap* pImage = new Bitmap();
+		result r = pImage->Construct(*__pAtlas, rect);
+		if(IsFailed(r)) {
+			AppLog("Atlas image %d not cut: %s", id, GetErrorMessage(r));
+			delete pImage;
+			return null;
+		}
+		__pImages[id] = pImage;
+	}
+	return __pImages[id];
+}
+
+void
+Atlas::Shutdown(void)
+{
+	for(int i = 0; i < ATLAS_IMAGE_COUNT; i++) {
+		delete __pImages[i];
+		__pImages[i] = null;
+	}
+	delete __pAtlas;
+	__pAtlas = null;
+	__loaded = false;
+}
+
+result
+Atlas::Load(void)
+{
+	PROFILE_SCOPE("Atlas::Load");
+	__loaded = true;
+	__pAtlas = BitmapCache::ReadN(CACHE_PATH, ATLAS_HASH);
+	if(__pAtlas != null) {
+		return E_SUCCESS;
+	}
+
+	__pAtlas = Application::GetInstance()->GetAppResource()->GetBitmapN(ATLAS_FILE);
+	result r = GetLastResult();
+	if(__pAtlas == null) {
+		AppLog("Atlas not decoded: %s", GetErrorMessage(r));
+		return IsFailed(r) ? r : E_FAILURE;
+	}
+	BitmapCache::Write(CACHE_PATH, ATLAS_HASH, *__pAtlas);
+	return E_SUCCESS;
+}
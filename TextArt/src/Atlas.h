@@ -0,0 +1,33 @@
+#ifndef ATLAS_H_
+#define ATLAS_H_
+
+#include <FBase.h>
+#include <FGraphics.h>
+
+#include "AtlasIds.h"
+
+/**
+ * The UI images, packed into Res/ScreenDensity-High/atlas.png by
+ * tools/AtlasGen. The atlas is decoded on the first request and each image
+ * is cut out of it once and kept, so building a popup, a footer or a list
+ * row decodes nothing. The decoded pixels are also saved to
+ * /Home/atlas.cache through BitmapCache, keyed by the hash of the atlas,
+ * and warm starts read that instead of decoding the PNG.
+ */
+class Atlas {
+public:
+	// Owned by the atlas until Shutdown(), null when the atlas cannot be read;
+	// controls copy what they are given
+	static const Osp::Graphics::Bitmap* GetBitmap(AtlasImage id);
+
+	static void Shutdown(void);
+
+private:
+	static result Load(void);
+
+	static Osp::Graphics::Bitmap* __pAtlas;
+	static Osp::Graphics::Bitmap* __pImages[ATLAS_IMAGE_COUNT];
+	static bool __loaded;
+};
+
+#endif
@@ -0,0 +1,28 @@
+// Generated by tools/AtlasGen from tools/atlas/atlas.txt - do not modify by hand.
+// Included by Atlas.cpp only.
+
+static const mchar ATLAS_FILE[] = L"atlas.png";
+static const int ATLAS_WIDTH = 520;
+static const int ATLAS_HEIGHT = 520;
+static const unsigned int ATLAS_HASH = 0xAC280E99u;
+
+// x, y, width and height of every AtlasImage
+static const short ATLAS_RECTS[ATLAS_IMAGE_COUNT][4] = {
+	{ 0, 0, 130, 130 },	// sms.png
+	{ 130, 0, 130, 130 },	// sms_p.png
+	{ 260, 0, 130, 130 },	// copy.png
+	{ 390, 0, 130, 130 },	// copy_p.png
+	{ 0, 130, 130, 130 },	// mail.png
+	{ 130, 130, 130, 130 },	// mail_p.png
+	{ 260, 130, 130, 130 },	// favorite.png
+	{ 390, 130, 130, 130 },	// favorite_p.png
+	{ 0, 260, 130, 130 },	// favorite_active.png
+	{ 130, 260, 130, 130 },	// favorite_active_p.png
+	{ 290, 390, 56, 54 },	// cancel.png
+	{ 346, 390, 56, 54 },	// cancel_p.png
+	{ 130, 390, 80, 80 },	// info.png
+	{ 210, 390, 80, 80 },	// info_p.png
+	{ 260, 260, 130, 130 },	// Ikonka_512.png
+	{ 390, 260, 130, 130 },	// uc_icon2.png
+	{ 0, 390, 130, 130 }	// scalc_icon.png
+};
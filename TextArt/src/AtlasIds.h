@@ -0,0 +1,27 @@
+// Generated by tools/AtlasGen from tools/atlas/atlas.txt - do not modify by hand.
+
+#ifndef ATLASIDS_H_
+#define ATLASIDS_H_
+
+enum AtlasImage {
+	ATLAS_SMS = 0,
+	ATLAS_SMS_P = 1,
+	ATLAS_COPY = 2,
+	ATLAS_COPY_P = 3,
+	ATLAS_MAIL = 4,
+	ATLAS_MAIL_P = 5,
+	ATLAS_FAVORITE = 6,
+	ATLAS_FAVORITE_P = 7,
+	ATLAS_FAVORITE_ACTIVE = 8,
+	ATLAS_FAVORITE_ACTIVE_P = 9,
+	ATLAS_CANCEL = 10,
+	ATLAS_CANCEL_P = 11,
+	ATLAS_INFO = 12,
+	ATLAS_INFO_P = 13,
+	ATLAS_IKONKA_512 = 14,
+	ATLAS_UC_ICON2 = 15,
+	ATLAS_SCALC_ICON = 16,
+	ATLAS_IMAGE_COUNT = 17
+};
+
+#endif
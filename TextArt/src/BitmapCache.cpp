@@ -0,0 +1,167 @@
+#include "BitmapCache.h"
+
+#include <FIo.h>
+
+#include "Debug.h"
+#include "TaskScheduler.h"
+
+using namespace Osp::Base;
+using namespace Osp::Graphics;
+using namespace Osp::Io;
+
+static const unsigned int CACHE_MAGIC = 0x43505442;
+
+// Ahead of the pixels, which follow row by row without padding
+struct CacheHeader {
+	unsigned int magic;
+	unsigned int key;
+	int width;
+	int height;
+	int format;
+};
+
+// Writes the copied pixels behind the UI thread
+class BitmapCache::WriteTask :
+	public ITask
+{
+public:
+	WriteTask(const String& path, const CacheHeader& header, ByteBuffer* pPixels):
+		__path(path),
+		__header(header),
+		__pPixels(pPixels)
+	{
+	}
+
+	~WriteTask(void)
+	{
+		delete __pPixels;
+	}
+
+	result Run(const CancelToken& token)
+	{
+		PROFILE_SCOPE("BitmapCache::Write");
+		File file;
+		result r = file.Construct(__path, L"w");
+		if(!IsFailed(r)) {
+			r = file.Write(&__header, sizeof(__header));
+		}
+		if(!IsFailed(r)) {
+			r = file.Write(*__pPixels);
+		}
+		if(IsFailed(r)) {
+			// a short file fails the size check on the next read
+			AppLog("Bitmap cache %ls not written: %s", __path.GetPointer(), GetErrorMessage(r));
+		}
+		return r;
+	}
+
+	void OnTaskCompleted(result r)
+	{
+	}
+
+private:
+	String __path;
+	CacheHeader __header;
+	ByteBuffer* __pPixels;
+};
+
+// Removes a file after the writes queued for it
+class BitmapCache::RemoveTask :
+	public ITask
+{
+public:
+	RemoveTask(const String& path):
+		__path(path)
+	{
+	}
+
+	result Run(const CancelToken& token)
+	{
+		return File::IsFileExist(__path) ? File::Remove(__path) : E_SUCCESS;
+	}
+
+	void OnTaskCompleted(result r)
+	{
+		if(IsFailed(r)) {
+			AppLog("Bitmap cache %ls not removed: %s", __path.GetPointer(), GetErrorMessage(r));
+		}
+	}
+
+private:
+	String __path;
+};
+
+Bitmap*
+BitmapCache::ReadN(const String& path, unsigned int key)
+{
+	File file;
+	if(IsFailed(file.Construct(path, L"r"))) {
+		return null;
+	}
+	CacheHeader header;
+	if(file.Read(&header, sizeof(header)) != sizeof(header) || header.magic != CACHE_MAGIC || header.key != key
+			|| header.width <= 0 || header.height <= 0) {
+		return null;
+	}
+	BitmapPixelFormat format = (BitmapPixelFormat)header.format;
+	int bytes = format == BITMAP_PIXEL_FORMAT_RGB565 ? 2 : 4;
+	ByteBuffer pixels;
+	if(IsFailed(pixels.Construct(header.width * header.height * bytes))) {
+		return null;
+	}
+	if(IsFailed(file.Read(pixels)) || pixels.GetRemaining() != 0) {
+		return null;
+	}
+	pixels.Flip();
+
+	// the pixels as they were locked, the platform must not scale them again
+	Bitmap* pBitmap = new Bitmap();
+	result r = pBitmap->Construct(pixels, Dimension(header.width, header.height), format, BUFFER_SCALING_NONE);
+	if(IsFailed(r)) {
+		AppLog("Bitmap cache %ls not read: %s", path.GetPointer(), GetErrorMessage(r));
+		delete pBitmap;
+		return null;
+	}
+	return pBitmap;
+}
+
+result
+BitmapCache::Write(const String& path, unsigned int key, Bitmap& bitmap)
+{
+	BufferInfo info;
+	result r = bitmap.Lock(info);
+	if(IsFailed(r)) {
+		return r;
+	}
+	int rowBytes = info.width * info.bitsPerPixel / 8;
+	ByteBuffer* pPixels = new ByteBuffer();
+	r = pPixels->Construct(rowBytes * info.height);
+	if(!IsFailed(r)) {
+		const byte* pRow = static_cast<const byte*>(info.pPixels);
+		for(int y = 0; y < info.height && !IsFailed(r); y++) {
+			r = pPixels->SetArray(pRow, 0, rowBytes);
+			pRow += info.pitch;
+		}
+		pPixels->Flip();
+	}
+	bitmap.Unlock();
+	if(IsFailed(r)) {
+		delete pPixels;
+		return r;
+	}
+
+	CacheHeader header;
+	header.magic = CACHE_MAGIC;
+	header.key = key;
+	header.width = info.width;
+	header.height = info.height;
+	header.format = bitmap.GetPixelColorFormat();
+	TaskScheduler::Post(new WriteTask(path, header, pPixels), TaskScheduler::LANE_BACKGROUND, TaskScheduler::STRAND_CACHE);
+	return E_SUCCESS;
+}
+
+void
+BitmapCache::Remove(const String& path)
+{
+	TaskScheduler::Post(new RemoveTask(path), TaskScheduler::LANE_BACKGROUND, TaskScheduler::STRAND_CACHE);
+}
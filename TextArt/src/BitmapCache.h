@@ -0,0 +1,27 @@
+#ifndef BITMAPCACHE_H_
+#define BITMAPCACHE_H_
+
+#include <FBase.h>
+#include <FGraphics.h>
+
+/**
+ * A bitmap kept in a file as the pixels the platform holds, so reading it
+ * back is one file read and no decoding. Each file is written for a key,
+ * such as a hash of what the pixels were made from, and a file of another
+ * key or with a short read is ignored.
+ */
+class BitmapCache {
+public:
+	// null when the file is missing, short or written for another key
+	static Osp::Graphics::Bitmap* ReadN(const Osp::Base::String& path, unsigned int key);
+	// Copies the pixels and writes them on the background lane
+	static result Write(const Osp::Base::String& path, unsigned int key, Osp::Graphics::Bitmap& bitmap);
+	// Queued behind the writes of the path, so none of them brings the file back
+	static void Remove(const Osp::Base::String& path);
+
+private:
+	class WriteTask;
+	class RemoveTask;
+};
+
+#endif
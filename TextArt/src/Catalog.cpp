@@ -0,0 +1,431 @@
+#include "Catalog.h"
+
+#include "Debug.h"
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+using namespace Osp::Base::Utility;
+using namespace Osp::Io;
+
+static const wchar_t* CATALOG_ROOT = L"/Home/catalog/";
+static const wchar_t* CATEGORY_INFO = L"category.info";
+
+// Copies the line starting at start without its line break, returns the start of the next line
+static int
+ReadLine(const String& text, int start, String& line)
+{
+	int length = text.GetLength();
+	int end = length;
+	if(start >= length || text.IndexOf(L'\n', start, end) != E_SUCCESS) {
+		end = length;
+	}
+	int next = end < length ? end + 1 : length;
+	if(end > start && text.GetPointer()[end - 1] == L'\r') {
+		end--;
+	}
+	if(end > start) {
+		text.SubString(start, end - start, line);
+	} else {
+		line.Clear();
+	}
+	return next;
+}
+
+// Rest of the file from start with '\r' dropped and blanks at line ends cut, so
+// copies of one body saved with other line breaks or editors read the same
+static void
+ReadArt(const String& text, int start, String& art, int& linecount)
+{
+	linecount = 0;
+	int length = text.GetLength() - start;
+	if(length <= 0) {
+		art.Clear();
+		return;
+	}
+
+	const mchar* pText = text.GetPointer() + start;
+	mchar* pArt = new mchar[length + 1];
+	int artLength = 0;
+	// end of the line without its trailing blanks
+	int kept = 0;
+	for(int i = 0; i < length; i++) {
+		mchar c = pText[i];
+		if(c == L'\r') {
+			continue;
+		}
+		if(c == L'\n') {
+			artLength = kept;
+			pArt[artLength++] = c;
+			kept = artLength;
+			linecount++;
+			continue;
+		}
+		pArt[artLength++] = c;
+		if(c != L' ' && c != L'\t') {
+			kept = artLength;
+		}
+	}
+	artLength = kept;
+	// the last line may lack its break
+	if(artLength > 0 && pArt[artLength - 1] != L'\n') {
+		linecount++;
+	}
+	pArt[artLength] = 0;
+	art = pArt;
+	delete[] pArt;
+}
+
+result
+Catalog::GetTranslated(String& fullString, int language)
+{
+	const mchar* p = fullString.GetPointer();
+	int length = fullString.GetLength();
+	while(length > 0 && (p[length - 1] == L'\n' || p[length - 1] == L'\r')) {
+		length--;
+	}
+
+	// A line with fewer columns falls back to its last one
+	int start = 0;
+	for(int column = 0; column < language; column++) {
+		int separator = start;
+		while(separator < length && p[separator] != L'|') {
+			separator++;
+		}
+		if(separator >= length) {
+			break;
+		}
+		start = separator + 1;
+	}
+
+	int end = start;
+	while(end < length && p[end] != L'|') {
+		end++;
+	}
+	if(end == start) {
+		return E_FAILURE;
+	}
+
+	String translated;
+	result r = fullString.SubString(start, end - start, translated);
+	if(IsFailed(r)) {
+		return r;
+	}
+	fullString = translated;
+	return E_SUCCESS;
+}
+
+void
+Catalog::GetTranslations(const String& fullString, String* pTranslations)
+{
+	const mchar* p = fullString.GetPointer();
+	int length = fullString.GetLength();
+	while(length > 0 && (p[length - 1] == L'\n' || p[length - 1] == L'\r')) {
+		length--;
+	}
+
+	int start = 0;
+	for(int language = 0; language < LANGUAGE_COUNT; language++) {
+		int end = start;
+		while(end < length && p[end] != L'|') {
+			end++;
+		}
+		if(end > start) {
+			fullString.SubString(start, end - start, pTranslations[language]);
+		} else {
+			pTranslations[language].Clear();
+		}
+		// past the last column every language keeps it
+		if(end < length) {
+			start = end + 1;
+		}
+	}
+}
+
+result
+Catalog::ReadText(const String& path, String& text)
+{
+	File file;
+	result r = file.Construct(path, L"r");
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	FileAttributes attributes;
+	r = File::GetAttributes(path, attributes);
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	// One spare byte for the terminator Utf8ToString needs
+	ByteBuffer buffer;
+	r = buffer.Construct((int)attributes.GetFileSize() + 1);
+	if(IsFailed(r)) {
+		return r;
+	}
+	r = file.Read(buffer);
+	if(IsFailed(r)) {
+		return r;
+	}
+	buffer.SetByte(0);
+	buffer.Flip();
+
+	r = StringUtil::Utf8ToString((const char*)buffer.GetPointer(), text);
+	if(IsFailed(r)) {
+		AppLog("File read error. File : %S", path.GetPointer());
+		return r;
+	}
+	if(text.GetLength() > 0 && text[0] == (mchar)0xFEFF) {
+		text.Remove(0, 1);
+	}
+	return E_SUCCESS;
+}
+
+result
+Catalog::ReadCategory(const String& name, int language, String& title, String& desc, String& preview)
+{
+	PROFILE_SCOPE("Catalog::ReadCategory");
+	String path;
+	GetCategoryPath(name, path);
+	path.Append(CATEGORY_INFO);
+
+	String text;
+	result r = ReadText(path, text);
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	int start = ReadLine(text, 0, title);
+	start = ReadLine(text, start, desc);
+	r = GetTranslated(title, language);
+	if(IsFailed(r)) {
+		return r;
+	}
+	// an untranslated description is still shown
+	GetTranslated(desc, language);
+
+	if(start < text.GetLength()) {
+		text.SubString(start, preview);
+	} else {
+		preview.Clear();
+	}
+	return E_SUCCESS;
+}
+
+result
+Catalog::ReadItem(const String& path, int language, String& title, String& art, int& linecount)
+{
+	PROFILE_SCOPE("Catalog::ReadItem");
+	String text;
+	result r = ReadText(path, text);
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	int start = ReadLine(text, 0, title);
+	r = GetTranslated(title, language);
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	ReadArt(text, start, art, linecount);
+	return E_SUCCESS;
+}
+
+result
+Catalog::ReadCategory(const String& name, String* pTitles, String* pDescs, String& preview)
+{
+	PROFILE_SCOPE("Catalog::ReadCategory");
+	String path;
+	GetCategoryPath(name, path);
+	path.Append(CATEGORY_INFO);
+
+	String text;
+	result r = ReadText(path, text);
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	String title, desc;
+	int start = ReadLine(text, 0, title);
+	start = ReadLine(text, start, desc);
+	GetTranslations(title, pTitles);
+	GetTranslations(desc, pDescs);
+
+	if(start < text.GetLength()) {
+		text.SubString(start, preview);
+	} else {
+		preview.Clear();
+	}
+	return E_SUCCESS;
+}
+
+result
+Catalog::ReadItem(const String& path, String* pTitles, String& art, int& linecount)
+{
+	PROFILE_SCOPE("Catalog::ReadItem");
+	String text;
+	result r = ReadText(path, text);
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	String title;
+	int start = ReadLine(text, 0, title);
+	GetTranslations(title, pTitles);
+	ReadArt(text, start, art, linecount);
+	return E_SUCCESS;
+}
+
+result
+Catalog::GetCategories(ArrayList& names)
+{
+	PROFILE_SCOPE("Catalog::GetCategories");
+	Directory dir;
+	result r = dir.Construct(CATALOG_ROOT);
+	if(IsFailed(r)) {
+		return r;
+	}
+	DirEnumerator* pDirEnum = dir.ReadN();
+	if(pDirEnum == null) {
+		return GetLastResult();
+	}
+
+	while(pDirEnum->MoveNext() == E_SUCCESS) {
+		DirEntry& dirEntry = pDirEnum->GetCurrentDirEntry();
+		if(dirEntry.IsDirectory()) {
+			String entryName = dirEntry.GetName();
+			if(!entryName.Equals(L".", false) && !entryName.Equals(L"..", false)) {
+				names.Add(*(new String(entryName)));
+			}
+		}
+	}
+	delete pDirEnum;
+	return E_SUCCESS;
+}
+
+result
+Catalog::GetItems(const String& name, ArrayList& paths)
+{
+	PROFILE_SCOPE("Catalog::GetItems");
+	String dirName;
+	GetCategoryPath(name, dirName);
+
+	Directory dir;
+	result r = dir.Construct(dirName);
+	if(IsFailed(r)) {
+		return r;
+	}
+	DirEnumerator* pDirEnum = dir.ReadN();
+	if(pDirEnum == null) {
+		return GetLastResult();
+	}
+
+	while(pDirEnum->MoveNext() == E_SUCCESS) {
+		DirEntry& dirEntry = pDirEnum->GetCurrentDirEntry();
+		if(dirEntry.IsNomalFile()) {
+			String entryName = dirEntry.GetName();
+			if(!entryName.Equals(CATEGORY_INFO, false)) {
+				paths.Add(*(new String(dirName + entryName)));
+			}
+		}
+	}
+	delete pDirEnum;
+	return E_SUCCESS;
+}
+
+unsigned int
+Catalog::HashArt(const mchar* pArt, int length)
+{
+	unsigned int hash = 2166136261u;
+	for(int i = 0; i < length; i++) {
+		hash = (hash ^ (pArt[i] & 0xFFFF)) * 16777619u;
+	}
+	return hash;
+}
+
+void
+Catalog::GetCategoryPath(const String& name, String& path)
+{
+	path = CATALOG_ROOT;
+	path.Append(name);
+	path.Append(L'/');
+}
+
+// Columns joined with '|', a title line in the format GetTranslations reads
+static void
+JoinTranslations(const String* pTranslations, String& line)
+{
+	line.Clear();
+	for(int language = 0; language < Catalog::LANGUAGE_COUNT; language++) {
+		if(language > 0) {
+			line.Append(L'|');
+		}
+		line.Append(pTranslations[language]);
+	}
+	line.Append(L'\n');
+}
+
+static result
+WriteText(const String& path, const String& text)
+{
+	File file;
+	result r = file.Construct(path, L"w", true);
+	if(IsFailed(r)) {
+		return r;
+	}
+	r = file.Write(text);
+	if(IsFailed(r)) {
+		AppLog("File write error. File : %S", path.GetPointer());
+		return r;
+	}
+	return file.Flush();
+}
+
+result
+Catalog::CreateCategory(const String& name, const String* pTitles, const String* pDescs, const String& preview)
+{
+	String path;
+	GetCategoryPath(name, path);
+	path.Append(CATEGORY_INFO);
+	if(File::IsFileExist(path)) {
+		return E_SUCCESS;
+	}
+
+	String text, desc;
+	JoinTranslations(pTitles, text);
+	JoinTranslations(pDescs, desc);
+	text.Append(desc);
+	text.Append(preview);
+	return WriteText(path, text);
+}
+
+result
+Catalog::WriteItem(const String& name, const String* pTitles, const String& art, String& path)
+{
+	String dirName;
+	GetCategoryPath(name, dirName);
+
+	// Items are numbered like the shipped ones, the first free number wins
+	ArrayList paths;
+	paths.Construct();
+	GetItems(name, paths);
+	int number = paths.GetCount() + 1;
+	paths.RemoveAll(true);
+	for(;;) {
+		path = dirName;
+		path.Append(number);
+		path.Append(L".txt");
+		if(!File::IsFileExist(path)) {
+			break;
+		}
+		number++;
+	}
+
+	String text;
+	JoinTranslations(pTitles, text);
+	text.Append(art);
+	if(!art.IsEmpty() && !art.EndsWith(L"\n")) {
+		text.Append(L'\n');
+	}
+	return WriteText(path, text);
+}
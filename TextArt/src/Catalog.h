@@ -0,0 +1,49 @@
+#ifndef CATALOG_H_
+#define CATALOG_H_
+
+#include "Port.h"
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+
+/**
+ * Reads the art catalog from /Home/catalog. Every category is a directory
+ * with a category.info (title line, description line, preview art) and one
+ * file per item (title line, art). Title and description lines carry all
+ * languages separated by '|' in TextPic::InternalAppLanguageEnum order.
+ * Items made on the device are written back in the same format.
+ * No UI dependencies, builds on the host through Port.h.
+ */
+class Catalog {
+public:
+	static const int LANGUAGE_COUNT = 4;
+
+	// Cuts the column of the given language out of a '|' separated line
+	static result GetTranslated(String& fullString, int language);
+	// Every column at once, same fallback as GetTranslated, untranslated ones are empty
+	static void GetTranslations(const String& fullString, String* pTranslations);
+
+	// Whole file decoded as UTF-8 in a single read, byte order mark dropped
+	static result ReadText(const String& path, String& text);
+
+	static result ReadCategory(const String& name, int language, String& title, String& desc, String& preview);
+	static result ReadItem(const String& path, int language, String& title, String& art, int& linecount);
+	// All languages, titles and descs hold LANGUAGE_COUNT strings
+	static result ReadCategory(const String& name, String* pTitles, String* pDescs, String& preview);
+	static result ReadItem(const String& path, String* pTitles, String& art, int& linecount);
+	// Art is read without '\r' and blanks at line ends, so copies of one body compare equal
+	static unsigned int HashArt(const mchar* pArt, int length);
+
+	// Writes category.info unless the category exists already
+	static result CreateCategory(const String& name, const String* pTitles, const String* pDescs, const String& preview);
+	// Adds the art under the next free number of the category, path receives the new file
+	static result WriteItem(const String& name, const String* pTitles, const String& art, String& path);
+
+	// Category directory names and item file paths in directory order
+	static result GetCategories(ArrayList& names);
+	static result GetItems(const String& name, ArrayList& paths);
+
+	static void GetCategoryPath(const String& name, String& path);
+};
+
+#endif
@@ -0,0 +1,393 @@
+#include "CatalogWatcher.h"
+
+#include "Catalog.h"
+#include "Debug.h"
+
+#include <stdlib.h>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+using namespace Osp::Io;
+
+static const wchar_t* CATEGORY_INFO = L"category.info";
+
+static const int MIN_CATEGORY_CAPACITY = 16;
+static const int MIN_ENTRY_CAPACITY = 16;
+static const int MIN_NAME_CAPACITY = 256;
+
+static const unsigned int FNV_OFFSET = 2166136261u;
+static const unsigned int FNV_PRIME = 16777619u;
+
+static inline unsigned int
+HashString(unsigned int hash, const mchar* pValue)
+{
+	for(; *pValue != 0; pValue++) {
+		hash = (hash ^ (*pValue & 0xFFFF)) * FNV_PRIME;
+	}
+	return hash;
+}
+
+static inline unsigned int
+HashValue(unsigned int hash, long long value)
+{
+	for(int i = 0; i < 8; i++) {
+		hash = (hash ^ (unsigned int)(value & 0xFF)) * FNV_PRIME;
+		value >>= 8;
+	}
+	return hash;
+}
+
+static bool
+Equals(const mchar* pLeft, const mchar* pRight)
+{
+	for(; *pLeft != 0 && *pLeft == *pRight; pLeft++, pRight++) {
+	}
+	return *pLeft == *pRight;
+}
+
+static int
+CompareEntries(const void* pLeft, const void* pRight)
+{
+	// hash is the first member
+	unsigned int left = *static_cast<const unsigned int*>(pLeft);
+	unsigned int right = *static_cast<const unsigned int*>(pRight);
+	return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+// CatalogChange
+
+CatalogChange::CatalogChange(Kind kind, const String& name):
+	kind(kind),
+	name(name),
+	infoChanged(false)
+{
+	items.Construct();
+	removedItems.Construct();
+}
+
+CatalogChange::~CatalogChange()
+{
+	items.RemoveAll(true);
+	removedItems.RemoveAll(true);
+}
+
+// CatalogWatcher
+
+CatalogWatcher::CatalogWatcher():
+	__pCategories(null),
+	__categoryCount(0),
+	__categoryCapacity(0),
+	__recorded(false)
+{
+}
+
+CatalogWatcher::~CatalogWatcher()
+{
+	for(int i = 0; i < __categoryCount; i++) {
+		FreeCategory(__pCategories[i]);
+	}
+	delete[] __pCategories;
+}
+
+int
+CatalogWatcher::GetEntryCount(void) const
+{
+	int count = 0;
+	for(int i = 0; i < __categoryCount; i++) {
+		count += __pCategories[i].entryCount;
+	}
+	return count;
+}
+
+result
+CatalogWatcher::Record(void)
+{
+	return Update(null);
+}
+
+result
+CatalogWatcher::Scan(ArrayList& changes)
+{
+	return Update(__recorded ? &changes : null);
+}
+
+result
+CatalogWatcher::Update(ArrayList* pChanges)
+{
+	PROFILE_SCOPE("CatalogWatcher::Update");
+	ArrayList names;
+	names.Construct();
+	result r = Catalog::GetCategories(names);
+	if(IsFailed(r)) {
+		AppLog("Listing the catalog failed by %s", GetErrorMessage(r));
+		return r;
+	}
+
+	for(int i = 0; i < __categoryCount; i++) {
+		__pCategories[i].seen = false;
+	}
+
+	for(int n = 0; n < names.GetCount(); n++) {
+		const String& name = *static_cast<String*>(names.GetAt(n));
+		Category category;
+		r = ReadCategory(name, category);
+		if(IsFailed(r)) {
+			// Gone between the listing and the read, the next scan sees it
+			FreeCategory(category);
+			r = E_SUCCESS;
+			continue;
+		}
+
+		int index = FindCategory(name);
+		if(index < 0) {
+			if(pChanges != null) {
+				pChanges->Add(*(new CatalogChange(CatalogChange::CATEGORY_ADDED, name)));
+			}
+			r = AddCategory(name, category);
+			if(IsFailed(r)) {
+				FreeCategory(category);
+				break;
+			}
+			continue;
+		}
+
+		Category& before = __pCategories[index];
+		before.seen = true;
+		if(before.fingerprint == category.fingerprint && before.entryCount == category.entryCount) {
+			FreeCategory(category);
+			continue;
+		}
+		if(pChanges != null) {
+			CatalogChange* pChange = new CatalogChange(CatalogChange::CATEGORY_CHANGED, name);
+			Compare(before, category, *pChange);
+			pChanges->Add(*pChange);
+		}
+		FreeCategory(before);
+		before.pEntries = category.pEntries;
+		before.entryCount = category.entryCount;
+		before.pNames = category.pNames;
+		before.fingerprint = category.fingerprint;
+	}
+	names.RemoveAll(true);
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	for(int i = __categoryCount - 1; i >= 0; i--) {
+		if(!__pCategories[i].seen) {
+			if(pChanges != null) {
+				pChanges->Add(*(new CatalogChange(CatalogChange::CATEGORY_REMOVED, __pCategories[i].name)));
+			}
+			RemoveCategory(i);
+		}
+	}
+	__recorded = true;
+	return E_SUCCESS;
+}
+
+int
+CatalogWatcher::FindCategory(const String& name) const
+{
+	for(int i = 0; i < __categoryCount; i++) {
+		if(__pCategories[i].name.Equals(name, true)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+result
+CatalogWatcher::AddCategory(const String& name, Category& category)
+{
+	if(__categoryCount == __categoryCapacity) {
+		int capacity = __categoryCapacity > 0 ? __categoryCapacity * 2 : MIN_CATEGORY_CAPACITY;
+		Category* pCategories = new Category[capacity];
+		if(pCategories == null) {
+			return E_OUT_OF_MEMORY;
+		}
+		for(int i = 0; i < __categoryCount; i++) {
+			pCategories[i] = __pCategories[i];
+		}
+		delete[] __pCategories;
+		__pCategories = pCategories;
+		__categoryCapacity = capacity;
+	}
+	category.name = name;
+	category.seen = true;
+	__pCategories[__categoryCount++] = category;
+	return E_SUCCESS;
+}
+
+void
+CatalogWatcher::RemoveCategory(int index)
+{
+	FreeCategory(__pCategories[index]);
+	for(int i = index + 1; i < __categoryCount; i++) {
+		__pCategories[i - 1] = __pCategories[i];
+	}
+	__categoryCount--;
+}
+
+result
+CatalogWatcher::ReadCategory(const String& name, Category& category)
+{
+	category.fingerprint = FNV_OFFSET;
+	category.pEntries = null;
+	category.entryCount = 0;
+	category.pNames = null;
+	category.seen = false;
+
+	String dirName;
+	Catalog::GetCategoryPath(name, dirName);
+	Directory dir;
+	result r = dir.Construct(dirName);
+	if(IsFailed(r)) {
+		return r;
+	}
+	DirEnumerator* pDirEnum = dir.ReadN();
+	if(pDirEnum == null) {
+		return GetLastResult();
+	}
+
+	int entryCapacity = 0;
+	int nameLength = 0;
+	int nameCapacity = 0;
+	while(pDirEnum->MoveNext() == E_SUCCESS) {
+		DirEntry& dirEntry = pDirEnum->GetCurrentDirEntry();
+		if(!dirEntry.IsNomalFile()) {
+			continue;
+		}
+		String entryName = dirEntry.GetName();
+		int length = entryName.GetLength() + 1;
+
+		if(category.entryCount == entryCapacity) {
+			int capacity = entryCapacity > 0 ? entryCapacity * 2 : MIN_ENTRY_CAPACITY;
+			Entry* pEntries = new Entry[capacity];
+			if(pEntries == null) {
+				r = E_OUT_OF_MEMORY;
+				break;
+			}
+			for(int i = 0; i < category.entryCount; i++) {
+				pEntries[i] = category.pEntries[i];
+			}
+			delete[] category.pEntries;
+			category.pEntries = pEntries;
+			entryCapacity = capacity;
+		}
+		if(nameLength + length > nameCapacity) {
+			int capacity = nameCapacity > 0 ? nameCapacity * 2 : MIN_NAME_CAPACITY;
+			while(capacity < nameLength + length) {
+				capacity *= 2;
+			}
+			mchar* pNames = new mchar[capacity];
+			if(pNames == null) {
+				r = E_OUT_OF_MEMORY;
+				break;
+			}
+			for(int i = 0; i < nameLength; i++) {
+				pNames[i] = category.pNames[i];
+			}
+			delete[] category.pNames;
+			category.pNames = pNames;
+			nameCapacity = capacity;
+		}
+
+		Entry& entry = category.pEntries[category.entryCount++];
+		const mchar* pName = entryName.GetPointer();
+		for(int i = 0; i < length; i++) {
+			category.pNames[nameLength + i] = pName[i];
+		}
+		entry.name = nameLength;
+		entry.hash = HashString(FNV_OFFSET, pName);
+		entry.size = dirEntry.GetFileSize();
+		entry.modified = dirEntry.GetDateTime().GetTime().GetTicks();
+		nameLength += length;
+	}
+	delete pDirEnum;
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	qsort(category.pEntries, category.entryCount, sizeof(Entry), CompareEntries);
+	for(int i = 0; i < category.entryCount; i++) {
+		const Entry& entry = category.pEntries[i];
+		unsigned int hash = (category.fingerprint ^ entry.hash) * FNV_PRIME;
+		hash = HashValue(hash, entry.size);
+		category.fingerprint = HashValue(hash, entry.modified);
+	}
+	return E_SUCCESS;
+}
+
+void
+CatalogWatcher::FreeCategory(Category& category)
+{
+	delete[] category.pEntries;
+	delete[] category.pNames;
+	category.pEntries = null;
+	category.pNames = null;
+	category.entryCount = 0;
+}
+
+void
+CatalogWatcher::Compare(const Category& before, const Category& after, CatalogChange& change)
+{
+	String dirName;
+	Catalog::GetCategoryPath(change.name, dirName);
+
+	// Both sides are sorted by hash, a run of one hash is matched by name
+	int i = 0;
+	int j = 0;
+	while(i < before.entryCount || j < after.entryCount) {
+		unsigned int hash;
+		if(j >= after.entryCount || (i < before.entryCount && before.pEntries[i].hash < after.pEntries[j].hash)) {
+			hash = before.pEntries[i].hash;
+		} else {
+			hash = after.pEntries[j].hash;
+		}
+		int beforeEnd = i;
+		while(beforeEnd < before.entryCount && before.pEntries[beforeEnd].hash == hash) {
+			beforeEnd++;
+		}
+		int afterEnd = j;
+		while(afterEnd < after.entryCount && after.pEntries[afterEnd].hash == hash) {
+			afterEnd++;
+		}
+
+		for(int a = j; a < afterEnd; a++) {
+			const Entry& entry = after.pEntries[a];
+			const mchar* pName = after.pNames + entry.name;
+			int b = i;
+			while(b < beforeEnd && !Equals(before.pNames + before.pEntries[b].name, pName)) {
+				b++;
+			}
+			if(b < beforeEnd && before.pEntries[b].size == entry.size && before.pEntries[b].modified == entry.modified) {
+				continue;
+			}
+			if(Equals(pName, CATEGORY_INFO)) {
+				change.infoChanged = true;
+			} else {
+				AddPath(dirName, pName, change.items);
+			}
+		}
+		for(int b = i; b < beforeEnd; b++) {
+			const mchar* pName = before.pNames + before.pEntries[b].name;
+			int a = j;
+			while(a < afterEnd && !Equals(after.pNames + after.pEntries[a].name, pName)) {
+				a++;
+			}
+			if(a == afterEnd && !Equals(pName, CATEGORY_INFO)) {
+				AddPath(dirName, pName, change.removedItems);
+			}
+		}
+		i = beforeEnd;
+		j = afterEnd;
+	}
+}
+
+void
+CatalogWatcher::AddPath(const String& dir, const mchar* pName, ArrayList& paths)
+{
+	String* pPath = new String(dir);
+	pPath->Append(pName);
+	paths.Add(*pPath);
+}
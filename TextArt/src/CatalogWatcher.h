@@ -0,0 +1,94 @@
+#ifndef CATALOGWATCHER_H_
+#define CATALOGWATCHER_H_
+
+#include "Port.h"
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+
+/**
+ * What happened to one category between two scans of the CatalogWatcher.
+ * The item lists hold full file paths as String and are only filled for
+ * CATEGORY_CHANGED; category.info is never among them, infoChanged tells
+ * whether it was rewritten.
+ */
+class CatalogChange : public Object {
+public:
+	enum Kind {
+		CATEGORY_ADDED,
+		CATEGORY_CHANGED,
+		CATEGORY_REMOVED
+	};
+
+	CatalogChange(Kind kind, const String& name);
+	virtual ~CatalogChange();
+
+	Kind kind;
+	String name;
+	bool infoChanged;
+	// Item files that are new or were rewritten
+	ArrayList items;
+	ArrayList removedItems;
+};
+
+/**
+ * Notices catalog content that arrived while the application was away, such
+ * as a content pack copied onto the memory card. Every category keeps the
+ * name, size and modification time of its files and a fingerprint over
+ * them. A scan lists the directories again without opening a file, and only
+ * categories whose fingerprint moved are compared entry by entry. Not thread
+ * safe, FormManager only calls it from tasks on TaskScheduler::STRAND_INDEX.
+ */
+class CatalogWatcher {
+public:
+	CatalogWatcher();
+	~CatalogWatcher();
+
+	// Takes the present catalog as the state later scans compare against
+	result Record(void);
+	bool IsRecorded(void) const { return __recorded; }
+	// Appends a CatalogChange per category added, changed or removed since the last record or scan, then records
+	result Scan(ArrayList& changes);
+
+	int GetCategoryCount(void) const { return __categoryCount; }
+	int GetEntryCount(void) const;
+
+private:
+	struct Entry {
+		unsigned int hash;
+		// Offset of the null terminated file name in the names of the category
+		int name;
+		long long size;
+		long long modified;
+	};
+
+	// Entries sorted by name hash
+	struct Category {
+		String name;
+		unsigned int fingerprint;
+		Entry* pEntries;
+		int entryCount;
+		mchar* pNames;
+		bool seen;
+	};
+
+	result Update(ArrayList* pChanges);
+	int FindCategory(const String& name) const;
+	result AddCategory(const String& name, Category& category);
+	void RemoveCategory(int index);
+
+	static result ReadCategory(const String& name, Category& category);
+	static void FreeCategory(Category& category);
+	static void Compare(const Category& before, const Category& after, CatalogChange& change);
+	static void AddPath(const String& dir, const mchar* pName, ArrayList& paths);
+
+	CatalogWatcher(const CatalogWatcher& watcher);
+	CatalogWatcher& operator =(const CatalogWatcher& watcher);
+
+	Category* __pCategories;
+	int __categoryCount;
+	int __categoryCapacity;
+	bool __recorded;
+};
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef CATEGORYITEMFORM_H_
 #define CATEGORYITEMFORM_H_
 
+#include "Catalog.h"
 #include "ItemListForm.h"
 
 #include <FBase.h>
@@ -15,22 +16,30 @@ public:
 	CategoryItemForm();
 	virtual ~CategoryItemForm();
 
-	bool Initialize(String t, String d);
+	// titles of the category in every language
+	bool Initialize(const String* pTitles, const String& d);
+
+	// Catalog directory name of the category listed
+	const String& GetCategory(void) const { return dir; }
+
+	// Patches the list when the category is among the CatalogChange objects
+	void OnCatalogChanged(const Osp::Base::Collection::ArrayList& changes);
 
 private:
 	static const int SOFTKEY_BACK = 101;
 	static const int SOFTKEY_INFO = 102;
 
 	String dir;
+	String __titles[Catalog::LANGUAGE_COUNT];
 	Osp::Ui::Controls::Footer* __pFooter;
 
-	result ReadCustomListItems();
 
 public:
 	virtual result OnInitializing(void);
 	virtual result OnTerminating(void);
 
 	virtual void OnActionPerformed(const Osp::Ui::Control& source, int actionId);
+	virtual void OnLanguageChanged(void);
 	virtual void OnFormBackRequested(Osp::Ui::Controls::Form& source);
 };
 
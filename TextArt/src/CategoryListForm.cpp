@@ -2,37 +2,328 @@
 #include "FormManager.h"
 
 #include "AnciiListElement.h"
+#include "ArtConverter.h"
+#include "ArtExporter.h"
+#include "Catalog.h"
+#include "CatalogWatcher.h"
 #include "Retina.h"
 #include "Helper.h"
+#include "SearchIndex.h"
+#include "SimilarityIndex.h"
+#include "StartSnapshot.h"
 #include "TabsForm.h"
+#include "Debug.h"
 
-#include <FIoDirectory.h>
-#include <FIoFile.h>
 #include <FGrpFont.h>
 #include <FApp.h>
+#include <FIo.h>
+#include <FMedia.h>
 #include <TextPic.h>
 
 using namespace Osp::Base;
 using namespace Osp::Ui;
 using namespace Osp::Ui::Controls;
 using namespace Osp::App;
-using namespace Osp::Io;
 using namespace Osp::Graphics;
 using namespace Osp::App;
+using namespace Osp::Media;
+
+// Language names stay untranslated so everybody finds their own
+static const wchar_t* LANGUAGE_NAMES[] = { L"Рус", L"Eng", L"Deu", L"Fra" };
+
+// Catalog category the converted pictures go to, created with the first one
+static const wchar_t* PHOTO_CATEGORY = L"photos";
+static const wchar_t* PHOTO_TITLES[] = { L"Мои фото", L"My photos", L"Meine Fotos", L"Mes photos" };
+static const wchar_t* PHOTO_DESCS[] = { L"Арт из снимков галереи", L"Art from gallery pictures", L"Kunst aus Galeriebildern", L"Art des photos de la galerie" };
+static const wchar_t* PHOTO_PREVIEW = L"  .---.\n [ (o) ]\n  '---'\n";
+
+// Glyphs the converter may pick from, their coverage is measured in the list font
+static const wchar_t* CONVERTER_GLYPHS = L" .,:;'-~=+*!il1tfjrxnuvczoaewmXYUJCLQ0OZ#%&8@$B";
+// Decoded pictures are scaled down into this box first
+static const int MAX_DECODE_SIZE = 480;
+// Width of the art element of CategoryItemForm
+static const int ART_WIDTH = 230;
+
+// Reads the search index on a worker, or builds it from the catalog when there is none
+class SearchIndexTask :
+	public ITask
+{
+public:
+	SearchIndexTask(CategoryListForm& form):
+		__form(form),
+		__pIndex(new SearchIndex())
+	{
+	}
+
+	~SearchIndexTask()
+	{
+		delete __pIndex;
+	}
+
+	result Run(const CancelToken& token)
+	{
+		PROFILE_SCOPE("SearchIndexTask::Run");
+		String path;
+		SearchIndex::GetDefaultPath(path);
+		result r = __pIndex->Load(path);
+		if(IsFailed(r) && !token.IsCancelled()) {
+			// first search after installation or an import reads the whole catalog once
+			r = __pIndex->Build();
+			// cancelled by a catalog change, the file it would write is already stale
+			if(!IsFailed(r) && !token.IsCancelled()) {
+				__pIndex->Save(path);
+			}
+		}
+		return r;
+	}
+
+	void OnTaskCompleted(result r)
+	{
+		__form.__searchTask = 0;
+		if(IsFailed(r)) {
+			AppLog("Search index not loaded by %s", GetErrorMessage(r));
+		} else {
+			delete __form.__pSearchIndex;
+			__form.__pSearchIndex = __pIndex;
+			__pIndex = null;
+		}
+		// the query typed meanwhile, or no results when the index failed
+		__form.ShowSearchResults();
+	}
+
+private:
+	CategoryListForm& __form;
+	SearchIndex* __pIndex;
+};
+
+// Builds both indexes again after the catalog's items changed
+class IndexBuildTask :
+	public ITask
+{
+public:
+	IndexBuildTask(CategoryListForm& form):
+		__form(form),
+		__pSearchIndex(new SearchIndex()),
+		__pSimilarityIndex(new SimilarityIndex())
+	{
+	}
+
+	~IndexBuildTask()
+	{
+		delete __pSearchIndex;
+		delete __pSimilarityIndex;
+	}
+
+	result Run(const CancelToken& token)
+	{
+		PROFILE_SCOPE("IndexBuildTask::Run");
+		String searchPath;
+		String similarPath;
+		SearchIndex::GetDefaultPath(searchPath);
+		SimilarityIndex::GetDefaultPath(similarPath);
+		// an exit before the new files are in leaves none stale for the next start
+		Osp::Io::File::Remove(searchPath);
+		Osp::Io::File::Remove(similarPath);
+
+		result r = __pSearchIndex->Build();
+		if(!IsFailed(r) && !token.IsCancelled()) {
+			__pSearchIndex->Save(searchPath);
+			r = __pSimilarityIndex->Build();
+		}
+		if(!IsFailed(r) && !token.IsCancelled()) {
+			__pSimilarityIndex->Save(similarPath);
+		}
+		return r;
+	}
+
+	void OnTaskCompleted(result r)
+	{
+		__form.__indexTask = 0;
+		if(IsFailed(r)) {
+			AppLog("Indexes not built by %s", GetErrorMessage(r));
+		} else {
+			delete __form.__pSearchIndex;
+			__form.__pSearchIndex = __pSearchIndex;
+			__pSearchIndex = null;
+			FormManager::SetSimilarityIndex(__pSimilarityIndex);
+			__pSimilarityIndex = null;
+		}
+		__form.ShowSearchResults();
+	}
+
+private:
+	CategoryListForm& __form;
+	SearchIndex* __pSearchIndex;
+	SimilarityIndex* __pSimilarityIndex;
+};
+
+// Turns a gallery picture into an item of the photo category on a worker
+class ImportTask :
+	public ITask
+{
+public:
+	// Takes the form's converter, null before the first import, and gives it back on completion
+	ImportTask(CategoryListForm& form, const String& path, ArtConverter* pConverter):
+		__form(form),
+		__path(path),
+		__pConverter(pConverter),
+		__categoryCreated(false)
+	{
+	}
+
+	~ImportTask()
+	{
+		delete __pConverter;
+	}
+
+	result Run(const CancelToken& token)
+	{
+		PROFILE_SCOPE("ImportTask::Run");
+		int fontSize = Retina::GetInt(ArtExporter::DEFAULT_FONT_SIZE);
+		result r = E_SUCCESS;
+
+		// The ramp follows the font the art is shown in, measured once
+		if(__pConverter == null) {
+			const mchar* pGlyphs = CONVERTER_GLYPHS;
+			int count = String(CONVERTER_GLYPHS).GetLength();
+			int* pCoverage = new int[count];
+			__pConverter = new ArtConverter();
+			r = ArtExporter::MeasureCoverage(fontSize, pGlyphs, count, pCoverage);
+			if(IsFailed(r) || IsFailed(__pConverter->Construct(pGlyphs, pCoverage, count))) {
+				AppLog("Glyph coverage not measured, default ramp used");
+				r = __pConverter->Construct();
+			}
+			delete[] pCoverage;
+		}
+
+		Image image;
+		r = image.Construct();
+		if(IsFailed(r)) {
+			return r;
+		}
+		Bitmap* pBitmap = image.DecodeN(__path, BITMAP_PIXEL_FORMAT_ARGB8888, MAX_DECODE_SIZE, MAX_DECODE_SIZE);
+		if(pBitmap == null) {
+			return GetLastResult();
+		}
+
+		// As many columns as average glyphs fit into the art element
+		Font font;
+		font.Construct(FONT_STYLE_PLAIN, fontSize);
+		Dimension cell;
+		font.GetTextExtent(L"o", 1, cell);
+		int columns = cell.width > 0 ? Retina::GetInt(ART_WIDTH) / cell.width : ArtConverter::DEFAULT_COLUMNS;
+
+		String art;
+		int linecount = 0;
+		BufferInfo info;
+		r = pBitmap->Lock(info);
+		if(!IsFailed(r)) {
+			r = __pConverter->Convert(static_cast<const unsigned int*>(info.pPixels), info.width, info.height,
+					info.pitch / (int)sizeof(unsigned int), columns, art, linecount);
+			pBitmap->Unlock();
+		}
+		delete pBitmap;
+		// the form went away, nobody waits for the item
+		if(IsFailed(r) || token.IsCancelled()) {
+			return r;
+		}
+
+		// The picture's file name is the title in every language
+		String name;
+		int slash = -1;
+		int dot = -1;
+		__path.LastIndexOf(L'/', __path.GetLength() - 1, slash);
+		__path.LastIndexOf(L'.', __path.GetLength() - 1, dot);
+		if(dot <= slash) {
+			dot = __path.GetLength();
+		}
+		__path.SubString(slash + 1, dot - slash - 1, name);
+		String titles[Catalog::LANGUAGE_COUNT];
+		String descs[Catalog::LANGUAGE_COUNT];
+		for(int language = 0; language < Catalog::LANGUAGE_COUNT; language++) {
+			titles[language] = PHOTO_TITLES[language];
+			descs[language] = PHOTO_DESCS[language];
+		}
+		r = Catalog::CreateCategory(PHOTO_CATEGORY, titles, descs, PHOTO_PREVIEW);
+		if(IsFailed(r)) {
+			return r;
+		}
+		__categoryCreated = true;
+		for(int language = 0; language < Catalog::LANGUAGE_COUNT; language++) {
+			titles[language] = name;
+		}
+		return Catalog::WriteItem(PHOTO_CATEGORY, titles, art, __itemPath);
+	}
 
-CategoryListForm::CategoryListForm(void) {}
+	void OnTaskCompleted(result r)
+	{
+		__form.__importTask = 0;
+		__form.__pConverter = __pConverter;
+		__pConverter = null;
+		if(__categoryCreated) {
+			StartSnapshot::Invalidate();
+		}
+		if(IsFailed(r)) {
+			AppLog("Import failed by %s", GetErrorMessage(r));
+			return;
+		}
+
+		__form.RebuildIndexes();
+
+		// A new category shows up here, the new item in the category opened next
+		__form.CategoryList->RemoveAllItems();
+		__form.ReleaseCategories();
+		__form.LoadCategories();
+		__form.AddCategoryItems();
+
+		// a user who went on to another form meanwhile finds the item in its category
+		if(Application::GetInstance()->GetAppFrame()->GetFrame()->GetCurrentForm() == &__form) {
+			FormManager::Navigate(FormManager::REQUEST_ITEMLIST, PHOTO_CATEGORY, __itemPath);
+		}
+	}
+
+private:
+	CategoryListForm& __form;
+	String __path;
+	ArtConverter* __pConverter;
+	bool __categoryCreated;
+	String __itemPath;
+};
+
+CategoryListForm::CategoryListForm(void):
+	__pCategories(null),
+	__categoryCount(0),
+	__pImportPreview(null),
+	__pConverter(null),
+	__importTask(0),
+	__pFooter(null),
+	__pSearchBar(null),
+	__pResultList(null),
+	__pResultFormat(null),
+	__pSearchIndex(null),
+	__searchTask(0),
+	__indexTask(0)
+{}
 
 CategoryListForm::~CategoryListForm(void) {}
 
 bool
 CategoryListForm::Initialize()
 {
-	TabsForm::Initialize(FORM_STYLE_INDICATOR | FORM_STYLE_TEXT_TAB | FORM_STYLE_TITLE, TabsForm::CATEGORY_TAB);
+	TabsForm::Initialize(FORM_STYLE_INDICATOR | FORM_STYLE_TEXT_TAB | FORM_STYLE_TITLE | FORM_STYLE_FOOTER, TabsForm::CATEGORY_TAB);
 
-	SetTitleText(Helper::GetTraslation("IDS_TITLE"));
+	SetTitleText(Helper::GetTraslation(IDS_TITLE));
 
-	list.Construct();
-	titlelist.Construct();
+	__pFooter = GetFooter();
+	__pFooter->SetStyle(FOOTER_STYLE_SEGMENTED_TEXT);
+	for(int language = 0; language < Catalog::LANGUAGE_COUNT; language++) {
+		FooterItem item;
+		item.Construct(ACTION_LANGUAGE + language);
+		item.SetText(LANGUAGE_NAMES[language]);
+		__pFooter->AddItem(item);
+	}
+	__pFooter->SetItemSelected(TextPic::__InternalAppLanguageIndex);
+	__pFooter->AddActionEventListener(*this);
 
 	return true;
 }
@@ -40,106 +331,293 @@ CategoryListForm::Initialize()
 result
 CategoryListForm::OnInitializing(void)
 {
+	PROFILE_SCOPE("CategoryListForm::OnInitializing");
 	Rectangle rect = this->GetClientAreaBounds();
 
 	result r = E_SUCCESS;
 	TabsForm::OnInitializing();
 
+	int barHeight = Retina::GetSize(Retina::SIZE_SEARCH_BAR);
+	__pSearchBar = new SearchBar();
+	__pSearchBar->Construct(Rectangle(0, 0, this->GetWidth(), barHeight));
+	__pSearchBar->SetGuideText(Helper::GetTraslation(IDS_SEARCH));
+	__pSearchBar->AddSearchBarEventListener(*this);
+	__pSearchBar->AddTextEventListener(*this);
+
+	// Title of the item, its category below
+	__pResultFormat = new CustomListItemFormat();
+	__pResultFormat->Construct();
+	__pResultFormat->AddElement(LIST_ELEMENT_TITLE, Retina::GetRect(Retina::RECT_RESULT_TITLE),
+			Retina::GetSize(Retina::SIZE_RESULT_TITLE_FONT), Color(9,86,126), Osp::Ui::Controls::SYSTEM_COLOR_LIST_ITEM_PRESSED_TEXT);
+	__pResultFormat->AddElement(LIST_ELEMENT_CATEGORY, Retina::GetRect(Retina::RECT_RESULT_CATEGORY),
+			Retina::GetSize(Retina::SIZE_RESULT_CATEGORY_FONT), Color(151,151,151), Osp::Ui::Controls::SYSTEM_COLOR_LIST_ITEM_PRESSED_TEXT);
+
+	__pResultList = new CustomList();
+	__pResultList->Construct(Rectangle(0, 0, this->GetWidth(), rect.height - barHeight), CUSTOM_LIST_STYLE_NORMAL);
+	__pResultList->SetBackgroundColor(Color(239,239,239));
+	__pResultList->AddCustomItemEventListener(*this);
+	__pSearchBar->SetContent(__pResultList);
+
 	CategoryList = new CustomList();
-	CategoryList->Construct(Rectangle(0, 0, this->GetWidth(), rect.height), CUSTOM_LIST_STYLE_NORMAL);
+	CategoryList->Construct(Rectangle(0, barHeight, this->GetWidth(), rect.height - barHeight), CUSTOM_LIST_STYLE_NORMAL);
 	CategoryList->SetBackgroundColor(Color(239,239,239));
 	CategoryList->AddCustomItemEventListener(*this);
 
 	// Category element format
 	pCustomListItemFormat = new CustomListItemFormat();
 	pCustomListItemFormat->Construct();
-	pCustomListItemFormat->AddElement(LIST_ELEMENT_ANCII, Rectangle(Retina::GetInt(5), Retina::GetInt(5), Retina::GetInt(100), Retina::GetInt(65)));
-	pCustomListItemFormat->AddElement(LIST_ELEMENT_TITLE, Rectangle(Retina::GetInt(105), Retina::GetInt(5), Retina::GetInt(130), Retina::GetInt(20)),
-			Retina::GetInt(20), Color(9,86,126), Osp::Ui::Controls::SYSTEM_COLOR_LIST_ITEM_PRESSED_TEXT);
-	pCustomListItemFormat->AddElement(LIST_ELEMENT_DESC, Rectangle(Retina::GetInt(105), Retina::GetInt(30), Retina::GetInt(130), Retina::GetInt(45)),
-			Retina::GetInt(12), Color(151,151,151), Osp::Ui::Controls::SYSTEM_COLOR_LIST_ITEM_PRESSED_TEXT);
-
-
-	String dirName(L"/Home/catalog");
-	Directory* pDir;
-	DirEnumerator* pDirEnum;
+	pCustomListItemFormat->AddElement(LIST_ELEMENT_ANCII, Retina::GetRect(Retina::RECT_CATEGORY_ART));
+	pCustomListItemFormat->AddElement(LIST_ELEMENT_TITLE, Retina::GetRect(Retina::RECT_CATEGORY_TITLE),
+			Retina::GetSize(Retina::SIZE_CATEGORY_TITLE_FONT), Color(9,86,126), Osp::Ui::Controls::SYSTEM_COLOR_LIST_ITEM_PRESSED_TEXT);
+	pCustomListItemFormat->AddElement(LIST_ELEMENT_DESC, Retina::GetRect(Retina::RECT_CATEGORY_DESC),
+			Retina::GetSize(Retina::SIZE_CATEGORY_DESC_FONT), Color(151,151,151), Osp::Ui::Controls::SYSTEM_COLOR_LIST_ITEM_PRESSED_TEXT);
 
-	pDir = new Directory; // allocate Directory instance
 
-	// Open directory
-	r = pDir->Construct(dirName);
+	String preview(PHOTO_PREVIEW);
+	__pImportPreview = new AnciiListElement(preview, Retina::GetSize(Retina::SIZE_CATEGORY_PREVIEW_FONT));
+	r = LoadCategories();
 
-	// Read all directory entries
-	pDirEnum = pDir->ReadN();
-
-	String contentType;
-	int i = 0;
-	while(pDirEnum->MoveNext() == E_SUCCESS) {
-		DirEntry dirEntry = pDirEnum->GetCurrentDirEntry();
-		if(dirEntry.IsDirectory()) {
-			//AppLog("%S", dirEntry.GetName().GetPointer());
-			if(!dirEntry.GetName().Equals(".", false) && !dirEntry.GetName().Equals("..", false)) {
-
-				String fileName(dirName+"/"+dirEntry.GetName()+"/category.info");
-				File file;
-				file.Construct(fileName, L"r+");
+	AddCategoryItems();
+	this->AddControl(*CategoryList);
+	this->AddControl(*__pSearchBar);
 
-				String title, desc;
-				String iTempStr, iTempStr2;
-				file.Read(title);
-				file.Read(desc);
-				result err = TextPic::GetTranslated(title);
-				if (IsFailed(err)) {
-					continue;
-				}
-				
-				list.Add(*(new String(dirEntry.GetName())));
-				
-				TextPic::GetTranslated(desc);
+	PROFILE_COUNT("categories", __categoryCount);
+	PROFILE_MEMORY("memory");
+	return r;
+}
 
-				title.Replace("\n", "");
-				desc.Replace("\n", "");
-				
+result
+CategoryListForm::LoadCategories(void)
+{
+	ArrayList names;
+	names.Construct();
+	result r = Catalog::GetCategories(names);
+
+	__pCategories = new Category[names.GetCount() > 0 ? names.GetCount() : 1];
+	__categoryCount = 0;
+	for(int n = 0; n < names.GetCount(); n++) {
+		Category& category = __pCategories[__categoryCount];
+		category.name = *(static_cast<String*>(names.GetAt(n)));
+
+		String preview;
+		if(IsFailed(Catalog::ReadCategory(category.name, category.titles, category.descs, preview))) {
+			continue;
+		}
+		category.pPreview = new AnciiListElement(preview, Retina::GetSize(Retina::SIZE_CATEGORY_PREVIEW_FONT));
+		__categoryCount++;
+	}
+	names.RemoveAll(true);
+	return r;
+}
 
-				titlelist.Add(*(new String(title)));
+void
+CategoryListForm::ReleaseCategories(void)
+{
+	for(int i = 0; i < __categoryCount; i++) {
+		delete __pCategories[i].pPreview;
+	}
+	delete[] __pCategories;
+	__pCategories = null;
+	__categoryCount = 0;
+}
 
-				while(file.Read(iTempStr) != E_END_OF_FILE) {
-					iTempStr2.Append(iTempStr);
-				}
+void
+CategoryListForm::AddCategoryItems(void)
+{
+	int language = TextPic::__InternalAppLanguageIndex;
+
+	CustomListItem * importItem = new CustomListItem();
+	importItem->Construct(Retina::GetSize(Retina::SIZE_CATEGORY_ROW));
+	importItem->SetItemFormat(*pCustomListItemFormat);
+	importItem->SetElement(LIST_ELEMENT_TITLE, Helper::GetTraslation(IDS_FROMPHOTO));
+	importItem->SetElement(LIST_ELEMENT_DESC, Helper::GetTraslation(IDS_FROMPHOTODESC));
+	importItem->SetElement(LIST_ELEMENT_ANCII, *(static_cast<ICustomListElement *>(__pImportPreview)));
+	CategoryList->AddItem(*importItem, ITEM_IMPORT);
+
+	for(int i = 0; i < __categoryCount; i++) {
+		const Category& category = __pCategories[i];
+		// categories without a title in this language are hidden, as before
+		if(category.pPreview != null && !category.titles[language].IsEmpty()) {
+			CategoryList->AddItem(*CreateCategoryItem(category), i);
+		}
+	}
+}
 
-				//CategoryList->AddItem(&iTempStr, NULL, NULL, NULL, i++);
+CustomListItem*
+CategoryListForm::CreateCategoryItem(const Category& category) const
+{
+	int language = TextPic::__InternalAppLanguageIndex;
+	CustomListItem * newItem = new CustomListItem();
+	newItem->Construct(Retina::GetSize(Retina::SIZE_CATEGORY_ROW));
+	newItem->SetItemFormat(*pCustomListItemFormat);
+
+	newItem->SetElement(LIST_ELEMENT_TITLE, category.titles[language]);
+	newItem->SetElement(LIST_ELEMENT_DESC, category.descs[language]);
+	newItem->SetElement(LIST_ELEMENT_ANCII, *(static_cast<ICustomListElement *>(category.pPreview)));
+	return newItem;
+}
 
-				CustomListItem * newItem = new CustomListItem();
-				AnciiListElement * custom_element = new AnciiListElement(iTempStr2, Retina::GetInt(13));
+void
+CategoryListForm::OnCatalogChanged(const ArrayList& changes)
+{
+	PROFILE_SCOPE("CategoryListForm::OnCatalogChanged");
+	if(changes.GetCount() > 0) {
+		StartSnapshot::Invalidate();
+	}
+	bool itemsChanged = false;
+	for(int i = 0; i < changes.GetCount(); i++) {
+		const CatalogChange& change = *(static_cast<const CatalogChange*>(changes.GetAt(i)));
+		int index = FindCategory(change.name);
+		if(change.kind == CatalogChange::CATEGORY_REMOVED) {
+			if(index >= 0) {
+				RemoveCategory(index);
+			}
+		} else if(index < 0) {
+			// also a category whose category.info could not be read before
+			AddCategory(change.name);
+		} else if(change.infoChanged) {
+			ReloadCategory(index);
+		}
+		itemsChanged = itemsChanged || change.kind != CatalogChange::CATEGORY_CHANGED
+				|| change.items.GetCount() > 0 || change.removedItems.GetCount() > 0;
+	}
+	if(itemsChanged) {
+		RebuildIndexes();
+		ShowSearchResults();
+	}
+}
 
+result
+CategoryListForm::AddCategory(const String& name)
+{
+	// rare enough to grow by one, the slots keep their indexes
+	Category* pCategories = new Category[__categoryCount + 1];
+	for(int i = 0; i < __categoryCount; i++) {
+		pCategories[i] = __pCategories[i];
+	}
+	delete[] __pCategories;
+	__pCategories = pCategories;
+
+	Category& category = __pCategories[__categoryCount];
+	category.name = name;
+	category.pPreview = null;
+	__categoryCount++;
+	result r = ReloadCategory(__categoryCount - 1);
+	if(IsFailed(r)) {
+		__categoryCount--;
+	}
+	return r;
+}
 
-				newItem->Construct(Retina::GetInt(75));
-				newItem->SetItemFormat(*pCustomListItemFormat);
+result
+CategoryListForm::ReloadCategory(int index)
+{
+	Category& category = __pCategories[index];
+	String titles[Catalog::LANGUAGE_COUNT];
+	String descs[Catalog::LANGUAGE_COUNT];
+	String preview;
+	result r = Catalog::ReadCategory(category.name, titles, descs, preview);
+	if(IsFailed(r)) {
+		return r;
+	}
+	for(int language = 0; language < Catalog::LANGUAGE_COUNT; language++) {
+		category.titles[language] = titles[language];
+		category.descs[language] = descs[language];
+	}
+	// the list item shows the old preview until it is replaced
+	AnciiListElement* pOldPreview = category.pPreview;
+	category.pPreview = new AnciiListElement(preview, Retina::GetSize(Retina::SIZE_CATEGORY_PREVIEW_FONT));
+	ShowCategory(index);
+	delete pOldPreview;
+	return E_SUCCESS;
+}
 
-				newItem->SetElement(LIST_ELEMENT_TITLE, title);
-				newItem->SetElement(LIST_ELEMENT_DESC, desc);
-				newItem->SetElement(LIST_ELEMENT_ANCII, *(static_cast<ICustomListElement *>(custom_element)));
+void
+CategoryListForm::RemoveCategory(int index)
+{
+	Category& category = __pCategories[index];
+	AnciiListElement* pOldPreview = category.pPreview;
+	category.pPreview = null;
+	category.name.Clear();
+	ShowCategory(index);
+	delete pOldPreview;
+}
 
-				CategoryList->AddItem(*newItem, i++);
-			}
+void
+CategoryListForm::ShowCategory(int index)
+{
+	const Category& category = __pCategories[index];
+	int position = CategoryList->GetItemIndexFromItemId(index);
+	if(category.pPreview == null || category.titles[TextPic::__InternalAppLanguageIndex].IsEmpty()) {
+		if(position >= 0) {
+			CategoryList->RemoveItemAt(position);
 		}
+		return;
 	}
+	CustomListItem* pItem = CreateCategoryItem(category);
+	if(position >= 0) {
+		CategoryList->SetItemAt(position, *pItem, index);
+	} else {
+		CategoryList->AddItem(*pItem, index);
+	}
+}
 
-	this->AddControl(*CategoryList);
-
-	return r;
+void
+CategoryListForm::RebuildIndexes(void)
+{
+	// A load in flight reads the files the build replaces, the index it had stays
+	TaskScheduler::Cancel(__searchTask);
+	__searchTask = 0;
+	TaskScheduler::Cancel(__indexTask);
+	__indexTask = TaskScheduler::Post(new IndexBuildTask(*this), TaskScheduler::LANE_BACKGROUND, TaskScheduler::STRAND_INDEX);
 }
 
 result
 CategoryListForm::OnTerminating(void)
 {
 	result r = E_SUCCESS;
+	TaskScheduler::Cancel(__searchTask);
+	__searchTask = 0;
+	TaskScheduler::Cancel(__indexTask);
+	__indexTask = 0;
+	TaskScheduler::Cancel(__importTask);
+	__importTask = 0;
 	delete pCustomListItemFormat;
-	list.RemoveAll(true);
-	titlelist.RemoveAll(true);
+	delete __pResultFormat;
+	delete __pSearchIndex;
+	ReleaseCategories();
+	delete __pImportPreview;
+	delete __pConverter;
 	return r;
 }
 
+void
+CategoryListForm::OnActionPerformed(const Osp::Ui::Control& source, int actionId)
+{
+	if(actionId >= ACTION_LANGUAGE && actionId < ACTION_LANGUAGE + Catalog::LANGUAGE_COUNT) {
+		Frame *pFrame = Application::GetInstance()->GetAppFrame()->GetFrame();
+		FormManager *pFormMgr = static_cast<FormManager *>(pFrame->GetControl("FormManager"));
+		if (pFormMgr != null) {
+			pFormMgr->SendUserEvent(FormManager::REQUEST_LANGUAGE + actionId - ACTION_LANGUAGE, null);
+		}
+		return;
+	}
+	TabsForm::OnActionPerformed(source, actionId);
+}
+
+void
+CategoryListForm::OnLanguageChanged(void)
+{
+	TabsForm::OnLanguageChanged();
+	SetTitleText(Helper::GetTraslation(IDS_TITLE));
+	__pFooter->SetItemSelected(TextPic::__InternalAppLanguageIndex);
+	__pSearchBar->SetGuideText(Helper::GetTraslation(IDS_SEARCH));
+
+	CategoryList->RemoveAllItems();
+	AddCategoryItems();
+	ShowSearchResults();
+}
+
 void
 CategoryListForm::OnItemStateChanged(const Osp::Ui::Control& source, int index, int itemId, Osp::Ui::ItemStatus status)
 {
@@ -149,12 +627,168 @@ CategoryListForm::OnItemStateChanged(const Osp::Ui::Control& source, int index,
 void
 CategoryListForm::OnItemStateChanged(const Osp::Ui::Control& source, int index, int itemId, int elementId, Osp::Ui::ItemStatus status)
 {
-	Frame *pFrame = Application::GetInstance()->GetAppFrame()->GetFrame();
-	FormManager *pFormMgr = static_cast<FormManager *>(pFrame->GetControl("FormManager"));
-	if (pFormMgr != null) {
-		ArrayList* alist = new ArrayList();
-		alist->Add(*(static_cast<String*> (titlelist.GetAt(itemId))));
-		alist->Add(*(static_cast<String*> (list.GetAt(itemId))));
-		pFormMgr->SendUserEvent(FormManager::REQUEST_ITEMLIST, alist);
+	String item;
+	if(&source == __pResultList) {
+		// the searching row has no id
+		if(__pSearchIndex == null || itemId < 0) {
+			return;
+		}
+		// a search result opens the category holding it, scrolled to the item
+		__pSearchIndex->GetPath(itemId, item);
+		itemId = FindCategory(String(__pSearchIndex->GetCategory(itemId)));
+		if(itemId < 0) {
+			return;
+		}
+		__pSearchBar->SetMode(SEARCH_BAR_MODE_NORMAL);
+	} else if(itemId == ITEM_IMPORT) {
+		PickImage();
+		return;
+	}
+
+	FormManager::Navigate(FormManager::REQUEST_ITEMLIST, __pCategories[itemId].name, item);
+}
+
+bool
+CategoryListForm::GetCategoryTitles(const String& name, String* pTitles) const
+{
+	int index = FindCategory(name);
+	if(index < 0) {
+		return false;
+	}
+	for(int language = 0; language < Catalog::LANGUAGE_COUNT; language++) {
+		pTitles[language] = __pCategories[index].titles[language];
+	}
+	return true;
+}
+
+int
+CategoryListForm::FindCategory(const String& name) const
+{
+	for(int i = 0; i < __categoryCount; i++) {
+		if(__pCategories[i].name.Equals(name)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void
+CategoryListForm::LoadSearchIndex(void)
+{
+	// a build in progress hands its index over when it is done
+	if(__pSearchIndex != null || __searchTask != 0 || __indexTask != 0) {
+		return;
+	}
+	__searchTask = TaskScheduler::Post(new SearchIndexTask(*this), TaskScheduler::LANE_VISIBLE, TaskScheduler::STRAND_INDEX);
+}
+
+void
+CategoryListForm::ShowSearchResults(void)
+{
+	__pResultList->RemoveAllItems();
+
+	String query = __pSearchBar->GetText();
+	if(__pSearchIndex == null && (__searchTask != 0 || __indexTask != 0) && !query.IsEmpty()) {
+		CustomListItem * newItem = new CustomListItem();
+		newItem->Construct(Retina::GetSize(Retina::SIZE_RESULT_ROW));
+		newItem->SetItemFormat(*__pResultFormat);
+		newItem->SetElement(LIST_ELEMENT_TITLE, Helper::GetTraslation(IDS_SEARCHING));
+		newItem->SetElement(LIST_ELEMENT_CATEGORY, L"");
+		__pResultList->AddItem(*newItem);
+	} else if(__pSearchIndex != null && !query.IsEmpty()) {
+		int language = TextPic::__InternalAppLanguageIndex;
+		SearchIndex::Result results[MAX_SEARCH_RESULTS];
+		int count = __pSearchIndex->Search(query, language, results, MAX_SEARCH_RESULTS);
+		for(int i = 0; i < count; i++) {
+			int item = results[i].item;
+			// an untranslated item shows its first title
+			String title(__pSearchIndex->GetTitle(item, language));
+			for(int other = 0; other < Catalog::LANGUAGE_COUNT && title.IsEmpty(); other++) {
+				title = __pSearchIndex->GetTitle(item, other);
+			}
+			String name(__pSearchIndex->GetCategory(item));
+			int category = FindCategory(name);
+
+			CustomListItem * newItem = new CustomListItem();
+			newItem->Construct(Retina::GetSize(Retina::SIZE_RESULT_ROW));
+			newItem->SetItemFormat(*__pResultFormat);
+			newItem->SetElement(LIST_ELEMENT_TITLE, title);
+			newItem->SetElement(LIST_ELEMENT_CATEGORY, category >= 0 ? __pCategories[category].titles[language] : name);
+			__pResultList->AddItem(*newItem, item);
+		}
+	}
+	__pResultList->Draw();
+	__pResultList->Show();
+}
+
+void
+CategoryListForm::OnTextValueChanged(const Osp::Ui::Control& source)
+{
+	ShowSearchResults();
+}
+
+void
+CategoryListForm::OnTextValueChangeCanceled(const Osp::Ui::Control& source)
+{
+}
+
+void
+CategoryListForm::OnSearchBarModeChanged(Osp::Ui::Controls::SearchBar& source, Osp::Ui::Controls::SearchBarMode mode)
+{
+	if(mode == SEARCH_BAR_MODE_INPUT) {
+		LoadSearchIndex();
+	} else {
+		__pSearchBar->SetText(L"");
+	}
+	ShowSearchResults();
+	Draw();
+	Show();
+}
+
+void
+CategoryListForm::PickImage(void)
+{
+	ArrayList* pDataList = new ArrayList();
+	pDataList->Construct();
+	pDataList->Add(*(new String(L"type:image")));
+	pDataList->Add(*(new String(L"selectionType:single")));
+
+	AppControl* pAc = AppManager::FindAppControlN(APPCONTROL_MEDIA, OPERATION_PICK);
+	if(pAc) {
+		pAc->Start(pDataList, this);
+		delete pAc;
+	}
+
+	pDataList->RemoveAll(true);
+	delete pDataList;
+}
+
+void
+CategoryListForm::OnAppControlCompleted(const String& providerId, const String& operationId, const IList* pResultList)
+{
+	// result first, then the picked file
+	if(pResultList == null || pResultList->GetCount() < 2) {
+		return;
+	}
+	const String* pResult = static_cast<const String*>(pResultList->GetAt(0));
+	if(!pResult->Equals(APPCONTROL_RESULT_SUCCEEDED)) {
+		return;
+	}
+	result r = ImportImage(*static_cast<const String*>(pResultList->GetAt(1)));
+	if(IsFailed(r)) {
+		AppLog("Import failed by %s", GetErrorMessage(r));
+	}
+}
+
+result
+CategoryListForm::ImportImage(const String& path)
+{
+	// the picker is modal, a second picture before the first is in is dropped
+	if(__importTask != 0) {
+		return E_IN_PROGRESS;
 	}
+	ImportTask* pTask = new ImportTask(*this, path, __pConverter);
+	__pConverter = null;
+	__importTask = TaskScheduler::Post(pTask, TaskScheduler::LANE_VISIBLE);
+	return E_SUCCESS;
 }
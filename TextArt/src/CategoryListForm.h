@@ -5,14 +5,26 @@
 #include <FUi.h>
 #include <FApp.h>
 
+#include "Catalog.h"
 #include "TabsForm.h"
+#include "TaskScheduler.h"
 
 using namespace Osp::Ui::Controls;
 using namespace Osp::Base::Collection;
 
+class AnciiListElement;
+class ArtConverter;
+class SearchIndex;
+class ImportTask;
+class IndexBuildTask;
+class SearchIndexTask;
+
 class CategoryListForm :
 	public TabsForm,
-	public Osp::Ui::ICustomItemEventListener
+	public Osp::Ui::ICustomItemEventListener,
+	public Osp::Ui::ITextEventListener,
+	public Osp::Ui::Controls::ISearchBarEventListener,
+	public Osp::App::IAppControlEventListener
 {
 
 public:
@@ -20,23 +32,92 @@ public:
 	virtual ~CategoryListForm(void);
 	bool Initialize(void);
 
+	// Adds, refreshes and removes categories in place for a list of CatalogChange objects
+	void OnCatalogChanged(const ArrayList& changes);
+	// Catalog::LANGUAGE_COUNT titles of a listed category, false when it is not listed
+	bool GetCategoryTitles(const String& name, String* pTitles) const;
+
 private:
-	ArrayList list;
-	ArrayList titlelist;
+	// Every language is kept so a language switch needs no file access. Ids of
+	// the list are indexes here, a removed category keeps its slot without a preview
+	struct Category {
+		String name;
+		String titles[Catalog::LANGUAGE_COUNT];
+		String descs[Catalog::LANGUAGE_COUNT];
+		AnciiListElement* pPreview;
+	};
+	Category* __pCategories;
+	int __categoryCount;
 
+	// First entry of the list, turns a gallery picture into a new item. The picture
+	// is converted and written by a task, which has the converter until it completes
+	AnciiListElement* __pImportPreview;
+	ArtConverter* __pConverter;
+	TaskScheduler::TaskId __importTask;
+	friend class ImportTask;
+
+	Osp::Ui::Controls::Footer* __pFooter;
 	CustomList* CategoryList;
 	CustomListItemFormat* pCustomListItemFormat;
 
+	// Results list is the search bar's content. The index is read, or built, by a task
+	// when the bar opens; a query typed before it is there shows as searching. A change
+	// of the catalog's items builds both indexes again in the background, the old ones
+	// answer until then
+	SearchBar* __pSearchBar;
+	CustomList* __pResultList;
+	CustomListItemFormat* __pResultFormat;
+	SearchIndex* __pSearchIndex;
+	TaskScheduler::TaskId __searchTask;
+	TaskScheduler::TaskId __indexTask;
+	friend class IndexBuildTask;
+	friend class SearchIndexTask;
+
 	static const int LIST_ELEMENT_TITLE = 201;
 	static const int LIST_ELEMENT_ANCII = 202;
 	static const int LIST_ELEMENT_DESC = 203;
+	static const int LIST_ELEMENT_CATEGORY = 204;
+
+	static const int ITEM_IMPORT = 10000;
+
+	static const int MAX_SEARCH_RESULTS = 50;
+
+	// Footer actions, one per TextPic::InternalAppLanguageEnum value
+	static const int ACTION_LANGUAGE = 400;
+
+	result LoadCategories(void);
+	void ReleaseCategories(void);
+	void AddCategoryItems(void);
+	CustomListItem* CreateCategoryItem(const Category& category) const;
+	result AddCategory(const String& name);
+	result ReloadCategory(int index);
+	void RemoveCategory(int index);
+	// Adds, replaces or takes off the list item of the category
+	void ShowCategory(int index);
+	void RebuildIndexes(void);
+
+	void PickImage(void);
+	result ImportImage(const String& path);
+
+	void LoadSearchIndex(void);
+	void ShowSearchResults(void);
+	int FindCategory(const String& name) const;
 
 public:
 	virtual result OnInitializing(void);
 	virtual result OnTerminating(void);
 
+	virtual void OnActionPerformed(const Osp::Ui::Control& source, int actionId);
+	virtual void OnLanguageChanged(void);
+
 	virtual void OnItemStateChanged(const Osp::Ui::Control& source, int index, int itemId, Osp::Ui::ItemStatus status);
 	virtual void OnItemStateChanged(const Osp::Ui::Control& source, int index, int itemId, int elementId, Osp::Ui::ItemStatus status);
+
+	virtual void OnTextValueChanged(const Osp::Ui::Control& source);
+	virtual void OnTextValueChangeCanceled(const Osp::Ui::Control& source);
+	virtual void OnSearchBarModeChanged(Osp::Ui::Controls::SearchBar& source, Osp::Ui::Controls::SearchBarMode mode);
+
+	virtual void OnAppControlCompleted(const String& providerId, const String& operationId, const Osp::Base::Collection::IList* pResultList);
 };
 
 #endif
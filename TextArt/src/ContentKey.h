@@ -0,0 +1,31 @@
+#ifndef CONTENTKEY_H_
+#define CONTENTKEY_H_
+
+/**
+ * Public half of the RSA key the content manifest is signed with, DER
+ * SubjectPublicKeyInfo. The private half stays with the release tooling
+ * (tools/manifest-gen -key).
+ */
+static const unsigned char CONTENT_PUBLIC_KEY[] = {
+	0x30, 0x82, 0x01, 0x22, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01,
+	0x01, 0x05, 0x00, 0x03, 0x82, 0x01, 0x0f, 0x00, 0x30, 0x82, 0x01, 0x0a, 0x02, 0x82, 0x01, 0x01,
+	0x00, 0x8c, 0xa3, 0xd5, 0xc0, 0x19, 0x35, 0xc7, 0x04, 0x7a, 0xe6, 0x0d, 0x60, 0x8a, 0x0d, 0xe7,
+	0xa4, 0xb7, 0x10, 0xd7, 0xd1, 0x34, 0x38, 0xb8, 0xfb, 0xd9, 0xd8, 0xa8, 0xc5, 0x41, 0xb9, 0xbe,
+	0x61, 0x3f, 0xf7, 0xf8, 0x53, 0x99, 0x7d, 0x66, 0xa3, 0xc8, 0x06, 0xee, 0xf7, 0x37, 0xb1, 0x85,
+	0xbf, 0x5b, 0xae, 0xf6, 0xb3, 0x34, 0xe8, 0x44, 0x70, 0xa5, 0xf5, 0x69, 0xc4, 0x1d, 0x3d, 0xcc,
+	0xbb, 0x0d, 0xfe, 0xda, 0x34, 0x4f, 0xb3, 0xd4, 0xec, 0x3c, 0x09, 0xdb, 0x99, 0xba, 0xb2, 0xd6,
+	0xa2, 0x07, 0xd7, 0x0a, 0xfb, 0x6d, 0x94, 0x3c, 0x6d, 0x16, 0x97, 0x49, 0x05, 0xd5, 0xac, 0x18,
+	0x80, 0xb2, 0xa1, 0x9c, 0x92, 0x3a, 0xf2, 0x1b, 0x74, 0xd2, 0x8d, 0x79, 0x4b, 0xab, 0x48, 0x0e,
+	0x7c, 0xb6, 0xc4, 0x9b, 0xab, 0x25, 0x88, 0x3b, 0x8c, 0x44, 0x2b, 0xff, 0xf9, 0x30, 0x9a, 0xb3,
+	0x61, 0x04, 0x6a, 0x1b, 0xae, 0x0f, 0x9a, 0xaf, 0x56, 0x23, 0xab, 0xc0, 0xd7, 0x54, 0xa6, 0x18,
+	0x70, 0x03, 0x33, 0x4a, 0x48, 0x83, 0xf0, 0xa0, 0x2f, 0xd6, 0xf2, 0xa4, 0x26, 0xba, 0x00, 0xc1,
+	0xde, 0xf9, 0x46, 0xa9, 0x80, 0x68, 0x44, 0xa2, 0xae, 0xbd, 0x8d, 0x32, 0x21, 0x16, 0x41, 0x0e,
+	0x14, 0x8c, 0x40, 0xc9, 0xd9, 0x59, 0xbe, 0x18, 0xb0, 0x81, 0x32, 0xcc, 0x6b, 0x2f, 0x79, 0x80,
+	0xae, 0x85, 0xb4, 0x29, 0x31, 0x61, 0xff, 0x52, 0x40, 0x43, 0xa7, 0x90, 0xe5, 0x45, 0x1f, 0x31,
+	0xd1, 0xad, 0x90, 0xfa, 0xdf, 0x76, 0x4a, 0x1f, 0x48, 0x5a, 0x79, 0x92, 0x78, 0xb3, 0x90, 0x9e,
+	0x68, 0x6f, 0xe2, 0xfc, 0x5a, 0x3a, 0xb8, 0x4e, 0x23, 0xa5, 0x2e, 0xc3, 0x7b, 0xc8, 0xa8, 0x79,
+	0xf9, 0xce, 0x22, 0xc3, 0xfc, 0x89, 0x0f, 0x1b, 0xd3, 0xec, 0x8b, 0x9d, 0xb4, 0x41, 0xe3, 0x58,
+	0x49, 0x02, 0x03, 0x01, 0x00, 0x01
+};
+
+#endif
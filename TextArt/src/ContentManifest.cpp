@@ -0,0 +1,581 @@
+#include "ContentManifest.h"
+
+#include "Catalog.h"
+#include "Debug.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+using namespace Osp::Base::Utility;
+using namespace Osp::Io;
+using namespace Osp::Security;
+using namespace Osp::Security::Crypto;
+
+static const char* MANIFEST_HEADER = "textart-manifest 1 ";
+static const char* SIGNATURE_PREFIX = "signature ";
+
+static const int MIN_ENTRY_CAPACITY = 64;
+static const int MIN_TEXT_CAPACITY = 4096;
+static const int MAX_PATH_BYTES = 1024;
+static const int READ_CHUNK = 16 * 1024;
+
+static const unsigned int FNV_OFFSET = 2166136261u;
+static const unsigned int FNV_PRIME = 16777619u;
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+static int
+HexValue(char c)
+{
+	if(c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	if(c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	}
+	if(c >= 'A' && c <= 'F') {
+		return c - 'A' + 10;
+	}
+	return -1;
+}
+
+static bool
+Equals(const mchar* pLeft, const mchar* pRight)
+{
+	for(; *pLeft != 0 && *pLeft == *pRight; pLeft++, pRight++) {
+	}
+	return *pLeft == *pRight;
+}
+
+// Appends UTF-8 of a path, pOut may be null to count
+static int
+EncodeUtf8(const mchar* pValue, char* pOut)
+{
+	int length = 0;
+	for(; *pValue != 0; pValue++) {
+		unsigned int c = *pValue & 0xFFFF;
+		char bytes[3];
+		int count;
+		if(c < 0x80) {
+			bytes[0] = (char)c;
+			count = 1;
+		} else if(c < 0x800) {
+			bytes[0] = (char)(0xC0 | (c >> 6));
+			bytes[1] = (char)(0x80 | (c & 0x3F));
+			count = 2;
+		} else {
+			bytes[0] = (char)(0xE0 | (c >> 12));
+			bytes[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+			bytes[2] = (char)(0x80 | (c & 0x3F));
+			count = 3;
+		}
+		if(pOut != null) {
+			memcpy(pOut + length, bytes, count);
+		}
+		length += count;
+	}
+	return length;
+}
+
+struct SortedPath {
+	const mchar* pPath;
+	int index;
+};
+
+static int
+ComparePaths(const void* pLeft, const void* pRight)
+{
+	const mchar* pLeftPath = static_cast<const SortedPath*>(pLeft)->pPath;
+	const mchar* pRightPath = static_cast<const SortedPath*>(pRight)->pPath;
+	for(; *pLeftPath != 0 && *pLeftPath == *pRightPath; pLeftPath++, pRightPath++) {
+	}
+	return (int)(*pLeftPath & 0xFFFF) - (int)(*pRightPath & 0xFFFF);
+}
+
+ContentManifest::ContentManifest():
+	__serial(0),
+	__pEntries(null),
+	__entryCount(0),
+	__entryCapacity(0),
+	__pText(null),
+	__textLength(0),
+	__textCapacity(0),
+	__pSlots(null),
+	__slotCount(0)
+{
+}
+
+ContentManifest::~ContentManifest()
+{
+	Clear();
+}
+
+void
+ContentManifest::Clear(void)
+{
+	delete[] __pEntries;
+	delete[] __pText;
+	delete[] __pSlots;
+	__serial = 0;
+	__pEntries = null;
+	__entryCount = 0;
+	__entryCapacity = 0;
+	__pText = null;
+	__textLength = 0;
+	__textCapacity = 0;
+	__pSlots = null;
+	__slotCount = 0;
+}
+
+unsigned int
+ContentManifest::HashPath(const mchar* pPath)
+{
+	unsigned int hash = FNV_OFFSET;
+	for(; *pPath != 0; pPath++) {
+		hash = (hash ^ (*pPath & 0xFFFF)) * FNV_PRIME;
+	}
+	return hash;
+}
+
+int
+ContentManifest::Find(const mchar* pPath) const
+{
+	if(__slotCount == 0) {
+		return -1;
+	}
+	unsigned int mask = __slotCount - 1;
+	for(unsigned int slot = HashPath(pPath) & mask; __pSlots[slot] != 0; slot = (slot + 1) & mask) {
+		int index = __pSlots[slot] - 1;
+		if(Equals(__pText + __pEntries[index].path, pPath)) {
+			return index;
+		}
+	}
+	return -1;
+}
+
+bool
+ContentManifest::ReserveText(int count)
+{
+	if(__textLength + count <= __textCapacity) {
+		return true;
+	}
+	int capacity = __textCapacity > 0 ? __textCapacity : MIN_TEXT_CAPACITY;
+	while(capacity < __textLength + count) {
+		capacity *= 2;
+	}
+	mchar* pText = new mchar[capacity];
+	if(pText == null) {
+		return false;
+	}
+	if(__textLength > 0) {
+		memcpy(pText, __pText, __textLength * sizeof(mchar));
+	}
+	delete[] __pText;
+	__pText = pText;
+	__textCapacity = capacity;
+	return true;
+}
+
+result
+ContentManifest::Rehash(int capacity)
+{
+	int* pSlots = new int[capacity];
+	if(pSlots == null) {
+		return E_OUT_OF_MEMORY;
+	}
+	memset(pSlots, 0, capacity * sizeof(int));
+	unsigned int mask = capacity - 1;
+	for(int i = 0; i < __entryCount; i++) {
+		unsigned int slot = HashPath(__pText + __pEntries[i].path) & mask;
+		while(pSlots[slot] != 0) {
+			slot = (slot + 1) & mask;
+		}
+		pSlots[slot] = i + 1;
+	}
+	delete[] __pSlots;
+	__pSlots = pSlots;
+	__slotCount = capacity;
+	return E_SUCCESS;
+}
+
+result
+ContentManifest::Add(const mchar* pPath, int length, const byte* pHash, long long size)
+{
+	if(Find(pPath) >= 0) {
+		return E_INVALID_FORMAT;
+	}
+	if(__entryCount == __entryCapacity) {
+		int capacity = __entryCapacity > 0 ? __entryCapacity * 2 : MIN_ENTRY_CAPACITY;
+		Entry* pEntries = new Entry[capacity];
+		if(pEntries == null) {
+			return E_OUT_OF_MEMORY;
+		}
+		if(__entryCount > 0) {
+			memcpy(pEntries, __pEntries, __entryCount * sizeof(Entry));
+		}
+		delete[] __pEntries;
+		__pEntries = pEntries;
+		__entryCapacity = capacity;
+	}
+	if(!ReserveText(length + 1)) {
+		return E_OUT_OF_MEMORY;
+	}
+
+	Entry& entry = __pEntries[__entryCount++];
+	memcpy(entry.hash, pHash, HASH_SIZE);
+	entry.size = size;
+	entry.path = __textLength;
+	memcpy(__pText + __textLength, pPath, length * sizeof(mchar));
+	__pText[__textLength + length] = 0;
+	__textLength += length + 1;
+
+	// Kept at most half full
+	if(__entryCount * 2 > __slotCount) {
+		return Rehash(__slotCount > 0 ? __slotCount * 2 : MIN_ENTRY_CAPACITY * 2);
+	}
+	unsigned int mask = __slotCount - 1;
+	unsigned int slot = HashPath(__pText + entry.path) & mask;
+	while(__pSlots[slot] != 0) {
+		slot = (slot + 1) & mask;
+	}
+	__pSlots[slot] = __entryCount;
+	return E_SUCCESS;
+}
+
+result
+ContentManifest::Scan(void)
+{
+	PROFILE_SCOPE("ContentManifest::Scan");
+	Clear();
+	ArrayList names;
+	names.Construct();
+	result r = Catalog::GetCategories(names);
+	for(int n = 0; n < names.GetCount() && !IsFailed(r); n++) {
+		const String& name = *static_cast<String*>(names.GetAt(n));
+		String dirName;
+		Catalog::GetCategoryPath(name, dirName);
+		Directory dir;
+		r = dir.Construct(dirName);
+		if(IsFailed(r)) {
+			break;
+		}
+		DirEnumerator* pDirEnum = dir.ReadN();
+		if(pDirEnum == null) {
+			r = GetLastResult();
+			break;
+		}
+		while(pDirEnum->MoveNext() == E_SUCCESS && !IsFailed(r)) {
+			DirEntry& dirEntry = pDirEnum->GetCurrentDirEntry();
+			if(!dirEntry.IsNomalFile()) {
+				continue;
+			}
+			String fileName = dirEntry.GetName();
+			String path(dirName);
+			path.Append(fileName);
+			byte hash[HASH_SIZE];
+			long long size = 0;
+			r = HashFile(path, hash, size);
+			if(IsFailed(r)) {
+				break;
+			}
+			String relative(name);
+			relative.Append(L'/');
+			relative.Append(fileName);
+			r = Add(relative.GetPointer(), relative.GetLength(), hash, size);
+		}
+		delete pDirEnum;
+	}
+	names.RemoveAll(true);
+	if(IsFailed(r)) {
+		AppLog("Scanning the catalog failed by %s", GetErrorMessage(r));
+		Clear();
+	}
+	return r;
+}
+
+result
+ContentManifest::Parse(const ByteBuffer& text, const ByteBuffer* pPublicKey)
+{
+	PROFILE_SCOPE("ContentManifest::Parse");
+	Clear();
+	const char* pText = reinterpret_cast<const char*>(text.GetPointer());
+	int length = text.GetRemaining();
+	if(pText == null) {
+		return E_INVALID_FORMAT;
+	}
+	pText += text.GetPosition();
+
+	// The signature is the last line and covers every byte before it
+	int end = length;
+	while(end > 0 && (pText[end - 1] == '\n' || pText[end - 1] == '\r')) {
+		end--;
+	}
+	int lastLine = end;
+	while(lastLine > 0 && pText[lastLine - 1] != '\n') {
+		lastLine--;
+	}
+	int signatureLength = (int)strlen(SIGNATURE_PREFIX);
+	bool signedText = end - lastLine > signatureLength && strncmp(pText + lastLine, SIGNATURE_PREFIX, signatureLength) == 0;
+	if(signedText) {
+		length = lastLine;
+	}
+
+	if(pPublicKey != null) {
+		int hexLength = end - lastLine - signatureLength;
+		if(!signedText || hexLength % 2 != 0) {
+			return E_INVALID_DATA;
+		}
+		ByteBuffer signature;
+		signature.Construct(hexLength / 2);
+		const char* pHex = pText + lastLine + signatureLength;
+		for(int i = 0; i < hexLength; i += 2) {
+			int high = HexValue(pHex[i]);
+			int low = HexValue(pHex[i + 1]);
+			if(high < 0 || low < 0) {
+				return E_INVALID_DATA;
+			}
+			signature.SetByte((byte)(high * 16 + low));
+		}
+		signature.Flip();
+
+		ByteBuffer data;
+		data.Construct(length);
+		data.SetArray(reinterpret_cast<const byte*>(pText), 0, length);
+		data.Flip();
+		PublicKey key;
+		RsaSignature rsa;
+		if(IsFailed(key.SetKey(*pPublicKey)) || IsFailed(rsa.SetPublicKey(key)) || !rsa.Verify(data, signature)) {
+			AppLog("The manifest signature does not verify");
+			return E_INVALID_DATA;
+		}
+	}
+
+	int headerLength = (int)strlen(MANIFEST_HEADER);
+	if(length < headerLength || strncmp(pText, MANIFEST_HEADER, headerLength) != 0) {
+		return E_INVALID_FORMAT;
+	}
+	int serial = atoi(pText + headerLength);
+
+	char line[MAX_PATH_BYTES + 1];
+	result r = E_SUCCESS;
+	int position = 0;
+	while(position < length && pText[position] != '\n') {
+		position++;
+	}
+	for(position++; position < length && !IsFailed(r);) {
+		int lineEnd = position;
+		while(lineEnd < length && pText[lineEnd] != '\n') {
+			lineEnd++;
+		}
+		int lineLength = lineEnd - position;
+		if(lineLength > 0 && pText[lineEnd - 1] == '\r') {
+			lineLength--;
+		}
+		if(lineLength == 0) {
+			position = lineEnd + 1;
+			continue;
+		}
+
+		// <hash> <size> <path>
+		byte hash[HASH_SIZE];
+		const char* pLine = pText + position;
+		int sizeEnd = HASH_HEX_LENGTH + 1;
+		while(sizeEnd < lineLength && pLine[sizeEnd] >= '0' && pLine[sizeEnd] <= '9') {
+			sizeEnd++;
+		}
+		int pathLength = lineLength - sizeEnd - 1;
+		if(lineLength <= HASH_HEX_LENGTH + 1 || pLine[HASH_HEX_LENGTH] != ' ' || !ParseHash(pLine, hash)
+				|| sizeEnd == HASH_HEX_LENGTH + 1 || pLine[sizeEnd] != ' ' || pathLength <= 0 || pathLength > MAX_PATH_BYTES) {
+			r = E_INVALID_FORMAT;
+			break;
+		}
+		long long size = strtoll(pLine + HASH_HEX_LENGTH + 1, null, 10);
+		memcpy(line, pLine + sizeEnd + 1, pathLength);
+		line[pathLength] = 0;
+		String path;
+		r = StringUtil::Utf8ToString(line, path);
+		if(!IsFailed(r)) {
+			r = IsValidPath(path.GetPointer()) ? Add(path.GetPointer(), path.GetLength(), hash, size) : E_INVALID_FORMAT;
+		}
+		position = lineEnd + 1;
+	}
+	if(IsFailed(r)) {
+		Clear();
+		return r;
+	}
+	__serial = serial;
+	return E_SUCCESS;
+}
+
+result
+ContentManifest::Load(const String& path, const ByteBuffer* pPublicKey)
+{
+	File file;
+	result r = file.Construct(path, L"r");
+	if(IsFailed(r)) {
+		return r;
+	}
+	FileAttributes attributes;
+	r = File::GetAttributes(path, attributes);
+	if(IsFailed(r)) {
+		return r;
+	}
+	int size = (int)attributes.GetFileSize();
+	ByteBuffer text;
+	r = text.Construct(size > 0 ? size : 1);
+	if(IsFailed(r)) {
+		return r;
+	}
+	while(size > 0 && text.HasRemaining()) {
+		r = file.Read(text);
+		if(r == E_END_OF_FILE) {
+			break;
+		}
+		if(IsFailed(r)) {
+			return r;
+		}
+	}
+	text.Flip();
+	return Parse(text, pPublicKey);
+}
+
+ByteBuffer*
+ContentManifest::FormatN(void) const
+{
+	char header[64];
+	int headerLength = snprintf(header, sizeof(header), "%s%d\n", MANIFEST_HEADER, __serial);
+	int length = headerLength;
+	for(int i = 0; i < __entryCount; i++) {
+		char size[24];
+		length += HASH_HEX_LENGTH + 1 + snprintf(size, sizeof(size), "%lld", __pEntries[i].size) + 1;
+		length += EncodeUtf8(GetPath(i), null) + 1;
+	}
+
+	// In path order, so the same catalog always gives the same text
+	char* pText = new char[length + 1];
+	SortedPath* pSorted = new SortedPath[__entryCount > 0 ? __entryCount : 1];
+	if(pText == null || pSorted == null) {
+		delete[] pText;
+		delete[] pSorted;
+		SetLastResult(E_OUT_OF_MEMORY);
+		return null;
+	}
+	for(int i = 0; i < __entryCount; i++) {
+		pSorted[i].pPath = GetPath(i);
+		pSorted[i].index = i;
+	}
+	qsort(pSorted, __entryCount, sizeof(SortedPath), ComparePaths);
+
+	memcpy(pText, header, headerLength);
+	int position = headerLength;
+	for(int i = 0; i < __entryCount; i++) {
+		const Entry& entry = __pEntries[pSorted[i].index];
+		FormatHash(entry.hash, pText + position);
+		position += HASH_HEX_LENGTH;
+		position += snprintf(pText + position, length + 1 - position, " %lld ", entry.size);
+		position += EncodeUtf8(pSorted[i].pPath, pText + position);
+		pText[position++] = '\n';
+	}
+	delete[] pSorted;
+
+	ByteBuffer* pBuffer = new ByteBuffer();
+	pBuffer->Construct(position);
+	pBuffer->SetArray(reinterpret_cast<const byte*>(pText), 0, position);
+	pBuffer->Flip();
+	delete[] pText;
+	SetLastResult(E_SUCCESS);
+	return pBuffer;
+}
+
+result
+ContentManifest::HashFile(const String& path, byte* pHash, long long& size)
+{
+	File file;
+	result r = file.Construct(path, L"r");
+	if(IsFailed(r)) {
+		return r;
+	}
+	Sha1Hash sha1;
+	r = sha1.Initialize();
+	if(IsFailed(r)) {
+		return r;
+	}
+	ByteBuffer chunk;
+	chunk.Construct(READ_CHUNK);
+	size = 0;
+	for(;;) {
+		chunk.Clear();
+		r = file.Read(chunk);
+		if(r == E_END_OF_FILE) {
+			break;
+		}
+		if(IsFailed(r)) {
+			return r;
+		}
+		chunk.Flip();
+		size += chunk.GetRemaining();
+		r = sha1.Update(chunk);
+		if(IsFailed(r)) {
+			return r;
+		}
+	}
+	ByteBuffer* pDigest = sha1.FinalizeN();
+	if(pDigest == null) {
+		return GetLastResult();
+	}
+	r = pDigest->GetRemaining() == HASH_SIZE ? pDigest->GetArray(pHash, 0, HASH_SIZE) : E_SYSTEM;
+	delete pDigest;
+	return r;
+}
+
+void
+ContentManifest::FormatHash(const byte* pHash, char* pHex)
+{
+	for(int i = 0; i < HASH_SIZE; i++) {
+		pHex[i * 2] = HEX_DIGITS[pHash[i] >> 4];
+		pHex[i * 2 + 1] = HEX_DIGITS[pHash[i] & 0x0F];
+	}
+}
+
+bool
+ContentManifest::ParseHash(const char* pHex, byte* pHash)
+{
+	for(int i = 0; i < HASH_SIZE; i++) {
+		int high = HexValue(pHex[i * 2]);
+		int low = high < 0 ? -1 : HexValue(pHex[i * 2 + 1]);
+		if(low < 0) {
+			return false;
+		}
+		pHash[i] = (byte)(high * 16 + low);
+	}
+	return true;
+}
+
+bool
+ContentManifest::IsValidPath(const mchar* pPath)
+{
+	int slashes = 0;
+	int segment = 0;
+	for(const mchar* pChar = pPath; ; pChar++) {
+		if(*pChar == L'/' || *pChar == 0) {
+			// No empty, "." or ".." segment
+			if(segment == 0 || (segment <= 2 && pChar[-1] == L'.' && (segment == 1 || pChar[-2] == L'.'))) {
+				return false;
+			}
+			if(*pChar == 0) {
+				break;
+			}
+			slashes++;
+			segment = 0;
+			continue;
+		}
+		if(*pChar == L'\\' || *pChar == L':' || *pChar < 0x20) {
+			return false;
+		}
+		segment++;
+	}
+	return slashes == 1;
+}
@@ -0,0 +1,83 @@
+#ifndef CONTENTMANIFEST_H_
+#define CONTENTMANIFEST_H_
+
+#include "Port.h"
+
+using namespace Osp::Base;
+
+/**
+ * Content hashes of every file of the catalog, category.info included, as
+ * served for the delta sync. The text form is UTF-8, one line per file
+ * under a header that carries a serial growing with every release:
+ *
+ *   textart-manifest 1 <serial>
+ *   <sha1 hex> <size> <category>/<file>
+ *   signature <hex>
+ *
+ * The signature is RSA PKCS #1 v1.5 over SHA-1 of every byte before its
+ * line, as the device verifies it. Paths are looked up through an open
+ * addressing table.
+ */
+class ContentManifest {
+public:
+	static const int HASH_SIZE = 20;
+	static const int HASH_HEX_LENGTH = HASH_SIZE * 2;
+
+	ContentManifest();
+	~ContentManifest();
+
+	// Hashes every file of the present catalog, the serial is left at zero
+	result Scan(void);
+	// Checks the signature against the DER public key unless it is null
+	result Parse(const ByteBuffer& text, const ByteBuffer* pPublicKey);
+	result Load(const String& path, const ByteBuffer* pPublicKey);
+	// The text form without the signature line, to be signed off-device
+	ByteBuffer* FormatN(void) const;
+
+	int GetSerial(void) const { return __serial; }
+	void SetSerial(int serial) { __serial = serial; }
+	int GetCount(void) const { return __entryCount; }
+	// "<category>/<file>", null terminated
+	const mchar* GetPath(int index) const { return __pText + __pEntries[index].path; }
+	const byte* GetHash(int index) const { return __pEntries[index].hash; }
+	long long GetSize(int index) const { return __pEntries[index].size; }
+	// Index of the path or -1
+	int Find(const mchar* pPath) const;
+
+	static result HashFile(const String& path, byte* pHash, long long& size);
+	static void FormatHash(const byte* pHash, char* pHex);
+	static bool ParseHash(const char* pHex, byte* pHash);
+	// Only "<category>/<file>" without any way out of the catalog
+	static bool IsValidPath(const mchar* pPath);
+
+private:
+	struct Entry {
+		byte hash[HASH_SIZE];
+		long long size;
+		// Offset of the null terminated path in the text
+		int path;
+	};
+
+	void Clear(void);
+	result Add(const mchar* pPath, int length, const byte* pHash, long long size);
+	bool ReserveText(int count);
+	result Rehash(int capacity);
+
+	static unsigned int HashPath(const mchar* pPath);
+
+	ContentManifest(const ContentManifest& manifest);
+	ContentManifest& operator =(const ContentManifest& manifest);
+
+	int __serial;
+	Entry* __pEntries;
+	int __entryCount;
+	int __entryCapacity;
+	mchar* __pText;
+	int __textLength;
+	int __textCapacity;
+	// Entry index plus one, zero when free
+	int* __pSlots;
+	int __slotCount;
+};
+
+#endif
@@ -0,0 +1,909 @@
+#include "ContentSync.h"
+
+#include "Catalog.h"
+#include "Debug.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+using namespace Osp::Io;
+using namespace Osp::Net::Http;
+using namespace Osp::Security::Crypto;
+
+static const wchar_t* SYNC_DIR = L"/Home/sync/";
+// Manifest the catalog was last brought up to, and the one being applied
+static const wchar_t* MANIFEST_PATH = L"/Home/sync/manifest.txt";
+static const wchar_t* PENDING_PATH = L"/Home/sync/pending.txt";
+static const wchar_t* JOURNAL_PATH = L"/Home/sync/apply.txt";
+static const wchar_t* JOURNAL_TMP_PATH = L"/Home/sync/apply.tmp";
+static const wchar_t* PART_SUFFIX = L".part";
+static const wchar_t* NEW_SUFFIX = L".new";
+
+static const int MIN_MANIFEST_CAPACITY = 16 * 1024;
+
+class ContentSync::WorkTask :
+	public ITask
+{
+public:
+	WorkTask(ContentSync& sync, State state):
+		__sync(sync),
+		__state(state)
+	{
+	}
+
+	result Run(const CancelToken& token)
+	{
+		return __state == STATE_SCAN ? __sync.ScanLocal() : __sync.Apply();
+	}
+
+	void OnTaskCompleted(result r)
+	{
+		__sync.__task = 0;
+		if(__state == STATE_SCAN) {
+			__sync.Continue(r);
+		} else {
+			__sync.Finish(r);
+		}
+	}
+
+private:
+	ContentSync& __sync;
+	State __state;
+};
+
+ContentSync::ContentSync():
+	__pHttpSession(null),
+	__pHttpTransaction(null),
+	__pListener(null),
+	__state(STATE_IDLE),
+	__task(0),
+	__error(E_SUCCESS),
+	__statusCode(0),
+	__receivedBytes(0),
+	__pManifestText(null),
+	__manifestLength(0),
+	__manifestCapacity(0),
+	__appliedSerial(-1),
+	__pendingSerial(-1),
+	__pWanted(null),
+	__wantedCount(0),
+	__batchStart(0),
+	__batchEnd(0),
+	__updated(0),
+	__removed(0),
+	__recordHeaderLength(0),
+	__recordRemaining(0),
+	__pRecordFile(null)
+{
+}
+
+ContentSync::~ContentSync()
+{
+	Cancel();
+	delete[] __pManifestText;
+}
+
+result
+ContentSync::Construct(const String& hostAddr, const String& uri, const ByteBuffer& publicKey, IContentSyncListener& listener)
+{
+	__hostAddr = hostAddr;
+	__uri = uri;
+	__pListener = &listener;
+	return __publicKey.Construct(publicKey);
+}
+
+result
+ContentSync::Start(void)
+{
+	if(IsBusy()) {
+		return E_IN_PROGRESS;
+	}
+	__receivedBytes = 0;
+	__manifestLength = 0;
+	__wantedCount = 0;
+	__batchStart = 0;
+	__batchEnd = 0;
+	__updated = 0;
+	__removed = 0;
+	__appliedSerial = IsFailed(__previous.Load(MANIFEST_PATH, null)) ? -1 : __previous.GetSerial();
+	__pendingSerial = ReadPending();
+	__state = STATE_MANIFEST;
+
+	String uri(__uri);
+	uri.Append(L"manifest.txt");
+	result r = Request(uri);
+	if(IsFailed(r)) {
+		__state = STATE_IDLE;
+	}
+	return r;
+}
+
+void
+ContentSync::Cancel(void)
+{
+	if(!IsBusy()) {
+		return;
+	}
+	// Objects staged so far are kept for the next start, an apply already running completes
+	TaskScheduler::Cancel(__task);
+	__task = 0;
+	CloseSession();
+	CloseRecord();
+	__state = STATE_IDLE;
+}
+
+result
+ContentSync::Request(const String& uri)
+{
+	if(__pHttpSession == null) {
+		__pHttpSession = new HttpSession();
+		result r = __pHttpSession->Construct(NET_HTTP_SESSION_MODE_NORMAL, null, __hostAddr, null);
+		if(IsFailed(r)) {
+			AppLog("HttpSession::Construct() is failed by %s", GetErrorMessage(r));
+			delete __pHttpSession;
+			__pHttpSession = null;
+			return r;
+		}
+	}
+
+	HttpTransaction* pHttpTransaction = __pHttpSession->OpenTransactionN();
+	if(pHttpTransaction == null) {
+		result r = GetLastResult();
+		CloseSession();
+		return r;
+	}
+	pHttpTransaction->AddHttpTransactionListener(*this);
+
+	HttpRequest* pHttpRequest = pHttpTransaction->GetRequest();
+	pHttpRequest->SetMethod(NET_HTTP_METHOD_GET);
+	pHttpRequest->SetUri(uri);
+	pHttpRequest->GetHeader()->AddField(L"Cache-Control", L"no-cache");
+	if(__state == STATE_MANIFEST && (__pendingSerial >= 0 || __appliedSerial >= 0)) {
+		// The manifest is tagged with its serial, one the device holds is not sent again
+		String tag(L"\"");
+		tag.Append(__pendingSerial >= 0 ? __pendingSerial : __appliedSerial);
+		tag.Append(L'"');
+		pHttpRequest->GetHeader()->AddField(L"If-None-Match", tag);
+	}
+
+	result r = pHttpTransaction->Submit();
+	if(IsFailed(r)) {
+		AppLog("HttpTransaction::Submit() is failed by %s", GetErrorMessage(r));
+		delete pHttpTransaction;
+		CloseSession();
+		return r;
+	}
+	__pHttpTransaction = pHttpTransaction;
+	__error = E_SUCCESS;
+	__statusCode = 0;
+	return E_SUCCESS;
+}
+
+void
+ContentSync::CloseSession(void)
+{
+	if(__pHttpSession != null) {
+		// closing the session also releases a transaction that is still open
+		delete __pHttpSession;
+		__pHttpSession = null;
+	}
+	__pHttpTransaction = null;
+}
+
+result
+ContentSync::RequestBatch(void)
+{
+	__batchStart = __batchEnd;
+	String uri(__uri);
+	uri.Append(L"objects?h=");
+	long long bytes = 0;
+	int end = __batchStart;
+	while(end < __wantedCount && end - __batchStart < BATCH_OBJECTS) {
+		long long size = __manifest.GetSize(__pWanted[end]);
+		if(end > __batchStart && bytes + size > BATCH_BYTES) {
+			break;
+		}
+		char hex[ContentManifest::HASH_HEX_LENGTH + 1];
+		ContentManifest::FormatHash(__manifest.GetHash(__pWanted[end]), hex);
+		hex[ContentManifest::HASH_HEX_LENGTH] = 0;
+		if(end > __batchStart) {
+			uri.Append(L',');
+		}
+		uri.Append(String(hex));
+		bytes += size;
+		end++;
+	}
+	__batchEnd = end;
+	__recordHeaderLength = 0;
+	__state = STATE_OBJECTS;
+	return Request(uri);
+}
+
+void
+ContentSync::OnTransactionHeaderCompleted(HttpSession& httpSession, HttpTransaction& httpTransaction, int headerLen, bool bAuthRequired)
+{
+	__statusCode = httpTransaction.GetResponse()->GetHttpStatusCode();
+	if(__state == STATE_MANIFEST && __statusCode == NET_HTTP_STATUS_OK) {
+		// A newer release than the one being resumed
+		__manifestLength = 0;
+	}
+}
+
+void
+ContentSync::OnTransactionReadyToRead(HttpSession& httpSession, HttpTransaction& httpTransaction, int availableBodyLen)
+{
+	ByteBuffer* pBody = httpTransaction.GetResponse()->ReadBodyN();
+	if(pBody == null) {
+		return;
+	}
+	__receivedBytes += pBody->GetRemaining();
+	// A failed body is drained and reported once the transaction completes
+	if(!IsFailed(__error) && __statusCode == NET_HTTP_STATUS_OK) {
+		if(__state == STATE_MANIFEST) {
+			__error = ReadManifest(pBody->GetPointer() + pBody->GetPosition(), pBody->GetRemaining());
+		} else {
+			__error = ReadObjects(*pBody);
+		}
+	}
+	delete pBody;
+}
+
+void
+ContentSync::OnTransactionAborted(HttpSession& httpSession, HttpTransaction& httpTransaction, result r)
+{
+	AppLog("Content sync aborted by %s", GetErrorMessage(r));
+	delete &httpTransaction;
+	__pHttpTransaction = null;
+	// a broken connection is not reused
+	CloseSession();
+	Finish(r);
+}
+
+void
+ContentSync::OnTransactionCompleted(HttpSession& httpSession, HttpTransaction& httpTransaction)
+{
+	delete &httpTransaction;
+	__pHttpTransaction = null;
+
+	result r = __error;
+	if(!IsFailed(r) && __state == STATE_MANIFEST && __statusCode == NET_HTTP_STATUS_NOT_MODIFIED) {
+		if(__pendingSerial < 0) {
+			Finish(E_SUCCESS);
+			return;
+		}
+		// Still the release being resumed, its manifest is read from the staging
+		__statusCode = NET_HTTP_STATUS_OK;
+	}
+	if(!IsFailed(r) && __statusCode != NET_HTTP_STATUS_OK) {
+		AppLog("Content server answered %d", __statusCode);
+		r = E_FAILURE;
+	}
+	if(!IsFailed(r) && __state == STATE_MANIFEST) {
+		r = OnManifestCompleted();
+		// a release the catalog does not have yet, what to fetch is known after the scan
+		if(!IsFailed(r) && __manifest.GetSerial() != __appliedSerial) {
+			PostWork(STATE_SCAN);
+			return;
+		}
+	} else if(!IsFailed(r)) {
+		r = OnBatchCompleted();
+	}
+	Continue(r);
+}
+
+void
+ContentSync::Continue(result r)
+{
+	if(!IsFailed(r) && __batchEnd < __wantedCount) {
+		r = RequestBatch();
+		if(!IsFailed(r)) {
+			return;
+		}
+	}
+	if(!IsFailed(r) && __manifest.GetSerial() != __appliedSerial) {
+		PostWork(STATE_APPLY);
+		return;
+	}
+	Finish(r);
+}
+
+void
+ContentSync::PostWork(State state)
+{
+	__state = state;
+	// on the strand of the catalog watcher and the indexes, none of them reads the catalog half applied
+	__task = TaskScheduler::Post(new WorkTask(*this, state), TaskScheduler::LANE_BACKGROUND, TaskScheduler::STRAND_INDEX);
+}
+
+result
+ContentSync::ReadManifest(const byte* pData, int length)
+{
+	if(__manifestLength + length > __manifestCapacity) {
+		int capacity = __manifestCapacity > 0 ? __manifestCapacity : MIN_MANIFEST_CAPACITY;
+		while(capacity < __manifestLength + length) {
+			capacity *= 2;
+		}
+		if(capacity > MAX_MANIFEST_BYTES) {
+			return E_OVERFLOW;
+		}
+		byte* pText = new byte[capacity];
+		if(pText == null) {
+			return E_OUT_OF_MEMORY;
+		}
+		if(__manifestLength > 0) {
+			memcpy(pText, __pManifestText, __manifestLength);
+		}
+		delete[] __pManifestText;
+		__pManifestText = pText;
+		__manifestCapacity = capacity;
+	}
+	memcpy(__pManifestText + __manifestLength, pData, length);
+	__manifestLength += length;
+	return E_SUCCESS;
+}
+
+int
+ContentSync::ReadPending(void)
+{
+	File file;
+	if(IsFailed(file.Construct(PENDING_PATH, L"r"))) {
+		return -1;
+	}
+	byte chunk[4096];
+	int count;
+	while((count = file.Read(chunk, sizeof(chunk))) > 0) {
+		if(IsFailed(ReadManifest(chunk, count))) {
+			break;
+		}
+	}
+	ByteBuffer text;
+	text.Construct(__manifestLength > 0 ? __manifestLength : 1);
+	text.SetArray(__pManifestText, 0, __manifestLength);
+	text.Flip();
+	// Checked against the key again once the server confirms it
+	if(IsFailed(__manifest.Parse(text, null)) || __manifest.GetSerial() <= __appliedSerial) {
+		__manifestLength = 0;
+		return -1;
+	}
+	return __manifest.GetSerial();
+}
+
+result
+ContentSync::OnManifestCompleted(void)
+{
+	PROFILE_SCOPE("ContentSync::OnManifestCompleted");
+	ByteBuffer text;
+	text.Construct(__manifestLength > 0 ? __manifestLength : 1);
+	text.SetArray(__pManifestText, 0, __manifestLength);
+	text.Flip();
+	result r = __manifest.Parse(text, &__publicKey);
+	if(IsFailed(r)) {
+		AppLog("The content manifest is rejected by %s", GetErrorMessage(r));
+		return r;
+	}
+
+	if(__manifest.GetSerial() < __appliedSerial) {
+		AppLog("The content manifest %d is older than the applied %d", __manifest.GetSerial(), __appliedSerial);
+		return E_INVALID_DATA;
+	}
+	if(__manifest.GetSerial() == __appliedSerial) {
+		return E_SUCCESS;
+	}
+
+	File pending;
+	r = pending.Construct(PENDING_PATH, L"w", true);
+	if(!IsFailed(r)) {
+		r = pending.Write(__pManifestText, __manifestLength);
+	}
+	if(!IsFailed(r)) {
+		r = pending.Flush();
+	}
+	return r;
+}
+
+result
+ContentSync::ScanLocal(void)
+{
+	PROFILE_SCOPE("ContentSync::ScanLocal");
+	result r = __local.Scan();
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	// One fetch per distinct content missing from the catalog and the staging
+	int count = __manifest.GetCount();
+	int slotCount = 16;
+	while(slotCount < count * 2) {
+		slotCount *= 2;
+	}
+	delete[] __pWanted;
+	__pWanted = new int[count > 0 ? count : 1];
+	int* pSlots = new int[slotCount];
+	if(__pWanted == null || pSlots == null) {
+		delete[] pSlots;
+		return E_OUT_OF_MEMORY;
+	}
+	memset(pSlots, 0, slotCount * sizeof(int));
+	for(int i = 0; i < count; i++) {
+		if(!IsOutdated(i)) {
+			continue;
+		}
+		const byte* pHash = __manifest.GetHash(i);
+		unsigned int slot = (pHash[0] | (pHash[1] << 8) | (pHash[2] << 16) | ((unsigned int)pHash[3] << 24)) & (slotCount - 1);
+		while(pSlots[slot] != 0 && memcmp(__manifest.GetHash(pSlots[slot] - 1), pHash, ContentManifest::HASH_SIZE) != 0) {
+			slot = (slot + 1) & (slotCount - 1);
+		}
+		if(pSlots[slot] != 0) {
+			continue;
+		}
+		pSlots[slot] = i + 1;
+
+		char hex[ContentManifest::HASH_HEX_LENGTH + 1];
+		ContentManifest::FormatHash(pHash, hex);
+		hex[ContentManifest::HASH_HEX_LENGTH] = 0;
+		String path;
+		GetObjectPath(hex, path);
+		if(!File::IsFileExist(path)) {
+			__pWanted[__wantedCount++] = i;
+		}
+	}
+	delete[] pSlots;
+	AppLog("Content manifest %d, %d files, %d to fetch", __manifest.GetSerial(), count, __wantedCount);
+	return E_SUCCESS;
+}
+
+result
+ContentSync::ReadObjects(ByteBuffer& body)
+{
+	const byte* pData = body.GetPointer();
+	int position = body.GetPosition();
+	int limit = body.GetLimit();
+	while(position < limit) {
+		if(__pRecordFile == null) {
+			// "<hash> <size>\n" ahead of every object
+			byte c = pData[position++];
+			if(c != '\n') {
+				if(__recordHeaderLength >= (int)sizeof(__recordHeader) - 1) {
+					return E_INVALID_DATA;
+				}
+				__recordHeader[__recordHeaderLength++] = (char)c;
+				continue;
+			}
+			__recordHeader[__recordHeaderLength] = 0;
+			int headerLength = __recordHeaderLength;
+			__recordHeaderLength = 0;
+			if(headerLength < ContentManifest::HASH_HEX_LENGTH + 2 || __recordHeader[ContentManifest::HASH_HEX_LENGTH] != ' '
+					|| !ContentManifest::ParseHash(__recordHeader, __recordHash)) {
+				return E_INVALID_DATA;
+			}
+			__recordRemaining = strtoll(__recordHeader + ContentManifest::HASH_HEX_LENGTH + 1, null, 10);
+			if(__recordRemaining < 0 || __recordRemaining > MAX_OBJECT_BYTES) {
+				return E_INVALID_DATA;
+			}
+			int wanted = __batchStart;
+			while(wanted < __batchEnd && memcmp(__manifest.GetHash(__pWanted[wanted]), __recordHash, ContentManifest::HASH_SIZE) != 0) {
+				wanted++;
+			}
+			if(wanted == __batchEnd) {
+				return E_INVALID_DATA;
+			}
+
+			__recordHeader[ContentManifest::HASH_HEX_LENGTH] = 0;
+			String path;
+			GetObjectPath(__recordHeader, path);
+			path.Append(PART_SUFFIX);
+			__pRecordFile = new File();
+			result r = __pRecordFile->Construct(path, L"w");
+			if(!IsFailed(r)) {
+				r = __recordSha1.Initialize();
+			}
+			if(!IsFailed(r) && __recordRemaining == 0) {
+				r = CompleteRecord();
+			}
+			if(IsFailed(r)) {
+				CloseRecord();
+				return r;
+			}
+			continue;
+		}
+
+		int count = limit - position;
+		if(count > __recordRemaining) {
+			count = (int)__recordRemaining;
+		}
+		body.SetLimit(position + count);
+		body.SetPosition(position);
+		result r = __recordSha1.Update(body);
+		body.SetLimit(limit);
+		if(!IsFailed(r)) {
+			r = __pRecordFile->Write(pData + position, count);
+		}
+		position += count;
+		__recordRemaining -= count;
+		if(!IsFailed(r) && __recordRemaining == 0) {
+			r = CompleteRecord();
+		}
+		if(IsFailed(r)) {
+			CloseRecord();
+			return r;
+		}
+	}
+	return E_SUCCESS;
+}
+
+result
+ContentSync::CompleteRecord(void)
+{
+	result r = __pRecordFile->Flush();
+	delete __pRecordFile;
+	__pRecordFile = null;
+
+	ByteBuffer* pDigest = __recordSha1.FinalizeN();
+	char hex[ContentManifest::HASH_HEX_LENGTH + 1];
+	ContentManifest::FormatHash(__recordHash, hex);
+	hex[ContentManifest::HASH_HEX_LENGTH] = 0;
+	String path;
+	GetObjectPath(hex, path);
+	String partPath(path);
+	partPath.Append(PART_SUFFIX);
+	if(pDigest == null || pDigest->GetRemaining() != ContentManifest::HASH_SIZE
+			|| memcmp(pDigest->GetPointer() + pDigest->GetPosition(), __recordHash, ContentManifest::HASH_SIZE) != 0) {
+		AppLog("Content object %s does not match its hash", hex);
+		r = E_INVALID_DATA;
+	}
+	delete pDigest;
+
+	// Only verified objects carry the bare hash as name
+	if(!IsFailed(r)) {
+		File::Remove(path);
+		r = File::Move(partPath, path);
+	}
+	if(IsFailed(r)) {
+		File::Remove(partPath);
+	}
+	return r;
+}
+
+void
+ContentSync::CloseRecord(void)
+{
+	delete __pRecordFile;
+	__pRecordFile = null;
+	__recordHeaderLength = 0;
+}
+
+result
+ContentSync::OnBatchCompleted(void)
+{
+	if(__pRecordFile != null || __recordHeaderLength > 0) {
+		CloseRecord();
+		return E_INVALID_DATA;
+	}
+	for(int i = __batchStart; i < __batchEnd; i++) {
+		char hex[ContentManifest::HASH_HEX_LENGTH + 1];
+		ContentManifest::FormatHash(__manifest.GetHash(__pWanted[i]), hex);
+		hex[ContentManifest::HASH_HEX_LENGTH] = 0;
+		String path;
+		GetObjectPath(hex, path);
+		if(!File::IsFileExist(path)) {
+			AppLog("Content object %s is missing from its batch", hex);
+			return E_INVALID_DATA;
+		}
+	}
+	return E_SUCCESS;
+}
+
+bool
+ContentSync::IsOutdated(int index) const
+{
+	const byte* pHash = __manifest.GetHash(index);
+	int local = __local.Find(__manifest.GetPath(index));
+	if(local < 0) {
+		return true;
+	}
+	if(memcmp(__local.GetHash(local), pHash, ContentManifest::HASH_SIZE) == 0) {
+		return false;
+	}
+	int previous = __previous.Find(__manifest.GetPath(index));
+	return previous < 0 || memcmp(__previous.GetHash(previous), pHash, ContentManifest::HASH_SIZE) != 0;
+}
+
+result
+ContentSync::Apply(void)
+{
+	PROFILE_SCOPE("ContentSync::Apply");
+	if(__manifest.GetSerial() == __appliedSerial) {
+		return E_SUCCESS;
+	}
+
+	File journal;
+	result r = journal.Construct(JOURNAL_TMP_PATH, L"w");
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	// A file that is in the way and not the one last synced was made on the device, it moves to a free number
+	int spare = 1;
+	for(int i = 0; i < __manifest.GetCount() && !IsFailed(r); i++) {
+		const mchar* pPath = __manifest.GetPath(i);
+		int local = __local.Find(pPath);
+		if(local < 0 || !IsOutdated(i)) {
+			continue;
+		}
+		int previous = __previous.Find(pPath);
+		if(previous >= 0 && memcmp(__previous.GetHash(previous), __local.GetHash(local), ContentManifest::HASH_SIZE) == 0) {
+			continue;
+		}
+		String path(pPath);
+		String category;
+		int slash = 0;
+		path.IndexOf(L'/', 0, slash);
+		path.SubString(0, slash + 1, category);
+		String sparePath;
+		do {
+			sparePath = category;
+			sparePath.Append(spare++);
+			sparePath.Append(L".txt");
+		} while(__manifest.Find(sparePath.GetPointer()) >= 0 || __local.Find(sparePath.GetPointer()) >= 0);
+
+		String line(L"keep ");
+		line.Append(pPath);
+		line.Append(L'\t');
+		line.Append(sparePath);
+		line.Append(L'\n');
+		r = journal.Write(line);
+	}
+
+	for(int i = 0; i < __manifest.GetCount() && !IsFailed(r); i++) {
+		if(!IsOutdated(i)) {
+			continue;
+		}
+		const mchar* pPath = __manifest.GetPath(i);
+		char hex[ContentManifest::HASH_HEX_LENGTH + 1];
+		ContentManifest::FormatHash(__manifest.GetHash(i), hex);
+		hex[ContentManifest::HASH_HEX_LENGTH] = 0;
+		String line(L"put ");
+		line.Append(String(hex));
+		line.Append(L' ');
+		line.Append(pPath);
+		line.Append(L'\n');
+		r = journal.Write(line);
+		__updated++;
+	}
+
+	// Dropped from the manifest, and still as synced
+	for(int i = 0; i < __previous.GetCount() && !IsFailed(r); i++) {
+		const mchar* pPath = __previous.GetPath(i);
+		int local = __local.Find(pPath);
+		if(__manifest.Find(pPath) >= 0 || local < 0
+				|| memcmp(__local.GetHash(local), __previous.GetHash(i), ContentManifest::HASH_SIZE) != 0) {
+			continue;
+		}
+		String line(L"del ");
+		line.Append(pPath);
+		line.Append(L'\n');
+		r = journal.Write(line);
+		__removed++;
+	}
+
+	if(!IsFailed(r)) {
+		r = journal.Write(String(L"end\n"));
+	}
+	if(!IsFailed(r)) {
+		r = journal.Flush();
+	}
+	if(IsFailed(r)) {
+		AppLog("Writing the content journal failed by %s", GetErrorMessage(r));
+		return r;
+	}
+
+	// The complete journal appearing under its name commits the update
+	File::Remove(JOURNAL_PATH);
+	r = File::Move(JOURNAL_TMP_PATH, JOURNAL_PATH);
+	if(IsFailed(r)) {
+		return r;
+	}
+	return RunJournal();
+}
+
+result
+ContentSync::RunJournal(void)
+{
+	PROFILE_SCOPE("ContentSync::RunJournal");
+	ArrayList lines;
+	lines.Construct();
+	{
+		File journal;
+		result r = journal.Construct(JOURNAL_PATH, L"r");
+		if(IsFailed(r)) {
+			return r;
+		}
+		String line;
+		while(journal.Read(line) == E_SUCCESS) {
+			line.Replace(L"\n", L"");
+			lines.Add(*(new String(line)));
+		}
+	}
+	int count = lines.GetCount();
+	if(count == 0 || !static_cast<String*>(lines.GetAt(count - 1))->Equals(L"end", true)) {
+		AppLog("Dropping an incomplete content journal");
+		lines.RemoveAll(true);
+		File::Remove(JOURNAL_PATH);
+		return E_INVALID_DATA;
+	}
+
+	// Every step can run again after an exit half way through
+	ArrayList emptied;
+	emptied.Construct();
+	for(int i = 0; i < count - 1; i++) {
+		String& line = *static_cast<String*>(lines.GetAt(i));
+		String argument;
+		int space = -1;
+		line.IndexOf(L' ', 0, space);
+		line.SubString(space + 1, argument);
+		if(line.StartsWith(L"keep ", 0)) {
+			int tab = -1;
+			argument.IndexOf(L'\t', 0, tab);
+			String from;
+			String to;
+			argument.SubString(0, tab, from);
+			argument.SubString(tab + 1, to);
+			if(tab < 0 || !ContentManifest::IsValidPath(from.GetPointer()) || !ContentManifest::IsValidPath(to.GetPointer())) {
+				continue;
+			}
+			String fromPath;
+			String toPath;
+			GetCatalogPath(from.GetPointer(), fromPath);
+			GetCatalogPath(to.GetPointer(), toPath);
+			if(!File::IsFileExist(toPath)) {
+				File::Move(fromPath, toPath);
+			}
+		} else if(line.StartsWith(L"put ", 0) && argument.GetLength() > ContentManifest::HASH_HEX_LENGTH + 1) {
+			String hex;
+			String relative;
+			argument.SubString(0, ContentManifest::HASH_HEX_LENGTH, hex);
+			argument.SubString(ContentManifest::HASH_HEX_LENGTH + 1, relative);
+			if(!ContentManifest::IsValidPath(relative.GetPointer())) {
+				continue;
+			}
+			String objectPath(SYNC_DIR);
+			objectPath.Append(hex);
+			String path;
+			GetCatalogPath(relative.GetPointer(), path);
+			String dirPath;
+			int slash = -1;
+			path.LastIndexOf(L'/', path.GetLength() - 1, slash);
+			path.SubString(0, slash, dirPath);
+			Directory::Create(dirPath, true);
+
+			String newPath(path);
+			newPath.Append(NEW_SUFFIX);
+			result r = File::Copy(objectPath, newPath, false);
+			if(!IsFailed(r)) {
+				File::Remove(path);
+				r = File::Move(newPath, path);
+			}
+			if(IsFailed(r) && !File::IsFileExist(objectPath)) {
+				// Staged objects go only with the journal, so this put has run before
+				r = E_SUCCESS;
+			}
+			if(IsFailed(r)) {
+				AppLog("Writing %ls failed by %s", path.GetPointer(), GetErrorMessage(r));
+				lines.RemoveAll(true);
+				emptied.RemoveAll(true);
+				return r;
+			}
+		} else if(line.StartsWith(L"del ", 0) && ContentManifest::IsValidPath(argument.GetPointer())) {
+			String path;
+			GetCatalogPath(argument.GetPointer(), path);
+			File::Remove(path);
+			if(argument.EndsWith(L"/category.info")) {
+				String* pDirPath = new String();
+				path.SubString(0, path.GetLength() - 13, *pDirPath);
+				emptied.Add(*pDirPath);
+			}
+		}
+	}
+	lines.RemoveAll(true);
+
+	// A category without its info goes when nothing of the device is left in it
+	for(int i = 0; i < emptied.GetCount(); i++) {
+		Directory::Remove(*static_cast<String*>(emptied.GetAt(i)), false);
+	}
+	emptied.RemoveAll(true);
+
+	if(File::IsFileExist(PENDING_PATH)) {
+		File::Remove(MANIFEST_PATH);
+		result r = File::Move(PENDING_PATH, MANIFEST_PATH);
+		if(IsFailed(r)) {
+			return r;
+		}
+	}
+	File::Remove(JOURNAL_PATH);
+	RemoveStaged();
+	return E_SUCCESS;
+}
+
+void
+ContentSync::RemoveStaged(void)
+{
+	Directory dir;
+	if(IsFailed(dir.Construct(SYNC_DIR))) {
+		return;
+	}
+	DirEnumerator* pDirEnum = dir.ReadN();
+	if(pDirEnum == null) {
+		return;
+	}
+	while(pDirEnum->MoveNext() == E_SUCCESS) {
+		DirEntry& dirEntry = pDirEnum->GetCurrentDirEntry();
+		String name = dirEntry.GetName();
+		if(dirEntry.IsNomalFile() && !name.Equals(L"manifest.txt", true)) {
+			String path(SYNC_DIR);
+			path.Append(name);
+			File::Remove(path);
+		}
+	}
+	delete pDirEnum;
+}
+
+bool
+ContentSync::IsInterrupted(void)
+{
+	return File::IsFileExist(JOURNAL_PATH);
+}
+
+result
+ContentSync::Recover(void)
+{
+	if(!IsInterrupted()) {
+		return E_SUCCESS;
+	}
+	AppLog("Completing an interrupted content update");
+	return RunJournal();
+}
+
+void
+ContentSync::Finish(result r)
+{
+	CloseRecord();
+	CloseSession();
+	__state = STATE_IDLE;
+	delete[] __pWanted;
+	__pWanted = null;
+	__wantedCount = 0;
+	__batchStart = 0;
+	__batchEnd = 0;
+
+	if(__pListener == null) {
+		return;
+	}
+	if(IsFailed(r)) {
+		__pListener->OnContentSyncFailed(r);
+	} else {
+		__pListener->OnContentSyncCompleted(__updated, __removed);
+	}
+}
+
+void
+ContentSync::GetObjectPath(const char* pHex, String& path)
+{
+	path = SYNC_DIR;
+	path.Append(String(pHex));
+}
+
+void
+ContentSync::GetCatalogPath(const mchar* pPath, String& path)
+{
+	String relative(pPath);
+	int slash = 0;
+	relative.IndexOf(L'/', 0, slash);
+	String category;
+	String file;
+	relative.SubString(0, slash, category);
+	relative.SubString(slash + 1, file);
+	Catalog::GetCategoryPath(category, path);
+	path.Append(file);
+}
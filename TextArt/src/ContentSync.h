@@ -0,0 +1,159 @@
+#ifndef CONTENTSYNC_H_
+#define CONTENTSYNC_H_
+
+#include "ContentManifest.h"
+#include "Port.h"
+#include "TaskScheduler.h"
+
+using namespace Osp::Base;
+using namespace Osp::Net::Http;
+
+// Receives the outcome of ContentSync::Start.
+class IContentSyncListener
+{
+public:
+	virtual ~IContentSyncListener() {}
+
+	// The catalog matches the manifest of the server; updated counts written files, removed deleted ones.
+	virtual void OnContentSyncCompleted(int updated, int removed) = 0;
+	// Nothing was applied; objects already downloaded are kept for the next start.
+	virtual void OnContentSyncFailed(result r) = 0;
+};
+
+/**
+ * Brings the catalog up to the signed manifest of the content server while
+ * transferring only what changed. Files whose path is new or whose content
+ * hash differs from the catalog are fetched by hash in batches from
+ * "<uri>objects?h=<hash>,<hash>,...", which answers "<hash> <size>\n<bytes>"
+ * per object, and every object is verified and staged in /Home/sync under
+ * its hash, so an interrupted sync resumes with the objects still missing.
+ * Files dropped from the manifest are deleted unless changed on the device.
+ * The manifest is requested with the serial the device holds as entity
+ * tag, so an unchanged release, or the one being resumed, answers 304
+ * without a body.
+ * Once everything is staged the writes and deletions are committed to a
+ * journal and applied from it; Recover() completes a journal left behind by
+ * an exit during the apply. The local scan and the apply run as tasks on
+ * TaskScheduler::STRAND_INDEX, behind any catalog record queued there.
+ */
+class ContentSync :
+	public Osp::Net::Http::IHttpTransactionEventListener
+{
+public:
+	ContentSync();
+	virtual ~ContentSync();
+
+	// hostAddr/uri are configurable so the client can be pointed at a local stand-in server; publicKey is DER.
+	result Construct(const String& hostAddr, const String& uri, const ByteBuffer& publicKey, IContentSyncListener& listener);
+
+	result Start(void);
+	void Cancel(void);
+	bool IsBusy(void) const { return __state != STATE_IDLE; }
+	// Body bytes received since Start
+	long long GetReceivedBytes(void) const { return __receivedBytes; }
+
+	// An apply was cut short, the catalog is partly updated until Recover()
+	static bool IsInterrupted(void);
+	// Finishes an apply cut short, before anything reads the catalog
+	static result Recover(void);
+
+private:
+	enum State {
+		STATE_IDLE,
+		STATE_MANIFEST,
+		// the catalog is hashed for the files to fetch on a worker
+		STATE_SCAN,
+		STATE_OBJECTS,
+		// the journal is written and run on a worker
+		STATE_APPLY
+	};
+
+	// Runs ScanLocal() or Apply() for the state on TaskScheduler::STRAND_INDEX, nothing
+	// else touches the sync meanwhile
+	class WorkTask;
+	friend class WorkTask;
+
+	result Request(const String& uri);
+	result RequestBatch(void);
+	result ReadManifest(const byte* pData, int length);
+	// Serial of a manifest staged by a sync cut short, kept as received, or -1
+	int ReadPending(void);
+	result ReadObjects(ByteBuffer& body);
+	result CompleteRecord(void);
+	void CloseRecord(void);
+	result OnManifestCompleted(void);
+	// Hashes the catalog and lists the objects to fetch
+	result ScanLocal(void);
+	result OnBatchCompleted(void);
+	// Fetches the next batch or applies once the objects are staged
+	void Continue(result r);
+	void PostWork(State state);
+	// The file differs from the manifest and was not just left as edited on the device
+	bool IsOutdated(int index) const;
+	result Apply(void);
+	void Finish(result r);
+	void CloseSession(void);
+
+	static void GetObjectPath(const char* pHex, String& path);
+	static void GetCatalogPath(const mchar* pPath, String& path);
+	static result RunJournal(void);
+	static void RemoveStaged(void);
+
+	void OnTransactionReadyToRead(Osp::Net::Http::HttpSession& httpSession, Osp::Net::Http::HttpTransaction& httpTransaction, int availableBodyLen);
+	void OnTransactionAborted(Osp::Net::Http::HttpSession& httpSession, Osp::Net::Http::HttpTransaction& httpTransaction, result r);
+	void OnTransactionReadyToWrite(Osp::Net::Http::HttpSession& httpSession, Osp::Net::Http::HttpTransaction& httpTransaction, int recommendedChunkSize) {}
+	void OnTransactionHeaderCompleted(Osp::Net::Http::HttpSession& httpSession, Osp::Net::Http::HttpTransaction& httpTransaction, int headerLen, bool bAuthRequired);
+	void OnTransactionCompleted(Osp::Net::Http::HttpSession& httpSession, Osp::Net::Http::HttpTransaction& httpTransaction);
+	void OnTransactionCertVerificationRequiredN(Osp::Net::Http::HttpSession& httpSession, Osp::Net::Http::HttpTransaction& httpTransaction, Osp::Base::String* pCert) {}
+
+	// Objects per batch request, and the bytes a batch should stay under
+	static const int BATCH_OBJECTS = 32;
+	static const int BATCH_BYTES = 64 * 1024;
+	static const int MAX_MANIFEST_BYTES = 4 * 1024 * 1024;
+	static const int MAX_OBJECT_BYTES = 1024 * 1024;
+
+	ContentSync(const ContentSync& sync);
+	ContentSync& operator =(const ContentSync& sync);
+
+	Osp::Net::Http::HttpSession* __pHttpSession;
+	Osp::Net::Http::HttpTransaction* __pHttpTransaction;
+	IContentSyncListener* __pListener;
+	String __hostAddr;
+	String __uri;
+	ByteBuffer __publicKey;
+	State __state;
+	TaskScheduler::TaskId __task;
+	// Set while a body is read, reported when the transaction completes
+	result __error;
+	int __statusCode;
+	long long __receivedBytes;
+
+	// Manifest as received, grown while it streams in
+	byte* __pManifestText;
+	int __manifestLength;
+	int __manifestCapacity;
+	ContentManifest __manifest;
+	// The manifest applied last and the files of the catalog
+	ContentManifest __previous;
+	int __appliedSerial;
+	int __pendingSerial;
+	ContentManifest __local;
+
+	// Manifest entries whose content is fetched, one per distinct hash
+	int* __pWanted;
+	int __wantedCount;
+	int __batchStart;
+	int __batchEnd;
+	int __updated;
+	int __removed;
+
+	// The object being received: its header line, then its bytes
+	char __recordHeader[ContentManifest::HASH_HEX_LENGTH + 24];
+	int __recordHeaderLength;
+	byte __recordHash[ContentManifest::HASH_SIZE];
+	long long __recordRemaining;
+	Osp::Io::File* __pRecordFile;
+	Osp::Security::Crypto::Sha1Hash __recordSha1;
+};
+
+#endif
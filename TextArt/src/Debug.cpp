@@ -0,0 +1,121 @@
+#include "Debug.h"
+
+#if defined(_DEBUG) && !defined(TEXTART_HOST)
+
+#include <FIo.h>
+
+#include "JsonWriter.h"
+
+using namespace Osp::Base;
+using namespace Osp::Base::Runtime;
+using namespace Osp::Io;
+using namespace Osp::System;
+
+Profiler::Record Profiler::__records[Profiler::CAPACITY];
+volatile unsigned int Profiler::__next = 0;
+
+static const char* RECORD_PHASES[] = { "X", "C", "C" };
+
+Profiler::Scope::Scope(const char* name):
+	__name(name),
+	__start(Profiler::GetTicks())
+{
+}
+
+Profiler::Scope::~Scope()
+{
+	Profiler::Push(__name, RECORD_SCOPE, __start, (int)(Profiler::GetTicks() - __start));
+}
+
+long long
+Profiler::GetTicks(void)
+{
+	// Millisecond resolution is the best the platform offers
+	long long ticks = 0;
+	SystemTime::GetTicks(ticks);
+	return ticks;
+}
+
+void
+Profiler::Push(const char* name, RecordType type, long long start, int value)
+{
+	unsigned int index = __sync_fetch_and_add(&__next, 1);
+	Record& record = __records[index & (CAPACITY - 1)];
+
+	record.sequence = 0;
+	__sync_synchronize();
+	record.name = name;
+	record.start = start;
+	record.value = value;
+	record.type = type;
+	record.thread = (unsigned long)Thread::GetCurrentThread();
+	__sync_synchronize();
+	record.sequence = index + 1;
+}
+
+void
+Profiler::Count(const char* name, int value)
+{
+	Push(name, RECORD_COUNTER, GetTicks(), value);
+}
+
+void
+Profiler::SampleMemory(const char* name)
+{
+	int value = 0;
+	if(RuntimeInfo::GetValue(L"AllocatedMemory", value) == E_SUCCESS) {
+		Push(name, RECORD_MEMORY, GetTicks(), value);
+	}
+}
+
+result
+Profiler::Export(const String& path)
+{
+	unsigned int next = __next;
+	unsigned int first = (next > (unsigned int)CAPACITY) ? next - CAPACITY : 0;
+
+	JsonWriter writer;
+	result r = writer.Construct(64 * 1024);
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	writer.BeginObject();
+	writer.Key("traceEvents");
+	writer.BeginArray();
+	for(unsigned int i = first; i < next; i++) {
+		const Record& record = __records[i & (CAPACITY - 1)];
+		// skip slots that are being rewritten right now
+		if(record.sequence != i + 1) {
+			continue;
+		}
+
+		writer.BeginObject();
+		writer.Member("name", record.name);
+		writer.Member("ph", RECORD_PHASES[record.type]);
+		writer.Member("pid", (long long)1);
+		writer.Member("tid", (long long)record.thread);
+		writer.Member("ts", record.start * 1000);
+		if(record.type == RECORD_SCOPE) {
+			writer.Member("dur", (long long)record.value * 1000);
+		} else {
+			writer.Key("args");
+			writer.BeginObject();
+			writer.Member(record.type == RECORD_MEMORY ? "bytes" : "value", (long long)record.value);
+			writer.EndObject();
+		}
+		writer.EndObject();
+	}
+	writer.EndArray();
+	writer.EndObject();
+
+	File file;
+	r = file.Construct(path, L"w");
+	if(!IsFailed(r)) {
+		r = file.Write(writer.GetPointer(), writer.GetLength());
+	}
+	AppLog("Profiler exported %d records to %ls: %s", next - first, path.GetPointer(), GetErrorMessage(r));
+	return r;
+}
+
+#endif
@@ -1,4 +1,12 @@
-#include <FBase.h>
+#ifndef DEBUG_H_
+#define DEBUG_H_
+
+#include "Port.h"
+
+using namespace Osp::Base;
+
+#ifndef TEXTART_HOST
+
 #include <FSystem.h>
 
 using namespace Osp::System;
@@ -26,3 +34,74 @@ public:
 }
 
 };
+
+#endif
+
+#if defined(_DEBUG) && !defined(TEXTART_HOST)
+
+/**
+ * Hot-path instrumentation for debug builds. Scoped timers, counters and
+ * memory samples go into a fixed ring buffer without locking and can be
+ * exported as a Chrome trace (chrome://tracing) JSON file.
+ * Names must be string literals, only the pointer is stored.
+ * Release builds compile all PROFILE_* macros to nothing.
+ */
+class Profiler {
+public:
+	enum RecordType {
+		RECORD_SCOPE = 0,
+		RECORD_COUNTER = 1,
+		RECORD_MEMORY = 2
+	};
+
+	class Scope {
+	public:
+		Scope(const char* name);
+		~Scope();
+	private:
+		const char* __name;
+		long long __start;
+	};
+
+	static void Count(const char* name, int value);
+	static void SampleMemory(const char* name);
+	static result Export(const Osp::Base::String& path);
+
+	// Power of two, the ring index is masked
+	static const int CAPACITY = 4096;
+
+private:
+	struct Record {
+		const char* name;
+		long long start;
+		int value;
+		int type;
+		unsigned long thread;
+		// 0 while the slot is written, index + 1 once complete
+		volatile unsigned int sequence;
+	};
+
+	static void Push(const char* name, RecordType type, long long start, int value);
+	static long long GetTicks(void);
+
+	static Record __records[CAPACITY];
+	static volatile unsigned int __next;
+};
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_SCOPE(name) Profiler::Scope PROFILE_CONCAT(__profileScope, __LINE__)(name)
+#define PROFILE_COUNT(name, value) Profiler::Count(name, value)
+#define PROFILE_MEMORY(name) Profiler::SampleMemory(name)
+#define PROFILE_EXPORT() Profiler::Export(L"/Home/trace.json")
+
+#else
+
+#define PROFILE_SCOPE(name) ((void) 0)
+#define PROFILE_COUNT(name, value) ((void) 0)
+#define PROFILE_MEMORY(name) ((void) 0)
+#define PROFILE_EXPORT() ((void) 0)
+
+#endif
+
+#endif
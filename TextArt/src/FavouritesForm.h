@@ -17,6 +17,7 @@ public:
 public:
 	result OnDraw(void);
 	virtual result OnInitializing(void);
+	virtual void OnLanguageChanged(void);
 };
 
 #endif
@@ -2,24 +2,94 @@
 #include "CategoryListForm.h"
 #include "ItemListForm.h"
 
+#include "Catalog.h"
+#include "ContentKey.h"
 #include "Debug.h"
+#include "Helper.h"
+#include "TextPic.h"
 
 using namespace Osp::App;
 using namespace Osp::Base;
+using namespace Osp::Graphics;
+using namespace Osp::Io;
 using namespace Osp::Ui;
 using namespace Osp::Ui::Controls;
 
+// Lists the catalog off the UI thread, a quiet scan of a large one takes a good half second
+class CatalogWatchTask :
+	public ITask
+{
+public:
+	enum Operation {
+		RECORD,
+		// only when nothing was recorded yet
+		RECORD_ONCE,
+		SCAN
+	};
+
+	CatalogWatchTask(FormManager& manager, Operation operation):
+		__manager(manager),
+		__operation(operation)
+	{
+		__changes.Construct();
+	}
+
+	~CatalogWatchTask()
+	{
+		__changes.RemoveAll(true);
+	}
+
+	result Run(const CancelToken& token)
+	{
+		PROFILE_SCOPE("CatalogWatchTask::Run");
+		CatalogWatcher& watcher = __manager.__catalogWatcher;
+		if(__operation == SCAN) {
+			// nothing to compare with before the first trip to the background
+			return watcher.IsRecorded() ? watcher.Scan(__changes) : E_SUCCESS;
+		}
+		if(__operation == RECORD_ONCE && watcher.IsRecorded()) {
+			return E_SUCCESS;
+		}
+		return watcher.Record();
+	}
+
+	void OnTaskCompleted(result r)
+	{
+		if(IsFailed(r)) {
+			AppLog("Catalog not listed by %s", GetErrorMessage(r));
+		} else if(__changes.GetCount() > 0) {
+			__manager.OnCatalogChanged(__changes);
+		}
+	}
+
+private:
+	FormManager& __manager;
+	Operation __operation;
+	ArrayList __changes;
+};
+
 FormManager::FormManager(void):
 	__itemlistForm(null),
 	__categoryForm(null),
 	activeItemList(false),
 	__recentForm(null),
-	__favouritesForm(null)
+	__favouritesForm(null),
+	__infoForm(null),
+	__similarForm(null),
+	__pSimilarReturn(null),
+	__viewerForm(null),
+	__pViewerReturn(null),
+	__pContentSync(null),
+	__pSnapshotForm(null),
+	__captureSnapshot(false),
+	__requestHead(0),
+	__requestCount(0)
 {
 }
 
 FormManager::~FormManager(void)
 {
+	delete __pContentSync;
 }
 
 bool FormManager::Initialize()
@@ -32,18 +102,234 @@ bool FormManager::Initialize()
 
 bool FormManager::SetStarterForm(RequestId requestId, Osp::Base::Collection::IList* pArgs)
 {
+	Bitmap* pSnapshot = StartSnapshot::ReadN();
+	if(pSnapshot == null) {
+		__captureSnapshot = true;
+		SwitchToForm(REQUEST_CATEGORYLIST, null);
+		return true;
+	}
 
-	SwitchToForm(REQUEST_CATEGORYLIST, null);
+	// The snapshot is on screen when the start returns, the catalog is read on the next event
+	Frame *pFrame = Application::GetInstance()->GetAppFrame()->GetFrame();
+	__pSnapshotForm = new SnapshotForm(pSnapshot);
+	__pSnapshotForm->Initialize();
+	pFrame->AddControl(*__pSnapshotForm);
+	pFrame->SetCurrentForm(*__pSnapshotForm);
+	__pSnapshotForm->Draw();
+	__pSnapshotForm->Show();
+	Navigate(REQUEST_CATEGORYLIST);
 	return true;
 }
 
+result FormManager::Navigate(RequestId requestId, const String& category, const String& item)
+{
+	Frame *pFrame = Application::GetInstance()->GetAppFrame()->GetFrame();
+	FormManager *pFormMgr = static_cast<FormManager *>(pFrame->GetControl("FormManager"));
+	if(pFormMgr == null) {
+		return E_INVALID_STATE;
+	}
+	return pFormMgr->PostRequest(requestId, category, item);
+}
+
+void FormManager::SetSimilarityIndex(SimilarityIndex* pIndex)
+{
+	Frame *pFrame = Application::GetInstance()->GetAppFrame()->GetFrame();
+	FormManager *pFormMgr = static_cast<FormManager *>(pFrame->GetControl("FormManager"));
+	if(pFormMgr == null || pFormMgr->__similarForm == null) {
+		delete pIndex;
+		return;
+	}
+	pFormMgr->__similarForm->SetIndex(pIndex);
+}
+
+static result CopyId(const String& value, mchar* pId)
+{
+	int length = value.GetLength();
+	if(length >= NavigationRequest::MAX_ID_LENGTH) {
+		return E_INVALID_ARG;
+	}
+	const mchar* pValue = value.GetPointer();
+	for(int i = 0; i < length; i++) {
+		pId[i] = pValue[i];
+	}
+	pId[length] = 0;
+	return E_SUCCESS;
+}
+
+result FormManager::PostRequest(RequestId requestId, const String& category, const String& item)
+{
+	// only a burst of taps faster than the event loop fills the pool
+	if(__requestCount == REQUEST_POOL_SIZE) {
+		AppLog("Navigation to %d dropped, %d requests waiting", requestId, __requestCount);
+		return E_OVERFLOW;
+	}
+	NavigationRequest& request = __requests[(__requestHead + __requestCount) % REQUEST_POOL_SIZE];
+	result r = CopyId(category, request.category);
+	if(!IsFailed(r)) {
+		r = CopyId(item, request.item);
+	}
+	if(IsFailed(r)) {
+		AppLog("Navigation to %d dropped, id too long", requestId);
+		return r;
+	}
+	request.requestId = requestId;
+	__requestCount++;
+	SendUserEvent(REQUEST_NAVIGATE, null);
+	return E_SUCCESS;
+}
+
 void FormManager::OnUserEventReceivedN(RequestId requestId, Osp::Base::Collection::IList* pArgs)
 {
-	SwitchToForm(requestId, pArgs);
+	if(requestId == REQUEST_NAVIGATE) {
+		if(__requestCount == 0) {
+			return;
+		}
+		// out of the pool first, the form switched to may navigate again
+		NavigationRequest request = __requests[__requestHead];
+		__requestHead = (__requestHead + 1) % REQUEST_POOL_SIZE;
+		__requestCount--;
+		SwitchToForm(request.requestId, &request);
+		return;
+	}
+	if(requestId >= REQUEST_LANGUAGE && requestId < REQUEST_LANGUAGE + Catalog::LANGUAGE_COUNT) {
+		ChangeLanguage(requestId - REQUEST_LANGUAGE);
+		return;
+	}
+	if(requestId == REQUEST_CATALOGRECORD) {
+		RecordCatalog(false);
+		return;
+	}
+	if(requestId == REQUEST_CATALOGSCAN) {
+		ScanCatalog();
+		return;
+	}
+	if(requestId == REQUEST_CONTENTUPDATE) {
+		UpdateContent();
+		return;
+	}
+	// forms are switched through Navigate() only
+	AppLog("Unknown request %d", requestId);
+}
+
+void FormManager::ChangeLanguage(int language)
+{
+	PROFILE_SCOPE("FormManager::ChangeLanguage");
+	if(language == TextPic::__InternalAppLanguageIndex) {
+		return;
+	}
+	TextPic::SetLanguage((TextPic::InternalAppLanguageEnum)language);
+
+	// Every open form rebuilds from what it holds, nothing is read again
+	TabsForm* forms[] = { __categoryForm, __itemlistForm, __recentForm, __favouritesForm, __infoForm, __similarForm };
+	for(unsigned int i = 0; i < sizeof(forms) / sizeof(forms[0]); i++) {
+		if(forms[i] != null) {
+			forms[i]->OnLanguageChanged();
+		}
+	}
+
+	Form* pForm = Application::GetInstance()->GetAppFrame()->GetFrame()->GetCurrentForm();
+	if(pForm != null) {
+		pForm->RequestRedraw(true);
+	}
+}
+
+void FormManager::RecordCatalog(bool once)
+{
+	TaskScheduler::Post(new CatalogWatchTask(*this, once ? CatalogWatchTask::RECORD_ONCE : CatalogWatchTask::RECORD),
+			TaskScheduler::LANE_BACKGROUND, TaskScheduler::STRAND_INDEX);
+}
+
+void FormManager::ScanCatalog(void)
+{
+	// after a record still on the strand
+	TaskScheduler::Post(new CatalogWatchTask(*this, CatalogWatchTask::SCAN), TaskScheduler::LANE_PREFETCH, TaskScheduler::STRAND_INDEX);
 }
 
-void FormManager::SwitchToForm(RequestId requestId, Osp::Base::Collection::IList* pArgs)
+void FormManager::OnCatalogChanged(const ArrayList& changes)
 {
+	PROFILE_SCOPE("FormManager::OnCatalogChanged");
+	AppLog("Catalog changed in %d categories", changes.GetCount());
+
+	// Open forms patch their lists, closed ones read the catalog when they open
+	if(__categoryForm != null) {
+		__categoryForm->OnCatalogChanged(changes);
+	}
+	if(__itemlistForm != null) {
+		__itemlistForm->OnCatalogChanged(changes);
+	}
+
+	Form* pForm = Application::GetInstance()->GetAppFrame()->GetFrame()->GetCurrentForm();
+	if(pForm != null) {
+		pForm->RequestRedraw(true);
+	}
+}
+
+void FormManager::UpdateContent(void)
+{
+	if(__pContentSync == null) {
+		String hostAddr(L"content.mobigear.ru");
+		String uri(L"content.mobigear.ru/textart/");
+
+		// Optional override of the content server: host on the first line, uri on the second.
+		static const wchar_t* ENDPOINT_PATH = L"/Home/content.endpoint";
+		if(File::IsFileExist(ENDPOINT_PATH)) {
+			File file;
+			if(!IsFailed(file.Construct(ENDPOINT_PATH, L"r"))) {
+				file.Read(hostAddr);
+				file.Read(uri);
+				hostAddr.Replace("\n", "");
+				uri.Replace("\n", "");
+				AppLog("Content endpoint: %ls %ls", hostAddr.GetPointer(), uri.GetPointer());
+			}
+		}
+
+		ByteBuffer publicKey;
+		publicKey.Construct(sizeof(CONTENT_PUBLIC_KEY));
+		publicKey.SetArray(CONTENT_PUBLIC_KEY, 0, sizeof(CONTENT_PUBLIC_KEY));
+		publicKey.Flip();
+		__pContentSync = new ContentSync();
+		__pContentSync->Construct(hostAddr, uri, publicKey, *this);
+	}
+	if(__pContentSync->IsBusy()) {
+		return;
+	}
+
+	// The sync shows up through the watcher, so it needs the catalog as it was.
+	// The record is on the strand ahead of the sync's apply
+	RecordCatalog(true);
+	result r = __pContentSync->Start();
+	if(IsFailed(r)) {
+		OnContentSyncFailed(r);
+		return;
+	}
+	SetUpdateStatus(Helper::GetTraslation(IDS_UPDATING));
+}
+
+void FormManager::SetUpdateStatus(const String& status)
+{
+	if(__infoForm != null) {
+		__infoForm->SetUpdateStatus(status);
+	}
+}
+
+void FormManager::OnContentSyncCompleted(int updated, int removed)
+{
+	AppLog("Content sync updated %d and removed %d files", updated, removed);
+	String status = Helper::GetTraslation(IDS_UPDATED);
+	status.Append(updated + removed);
+	SetUpdateStatus(status);
+	ScanCatalog();
+}
+
+void FormManager::OnContentSyncFailed(result r)
+{
+	AppLog("Content sync failed by %s", GetErrorMessage(r));
+	SetUpdateStatus(Helper::GetTraslation(IDS_UPDATEFAILED));
+}
+
+void FormManager::SwitchToForm(RequestId requestId, const NavigationRequest* pRequest)
+{
+	PROFILE_SCOPE("FormManager::SwitchToForm");
 	Frame *pFrame = Application::GetInstance()->GetAppFrame()->GetFrame();
 
 	if(requestId == REQUEST_CATEGORYLISTBACK) {
@@ -55,6 +341,22 @@ void FormManager::SwitchToForm(RequestId requestId, Osp::Base::Collection::IList
 		requestId = REQUEST_ITEMLIST;
 	}
 
+	// a request for another category than the open list's builds a new list, as when none is open
+	CategoryItemForm* pReplacedList = null;
+	if(requestId == REQUEST_ITEMLIST && __itemlistForm != null && pRequest != null && pRequest->category[0] != 0
+			&& !__itemlistForm->GetCategory().Equals(String(pRequest->category))) {
+		pReplacedList = __itemlistForm;
+		__itemlistForm = null;
+	}
+
+	// the category list has the titles of every category it shows
+	String titles[Catalog::LANGUAGE_COUNT];
+	if(requestId == REQUEST_ITEMLIST && __itemlistForm == null
+			&& (pRequest == null || __categoryForm == null || !__categoryForm->GetCategoryTitles(pRequest->category, titles))) {
+		// back from the info tab with no list open, or the category is gone
+		requestId = REQUEST_CATEGORYLIST;
+	}
+
 	switch(requestId) {
 		case REQUEST_CATEGORYLIST: {
 			activeItemList = false;
@@ -67,23 +369,34 @@ void FormManager::SwitchToForm(RequestId requestId, Osp::Base::Collection::IList
 			pFrame->SetCurrentForm(*__categoryForm);
 			__categoryForm->Draw();
 			__categoryForm->Show();
+			if(__captureSnapshot) {
+				__captureSnapshot = false;
+				StartSnapshot::Capture(*__categoryForm);
+			}
 
 			if (__itemlistForm != null) {
 				pFrame->RemoveControl(*__itemlistForm);
 				__itemlistForm = null;
 			}
+			if(pReplacedList != null) {
+				pFrame->RemoveControl(*pReplacedList);
+			}
 		}
 		break;
 		case REQUEST_ITEMLIST: {
 			activeItemList = true;
 
-			if(__itemlistForm == null) {
-				String title = *(static_cast<String*> (pArgs->GetAt(0)));
-				String dir = *(static_cast<String*> (pArgs->GetAt(1)));
-
+			// with no list open there is a request, the category of the titles found above
+			bool created = __itemlistForm == null;
+			if(created) {
 				__itemlistForm = new CategoryItemForm();
-				__itemlistForm->Initialize(title, dir);
-
+				__itemlistForm->Initialize(titles, pRequest->category);
+			}
+			// on a new list before AddControl starts the load
+			if(pRequest != null && pRequest->item[0] != 0) {
+				__itemlistForm->FocusItem(pRequest->item);
+			}
+			if(created) {
 				pFrame->AddControl(*__itemlistForm);
 			}
 			pFrame->SetCurrentForm(*__itemlistForm);
@@ -91,6 +404,63 @@ void FormManager::SwitchToForm(RequestId requestId, Osp::Base::Collection::IList
 			__itemlistForm->Draw();
 			__itemlistForm->Show();
 
+			// off the frame once the new one is current
+			if(pReplacedList != null) {
+				pFrame->RemoveControl(*pReplacedList);
+			}
+		}
+		break;
+		case REQUEST_SIMILAR: {
+			if(__similarForm == null) {
+				__similarForm = new SimilarItemForm();
+				__similarForm->Initialize();
+				pFrame->AddControl(*__similarForm);
+			}
+			// a similar item of a similar item keeps the way back
+			if(pFrame->GetCurrentForm() != __similarForm) {
+				__pSimilarReturn = pFrame->GetCurrentForm();
+			}
+			if(pRequest != null) {
+				__similarForm->ShowSimilar(pRequest->item);
+			}
+			pFrame->SetCurrentForm(*__similarForm);
+			__similarForm->Draw();
+			__similarForm->Show();
+		}
+		break;
+		case REQUEST_SIMILARBACK: {
+			Form* pForm = __pSimilarReturn != null ? __pSimilarReturn : __categoryForm;
+			__pSimilarReturn = null;
+			pFrame->SetCurrentForm(*pForm);
+			pForm->Draw();
+			pForm->Show();
+		}
+		break;
+		case REQUEST_VIEWER: {
+			if(__viewerForm == null) {
+				__pViewerReturn = pFrame->GetCurrentForm();
+				__viewerForm = new ArtViewerForm();
+				__viewerForm->Initialize();
+				pFrame->AddControl(*__viewerForm);
+			}
+			if(pRequest != null) {
+				__viewerForm->ShowArt(pRequest->item);
+			}
+			pFrame->SetCurrentForm(*__viewerForm);
+			__viewerForm->Draw();
+			__viewerForm->Show();
+		}
+		break;
+		case REQUEST_VIEWERBACK: {
+			Form* pForm = __pViewerReturn != null ? __pViewerReturn : __categoryForm;
+			__pViewerReturn = null;
+			pFrame->SetCurrentForm(*pForm);
+			pForm->Draw();
+			pForm->Show();
+			if(__viewerForm != null) {
+				pFrame->RemoveControl(*__viewerForm);
+				__viewerForm = null;
+			}
 		}
 		break;
 		case REQUEST_RECENT: {
@@ -132,9 +502,11 @@ void FormManager::SwitchToForm(RequestId requestId, Osp::Base::Collection::IList
 		break;
 	}
 
-	/*if(pArgs != null) {
-		pArgs->RemoveAll(true);
-		delete pArgs;
-	}*/
+	if(__pSnapshotForm != null && pFrame->GetCurrentForm() != __pSnapshotForm) {
+		pFrame->RemoveControl(*__pSnapshotForm);
+		__pSnapshotForm = null;
+	}
+
+	PROFILE_MEMORY("memory");
 }
 
@@ -5,14 +5,39 @@
 #include <FBase.h>
 #include <FUi.h>
 
+#include "CatalogWatcher.h"
+#include "ContentSync.h"
 #include "CategoryListForm.h"
 #include "CategoryItemForm.h"
 #include "RecentForm.h"
 #include "FavouritesForm.h"
 #include "InfoForm.h"
+#include "SimilarItemForm.h"
+#include "ArtViewerForm.h"
+#include "StartSnapshot.h"
+#include "TaskScheduler.h"
+
+class CatalogWatchTask;
+
+/**
+ * Where a form asks to go, posted by FormManager::Navigate(). The request is
+ * copied into a slot of a small pool in FormManager and the user event
+ * carries nothing, so navigating allocates nothing; the pool owns the
+ * payload until FormManager takes it out on delivery.
+ */
+struct NavigationRequest {
+	static const int MAX_ID_LENGTH = 256;
+
+	RequestId requestId;
+	// Catalog directory name of the category, empty when there is none
+	mchar category[MAX_ID_LENGTH];
+	// Path of the item the form shows or scrolls to, empty when there is none
+	mchar item[MAX_ID_LENGTH];
+};
 
 class FormManager :
-	public Osp::Ui::Controls::Form
+	public Osp::Ui::Controls::Form,
+	public IContentSyncListener
 {
 public:
 	FormManager(void);
@@ -22,6 +47,13 @@ public:
 	bool Initialize();
 	bool SetStarterForm(RequestId requestId, Osp::Base::Collection::IList* pArgs);
 
+	// Posts a request for the form of requestId to the FormManager of the frame,
+	// E_OVERFLOW while all the slots are waiting for delivery
+	static result Navigate(RequestId requestId, const Osp::Base::String& category = L"", const Osp::Base::String& item = L"");
+	// Hands a similarity index built after a catalog change to the similar item
+	// form, deleted when that form was never opened
+	static void SetSimilarityIndex(SimilarityIndex* pIndex);
+
 	static const RequestId REQUEST_TAB = 100;
 	static const RequestId REQUEST_CATEGORYLIST = 101;
 	static const RequestId REQUEST_CATEGORYLISTBACK = 301;
@@ -29,7 +61,25 @@ public:
 	static const RequestId REQUEST_FAVOURITES = 103;
 	static const RequestId REQUEST_INFO = 104;
 
+	// the category, an item opens the list scrolled to it
 	static const RequestId REQUEST_ITEMLIST = 201;
+	// the item, back returns to the form it came from
+	static const RequestId REQUEST_SIMILAR = 202;
+	static const RequestId REQUEST_SIMILARBACK = 302;
+	// the item full screen, back returns to the form it came from
+	static const RequestId REQUEST_VIEWER = 203;
+	static const RequestId REQUEST_VIEWERBACK = 303;
+
+	// plus a TextPic::InternalAppLanguageEnum value
+	static const RequestId REQUEST_LANGUAGE = 400;
+
+	// The catalog is recorded when the application goes to the background and compared on return
+	static const RequestId REQUEST_CATALOGRECORD = 500;
+	static const RequestId REQUEST_CATALOGSCAN = 501;
+	// Brings the catalog up to the content server, the open forms pick up what changed
+	static const RequestId REQUEST_CONTENTUPDATE = 502;
+	// Takes the oldest NavigationRequest out of the pool
+	static const RequestId REQUEST_NAVIGATE = 503;
 
 private:
 	CategoryListForm* __categoryForm;
@@ -37,11 +87,43 @@ private:
 	RecentForm* __recentForm;
 	FavouritesForm* __favouritesForm;
 	InfoForm* __infoForm;
+	SimilarItemForm* __similarForm;
+	Osp::Ui::Controls::Form* __pSimilarReturn;
+	// Built for every item viewed, its tiles go with it
+	ArtViewerForm* __viewerForm;
+	Osp::Ui::Controls::Form* __pViewerReturn;
+	// Only touched by CatalogWatchTask, which runs on TaskScheduler::STRAND_INDEX
+	CatalogWatcher __catalogWatcher;
+	friend class CatalogWatchTask;
+	ContentSync* __pContentSync;
+	// Up from the start until the category list is built
+	SnapshotForm* __pSnapshotForm;
+	// The category list is saved for the next start when it first shows
+	bool __captureSnapshot;
 
 	bool activeItemList;
 
+	// Requests posted and not delivered yet, in posting order from __requestHead
+	static const int REQUEST_POOL_SIZE = 8;
+	NavigationRequest __requests[REQUEST_POOL_SIZE];
+	int __requestHead;
+	int __requestCount;
+
+	result PostRequest(RequestId requestId, const Osp::Base::String& category, const Osp::Base::String& item);
+
 protected:
-	void SwitchToForm(RequestId requestId, Osp::Base::Collection::IList* pArgs);
+	// request null is one without payload
+	void SwitchToForm(RequestId requestId, const NavigationRequest* pRequest);
+	void ChangeLanguage(int language);
+	// Post a CatalogWatchTask, the scan's changes come back to OnCatalogChanged()
+	void RecordCatalog(bool once);
+	void ScanCatalog(void);
+	void OnCatalogChanged(const Osp::Base::Collection::ArrayList& changes);
+	void UpdateContent(void);
+	void SetUpdateStatus(const Osp::Base::String& status);
+
+	void OnContentSyncCompleted(int updated, int removed);
+	void OnContentSyncFailed(result r);
 
 public:
 	virtual void OnUserEventReceivedN(RequestId requestId, Osp::Base::Collection::IList* pArgs);
@@ -0,0 +1,330 @@
+#include "FrameMonitor.h"
+
+#include <FApp.h>
+#include <FIo.h>
+#include <FSystem.h>
+#include <FUi.h>
+
+#include <string.h>
+
+#include "JsonWriter.h"
+#include "Retina.h"
+
+using namespace Osp::App;
+using namespace Osp::Base;
+using namespace Osp::Base::Runtime;
+using namespace Osp::Graphics;
+using namespace Osp::Io;
+using namespace Osp::System;
+using namespace Osp::Ui::Controls;
+
+static const wchar_t* ENABLE_PATH = L"/Home/frames.enable";
+static const wchar_t* DUMP_PATH = L"/Home/frames.json";
+
+static const char* HISTOGRAM_NAMES[] = { "frame", "interval", "art", "title" };
+static const char* ELEMENT_NAMES[] = { "art", "title" };
+
+FrameMonitor* FrameMonitor::__pInstance = null;
+
+FrameMonitor::Scope::Scope(ElementKind kind, const ItemStore* pStore, int index):
+	__kind(kind),
+	__pStore(pStore),
+	__index(index),
+	__start(FrameMonitor::__pInstance != null ? FrameMonitor::GetTicks() : 0)
+{
+}
+
+FrameMonitor::Scope::~Scope()
+{
+	if(__start != 0 && FrameMonitor::__pInstance != null) {
+		FrameMonitor::__pInstance->Record(__kind, __pStore, __index, __start, FrameMonitor::GetTicks());
+	}
+}
+
+FrameMonitor::FrameMonitor():
+	__slowDrawCount(0),
+	__janks(0),
+	__frameStart(0),
+	__frameEnd(0),
+	__lastFrameStart(0),
+	__shownFrames(0)
+{
+	memset(__histograms, 0, sizeof(__histograms));
+	for(int i = 0; i < SLOW_DRAW_COUNT; i++) {
+		__slowDraws[i].time = 0;
+		__slowDraws[i].kind = 0;
+	}
+}
+
+FrameMonitor::~FrameMonitor()
+{
+	__timer.Cancel();
+}
+
+result
+FrameMonitor::Setup(void)
+{
+	if(__pInstance != null || !File::IsFileExist(ENABLE_PATH)) {
+		return E_SUCCESS;
+	}
+	__pInstance = new FrameMonitor();
+	result r = __pInstance->Construct();
+	if(IsFailed(r)) {
+		delete __pInstance;
+		__pInstance = null;
+		return r;
+	}
+	AppLog("Frame monitor on, dumps to %ls", DUMP_PATH);
+	return E_SUCCESS;
+}
+
+void
+FrameMonitor::Shutdown(void)
+{
+	Dump();
+	delete __pInstance;
+	__pInstance = null;
+}
+
+result
+FrameMonitor::Dump(void)
+{
+	if(__pInstance == null) {
+		return E_SUCCESS;
+	}
+	__pInstance->CloseFrame();
+	return __pInstance->Write(DUMP_PATH);
+}
+
+result
+FrameMonitor::Construct(void)
+{
+	result r = __font.Construct(FONT_STYLE_PLAIN, Retina::GetSize(Retina::SIZE_RESULT_CATEGORY_FONT));
+	if(!IsFailed(r)) {
+		r = __timer.Construct(*this);
+	}
+	if(!IsFailed(r)) {
+		r = __timer.Start(OVERLAY_PERIOD);
+	}
+	return r;
+}
+
+long long
+FrameMonitor::GetTicks(void)
+{
+	long long ticks = 0;
+	SystemTime::GetTicks(ticks);
+	return ticks;
+}
+
+void
+FrameMonitor::Add(Histogram& histogram, int time)
+{
+	if(time < 0) {
+		time = 0;
+	}
+	histogram.buckets[time < BUCKET_COUNT ? time : BUCKET_COUNT - 1]++;
+	histogram.count++;
+	if(time > histogram.max) {
+		histogram.max = time;
+	}
+}
+
+int
+FrameMonitor::GetPercentile(const Histogram& histogram, int percent)
+{
+	if(histogram.count == 0) {
+		return 0;
+	}
+	// the smallest time at or above which the slowest (100 - percent)% lie
+	int rank = (histogram.count * percent + 99) / 100;
+	int seen = 0;
+	for(int time = 0; time < BUCKET_COUNT; time++) {
+		seen += histogram.buckets[time];
+		if(seen >= rank) {
+			return time;
+		}
+	}
+	return histogram.max;
+}
+
+void
+FrameMonitor::Record(ElementKind kind, const ItemStore* pStore, int index, long long start, long long end)
+{
+	int time = (int)(end - start);
+	Add(__histograms[HISTOGRAM_ELEMENT + kind], time);
+	if(__slowDrawCount < SLOW_DRAW_COUNT || time > __slowDraws[SLOW_DRAW_COUNT - 1].time) {
+		KeepSlowDraw(kind, pStore, index, time);
+	}
+
+	if(__frameEnd != 0 && start - __frameEnd > FRAME_GAP) {
+		CloseFrame();
+	}
+	if(__frameEnd == 0) {
+		__frameStart = start;
+	}
+	__frameEnd = end;
+}
+
+void
+FrameMonitor::CloseFrame(void)
+{
+	if(__frameEnd == 0) {
+		return;
+	}
+	Add(__histograms[HISTOGRAM_FRAME], (int)(__frameEnd - __frameStart));
+	// the first frame of a scroll has nothing to follow
+	int interval = (int)(__frameStart - __lastFrameStart);
+	if(__lastFrameStart != 0 && interval < SCROLL_GAP) {
+		Add(__histograms[HISTOGRAM_INTERVAL], interval);
+		if(interval > JANK_INTERVAL) {
+			__janks++;
+		}
+	}
+	__lastFrameStart = __frameStart;
+	__frameEnd = 0;
+}
+
+void
+FrameMonitor::KeepSlowDraw(ElementKind kind, const ItemStore* pStore, int index, int time)
+{
+	// insertion into the short sorted list, the last one falls off when full
+	int position = __slowDrawCount < SLOW_DRAW_COUNT ? __slowDrawCount++ : SLOW_DRAW_COUNT - 1;
+	while(position > 0 && __slowDraws[position - 1].time < time) {
+		__slowDraws[position] = __slowDraws[position - 1];
+		position--;
+	}
+	SlowDraw& draw = __slowDraws[position];
+	draw.time = time;
+	draw.kind = kind;
+	draw.item.Clear();
+	if(pStore == null || IsFailed(pStore->GetPath(index, draw.item))) {
+		draw.item = L"(preview)";
+	}
+}
+
+void
+FrameMonitor::GetSummary(String& summary) const
+{
+	const Histogram& frames = __histograms[HISTOGRAM_FRAME];
+	const Histogram& intervals = __histograms[HISTOGRAM_INTERVAL];
+	summary.Clear();
+	summary.Append(L"frame ");
+	summary.Append(GetPercentile(frames, 50));
+	summary.Append(L"/");
+	summary.Append(GetPercentile(frames, 95));
+	summary.Append(L"/");
+	summary.Append(GetPercentile(frames, 99));
+	summary.Append(L" gap ");
+	summary.Append(GetPercentile(intervals, 50));
+	summary.Append(L"/");
+	summary.Append(GetPercentile(intervals, 95));
+	summary.Append(L"/");
+	summary.Append(GetPercentile(intervals, 99));
+	summary.Append(L" ms, jank ");
+	summary.Append(__janks);
+	summary.Append(L" of ");
+	summary.Append(frames.count);
+}
+
+void
+FrameMonitor::DrawOverlay(const String& summary)
+{
+	// Forms share the frame buffer, the strip stays until the indicator is drawn again
+	Frame* pFrame = Application::GetInstance()->GetAppFrame()->GetFrame();
+	Rectangle rect(0, 0, pFrame->GetWidth(), __font.GetSize() + 4);
+	Canvas* pCanvas = pFrame->GetCanvasN(rect);
+	if(pCanvas == null) {
+		return;
+	}
+	pCanvas->FillRectangle(Color::COLOR_BLACK, Rectangle(0, 0, rect.width, rect.height));
+	pCanvas->SetFont(__font);
+	pCanvas->SetForegroundColor(__janks > 0 ? Color::COLOR_YELLOW : Color::COLOR_GREEN);
+	pCanvas->DrawText(Point(2, 2), summary);
+	pCanvas->Show();
+	delete pCanvas;
+}
+
+result
+FrameMonitor::Write(const String& path) const
+{
+	JsonWriter writer;
+	result r = writer.Construct(16 * 1024);
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	writer.BeginObject();
+	writer.Member("frames", (long long)__histograms[HISTOGRAM_FRAME].count);
+	writer.Member("janks", (long long)__janks);
+	writer.Member("jankInterval", (long long)JANK_INTERVAL);
+	writer.Key("histograms");
+	writer.BeginObject();
+	for(int i = 0; i < HISTOGRAM_COUNT; i++) {
+		const Histogram& histogram = __histograms[i];
+		writer.Key(HISTOGRAM_NAMES[i]);
+		writer.BeginObject();
+		writer.Member("count", (long long)histogram.count);
+		writer.Member("p50", (long long)GetPercentile(histogram, 50));
+		writer.Member("p95", (long long)GetPercentile(histogram, 95));
+		writer.Member("p99", (long long)GetPercentile(histogram, 99));
+		writer.Member("max", (long long)histogram.max);
+		// counts by milliseconds, up to the longest bucket used
+		int used = 0;
+		for(int time = 0; time < BUCKET_COUNT; time++) {
+			if(histogram.buckets[time] != 0) {
+				used = time + 1;
+			}
+		}
+		writer.Key("buckets");
+		writer.BeginArray();
+		for(int time = 0; time < used; time++) {
+			writer.Value((long long)histogram.buckets[time]);
+		}
+		writer.EndArray();
+		writer.EndObject();
+	}
+	writer.EndObject();
+
+	writer.Key("slowest");
+	writer.BeginArray();
+	for(int i = 0; i < __slowDrawCount; i++) {
+		const SlowDraw& draw = __slowDraws[i];
+		writer.BeginObject();
+		writer.Member("ms", (long long)draw.time);
+		writer.Member("element", ELEMENT_NAMES[draw.kind]);
+		writer.Member("item", draw.item);
+		writer.EndObject();
+	}
+	writer.EndArray();
+	writer.EndObject();
+
+	r = writer.GetLastResult();
+	if(IsFailed(r)) {
+		return r;
+	}
+	File file;
+	r = file.Construct(path, L"w");
+	if(!IsFailed(r)) {
+		r = file.Write(writer.GetPointer(), writer.GetLength());
+	}
+	AppLog("Frame monitor dumped %d frames to %ls: %s", __histograms[HISTOGRAM_FRAME].count, path.GetPointer(), GetErrorMessage(r));
+	return r;
+}
+
+void
+FrameMonitor::OnTimerExpired(Timer& timer)
+{
+	// a frame is over once no draw followed it
+	if(__frameEnd != 0 && GetTicks() - __frameEnd > FRAME_GAP) {
+		CloseFrame();
+	}
+	String summary;
+	GetSummary(summary);
+	if(__histograms[HISTOGRAM_FRAME].count != __shownFrames) {
+		__shownFrames = __histograms[HISTOGRAM_FRAME].count;
+		AppLog("Frames: %ls", summary.GetPointer());
+	}
+	DrawOverlay(summary);
+	__timer.Start(OVERLAY_PERIOD);
+}
@@ -0,0 +1,118 @@
+#ifndef FRAMEMONITOR_H_
+#define FRAMEMONITOR_H_
+
+#include <FBase.h>
+#include <FGraphics.h>
+
+#include "ItemStore.h"
+
+/**
+ * Frame times of the lists, opt-in: on for runs started while
+ * /Home/frames.enable exists. Every DrawElement of the list elements is
+ * timed. Draws less than FRAME_GAP apart belong to one frame, which lasts
+ * from the start of its first draw to the end of its last; the time between
+ * the starts of two frames of one scroll is the frame interval, and an
+ * interval over JANK_INTERVAL is a dropped frame. Frame times, intervals and
+ * the draw times of each element kind go into histograms of 1 ms buckets,
+ * and the slowest draws are kept with the path of their item. Twice a
+ * second the percentiles are painted over the indicator and logged; Dump()
+ * writes everything to /Home/frames.json, at exit and on every trip to the
+ * background. Off, a draw costs one null check. The platform ticks in
+ * milliseconds, so are the times.
+ */
+class FrameMonitor :
+	public Osp::Base::Runtime::ITimerEventListener
+{
+public:
+	enum ElementKind {
+		ELEMENT_ART = 0,
+		ELEMENT_TITLE = 1,
+		ELEMENT_KIND_COUNT = 2
+	};
+
+	// Times one DrawElement, store null for elements that hold their own text
+	class Scope {
+	public:
+		Scope(ElementKind kind, const ItemStore* pStore, int index);
+		~Scope();
+	private:
+		ElementKind __kind;
+		const ItemStore* __pStore;
+		int __index;
+		long long __start;
+	};
+
+	static result Setup(void);
+	// Dumps first
+	static void Shutdown(void);
+	static result Dump(void);
+
+private:
+	FrameMonitor();
+	virtual ~FrameMonitor();
+
+	result Construct(void);
+
+	enum HistogramId {
+		HISTOGRAM_FRAME = 0,
+		HISTOGRAM_INTERVAL = 1,
+		// then one per ElementKind
+		HISTOGRAM_ELEMENT = 2,
+		HISTOGRAM_COUNT = HISTOGRAM_ELEMENT + ELEMENT_KIND_COUNT
+	};
+
+	// Millisecond buckets, the last one takes everything longer
+	static const int BUCKET_COUNT = 256;
+
+	struct Histogram {
+		int buckets[BUCKET_COUNT];
+		int count;
+		int max;
+	};
+
+	struct SlowDraw {
+		int time;
+		int kind;
+		Osp::Base::String item;
+	};
+
+	static const int FRAME_GAP = 4;
+	static const int SCROLL_GAP = 250;
+	static const int JANK_INTERVAL = 33;
+	static const int SLOW_DRAW_COUNT = 10;
+	static const int OVERLAY_PERIOD = 500;
+
+	static long long GetTicks(void);
+	static void Add(Histogram& histogram, int time);
+	static int GetPercentile(const Histogram& histogram, int percent);
+
+	void Record(ElementKind kind, const ItemStore* pStore, int index, long long start, long long end);
+	void CloseFrame(void);
+	void KeepSlowDraw(ElementKind kind, const ItemStore* pStore, int index, int time);
+	void GetSummary(Osp::Base::String& summary) const;
+	void DrawOverlay(const Osp::Base::String& summary);
+	result Write(const Osp::Base::String& path) const;
+
+	void OnTimerExpired(Osp::Base::Runtime::Timer& timer);
+
+	static FrameMonitor* __pInstance;
+
+	Histogram __histograms[HISTOGRAM_COUNT];
+	// Slowest first
+	SlowDraw __slowDraws[SLOW_DRAW_COUNT];
+	int __slowDrawCount;
+	int __janks;
+	// Frame being drawn, __frameEnd is 0 while there is none
+	long long __frameStart;
+	long long __frameEnd;
+	// Start of the last closed frame, for the interval
+	long long __lastFrameStart;
+	// Frames in the histogram at the last overlay
+	int __shownFrames;
+	Osp::Base::Runtime::Timer __timer;
+	Osp::Graphics::Font __font;
+};
+
+#define FRAME_ELEMENT(kind, pStore, index) FrameMonitor::Scope __frameElement(kind, pStore, index)
+
+#endif
@@ -1,5 +1,6 @@
 #include "InfoForm.h"
 
+#include "Atlas.h"
 #include "FormManager.h"
 #include "Helper.h"
 #include "TextArtRegistry.h"
@@ -19,7 +20,10 @@ using namespace Osp::System;
 using namespace Osp::App;
 using namespace Osp::Web::Controls;
 
-InfoForm::InfoForm() {}
+InfoForm::InfoForm():
+	CategoryList(null)
+{
+}
 
 InfoForm::~InfoForm() {}
 
@@ -27,7 +31,7 @@ bool
 InfoForm::Initialize()
 {
 	TabsForm::Initialize(FORM_STYLE_INDICATOR | FORM_STYLE_TITLE | FORM_STYLE_FOOTER, TabsForm::INFO_TAB);
-	SetTitleText(Helper::GetTraslation("IDS_INFO"));
+	SetTitleText(Helper::GetTraslation(IDS_INFO));
 
 	__pFooter = TabsForm::GetFooter();
 	__pFooter->SetStyle(FOOTER_STYLE_SEGMENTED_ICON);
@@ -46,9 +50,6 @@ InfoForm::OnInitializing(void)
 	result r = E_SUCCESS;
 	TabsForm::OnInitializing();
 
-	AppResource *pAppResource = Application::GetInstance()->GetAppResource();
-	Bitmap* _bitmap;
-
 	CategoryList = new CustomList();
 	CategoryList->Construct(Rectangle(0, 0, this->GetWidth(), rect.height), CUSTOM_LIST_STYLE_NORMAL);
 	CategoryList->SetBackgroundColor(Color(239,239,239));
@@ -57,9 +58,9 @@ InfoForm::OnInitializing(void)
 	// Category element format
 	pCustomListItemFormat = new CustomListItemFormat();
 	pCustomListItemFormat->Construct();
-	pCustomListItemFormat->AddElement(LIST_ELEMENT_IMG, Rectangle(Retina::GetInt(5), Retina::GetInt(5), Retina::GetInt(65), Retina::GetInt(65)));
-	pCustomListItemFormat->AddElement(LIST_ELEMENT_DESC, Rectangle(Retina::GetInt(75), Retina::GetInt(5), Retina::GetInt(180), Retina::GetInt(120)),
-		Retina::GetInt(12), Color(151,151,151), Osp::Ui::Controls::SYSTEM_COLOR_LIST_ITEM_PRESSED_TEXT);
+	pCustomListItemFormat->AddElement(LIST_ELEMENT_IMG, Retina::GetRect(Retina::RECT_INFO_IMAGE));
+	pCustomListItemFormat->AddElement(LIST_ELEMENT_DESC, Retina::GetRect(Retina::RECT_INFO_DESC),
+		Retina::GetSize(Retina::SIZE_INFO_DESC_FONT), Color(151,151,151), Osp::Ui::Controls::SYSTEM_COLOR_LIST_ITEM_PRESSED_TEXT);
 
 	CreateArray();
 
@@ -68,8 +69,9 @@ InfoForm::OnInitializing(void)
 	while(__pProducts[i][0]->GetLength() == 12)
 	{
 		CustomListItem * newItem = new CustomListItem();
+		const Bitmap* pBitmap = null;
 
-		newItem->Construct(Retina::GetInt(75));
+		newItem->Construct(Retina::GetSize(Retina::SIZE_INFO_ROW));
 		newItem->SetItemFormat(*pCustomListItemFormat);
 		int k=0;
 		Integer::Parse(*__pProducts[i][1], k);
@@ -78,39 +80,67 @@ InfoForm::OnInitializing(void)
 		{
 			case 451549:
 			case 451431:
-				newItem->SetElement(LIST_ELEMENT_DESC, Helper::GetTraslation("IDS_SPACESHUFFLE"));
-				_bitmap = pAppResource->GetBitmapN(L"Ikonka_512.png");
+				newItem->SetElement(LIST_ELEMENT_DESC, Helper::GetTraslation(IDS_SPACESHUFFLE));
+				pBitmap = Atlas::GetBitmap(ATLAS_IKONKA_512);
 				break;
 			case 53471:
-				newItem->SetElement(LIST_ELEMENT_DESC, Helper::GetTraslation("IDS_UCONVERTOR"));
-				_bitmap = pAppResource->GetBitmapN(L"uc_icon2.png");
+				newItem->SetElement(LIST_ELEMENT_DESC, Helper::GetTraslation(IDS_UCONVERTOR));
+				pBitmap = Atlas::GetBitmap(ATLAS_UC_ICON2);
 				break;
 			case 287131:
 			case 287177:
 			case 232222:
 			case 279563:
-				newItem->SetElement(LIST_ELEMENT_DESC, Helper::GetTraslation("IDS_sCalc"));
-				_bitmap = pAppResource->GetBitmapN(L"scalc_icon.png");
+				newItem->SetElement(LIST_ELEMENT_DESC, Helper::GetTraslation(IDS_sCalc));
+				pBitmap = Atlas::GetBitmap(ATLAS_SCALC_ICON);
 				break;
 		}
-		newItem->SetElement(LIST_ELEMENT_IMG, *_bitmap, _bitmap);
+		if(pBitmap != null) {
+			newItem->SetElement(LIST_ELEMENT_IMG, *pBitmap, pBitmap);
+		}
 		CategoryList->AddItem(*newItem, i);
 		i++;
 	}
 
+	CategoryList->AddItem(*CreateUpdateItem(Helper::GetTraslation(IDS_UPDATEDESC)), ITEM_UPDATE);
+
 	this->AddControl(*CategoryList);
 
 	return r;
 }
 
+CustomListItem*
+InfoForm::CreateUpdateItem(const String& status)
+{
+	CustomListItem* pItem = new CustomListItem();
+	pItem->Construct(Retina::GetSize(Retina::SIZE_INFO_ROW));
+	pItem->SetItemFormat(*pCustomListItemFormat);
+	String desc = Helper::GetTraslation(IDS_UPDATE);
+	desc.Append(L'\n');
+	desc.Append(status);
+	pItem->SetElement(LIST_ELEMENT_DESC, desc);
+	return pItem;
+}
+
 void
-InfoForm::OnFormBackRequested(Osp::Ui::Controls::Form& form)
+InfoForm::SetUpdateStatus(const String& status)
 {
-	Frame *pFrame = Application::GetInstance()->GetAppFrame()->GetFrame();
-	FormManager *pFormMgr = static_cast<FormManager *>(pFrame->GetControl("FormManager"));
-	if (pFormMgr != null) {
-		pFormMgr->SendUserEvent(FormManager::REQUEST_ITEMLIST, null);
+	if(CategoryList == null) {
+		return;
 	}
+	int index = CategoryList->GetItemIndexFromItemId(ITEM_UPDATE);
+	if(index < 0) {
+		return;
+	}
+	CategoryList->SetItemAt(index, *CreateUpdateItem(status), ITEM_UPDATE);
+	RequestRedraw(true);
+}
+
+void
+InfoForm::OnFormBackRequested(Osp::Ui::Controls::Form& form)
+{
+	// the list left for the info tab, or the category list when there is none
+	FormManager::Navigate(FormManager::REQUEST_ITEMLIST);
 }
 
 void
@@ -122,6 +152,14 @@ InfoForm::OnItemStateChanged(const Control& source, int index, int itemId, ItemS
 void
 InfoForm::OnItemStateChanged(const Osp::Ui::Control& source, int index, int itemId, int elementId, Osp::Ui::ItemStatus status)
 {
+	if(itemId == ITEM_UPDATE) {
+		Frame *pFrame = Application::GetInstance()->GetAppFrame()->GetFrame();
+		FormManager *pFormMgr = static_cast<FormManager *>(pFrame->GetControl("FormManager"));
+		if (pFormMgr != null) {
+			pFormMgr->SendUserEvent(FormManager::REQUEST_CONTENTUPDATE, null);
+		}
+		return;
+	}
 	GetProduct(index);
 }
 
@@ -20,6 +20,8 @@ public:
 	virtual ~InfoForm();
 
 	bool Initialize(void);
+	// Shown under the update item
+	void SetUpdateStatus(const Osp::Base::String& status);
 
 private:
 	static const int SOFTKEY_BACK = 101;
@@ -32,8 +34,11 @@ private:
 
 	static const int LIST_ELEMENT_IMG = 201;
 	static const int LIST_ELEMENT_DESC = 202;
+	// Item id of the catalog update, after the products
+	static const int ITEM_UPDATE = 10000;
 
 	void GetProduct(int index);
+	Osp::Ui::Controls::CustomListItem* CreateUpdateItem(const Osp::Base::String& status);
 	void CreateArray(void);
 
 public:
@@ -3,10 +3,16 @@
 #include "TitleListElement.h"
 #include "FormManager.h"
 
+#include "Catalog.h"
 #include "Debug.h"
 #include "Retina.h"
 #include "Helper.h"
 #include "TextArtRegistry.h"
+#include "Telemetry.h"
+#include "SmsSegmenter.h"
+#include "ArtExporter.h"
+#include "Atlas.h"
+#include "TextPic.h"
 
 #include <FGrpFont.h>
 #include <FApp.h>
@@ -18,8 +24,95 @@ using namespace Osp::App;
 using namespace Osp::Graphics;
 using namespace Osp::Base::Collection;
 
+// Height of a line of art on the 240 wide screen, the art element is as high as its lines
+static const int ART_LINE_HEIGHT = 16;
+
+// Reads the item files on a worker, the form takes them over on the UI thread
+class ItemLoadTask :
+	public ITask
+{
+public:
+	ItemLoadTask(ItemListForm& form, ItemListForm::ItemSource source, const String& dir):
+		__form(form),
+		__source(source),
+		__dir(dir),
+		__pItems(null),
+		__count(0)
+	{
+	}
+
+	~ItemLoadTask()
+	{
+		delete[] __pItems;
+	}
+
+	result Run(const CancelToken& token)
+	{
+		PROFILE_SCOPE("ItemLoadTask::Run");
+		ArrayList* pPaths = null;
+		result r = E_SUCCESS;
+		if(__source == ItemListForm::SOURCE_CATEGORY) {
+			pPaths = new ArrayList();
+			pPaths->Construct();
+			r = Catalog::GetItems(__dir, *pPaths);
+		} else if(__source == ItemListForm::SOURCE_RECENT) {
+			pPaths = TextArtRegistry::GetRecent();
+		} else {
+			pPaths = TextArtRegistry::GetFavourites();
+		}
+
+		__pItems = new Item[pPaths->GetCount() > 0 ? pPaths->GetCount() : 1];
+		for(int n = 0; n < pPaths->GetCount() && !token.IsCancelled(); n++) {
+			Item& item = __pItems[__count];
+			item.path = *(static_cast<String*>(pPaths->GetAt(n)));
+			if(!IsFailed(Catalog::ReadItem(item.path, item.titles, item.art, item.linecount))) {
+				__count++;
+			}
+		}
+		pPaths->RemoveAll(true);
+		delete pPaths;
+		return r;
+	}
+
+	void OnTaskCompleted(result r)
+	{
+		PROFILE_SCOPE("ItemLoadTask::OnTaskCompleted");
+		__form.__loadTask = 0;
+		__form.ClearList();
+		for(int i = 0; i < __count; i++) {
+			__form.AppendItem(__pItems[i].titles, __pItems[i].art, __pItems[i].path, __pItems[i].linecount);
+		}
+		PROFILE_COUNT("items", __count);
+		PROFILE_MEMORY("memory");
+		__form.ScrollToFocus();
+
+		Form* pForm = Application::GetInstance()->GetAppFrame()->GetFrame()->GetCurrentForm();
+		if(pForm == &__form) {
+			__form.RequestRedraw(true);
+		}
+	}
+
+private:
+	struct Item {
+		String titles[Catalog::LANGUAGE_COUNT];
+		String art;
+		String path;
+		int linecount;
+	};
+
+	ItemListForm& __form;
+	ItemListForm::ItemSource __source;
+	String __dir;
+	Item* __pItems;
+	int __count;
+};
+
 ItemListForm::ItemListForm():
-	__pPopup(null)
+	__pArtFont(null),
+	__pTitleFont(null),
+	__loadTask(0),
+	__pPopup(null),
+	CategoryList(null)
 {}
 
 ItemListForm::~ItemListForm() { }
@@ -31,7 +124,6 @@ ItemListForm::Initialize()
 
 	list.Construct();
 	titlelist.Construct();
-	formatlist.Construct();
 
 	title = t;
 	dir = d;
@@ -39,7 +131,7 @@ ItemListForm::Initialize()
 	SetTitleText(title);
 
 	SetSoftkeyEnabled(SOFTKEY_1,true);
-	SetSoftkeyText(SOFTKEY_1, Helper::GetTraslation("IDS_BACK"));
+	SetSoftkeyText(SOFTKEY_1, Helper::GetTraslation(IDS_BACK));
 	SetSoftkeyActionId(SOFTKEY_1, SOFTKEY_BACK);
 	AddSoftkeyActionListener(SOFTKEY_1, *this);
 */
@@ -52,10 +144,13 @@ ItemListForm::OnInitializing(void)
 	result r = E_SUCCESS;
 	TabsForm::OnInitializing();
 
-	formatlist.Construct();
-	anciilist.Construct();
-	titlelist.Construct();
-	filelist.Construct();
+	__items.Construct();
+	__items.SetLanguage(TextPic::__InternalAppLanguageIndex);
+	__arena.Construct();
+	__pArtFont = new Font();
+	__pArtFont->Construct(FONT_STYLE_PLAIN, Retina::GetSize(Retina::SIZE_ITEM_ART_FONT));
+	__pTitleFont = new Font();
+	__pTitleFont->Construct(FONT_STYLE_PLAIN, Retina::GetSize(Retina::SIZE_ITEM_TITLE_FONT));
 
 	DrawCustomList();
 	//ReadCustomListItems();
@@ -71,13 +166,13 @@ ItemListForm::DrawCustomList()
 	CategoryList = new CustomList();
 	CategoryList->Construct(Rectangle(0, 0, this->GetWidth(), rect.height), CUSTOM_LIST_STYLE_NORMAL);
 	CategoryList->AddCustomItemEventListener(*this);
-	//CategoryList->SetTextOfEmptyList(Helper::GetTraslation("IDS_EMPTYLIST"));
+	//CategoryList->SetTextOfEmptyList(Helper::GetTraslation(IDS_EMPTYLIST));
 	CategoryList->SetTextOfEmptyList("");
 	CategoryList->SetShowState(false);
 	this->AddControl(*CategoryList);
 
 	empty = new Label();
-	empty->Construct(Rectangle(0, 0, this->GetWidth(), 100), Helper::GetTraslation("IDS_EMPTYLIST"));
+	empty->Construct(Rectangle(0, 0, this->GetWidth(), 100), Helper::GetTraslation(IDS_EMPTYLIST));
 	empty->SetTextColor(Color::COLOR_BLACK);
 	empty->SetBackgroundColor(Color(239,239,239));
 	empty->SetShowState(true);
@@ -88,29 +183,29 @@ ItemListForm::DrawCustomList()
 }
 
 result
-ItemListForm::AddListItem(CustomList& CustomListPtr, String title, String ancii, int id, int linecount)
+ItemListForm::AddListItem(CustomList& CustomListPtr, int id, int linecount, int index)
 {
+	PROFILE_SCOPE("ItemListForm::AddListItem");
 	CategoryList->SetShowState(true);
 	CategoryList->SetBackgroundColor(Color(239,239,239));
 	empty->SetShowState(false);
-	CustomListItemFormat* pCustomListItemFormat = new CustomListItemFormat();
+	CustomListItemFormat* pCustomListItemFormat = __arena.Own(new (__arena) CustomListItemFormat());
 	pCustomListItemFormat->Construct();
 
-	pCustomListItemFormat->AddElement(LIST_ELEMENT_TITLE, Rectangle(Retina::GetInt(10), Retina::GetInt(5), Retina::GetInt(220), Retina::GetInt(20)));
-	pCustomListItemFormat->AddElement(LIST_ELEMENT_ANCII, Rectangle(Retina::GetInt(10), Retina::GetInt(30), Retina::GetInt(230), Retina::GetInt(linecount*16)));
-
-	formatlist.Add(*pCustomListItemFormat);
-
+	int artHeight = Retina::GetInt(linecount * ART_LINE_HEIGHT);
+	Rectangle artRect = Retina::GetRect(Retina::RECT_ITEM_ART);
+	artRect.height = artHeight;
+	pCustomListItemFormat->AddElement(LIST_ELEMENT_TITLE, Retina::GetRect(Retina::RECT_ITEM_TITLE));
+	pCustomListItemFormat->AddElement(LIST_ELEMENT_ANCII, artRect);
 
+	// the list takes ownership of the item only
 	CustomListItem * newItem = new CustomListItem();
 
-	AnciiListElement * custom_element = new AnciiListElement(ancii, Retina::GetInt(16));
+	AnciiListElement * custom_element = __arena.Own(new (__arena) AnciiListElement(__items, id, *__pArtFont));
 
-	TitleListElement * custom_element2 = new TitleListElement(title, Retina::GetInt(20));
+	TitleListElement * custom_element2 = __arena.Own(new (__arena) TitleListElement(__items, id, *__pTitleFont));
 
-	formatlist.Add(*custom_element);
-	formatlist.Add(*custom_element2);
-	int height = (Retina::GetInt(linecount*16))+(Retina::GetInt(40));
+	int height = artHeight + Retina::GetSize(Retina::SIZE_ITEM_PADDING);
 	newItem->Construct(height);
 	newItem->SetItemFormat(*pCustomListItemFormat);
 
@@ -118,10 +213,138 @@ ItemListForm::AddListItem(CustomList& CustomListPtr, String title, String ancii,
 	newItem->SetElement(LIST_ELEMENT_TITLE, *(static_cast<ICustomListElement *>(custom_element2)));
 	newItem->SetElement(LIST_ELEMENT_ANCII, *(static_cast<ICustomListElement *>(custom_element)));
 
+	if(index >= 0) {
+		return CustomListPtr.SetItemAt(index, *newItem, id);
+	}
 	CustomListPtr.AddItem(*newItem, id);
 	return E_SUCCESS;
 }
 
+void
+ItemListForm::LoadItems(ItemSource source, const String& dir)
+{
+	TaskScheduler::Cancel(__loadTask);
+	// neither the empty text nor old items of a category until the items are read
+	if(CategoryList->GetItemCount() == 0) {
+		empty->SetShowState(false);
+	}
+	__loadTask = TaskScheduler::Post(new ItemLoadTask(*this, source, dir), TaskScheduler::LANE_VISIBLE,
+			source == SOURCE_CATEGORY ? TaskScheduler::STRAND_NONE : TaskScheduler::STRAND_REGISTRY);
+}
+
+void
+ItemListForm::FocusItem(const String& path)
+{
+	__focusPath = path;
+	// not constructed yet or still loading, the load scrolls when it is done
+	if(CategoryList != null && !IsLoading()) {
+		ScrollToFocus();
+	}
+}
+
+void
+ItemListForm::ScrollToFocus()
+{
+	if(__focusPath.IsEmpty()) {
+		return;
+	}
+	int id = __items.Find(__focusPath);
+	int index = id >= 0 ? CategoryList->GetItemIndexFromItemId(id) : -1;
+	if(index >= 0) {
+		CategoryList->ScrollToTop(index);
+	}
+	__focusPath.Clear();
+}
+
+int
+ItemListForm::AppendItem(const String* pTitles, const String& ancii, const String& file, int linecount)
+{
+	// ids index the store, skipped entries must not leave gaps
+	int itemId = __items.GetCount();
+	result r = __items.Add(pTitles, ancii, file, linecount);
+	if(IsFailed(r)) {
+		AppLog("Item store add failed: %s", GetErrorMessage(r));
+		return -1;
+	}
+
+	if(__items.IsTranslated(itemId)) {
+		AddListItem(*CategoryList, itemId, linecount);
+	}
+	return itemId;
+}
+
+void
+ItemListForm::PatchItem(const String* pTitles, const String& ancii, const String& file, int linecount)
+{
+	int oldId = __items.Find(file);
+	int index = oldId >= 0 ? CategoryList->GetItemIndexFromItemId(oldId) : -1;
+	__items.Remove(oldId);
+
+	// the old elements stay in the arena until the list is cleared, they are small
+	int itemId = -1;
+	if(pTitles != null) {
+		itemId = __items.GetCount();
+		result r = __items.Add(pTitles, ancii, file, linecount);
+		if(IsFailed(r)) {
+			AppLog("Item store add failed: %s", GetErrorMessage(r));
+			itemId = -1;
+		}
+	}
+
+	if(__items.IsTranslated(itemId)) {
+		AddListItem(*CategoryList, itemId, linecount, index);
+	} else if(index >= 0) {
+		CategoryList->RemoveItemAt(index);
+		if(CategoryList->GetItemCount() == 0) {
+			CategoryList->SetShowState(false);
+			empty->SetShowState(true);
+		}
+	}
+}
+
+void
+ItemListForm::RebuildList()
+{
+	PROFILE_SCOPE("ItemListForm::RebuildList");
+	CategoryList->RemoveAllItems();
+	// only the elements go, the store keeps every language
+	__arena.Reset();
+
+	CategoryList->SetShowState(false);
+	empty->SetShowState(true);
+	for(int itemId = 0; itemId < __items.GetCount(); itemId++) {
+		ItemStore::Item item;
+		if(__items.IsTranslated(itemId) && !IsFailed(__items.GetItem(itemId, item))) {
+			AddListItem(*CategoryList, itemId, item.linecount);
+		}
+	}
+}
+
+void
+ItemListForm::OnLanguageChanged(void)
+{
+	TabsForm::OnLanguageChanged();
+	empty->SetText(Helper::GetTraslation(IDS_EMPTYLIST));
+	__items.SetLanguage(TextPic::__InternalAppLanguageIndex);
+	RebuildList();
+}
+
+void
+ItemListForm::ReleaseItems()
+{
+	const Arena::Stats& stats = __arena.GetStats();
+	PROFILE_COUNT("ItemListForm::arenaObjects", stats.allocations);
+	PROFILE_COUNT("ItemListForm::arenaBlocks", stats.blocks);
+	AppLog("Item arena: %d objects (%d with destructors) in %d heap blocks, %d of %d bytes used",
+			stats.allocations, stats.finalizers, stats.blocks, stats.bytesUsed, stats.bytesReserved);
+	PROFILE_COUNT("ItemListForm::storeBytes", __items.GetMemoryUsage());
+	AppLog("Item store: %d items in %d bytes", __items.GetCount(), __items.GetMemoryUsage());
+
+	// elements point into the store, so they go first
+	__arena.Reset();
+	__items.RemoveAll();
+}
+
 result
 ItemListForm::OnTerminating(void)
 {
@@ -131,10 +354,11 @@ ItemListForm::OnTerminating(void)
 		delete __pPopup;
 	}
 
-	anciilist.RemoveAll(true);
-	titlelist.RemoveAll(true);
-	filelist.RemoveAll(true);
-	formatlist.RemoveAll(true);
+	TaskScheduler::Cancel(__loadTask);
+	__loadTask = 0;
+	ReleaseItems();
+	delete __pArtFont;
+	delete __pTitleFont;
 
 	return r;
 }
@@ -147,10 +371,7 @@ ItemListForm::ClearList()
 	CategoryList->SetShowState(false);
 	empty->SetShowState(true);
 
-	anciilist.RemoveAll(true);
-	titlelist.RemoveAll(true);
-	filelist.RemoveAll(true);
-	formatlist.RemoveAll(true);
+	ReleaseItems();
 	return E_SUCCESS;
 }
 
@@ -180,7 +401,7 @@ ItemListForm::OnActionPerformed(const Osp::Ui::Control& source, int actionId)
 
 					 ArrayList* pDataList = new ArrayList();
 					 String* pData = new String(L"type:SMS");
-					 String* pData2 = new String("text:"+anciitext);
+					 String* pData2 = new String("text:"+smstext);
 					 //String* pData4 = new String(L"text:LAbas");
 					 String* pData3 = new String(L"to:");
 
@@ -215,13 +436,47 @@ ItemListForm::OnActionPerformed(const Osp::Ui::Control& source, int actionId)
 					//delete e;
 				}
 						break;
+				case BUTTON_SENDMMS:
+				{
+					String path;
+					result r = ArtExporter::ExportPng(anciitext, Retina::GetInt(ArtExporter::DEFAULT_FONT_SIZE), path);
+
+					ArrayList* pDataList = new ArrayList();
+					pDataList->Construct();
+					pDataList->Add(*(new String(L"type:MMS")));
+					if(!IsFailed(r)) {
+						pDataList->Add(*(new String(L"attachments:"+path)));
+					} else {
+						// without the picture the art still goes, as the text of the message
+						pDataList->Add(*(new String(L"text:"+anciitext)));
+					}
+					pDataList->Add(*(new String(L"to:")));
+
+					AppControl* pAc = AppManager::FindAppControlN(APPCONTROL_MESSAGE, OPERATION_EDIT);
+					if(pAc) {
+						pAc->Start(pDataList, null);
+						delete pAc;
+					}
+
+					pDataList->RemoveAll(true);
+					delete pDataList;
+					HidePopup();
+				}
+				break;
 				case BUTTON_SENDEMAIL:
 				{
+					// The text body is kept, the picture keeps the layout in proportional fonts
+					String path;
+					result r = ArtExporter::ExportPng(anciitext, Retina::GetInt(ArtExporter::DEFAULT_FONT_SIZE), path);
+
 					ArrayList* pDataList = new ArrayList();
 					String* pData2 = new String(L"text:"+anciitext);
 
 					pDataList->Construct();
 					pDataList->Add(*pData2);
+					if(!IsFailed(r)) {
+						pDataList->Add(*(new String(L"attachments:"+path)));
+					}
 
 					AppControl* pAc = AppManager::FindAppControlN(APPCONTROL_EMAIL, OPERATION_EDIT);
 					if(pAc)
@@ -242,6 +497,7 @@ ItemListForm::OnActionPerformed(const Osp::Ui::Control& source, int actionId)
 				case BUTTON_ADDTOFAVOURITES:
 				{
 					TextArtRegistry::AddFavourite(filename);
+					Telemetry::Track(Telemetry::EVENT_FAVOURITE, filename);
 					HidePopup();
 				}
 				break;
@@ -251,12 +507,33 @@ ItemListForm::OnActionPerformed(const Osp::Ui::Control& source, int actionId)
 					HidePopup();
 				}
 				break;
+				case BUTTON_SIMILAR:
+				{
+					HidePopup();
+					FormManager::Navigate(FormManager::REQUEST_SIMILAR, L"", filename);
+				}
+				break;
+				case BUTTON_VIEW:
+				{
+					HidePopup();
+					FormManager::Navigate(FormManager::REQUEST_VIEWER, L"", filename);
+				}
+				break;
 				default:
 					break;
 			}
 
-	if(actionId == ItemListForm::BUTTON_SENDSMS || actionId == ItemListForm::BUTTON_SENDEMAIL || actionId == ItemListForm::BUTTON_COPY) {
+	if(actionId == ItemListForm::BUTTON_SENDSMS || actionId == ItemListForm::BUTTON_SENDMMS || actionId == ItemListForm::BUTTON_SENDEMAIL || actionId == ItemListForm::BUTTON_COPY) {
 			TextArtRegistry::AddRecent(filename);
+
+			String channel;
+			switch(actionId) {
+				case BUTTON_SENDSMS: channel = L"sms"; break;
+				case BUTTON_SENDMMS: channel = L"mms"; break;
+				case BUTTON_SENDEMAIL: channel = L"email"; break;
+				default: channel = L"copy"; break;
+			}
+			Telemetry::Track(Telemetry::EVENT_SHARE, filename, channel);
 	}
 }
 
@@ -269,14 +546,15 @@ ItemListForm::OnItemStateChanged(const Osp::Ui::Control& source, int index, int
 void
 ItemListForm::OnItemStateChanged(const Osp::Ui::Control& source, int index, int itemId, int elementId, Osp::Ui::ItemStatus status)
 {
-	String ancii = *(static_cast<String*> (anciilist.GetAt(itemId)));
-	String title = *(static_cast<String*> (titlelist.GetAt(itemId)));
-	String file = *(static_cast<String*> (filelist.GetAt(itemId)));
-
-	anciitext = ancii;
-	filename = file;
+	String title;
+	if(IsFailed(__items.GetTitle(itemId, title))) {
+		return;
+	}
+	__items.GetArt(itemId, anciitext);
+	__items.GetPath(itemId, filename);
 
-	ShowPopup(title, ancii);
+	Telemetry::Track(Telemetry::EVENT_VIEW, filename);
+	ShowPopup(title, anciitext);
 }
 
 void
@@ -291,34 +569,39 @@ ItemListForm::HidePopup() {
 	__pPopup = null;
 }
 
+// A button keeps working without its images when the atlas cannot be read
+static void
+SetButtonBitmaps(Button& button, AtlasImage normal, AtlasImage pressed)
+{
+	const Bitmap* pNormal = Atlas::GetBitmap(normal);
+	const Bitmap* pPressed = Atlas::GetBitmap(pressed);
+	if(pNormal != null) {
+		button.SetNormalBackgroundBitmap(*pNormal);
+	}
+	if(pPressed != null) {
+		button.SetPressedBackgroundBitmap(*pPressed);
+	}
+}
+
 void
 ItemListForm::ShowPopup(String title, String sms)
 {
 	__pPopup = new Popup();
-	Dimension dim(Retina::GetInt(222), Retina::GetInt(222));
+	Dimension dim(Retina::GetSize(Retina::SIZE_POPUP), Retina::GetSize(Retina::SIZE_POPUP));
 	__pPopup->Construct(true, dim);
 	__pPopup->SetTitleText(title);
 
-	AppResource *pAppResource = Application::GetInstance()->GetAppResource();
-
-	if(anciitext.GetLength() > 80) {
-		//pApp->GetAppResource()->GetString("IDS_TOOLONG", toolong);
+	SmsSegmenter::Info smsInfo;
+	bool smsAvailable = SmsSegmenter::Prepare(anciitext, smstext, smsInfo);
+	AppLog("SMS: encoding %d, %d units, %d segments", smsInfo.encoding, smsInfo.units, smsInfo.segments);
 
-		Label* lbl = new Label();
-		lbl->Construct(Rectangle(0, Retina::GetInt(4), Retina::GetInt(190), Retina::GetInt(42)), Helper::GetTraslation("IDS_TOOLONG"));
-		lbl->SetTextConfig(Retina::GetInt(12), LABEL_TEXT_STYLE_NORMAL);
-		lbl->SetBackgroundColor(Osp::Ui::Controls::SYSTEM_COLOR_POPUP_BACKGROUND);
-		__pPopup->AddControl(*lbl);
-	}
-	else {
-		Button* bnt1 = new Button();
-		bnt1->Construct(Rectangle(Retina::GetInt(40), Retina::GetInt(5), Retina::GetInt(65), Retina::GetInt(65)));
-		bnt1->SetActionId(BUTTON_SENDSMS);
-		bnt1->SetNormalBackgroundBitmap(*pAppResource->GetBitmapN(L"sms.png"));
-		bnt1->SetPressedBackgroundBitmap(*pAppResource->GetBitmapN(L"sms_p.png"));
-		bnt1->AddActionEventListener(*this);
-		__pPopup->AddControl(*bnt1);
-	}
+	// Art too long for SMS goes out as an MMS picture instead
+	Button* bnt1 = new Button();
+	bnt1->Construct(Retina::GetRect(Retina::RECT_POPUP_SEND));
+	bnt1->SetActionId(smsAvailable ? BUTTON_SENDSMS : BUTTON_SENDMMS);
+	SetButtonBitmaps(*bnt1, ATLAS_SMS, ATLAS_SMS_P);
+	bnt1->AddActionEventListener(*this);
+	__pPopup->AddControl(*bnt1);
 
 		/*e = new EditArea();
 		e->Construct(Rectangle(Retina::GetInt(5), Retina::GetInt(51), Retina::GetInt(50), Retina::GetInt(40)));
@@ -327,55 +610,50 @@ ItemListForm::ShowPopup(String title, String sms)
 		__pPopup->AddControl(*e);*/
 
 		Button* bnt2 = new Button();
-		bnt2->Construct(Rectangle(Retina::GetInt(40), Retina::GetInt(75), Retina::GetInt(65), Retina::GetInt(65)));
-		bnt2->SetNormalBackgroundBitmap(*pAppResource->GetBitmapN(L"copy.png"));
-		bnt2->SetPressedBackgroundBitmap(*pAppResource->GetBitmapN(L"copy_p.png"));
+		bnt2->Construct(Retina::GetRect(Retina::RECT_POPUP_COPY));
+		SetButtonBitmaps(*bnt2, ATLAS_COPY, ATLAS_COPY_P);
 		bnt2->SetActionId(BUTTON_COPY);
 		bnt2->AddActionEventListener(*this);
-		if(anciitext.GetLength() > 80)
-			{
-			bnt2->SetBounds(Rectangle(Retina::GetInt(75), Retina::GetInt(50), Retina::GetInt(65), Retina::GetInt(65)));
-			}
 		__pPopup->AddControl(*bnt2);
 
 		Button* bnt3 = new Button();
-		bnt3->Construct(Rectangle(Retina::GetInt(110), Retina::GetInt(5), Retina::GetInt(65), Retina::GetInt(65)));
+		bnt3->Construct(Retina::GetRect(Retina::RECT_POPUP_MAIL));
 		bnt3->SetActionId(BUTTON_SENDEMAIL);
-		bnt3->SetNormalBackgroundBitmap(*pAppResource->GetBitmapN(L"mail.png"));
-		bnt3->SetPressedBackgroundBitmap(*pAppResource->GetBitmapN(L"mail_p.png"));
+		SetButtonBitmaps(*bnt3, ATLAS_MAIL, ATLAS_MAIL_P);
 		bnt3->AddActionEventListener(*this);
-		if(anciitext.GetLength() > 80)
-			{
-			bnt3->SetBounds(Rectangle(Retina::GetInt(5), Retina::GetInt(50), Retina::GetInt(65), Retina::GetInt(65)));
-			}
 		__pPopup->AddControl(*bnt3);
 
 		Button* bnt4 = new Button();
-		bnt4->Construct(Rectangle(Retina::GetInt(110), Retina::GetInt(75), Retina::GetInt(65), Retina::GetInt(65)));
+		bnt4->Construct(Retina::GetRect(Retina::RECT_POPUP_FAVOURITE));
 		if(tab_index_ == TabsForm::FAVOURITES_TAB) {
-			//bnt4->SetText(Helper::GetTraslation("IDS_REMOVEFROMFAVOURITES"));
-			bnt4->SetNormalBackgroundBitmap(*pAppResource->GetBitmapN(L"favorite_active.png"));
-			bnt4->SetPressedBackgroundBitmap(*pAppResource->GetBitmapN(L"favorite_active_p.png"));
+			//bnt4->SetText(Helper::GetTraslation(IDS_REMOVEFROMFAVOURITES));
+			SetButtonBitmaps(*bnt4, ATLAS_FAVORITE_ACTIVE, ATLAS_FAVORITE_ACTIVE_P);
 			bnt4->SetActionId(BUTTON_REMOVEFROMFAVOURITES);
 			bnt4->AddActionEventListener(*this);
 		}
 		else {
-			//bnt4->SetText(Helper::GetTraslation("IDS_ADDTOFAVOURITES"));
-			bnt4->SetNormalBackgroundBitmap(*pAppResource->GetBitmapN(L"favorite.png"));
-			bnt4->SetPressedBackgroundBitmap(*pAppResource->GetBitmapN(L"favorite_p.png"));
+			//bnt4->SetText(Helper::GetTraslation(IDS_ADDTOFAVOURITES));
+			SetButtonBitmaps(*bnt4, ATLAS_FAVORITE, ATLAS_FAVORITE_P);
 			bnt4->SetActionId(BUTTON_ADDTOFAVOURITES);
 			bnt4->AddActionEventListener(*this);
 		}
-		if(anciitext.GetLength() > 80)
-			{
-			bnt4->SetBounds(Rectangle(Retina::GetInt(145), Retina::GetInt(50), Retina::GetInt(65), Retina::GetInt(65)));
-			}
 		__pPopup->AddControl(*bnt4);
 
+		Button* bnt6 = new Button();
+		bnt6->Construct(Retina::GetRect(Retina::RECT_POPUP_SIMILAR), Helper::GetTraslation(IDS_SIMILAR));
+		bnt6->SetActionId(BUTTON_SIMILAR);
+		bnt6->AddActionEventListener(*this);
+		__pPopup->AddControl(*bnt6);
+
+		Button* bnt7 = new Button();
+		bnt7->Construct(Retina::GetRect(Retina::RECT_POPUP_VIEW), Helper::GetTraslation(IDS_VIEW));
+		bnt7->SetActionId(BUTTON_VIEW);
+		bnt7->AddActionEventListener(*this);
+		__pPopup->AddControl(*bnt7);
+
 		Button* bnt5 = new Button();
-		bnt5->Construct(Rectangle(Retina::GetInt(180), Retina::GetInt(145), Retina::GetInt(28), Retina::GetInt(28)));
-		bnt5->SetNormalBackgroundBitmap(*pAppResource->GetBitmapN(L"cancel.png"));
-		bnt5->SetPressedBackgroundBitmap(*pAppResource->GetBitmapN(L"cancel_p.png"));
+		bnt5->Construct(Retina::GetRect(Retina::RECT_POPUP_CANCEL));
+		SetButtonBitmaps(*bnt5, ATLAS_CANCEL, ATLAS_CANCEL_P);
 		bnt5->SetActionId(BUTTON_CANCEL);
 		bnt5->AddActionEventListener(*this);
 		__pPopup->AddControl(*bnt5);
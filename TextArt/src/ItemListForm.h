@@ -5,13 +5,18 @@
 #include <FUi.h>
 #include <FApp.h>
 
+#include "Arena.h"
+#include "ItemStore.h"
 #include "TabsForm.h"
+#include "TaskScheduler.h"
 
 using namespace Osp::Base;
 using namespace Osp::Base::Collection;
 using namespace Osp::Ui::Controls;
 using namespace Osp::Io;
 
+class ItemLoadTask;
+
 class ItemListForm :
 	public TabsForm,
 	public Osp::Ui::ICustomItemEventListener {
@@ -21,6 +26,8 @@ public:
 	bool Initialize();
 
 	void HidePopup();
+	// Scrolls the list to the item of path, after the load when one is running
+	void FocusItem(const String& path);
 
 private:
 
@@ -28,7 +35,23 @@ private:
 	static const int LIST_ELEMENT_ANCII = 202;
 
 	String title;
-	ArrayList formatlist;
+
+	// Titles in every language, art and path of every item, looked up by item id
+	ItemStore __items;
+	// Owns the formats and elements, released at once by ClearList()
+	Arena __arena;
+	Osp::Graphics::Font* __pArtFont;
+	Osp::Graphics::Font* __pTitleFont;
+
+	// Load running on a worker, 0 when there is none
+	TaskScheduler::TaskId __loadTask;
+	friend class ItemLoadTask;
+	// Item FocusItem() waits for, empty when none
+	String __focusPath;
+
+	void ReleaseItems();
+	void ScrollToFocus();
+	void RebuildList();
 
 	Osp::Ui::Controls::Popup* __pPopup;
 
@@ -37,11 +60,8 @@ private:
 	void ShowPopup(String title, String sms);
 
 protected:
-	ArrayList anciilist;
-	ArrayList titlelist;
-	ArrayList filelist;
-
 	String anciitext;
+	String smstext;
 	String filename;
 
 	static const int BUTTON_SENDSMS = 301;
@@ -50,13 +70,32 @@ protected:
 	static const int BUTTON_CANCEL = 304;
 	static const int BUTTON_ADDTOFAVOURITES = 305;
 	static const int BUTTON_REMOVEFROMFAVOURITES = 306;
+	static const int BUTTON_SENDMMS = 307;
+	static const int BUTTON_SIMILAR = 308;
+	static const int BUTTON_VIEW = 309;
 
 	CustomList* CategoryList;
 	Label* empty;
 
+	enum ItemSource {
+		SOURCE_CATEGORY,
+		SOURCE_RECENT,
+		SOURCE_FAVOURITES
+	};
+
 	result DrawCustomList();
-	result ReadCustomListItems();
-	result AddListItem(CustomList& CustomListPtr, String title, String ancii, int id, int linecount);
+	// Reads the items of the category dir, or the registry list, on a worker and shows them in place
+	// of the current ones when done; a load still running is cancelled
+	void LoadItems(ItemSource source, const String& dir = L"");
+	bool IsLoading(void) const { return __loadTask != 0; }
+	// Replaces the list item at index instead of adding one when index is not -1
+	result AddListItem(CustomList& CustomListPtr, int id, int linecount, int index = -1);
+	// Keeps the item data in the item store and adds the list item when it is translated
+	// to the active language, returns its id or -1. titles holds Catalog::LANGUAGE_COUNT strings
+	int AppendItem(const String* pTitles, const String& ancii, const String& file, int linecount);
+	// Brings the list item of a file that was added or rewritten up to date in place,
+	// null titles take the item of a removed file off the list
+	void PatchItem(const String* pTitles, const String& ancii, const String& file, int linecount);
 	result ClearList();
 	result RedrawList();
 	result SetEmptyText(String text);
@@ -66,6 +105,7 @@ public:
 	virtual result OnTerminating(void);
 
 	virtual void OnActionPerformed(const Osp::Ui::Control& source, int actionId);
+	virtual void OnLanguageChanged(void);
 
 	virtual void OnItemStateChanged(const Osp::Ui::Control& source, int index, int itemId, Osp::Ui::ItemStatus status);
 	virtual void OnItemStateChanged(const Osp::Ui::Control& source, int index, int itemId, int elementId, Osp::Ui::ItemStatus status);
@@ -0,0 +1,389 @@
+#include "ItemStore.h"
+
+#include <string.h>
+
+using namespace Osp::Base;
+
+static const int MIN_TEXT_CAPACITY = 1024;
+static const int MIN_RECORD_CAPACITY = 16;
+static const int MIN_ART_CAPACITY = 32;
+static const int MAX_SHORT = 0x7FFF;
+static const int MAX_UNSIGNED_SHORT = 0xFFFF;
+
+ItemStore::ItemStore():
+	__language(0),
+	__pText(null),
+	__textLength(0),
+	__textCapacity(0),
+	__pRecords(null),
+	__count(0),
+	__capacity(0),
+	__pPrefixes(null),
+	__prefixCount(0),
+	__prefixCapacity(0),
+	__pArts(null),
+	__artCount(0),
+	__artCapacity(0)
+{
+}
+
+ItemStore::~ItemStore()
+{
+	delete[] __pText;
+	delete[] __pRecords;
+	delete[] __pPrefixes;
+	delete[] __pArts;
+}
+
+result
+ItemStore::Construct(int capacity)
+{
+	if(capacity < 0) {
+		return E_INVALID_ARG;
+	}
+	if(capacity > 0 && !ReserveRecords(capacity)) {
+		return E_OUT_OF_MEMORY;
+	}
+	return E_SUCCESS;
+}
+
+void
+ItemStore::RemoveAll(void)
+{
+	__textLength = 0;
+	__count = 0;
+	__prefixCount = 0;
+	for(int i = 0; i < __artCapacity; i++) {
+		__pArts[i].text = -1;
+	}
+	__artCount = 0;
+}
+
+bool
+ItemStore::ReserveText(int count)
+{
+	if(__textLength + count <= __textCapacity) {
+		return true;
+	}
+
+	int capacity = __textCapacity > 0 ? __textCapacity : MIN_TEXT_CAPACITY;
+	while(capacity < __textLength + count) {
+		capacity *= 2;
+	}
+
+	mchar* pText = new mchar[capacity];
+	if(pText == null) {
+		return false;
+	}
+	if(__textLength > 0) {
+		memcpy(pText, __pText, __textLength * sizeof(mchar));
+	}
+	delete[] __pText;
+	__pText = pText;
+	__textCapacity = capacity;
+	return true;
+}
+
+bool
+ItemStore::ReserveRecords(int count)
+{
+	if(__count + count <= __capacity) {
+		return true;
+	}
+
+	int capacity = __capacity > 0 ? __capacity : MIN_RECORD_CAPACITY;
+	while(capacity < __count + count) {
+		capacity *= 2;
+	}
+
+	Record* pRecords = new Record[capacity];
+	if(pRecords == null) {
+		return false;
+	}
+	if(__count > 0) {
+		memcpy(pRecords, __pRecords, __count * sizeof(Record));
+	}
+	delete[] __pRecords;
+	__pRecords = pRecords;
+	__capacity = capacity;
+	return true;
+}
+
+void
+ItemStore::PutText(const mchar* pValue, int length)
+{
+	if(length > 0) {
+		memcpy(__pText + __textLength, pValue, length * sizeof(mchar));
+	}
+	__pText[__textLength + length] = 0;
+	__textLength += length + 1;
+}
+
+int
+ItemStore::InternPrefix(const mchar* pValue, int length)
+{
+	// Lists are filled directory by directory, the newest prefix matches first
+	for(int i = __prefixCount - 1; i >= 0; i--) {
+		const Prefix& prefix = __pPrefixes[i];
+		if(prefix.length == length && memcmp(__pText + prefix.text, pValue, length * sizeof(mchar)) == 0) {
+			return i;
+		}
+	}
+
+	if(__prefixCount >= MAX_SHORT || !ReserveText(length + 1)) {
+		return -1;
+	}
+	if(__prefixCount == __prefixCapacity) {
+		int capacity = __prefixCapacity > 0 ? __prefixCapacity * 2 : 4;
+		Prefix* pPrefixes = new Prefix[capacity];
+		if(pPrefixes == null) {
+			return -1;
+		}
+		if(__prefixCount > 0) {
+			memcpy(pPrefixes, __pPrefixes, __prefixCount * sizeof(Prefix));
+		}
+		delete[] __pPrefixes;
+		__pPrefixes = pPrefixes;
+		__prefixCapacity = capacity;
+	}
+
+	Prefix& prefix = __pPrefixes[__prefixCount];
+	prefix.text = __textLength;
+	prefix.length = length;
+	PutText(pValue, length);
+	return __prefixCount++;
+}
+
+void
+ItemStore::SetLanguage(int language)
+{
+	if(language >= 0 && language < Catalog::LANGUAGE_COUNT) {
+		__language = language;
+	}
+}
+
+bool
+ItemStore::IsTranslated(int index) const
+{
+	return index >= 0 && index < __count && __pRecords[index].titleLengths[__language] > 0 && !__pRecords[index].removed;
+}
+
+void
+ItemStore::Remove(int index)
+{
+	if(index >= 0 && index < __count) {
+		__pRecords[index].removed = true;
+	}
+}
+
+int
+ItemStore::Find(const String& path) const
+{
+	const mchar* pPath = path.GetPointer();
+	int pathLength = path.GetLength();
+	for(int index = __count - 1; index >= 0; index--) {
+		const Record& record = __pRecords[index];
+		const Prefix& prefix = __pPrefixes[record.prefix];
+		if(record.removed || prefix.length + record.nameLength != pathLength) {
+			continue;
+		}
+		const mchar* pPrefix = __pText + prefix.text;
+		const mchar* pName = __pText + GetNameOffset(record);
+		int i = 0;
+		while(i < prefix.length && pPrefix[i] == pPath[i]) {
+			i++;
+		}
+		while(i >= prefix.length && i < pathLength && pName[i - prefix.length] == pPath[i]) {
+			i++;
+		}
+		if(i == pathLength) {
+			return index;
+		}
+	}
+	return -1;
+}
+
+bool
+ItemStore::ReserveArt(void)
+{
+	if((__artCount + 1) * 2 <= __artCapacity) {
+		return true;
+	}
+
+	int capacity = __artCapacity > 0 ? __artCapacity * 2 : MIN_ART_CAPACITY;
+	Art* pArts = new Art[capacity];
+	if(pArts == null) {
+		return false;
+	}
+	for(int i = 0; i < capacity; i++) {
+		pArts[i].text = -1;
+	}
+	for(int i = 0; i < __artCapacity; i++) {
+		if(__pArts[i].text >= 0) {
+			int slot = __pArts[i].hash & (capacity - 1);
+			while(pArts[slot].text >= 0) {
+				slot = (slot + 1) & (capacity - 1);
+			}
+			pArts[slot] = __pArts[i];
+		}
+	}
+	delete[] __pArts;
+	__pArts = pArts;
+	__artCapacity = capacity;
+	return true;
+}
+
+int
+ItemStore::InternArt(const mchar* pValue, int length)
+{
+	if(!ReserveArt()) {
+		return -1;
+	}
+	unsigned int hash = Catalog::HashArt(pValue, length);
+	int slot = hash & (__artCapacity - 1);
+	for(; __pArts[slot].text >= 0; slot = (slot + 1) & (__artCapacity - 1)) {
+		const Art& art = __pArts[slot];
+		if(art.hash == hash && art.length == length && memcmp(__pText + art.text, pValue, length * sizeof(mchar)) == 0) {
+			return art.text;
+		}
+	}
+
+	if(!ReserveText(length + 1)) {
+		return -1;
+	}
+	Art& art = __pArts[slot];
+	art.text = __textLength;
+	art.length = length;
+	art.hash = hash;
+	PutText(pValue, length);
+	__artCount++;
+	return art.text;
+}
+
+int
+ItemStore::GetNameOffset(const Record& record) const
+{
+	int offset = record.text;
+	for(int language = 0; language < Catalog::LANGUAGE_COUNT; language++) {
+		offset += record.titleLengths[language] + 1;
+	}
+	return offset;
+}
+
+result
+ItemStore::Add(const String* pTitles, const String& art, const String& path, int linecount)
+{
+	const mchar* pPath = path.GetPointer();
+	int pathLength = path.GetLength();
+	int slash = pathLength;
+	while(slash > 0 && pPath[slash - 1] != L'/') {
+		slash--;
+	}
+	int nameLength = pathLength - slash;
+	if(nameLength > MAX_SHORT) {
+		return E_INVALID_ARG;
+	}
+
+	int prefix = InternPrefix(pPath, slash);
+	if(prefix < 0) {
+		return E_OUT_OF_MEMORY;
+	}
+
+	int textLength = 0;
+	for(int language = 0; language < Catalog::LANGUAGE_COUNT; language++) {
+		int titleLength = pTitles[language].GetLength();
+		if(titleLength > MAX_UNSIGNED_SHORT) {
+			return E_INVALID_ARG;
+		}
+		textLength += titleLength + 1;
+	}
+	int artLength = art.GetLength();
+	int artText = InternArt(art.GetPointer(), artLength);
+	if(artText < 0 || !ReserveRecords(1) || !ReserveText(textLength + nameLength + 1)) {
+		return E_OUT_OF_MEMORY;
+	}
+
+	Record& record = __pRecords[__count];
+	record.text = __textLength;
+	record.art = artText;
+	for(int language = 0; language < Catalog::LANGUAGE_COUNT; language++) {
+		record.titleLengths[language] = (unsigned short)pTitles[language].GetLength();
+	}
+	record.artLength = artLength;
+	record.nameLength = (short)nameLength;
+	record.prefix = (short)prefix;
+	record.linecount = linecount;
+	record.removed = false;
+
+	for(int language = 0; language < Catalog::LANGUAGE_COUNT; language++) {
+		PutText(pTitles[language].GetPointer(), pTitles[language].GetLength());
+	}
+	PutText(pPath + slash, nameLength);
+	__count++;
+	return E_SUCCESS;
+}
+
+result
+ItemStore::GetItem(int index, Item& item) const
+{
+	if(index < 0 || index >= __count) {
+		return E_OUT_OF_RANGE;
+	}
+	const Record& record = __pRecords[index];
+	const mchar* pTitle = __pText + record.text;
+	for(int language = 0; language < __language; language++) {
+		pTitle += record.titleLengths[language] + 1;
+	}
+	item.pTitle = pTitle;
+	item.titleLength = record.titleLengths[__language];
+	item.pArt = __pText + record.art;
+	item.artLength = record.artLength;
+	item.linecount = record.linecount;
+	return E_SUCCESS;
+}
+
+result
+ItemStore::GetTitle(int index, String& title) const
+{
+	Item item;
+	result r = GetItem(index, item);
+	if(IsFailed(r)) {
+		return r;
+	}
+	title = item.pTitle;
+	return E_SUCCESS;
+}
+
+result
+ItemStore::GetArt(int index, String& art) const
+{
+	Item item;
+	result r = GetItem(index, item);
+	if(IsFailed(r)) {
+		return r;
+	}
+	art = item.pArt;
+	return E_SUCCESS;
+}
+
+result
+ItemStore::GetPath(int index, String& path) const
+{
+	if(index < 0 || index >= __count) {
+		return E_OUT_OF_RANGE;
+	}
+	const Record& record = __pRecords[index];
+	const Prefix& prefix = __pPrefixes[record.prefix];
+	path.Clear();
+	path.EnsureCapacity(prefix.length + record.nameLength);
+	path.Append(__pText + prefix.text);
+	path.Append(__pText + GetNameOffset(record));
+	return E_SUCCESS;
+}
+
+int
+ItemStore::GetMemoryUsage(void) const
+{
+	return __textCapacity * sizeof(mchar) + __capacity * sizeof(Record) + __prefixCapacity * sizeof(Prefix)
+			+ __artCapacity * sizeof(Art);
+}
@@ -0,0 +1,118 @@
+#ifndef ITEMSTORE_H_
+#define ITEMSTORE_H_
+
+#include "Catalog.h"
+#include "Port.h"
+
+using namespace Osp::Base;
+
+/**
+ * Item table of a list form. The titles in every language, art and file
+ * names live in one contiguous character buffer, every item is a fixed size
+ * record of offsets and lengths, and the directory part of the paths is
+ * stored once per directory. Equal art bodies of the store, such as the
+ * language variants of one item, are stored once and shared by their
+ * records. Titles are read in the active language, so a language switch is
+ * SetLanguage() and a redraw. The store only grows: a file read again is
+ * added anew and its old record removed. The arrays grow by doubling and
+ * keep their capacity across RemoveAll(). Pointers into the buffer are
+ * valid until the next Add().
+ */
+class ItemStore {
+public:
+	// Read-only view of one item in the active language, the pointers are null terminated
+	struct Item {
+		const mchar* pTitle;
+		int titleLength;
+		const mchar* pArt;
+		int artLength;
+		int linecount;
+	};
+
+	ItemStore();
+	~ItemStore();
+
+	result Construct(int capacity = 0);
+	void RemoveAll(void);
+
+	// titles holds Catalog::LANGUAGE_COUNT strings, empty where untranslated
+	result Add(const String* pTitles, const String& art, const String& path, int linecount);
+
+	int GetCount(void) const { return __count; }
+
+	void SetLanguage(int language);
+	int GetLanguage(void) const { return __language; }
+	// False when the item has no title in the active language or was removed
+	bool IsTranslated(int index) const;
+	// Hides the item everywhere, its text is kept until RemoveAll(), so ids stay valid
+	void Remove(int index);
+	// Newest item of the file that was not removed, -1 if there is none
+	int Find(const String& path) const;
+
+	result GetItem(int index, Item& item) const;
+	result GetTitle(int index, String& title) const;
+	result GetArt(int index, String& art) const;
+	result GetPath(int index, String& path) const;
+
+	// Heap bytes held by the buffers, reserved capacity included
+	int GetMemoryUsage(void) const;
+	// Distinct art bodies among the items
+	int GetArtCount(void) const { return __artCount; }
+
+private:
+	// Titles and file name follow each other at text, each null terminated; art may be shared
+	struct Record {
+		int text;
+		unsigned short titleLengths[Catalog::LANGUAGE_COUNT];
+		int art;
+		int artLength;
+		short nameLength;
+		short prefix;
+		int linecount;
+		bool removed;
+	};
+
+	struct Prefix {
+		int text;
+		int length;
+	};
+
+	// Slot of the art table, text -1 when free
+	struct Art {
+		int text;
+		int length;
+		unsigned int hash;
+	};
+
+	bool ReserveText(int count);
+	bool ReserveRecords(int count);
+	int InternPrefix(const mchar* pValue, int length);
+	int InternArt(const mchar* pValue, int length);
+	bool ReserveArt(void);
+	void PutText(const mchar* pValue, int length);
+	int GetNameOffset(const Record& record) const;
+
+	ItemStore(const ItemStore& store);
+	ItemStore& operator =(const ItemStore& store);
+
+	int __language;
+
+	mchar* __pText;
+	int __textLength;
+	int __textCapacity;
+
+	Record* __pRecords;
+	int __count;
+	int __capacity;
+
+	Prefix* __pPrefixes;
+	int __prefixCount;
+	int __prefixCapacity;
+
+	// Open addressing by body hash, at most half full
+	Art* __pArts;
+	int __artCount;
+	int __artCapacity;
+};
+
+#endif
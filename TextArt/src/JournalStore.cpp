@@ -0,0 +1,514 @@
+#include "JournalStore.h"
+
+#include "Debug.h"
+
+#include <string.h>
+
+using namespace Osp::Base;
+using namespace Osp::Io;
+
+static const unsigned int SNAPSHOT_MAGIC = 0x534A5854;
+static const unsigned int JOURNAL_MAGIC = 0x4A4A5854;
+
+static const mchar SNAPSHOT_SUFFIX[] = L".snapshot";
+static const mchar JOURNAL_SUFFIX[] = L".journal";
+static const mchar TEMP_SUFFIX[] = L".tmp";
+
+static const int MIN_ENTRY_CAPACITY = 16;
+
+static const unsigned int FNV_OFFSET = 2166136261u;
+static const unsigned int FNV_PRIME = 16777619u;
+
+static void
+PutUInt(byte* p, unsigned int value)
+{
+	p[0] = (byte)value;
+	p[1] = (byte)(value >> 8);
+	p[2] = (byte)(value >> 16);
+	p[3] = (byte)(value >> 24);
+}
+
+static void
+PutUShort(byte* p, unsigned int value)
+{
+	p[0] = (byte)value;
+	p[1] = (byte)(value >> 8);
+}
+
+static unsigned int
+GetUInt(const byte* p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static unsigned int
+GetUShort(const byte* p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+JournalStore::JournalStore():
+	__pJournal(null),
+	__generation(0),
+	__journalRecords(0)
+{
+	for(int i = 0; i < MAX_COLLECTIONS; i++) {
+		Collection& entries = __collections[i];
+		entries.pEntries = null;
+		entries.count = 0;
+		entries.capacity = 0;
+		entries.limit = 0;
+		entries.policy = LIMIT_DROP_OLDEST;
+	}
+}
+
+JournalStore::~JournalStore()
+{
+	Close();
+	Clear();
+}
+
+void
+JournalStore::Clear(void)
+{
+	for(int i = 0; i < MAX_COLLECTIONS; i++) {
+		Collection& entries = __collections[i];
+		for(int j = 0; j < entries.count; j++) {
+			delete entries.pEntries[j].pKey;
+		}
+		delete[] entries.pEntries;
+		entries.pEntries = null;
+		entries.count = 0;
+		entries.capacity = 0;
+	}
+}
+
+void
+JournalStore::SetLimit(int collection, int limit, LimitPolicy policy)
+{
+	if(collection >= 0 && collection < MAX_COLLECTIONS) {
+		__collections[collection].limit = limit;
+		__collections[collection].policy = policy;
+	}
+}
+
+result
+JournalStore::Construct(const String& path)
+{
+	PROFILE_SCOPE("JournalStore::Construct");
+	__snapshotPath = path + SNAPSHOT_SUFFIX;
+	__journalPath = path + JOURNAL_SUFFIX;
+
+	// A compaction that stopped between removing the old snapshot and moving the new one in
+	// left a complete file aside, one that stopped earlier left a partial one next to the old
+	String tempPath(__snapshotPath + TEMP_SUFFIX);
+	if(File::IsFileExist(tempPath)) {
+		if(File::IsFileExist(__snapshotPath)) {
+			File::Remove(tempPath);
+		} else {
+			File::Move(tempPath, __snapshotPath);
+		}
+	}
+
+	bool compact = false;
+	int records = 0;
+	ByteBuffer snapshot;
+	result r = ReadFile(__snapshotPath, snapshot);
+	if(IsFailed(r) || !ReadHeader(snapshot, SNAPSHOT_MAGIC, __generation)) {
+		if(r != E_FILE_NOT_FOUND) {
+			AppLog("Journal store snapshot %ls not read: %s", __snapshotPath.GetPointer(), GetErrorMessage(r));
+		}
+		compact = true;
+	} else if(!Replay(snapshot, records)) {
+		AppLog("Journal store snapshot %ls cut after %d records", __snapshotPath.GetPointer(), records);
+		compact = true;
+	}
+
+	unsigned int generation = 0;
+	records = 0;
+	ByteBuffer journal;
+	r = ReadFile(__journalPath, journal);
+	if(IsFailed(r) || !ReadHeader(journal, JOURNAL_MAGIC, generation) || generation != __generation) {
+		// older than the snapshot, which holds all of it
+		compact = true;
+	} else if(!Replay(journal, records)) {
+		AppLog("Journal store journal %ls cut after %d records", __journalPath.GetPointer(), records);
+		compact = true;
+	}
+	__journalRecords = records;
+
+	if(compact) {
+		return Compact();
+	}
+	__pJournal = new File();
+	r = __pJournal->Construct(__journalPath, L"a");
+	if(IsFailed(r)) {
+		delete __pJournal;
+		__pJournal = null;
+	}
+	return r;
+}
+
+void
+JournalStore::Close(void)
+{
+	delete __pJournal;
+	__pJournal = null;
+}
+
+result
+JournalStore::Put(int collection, const String& key, int value)
+{
+	return Write(OPERATION_PUT, collection, key, value);
+}
+
+result
+JournalStore::Remove(int collection, const String& key)
+{
+	return Write(OPERATION_REMOVE, collection, key, 0);
+}
+
+result
+JournalStore::Increment(int collection, const String& key, int delta)
+{
+	return Write(OPERATION_INCREMENT, collection, key, delta);
+}
+
+int
+JournalStore::GetCount(int collection) const
+{
+	return collection >= 0 && collection < MAX_COLLECTIONS ? __collections[collection].count : 0;
+}
+
+const String&
+JournalStore::GetKey(int collection, int index) const
+{
+	const Collection& entries = __collections[collection];
+	return *entries.pEntries[entries.count - 1 - index].pKey;
+}
+
+int
+JournalStore::GetValue(int collection, int index) const
+{
+	const Collection& entries = __collections[collection];
+	return entries.pEntries[entries.count - 1 - index].value;
+}
+
+int
+JournalStore::Find(int collection, const String& key) const
+{
+	if(collection < 0 || collection >= MAX_COLLECTIONS) {
+		return -1;
+	}
+	int position = FindEntry(collection, HashKey(key.GetPointer(), key.GetLength()), key);
+	return position >= 0 ? __collections[collection].count - 1 - position : -1;
+}
+
+result
+JournalStore::Compact(void)
+{
+	PROFILE_SCOPE("JournalStore::Compact");
+	unsigned int generation = __generation + 1;
+	String tempPath(__snapshotPath + TEMP_SUFFIX);
+	result r = E_SUCCESS;
+	{
+		File snapshot;
+		r = snapshot.Construct(tempPath, L"w", true);
+		if(!IsFailed(r)) {
+			r = WriteHeader(snapshot, SNAPSHOT_MAGIC, generation);
+		}
+		for(int collection = 0; collection < MAX_COLLECTIONS && !IsFailed(r); collection++) {
+			const Collection& entries = __collections[collection];
+			for(int i = 0; i < entries.count && !IsFailed(r); i++) {
+				int size = EncodeRecord(__record, OPERATION_PUT, collection, *entries.pEntries[i].pKey, entries.pEntries[i].value);
+				r = snapshot.Write(__record, size);
+			}
+		}
+		if(!IsFailed(r)) {
+			r = snapshot.Flush();
+		}
+	}
+	if(IsFailed(r)) {
+		File::Remove(tempPath);
+		return r;
+	}
+
+	// Move does not replace, Construct() finishes the job after a crash in between
+	Close();
+	File::Remove(__snapshotPath);
+	r = File::Move(tempPath, __snapshotPath);
+	if(IsFailed(r)) {
+		// the journal left behind is older than the file aside, appending to it would lose the changes
+		AppLog("Journal store snapshot %ls not moved in: %s", __snapshotPath.GetPointer(), GetErrorMessage(r));
+		return r;
+	}
+	__generation = generation;
+	__journalRecords = 0;
+
+	__pJournal = new File();
+	r = __pJournal->Construct(__journalPath, L"w", true);
+	if(!IsFailed(r)) {
+		r = WriteHeader(*__pJournal, JOURNAL_MAGIC, generation);
+	}
+	if(IsFailed(r)) {
+		Close();
+	}
+	return r;
+}
+
+unsigned int
+JournalStore::HashKey(const mchar* pKey, int length)
+{
+	unsigned int hash = FNV_OFFSET;
+	for(int i = 0; i < length; i++) {
+		hash = (hash ^ (pKey[i] & 0xFFFF)) * FNV_PRIME;
+	}
+	return hash;
+}
+
+unsigned int
+JournalStore::Checksum(const byte* pBytes, int length)
+{
+	unsigned int hash = FNV_OFFSET;
+	for(int i = 0; i < length; i++) {
+		hash = (hash ^ pBytes[i]) * FNV_PRIME;
+	}
+	return hash;
+}
+
+int
+JournalStore::EncodeRecord(byte* pRecord, Operation operation, int collection, const String& key, int value)
+{
+	const mchar* pKey = key.GetPointer();
+	int length = key.GetLength();
+	PutUShort(pRecord + 4, length);
+	pRecord[6] = (byte)operation;
+	pRecord[7] = (byte)collection;
+	PutUInt(pRecord + 8, (unsigned int)value);
+	for(int i = 0; i < length; i++) {
+		PutUShort(pRecord + RECORD_HEADER_SIZE + i * 2, pKey[i] & 0xFFFF);
+	}
+	int size = RECORD_HEADER_SIZE + length * 2;
+	PutUInt(pRecord, Checksum(pRecord + 4, size - 4));
+	return size;
+}
+
+result
+JournalStore::ReadFile(const String& path, ByteBuffer& bytes)
+{
+	if(!File::IsFileExist(path)) {
+		return E_FILE_NOT_FOUND;
+	}
+	File file;
+	result r = file.Construct(path, L"r");
+	if(IsFailed(r)) {
+		return r;
+	}
+	FileAttributes attributes;
+	r = File::GetAttributes(path, attributes);
+	if(IsFailed(r)) {
+		return r;
+	}
+	int size = (int)attributes.GetFileSize();
+	r = bytes.Construct(size > 0 ? size : 1);
+	if(IsFailed(r)) {
+		return r;
+	}
+	while(size > 0 && bytes.HasRemaining()) {
+		r = file.Read(bytes);
+		if(r == E_END_OF_FILE) {
+			break;
+		}
+		if(IsFailed(r)) {
+			return r;
+		}
+	}
+	bytes.Flip();
+	return E_SUCCESS;
+}
+
+bool
+JournalStore::ReadHeader(const ByteBuffer& bytes, unsigned int magic, unsigned int& generation)
+{
+	if(bytes.GetLimit() < FILE_HEADER_SIZE || GetUInt(bytes.GetPointer()) != magic) {
+		return false;
+	}
+	generation = GetUInt(bytes.GetPointer() + 4);
+	return true;
+}
+
+result
+JournalStore::WriteHeader(File& file, unsigned int magic, unsigned int generation)
+{
+	byte header[FILE_HEADER_SIZE];
+	PutUInt(header, magic);
+	PutUInt(header + 4, generation);
+	result r = file.Write(header, FILE_HEADER_SIZE);
+	if(!IsFailed(r)) {
+		r = file.Flush();
+	}
+	return r;
+}
+
+result
+JournalStore::Write(Operation operation, int collection, const String& key, int value)
+{
+	if(collection < 0 || collection >= MAX_COLLECTIONS || key.GetLength() == 0 || key.GetLength() > MAX_KEY_LENGTH) {
+		return E_INVALID_ARG;
+	}
+	if(__pJournal == null) {
+		return E_INVALID_STATE;
+	}
+	const Collection& entries = __collections[collection];
+	unsigned int hash = HashKey(key.GetPointer(), key.GetLength());
+	bool present = FindEntry(collection, hash, key) >= 0;
+	if(operation == OPERATION_REMOVE && !present) {
+		return E_OBJ_NOT_FOUND;
+	}
+	if(operation != OPERATION_REMOVE && !present && entries.policy == LIMIT_REFUSE
+			&& entries.limit > 0 && entries.count >= entries.limit) {
+		return E_OVERFLOW;
+	}
+
+	// on storage before it is visible
+	int size = EncodeRecord(__record, operation, collection, key, value);
+	result r = __pJournal->Write(__record, size);
+	if(!IsFailed(r)) {
+		r = __pJournal->Flush();
+	}
+	if(IsFailed(r)) {
+		// a partial record would hide every later one from the replay, start over without it
+		AppLog("Journal store append failed: %s", GetErrorMessage(r));
+		Compact();
+		return r;
+	}
+	Apply(operation, collection, hash, key, value);
+	__journalRecords++;
+
+	int live = 0;
+	for(int i = 0; i < MAX_COLLECTIONS; i++) {
+		live += __collections[i].count;
+	}
+	if(__journalRecords >= COMPACT_MIN_RECORDS && __journalRecords > live * COMPACT_RATIO) {
+		result compacted = Compact();
+		if(IsFailed(compacted)) {
+			AppLog("Journal store compaction failed: %s", GetErrorMessage(compacted));
+		}
+	}
+	return E_SUCCESS;
+}
+
+void
+JournalStore::Apply(Operation operation, int collection, unsigned int hash, const String& key, int value)
+{
+	Collection& entries = __collections[collection];
+	int position = FindEntry(collection, hash, key);
+	if(operation == OPERATION_REMOVE) {
+		if(position >= 0) {
+			RemoveEntry(collection, position);
+		}
+		return;
+	}
+
+	String* pKey = null;
+	if(position >= 0) {
+		if(operation == OPERATION_INCREMENT) {
+			value += entries.pEntries[position].value;
+		}
+		// out of its place, to be appended as the newest
+		pKey = entries.pEntries[position].pKey;
+		memmove(entries.pEntries + position, entries.pEntries + position + 1, (entries.count - position - 1) * sizeof(Entry));
+		entries.count--;
+	} else {
+		if(entries.limit > 0 && entries.count >= entries.limit) {
+			if(entries.policy == LIMIT_REFUSE) {
+				return;
+			}
+			RemoveEntry(collection, 0);
+		}
+		if(!Reserve(entries, entries.count + 1)) {
+			return;
+		}
+		pKey = new String(key);
+	}
+	Entry& entry = entries.pEntries[entries.count++];
+	entry.hash = hash;
+	entry.pKey = pKey;
+	entry.value = value;
+}
+
+int
+JournalStore::FindEntry(int collection, unsigned int hash, const String& key) const
+{
+	const Collection& entries = __collections[collection];
+	// newest first, they are asked about most
+	for(int i = entries.count - 1; i >= 0; i--) {
+		if(entries.pEntries[i].hash == hash && *entries.pEntries[i].pKey == key) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void
+JournalStore::RemoveEntry(int collection, int position)
+{
+	Collection& entries = __collections[collection];
+	delete entries.pEntries[position].pKey;
+	memmove(entries.pEntries + position, entries.pEntries + position + 1, (entries.count - position - 1) * sizeof(Entry));
+	entries.count--;
+}
+
+bool
+JournalStore::Reserve(Collection& entries, int count)
+{
+	if(count <= entries.capacity) {
+		return true;
+	}
+	int capacity = entries.capacity > 0 ? entries.capacity * 2 : MIN_ENTRY_CAPACITY;
+	while(capacity < count) {
+		capacity *= 2;
+	}
+	Entry* pEntries = new Entry[capacity];
+	if(pEntries == null) {
+		return false;
+	}
+	if(entries.count > 0) {
+		memcpy(pEntries, entries.pEntries, entries.count * sizeof(Entry));
+	}
+	delete[] entries.pEntries;
+	entries.pEntries = pEntries;
+	entries.capacity = capacity;
+	return true;
+}
+
+bool
+JournalStore::Replay(const ByteBuffer& bytes, int& records)
+{
+	const byte* pBytes = bytes.GetPointer();
+	int length = bytes.GetLimit();
+	String key;
+	records = 0;
+	for(int position = FILE_HEADER_SIZE; position < length; records++) {
+		const byte* pRecord = pBytes + position;
+		if(length - position < RECORD_HEADER_SIZE) {
+			return false;
+		}
+		int keyLength = GetUShort(pRecord + 4);
+		int size = RECORD_HEADER_SIZE + keyLength * 2;
+		int operation = pRecord[6];
+		int collection = pRecord[7];
+		if(keyLength == 0 || keyLength > MAX_KEY_LENGTH || length - position < size
+				|| Checksum(pRecord + 4, size - 4) != GetUInt(pRecord)
+				|| operation < OPERATION_PUT || operation > OPERATION_INCREMENT || collection >= MAX_COLLECTIONS) {
+			return false;
+		}
+		key.Clear();
+		for(int i = 0; i < keyLength; i++) {
+			key.Append((mchar)GetUShort(pRecord + RECORD_HEADER_SIZE + i * 2));
+		}
+		Apply((Operation)operation, collection, HashKey(key.GetPointer(), keyLength), key, (int)GetUInt(pRecord + 8));
+		position += size;
+	}
+	return true;
+}
@@ -0,0 +1,126 @@
+#ifndef JOURNALSTORE_H_
+#define JOURNALSTORE_H_
+
+#include "Port.h"
+
+using namespace Osp::Base;
+
+/**
+ * A few small collections of string keys with an int each, in insertion
+ * order, kept in two files next to the given path:
+ *
+ *   <path>.snapshot  every live key, as written by the last compaction
+ *   <path>.journal   every change since, one record appended and flushed per call
+ *
+ * Both start with a magic and a generation, and a journal only counts when
+ * its generation is the snapshot's. A record is
+ *
+ *   checksum u32, length u16, operation u8, collection u8, value i32, key in UTF-16
+ *
+ * little endian, the checksum FNV-1a over everything after it. Opening
+ * replays the snapshot and then the journal up to the first record that is
+ * short or fails its checksum, which is where a crash cut the last write.
+ * Once the journal holds many times the live keys it is compacted: the
+ * snapshot of the next generation is written aside and moved in, then an
+ * empty journal of that generation replaces the old one. A crash anywhere in
+ * between leaves either the old pair or a snapshot that already holds
+ * everything. Not thread safe.
+ */
+class JournalStore {
+public:
+	enum LimitPolicy {
+		// A new key over the limit pushes out the oldest
+		LIMIT_DROP_OLDEST,
+		// A new key over the limit is refused by E_OVERFLOW
+		LIMIT_REFUSE
+	};
+
+	static const int MAX_COLLECTIONS = 4;
+	static const int MAX_KEY_LENGTH = 1024;
+
+	JournalStore();
+	~JournalStore();
+
+	// Before Construct(), collections are unlimited by default
+	void SetLimit(int collection, int limit, LimitPolicy policy);
+	// Creates the files when missing
+	result Construct(const String& path);
+	void Close(void);
+
+	// Adds the key with the value, or moves it to the newest and sets the value
+	result Put(int collection, const String& key, int value = 0);
+	// E_OBJ_NOT_FOUND when missing
+	result Remove(int collection, const String& key);
+	// Adds delta to the value of the key, as a Put of delta when missing, and makes it the newest
+	result Increment(int collection, const String& key, int delta);
+
+	int GetCount(int collection) const;
+	// Newest first
+	const String& GetKey(int collection, int index) const;
+	int GetValue(int collection, int index) const;
+	// Newest first index of the key or -1
+	int Find(int collection, const String& key) const;
+
+	// Rewrites the snapshot and empties the journal
+	result Compact(void);
+	int GetJournalRecords(void) const { return __journalRecords; }
+
+private:
+	enum Operation {
+		OPERATION_PUT = 1,
+		OPERATION_REMOVE = 2,
+		OPERATION_INCREMENT = 3
+	};
+
+	struct Entry {
+		unsigned int hash;
+		String* pKey;
+		int value;
+	};
+
+	// Oldest first
+	struct Collection {
+		Entry* pEntries;
+		int count;
+		int capacity;
+		int limit;
+		LimitPolicy policy;
+	};
+
+	static const int FILE_HEADER_SIZE = 8;
+	static const int RECORD_HEADER_SIZE = 12;
+	static const int MAX_RECORD_SIZE = RECORD_HEADER_SIZE + MAX_KEY_LENGTH * 2;
+	// Compaction once the journal has this many records and more than COMPACT_RATIO per live key
+	static const int COMPACT_MIN_RECORDS = 256;
+	static const int COMPACT_RATIO = 4;
+
+	static unsigned int HashKey(const mchar* pKey, int length);
+	static unsigned int Checksum(const byte* pBytes, int length);
+	static int EncodeRecord(byte* pRecord, Operation operation, int collection, const String& key, int value);
+	static result ReadFile(const String& path, ByteBuffer& bytes);
+	static bool ReadHeader(const ByteBuffer& bytes, unsigned int magic, unsigned int& generation);
+	static result WriteHeader(Osp::Io::File& file, unsigned int magic, unsigned int generation);
+
+	result Write(Operation operation, int collection, const String& key, int value);
+	void Apply(Operation operation, int collection, unsigned int hash, const String& key, int value);
+	int FindEntry(int collection, unsigned int hash, const String& key) const;
+	void RemoveEntry(int collection, int position);
+	bool Reserve(Collection& collection, int count);
+	// Replays the records after the header, false when they end in a bad one
+	bool Replay(const ByteBuffer& bytes, int& records);
+	void Clear(void);
+
+	JournalStore(const JournalStore& store);
+	JournalStore& operator =(const JournalStore& store);
+
+	Collection __collections[MAX_COLLECTIONS];
+	String __snapshotPath;
+	String __journalPath;
+	// Open for appends, null before Construct() and when the journal could not be rewritten
+	Osp::Io::File* __pJournal;
+	unsigned int __generation;
+	int __journalRecords;
+	byte __record[MAX_RECORD_SIZE];
+};
+
+#endif
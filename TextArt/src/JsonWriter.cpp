@@ -0,0 +1,322 @@
+#include "JsonWriter.h"
+
+#include <string.h>
+
+using namespace Osp::Base;
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+JsonWriter::JsonWriter():
+	__pData(null),
+	__length(0),
+	__capacity(0),
+	__depth(0),
+	__first(0),
+	__afterKey(false),
+	__r(E_SUCCESS)
+{
+}
+
+JsonWriter::~JsonWriter()
+{
+	delete[] __pData;
+}
+
+result
+JsonWriter::Construct(int capacity)
+{
+	if(capacity <= 0) {
+		return E_INVALID_ARG;
+	}
+	__pData = new byte[capacity];
+	if(__pData == null) {
+		return E_OUT_OF_MEMORY;
+	}
+	__capacity = capacity;
+	Clear();
+	return E_SUCCESS;
+}
+
+void
+JsonWriter::Clear(void)
+{
+	__length = 0;
+	__depth = 0;
+	__first = 0;
+	__afterKey = false;
+	__r = E_SUCCESS;
+}
+
+bool
+JsonWriter::Reserve(int count)
+{
+	if(__length + count <= __capacity) {
+		return true;
+	}
+
+	int capacity = __capacity > 0 ? __capacity : 64;
+	while(capacity < __length + count) {
+		capacity *= 2;
+	}
+
+	byte* pData = new byte[capacity];
+	if(pData == null) {
+		__r = E_OUT_OF_MEMORY;
+		return false;
+	}
+	if(__length > 0) {
+		memcpy(pData, __pData, __length);
+	}
+	delete[] __pData;
+	__pData = pData;
+	__capacity = capacity;
+	return true;
+}
+
+void
+JsonWriter::Put(byte value)
+{
+	if(Reserve(1)) {
+		__pData[__length++] = value;
+	}
+}
+
+void
+JsonWriter::PutAscii(const char* pValue)
+{
+	int length = strlen(pValue);
+	if(Reserve(length)) {
+		memcpy(__pData + __length, pValue, length);
+		__length += length;
+	}
+}
+
+void
+JsonWriter::PutEscaped(const mchar* pValue, int length)
+{
+	// Worst case is 6 bytes per character (\u00XX, or 3 UTF-8 bytes per UTF-16 unit)
+	if(!Reserve(length * 6 + 2)) {
+		return;
+	}
+
+	byte* p = __pData + __length;
+	*p++ = '"';
+	for(int i = 0; i < length; i++) {
+		unsigned long c = (unsigned long)pValue[i];
+
+		if(c < 0x80) {
+			switch(c) {
+			case '"':  *p++ = '\\'; *p++ = '"'; break;
+			case '\\': *p++ = '\\'; *p++ = '\\'; break;
+			case '\n': *p++ = '\\'; *p++ = 'n'; break;
+			case '\r': *p++ = '\\'; *p++ = 'r'; break;
+			case '\t': *p++ = '\\'; *p++ = 't'; break;
+			case '\b': *p++ = '\\'; *p++ = 'b'; break;
+			case '\f': *p++ = '\\'; *p++ = 'f'; break;
+			default:
+				if(c < 0x20) {
+					*p++ = '\\'; *p++ = 'u'; *p++ = '0'; *p++ = '0';
+					*p++ = HEX_DIGITS[c >> 4];
+					*p++ = HEX_DIGITS[c & 0xF];
+				} else {
+					*p++ = (byte)c;
+				}
+				break;
+			}
+			continue;
+		}
+
+		// Combine UTF-16 surrogate pairs where wchar_t is 16 bit
+		if(c >= 0xD800 && c <= 0xDBFF && i + 1 < length) {
+			unsigned long low = (unsigned long)pValue[i + 1];
+			if(low >= 0xDC00 && low <= 0xDFFF) {
+				c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+				i++;
+			}
+		}
+		if(c >= 0xD800 && c <= 0xDFFF) {
+			// lone surrogate, emit U+FFFD
+			c = 0xFFFD;
+		}
+
+		if(c < 0x800) {
+			*p++ = (byte)(0xC0 | (c >> 6));
+			*p++ = (byte)(0x80 | (c & 0x3F));
+		} else if(c < 0x10000) {
+			*p++ = (byte)(0xE0 | (c >> 12));
+			*p++ = (byte)(0x80 | ((c >> 6) & 0x3F));
+			*p++ = (byte)(0x80 | (c & 0x3F));
+		} else {
+			*p++ = (byte)(0xF0 | (c >> 18));
+			*p++ = (byte)(0x80 | ((c >> 12) & 0x3F));
+			*p++ = (byte)(0x80 | ((c >> 6) & 0x3F));
+			*p++ = (byte)(0x80 | (c & 0x3F));
+		}
+	}
+	*p++ = '"';
+	__length = p - __pData;
+}
+
+void
+JsonWriter::Separator(void)
+{
+	if(__afterKey) {
+		__afterKey = false;
+		return;
+	}
+	if(__depth == 0) {
+		return;
+	}
+
+	unsigned int bit = 1u << (__depth - 1);
+	if(__first & bit) {
+		__first &= ~bit;
+	} else {
+		Put(',');
+	}
+}
+
+void
+JsonWriter::BeginObject(void)
+{
+	Separator();
+	Put('{');
+	if(__depth < MAX_DEPTH) {
+		__first |= 1u << __depth;
+		__depth++;
+	} else {
+		__r = E_OVERFLOW;
+	}
+}
+
+void
+JsonWriter::EndObject(void)
+{
+	if(__depth > 0) {
+		__depth--;
+	}
+	Put('}');
+}
+
+void
+JsonWriter::BeginArray(void)
+{
+	Separator();
+	Put('[');
+	if(__depth < MAX_DEPTH) {
+		__first |= 1u << __depth;
+		__depth++;
+	} else {
+		__r = E_OVERFLOW;
+	}
+}
+
+void
+JsonWriter::EndArray(void)
+{
+	if(__depth > 0) {
+		__depth--;
+	}
+	Put(']');
+}
+
+void
+JsonWriter::Key(const char* key)
+{
+	Separator();
+	Put('"');
+	PutAscii(key);
+	Put('"');
+	Put(':');
+	__afterKey = true;
+}
+
+void
+JsonWriter::Key(const String& key)
+{
+	Separator();
+	PutEscaped(key.GetPointer(), key.GetLength());
+	Put(':');
+	__afterKey = true;
+}
+
+void
+JsonWriter::Value(const String& value)
+{
+	Value(value.GetPointer(), value.GetLength());
+}
+
+void
+JsonWriter::Value(const mchar* pValue, int length)
+{
+	Separator();
+	PutEscaped(pValue, length);
+}
+
+void
+JsonWriter::Value(const char* pValue)
+{
+	Separator();
+	Put('"');
+	for(const char* p = pValue; *p != '\0'; p++) {
+		if(*p == '"' || *p == '\\') {
+			Put('\\');
+		}
+		Put((byte)*p);
+	}
+	Put('"');
+}
+
+void
+JsonWriter::Value(long long value)
+{
+	Separator();
+
+	char digits[24];
+	int pos = sizeof(digits);
+	digits[--pos] = '\0';
+
+	unsigned long long v = value < 0 ? -(unsigned long long)value : (unsigned long long)value;
+	do {
+		digits[--pos] = (char)('0' + (v % 10));
+		v /= 10;
+	} while(v != 0);
+	if(value < 0) {
+		digits[--pos] = '-';
+	}
+	PutAscii(digits + pos);
+}
+
+void
+JsonWriter::Value(bool value)
+{
+	Separator();
+	PutAscii(value ? "true" : "false");
+}
+
+void
+JsonWriter::Null(void)
+{
+	Separator();
+	PutAscii("null");
+}
+
+JsonWriter::Checkpoint
+JsonWriter::GetCheckpoint(void) const
+{
+	Checkpoint checkpoint;
+	checkpoint.length = __length;
+	checkpoint.depth = __depth;
+	checkpoint.first = __first;
+	checkpoint.afterKey = __afterKey;
+	return checkpoint;
+}
+
+void
+JsonWriter::Rollback(const Checkpoint& checkpoint)
+{
+	__length = checkpoint.length;
+	__depth = checkpoint.depth;
+	__first = checkpoint.first;
+	__afterKey = checkpoint.afterKey;
+}
@@ -0,0 +1,80 @@
+#ifndef JSONWRITER_H_
+#define JSONWRITER_H_
+
+#include "Port.h"
+
+using namespace Osp::Base;
+
+/**
+ * Streams JSON as UTF-8 into a growable byte array. Commas and escaping are
+ * handled by the writer; the buffer keeps its capacity across Clear() so one
+ * instance can be reused for every payload.
+ */
+class JsonWriter {
+public:
+	JsonWriter();
+	~JsonWriter();
+
+	result Construct(int capacity);
+	void Clear(void);
+
+	void BeginObject(void);
+	void EndObject(void);
+	void BeginArray(void);
+	void EndArray(void);
+
+	// key must be plain ASCII
+	void Key(const char* key);
+	void Key(const String& key);
+
+	void Value(const String& value);
+	void Value(const mchar* pValue, int length);
+	// pValue must be plain ASCII
+	void Value(const char* pValue);
+	void Value(long long value);
+	void Value(bool value);
+	void Null(void);
+
+	void Member(const char* key, const String& value) { Key(key); Value(value); }
+	void Member(const char* key, const char* pValue) { Key(key); Value(pValue); }
+	void Member(const char* key, long long value) { Key(key); Value(value); }
+	void Member(const char* key, bool value) { Key(key); Value(value); }
+
+	// Batches: take a checkpoint before each element and roll back to it when
+	// the element pushed the payload over its size budget.
+	struct Checkpoint {
+		int length;
+		int depth;
+		unsigned int first;
+		bool afterKey;
+	};
+	Checkpoint GetCheckpoint(void) const;
+	void Rollback(const Checkpoint& checkpoint);
+
+	const byte* GetPointer(void) const { return __pData; }
+	int GetLength(void) const { return __length; }
+	result GetLastResult(void) const { return __r; }
+
+private:
+	JsonWriter(const JsonWriter&);
+	JsonWriter& operator =(const JsonWriter&);
+
+	bool Reserve(int count);
+	void Put(byte value);
+	void PutAscii(const char* pValue);
+	void PutEscaped(const mchar* pValue, int length);
+	void Separator(void);
+
+	static const int MAX_DEPTH = 32;
+
+	byte* __pData;
+	int __length;
+	int __capacity;
+	int __depth;
+	// bit n is set while the container at depth n has no element yet
+	unsigned int __first;
+	bool __afterKey;
+	result __r;
+};
+
+#endif
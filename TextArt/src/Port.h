@@ -0,0 +1,22 @@
+#ifndef PORT_H_
+#define PORT_H_
+
+/**
+ * Osp surface of the UI-free core (Catalog, TextArtRegistry, JournalStore, JsonWriter,
+ * SmsSegmenter, ContentSync, TaskScheduler, Telemetry, StartAPI). Device builds take it from the SDK,
+ * TEXTART_HOST builds from the desktop implementation in host/ so the core
+ * can be run and measured off-device (see bench/).
+ */
+#ifdef TEXTART_HOST
+#include "HostOsp.h"
+#else
+#include <FApp.h>
+#include <FBase.h>
+#include <FBaseRt.h>
+#include <FIo.h>
+#include <FNet.h>
+#include <FSecurity.h>
+#include <FSystem.h>
+#endif
+
+#endif
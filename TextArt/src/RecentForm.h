@@ -19,6 +19,7 @@ public:
 	virtual result OnDraw(void);
 	virtual result OnInitializing(void);
 	virtual result OnTerminating(void);
+	virtual void OnLanguageChanged(void);
 };
 
 #endif
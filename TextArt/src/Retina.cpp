@@ -1,3 +1,93 @@
 #include "Retina.h"
 
-float Retina::M = 1.0f;
+// Expanded once per screen below, RETINA_TABLE_SCALE is the scale of the table
+#define RETINA_SCALED(value) ((value) * RETINA_TABLE_SCALE / Retina::SCALE_ONE)
+#define RETINA_RECT_ROW(id, x, y, width, height) \
+	{ RETINA_SCALED(x), RETINA_SCALED(y), RETINA_SCALED(width), RETINA_SCALED(height) },
+#define RETINA_SIZE_ROW(id, value) RETINA_SCALED(value),
+
+#define RETINA_TABLE_SCALE 1000
+static const Retina::Rect RECTS_240[] = { RETINA_RECTS(RETINA_RECT_ROW) };
+static const short SIZES_240[] = { RETINA_SIZES(RETINA_SIZE_ROW) };
+#undef RETINA_TABLE_SCALE
+
+#define RETINA_TABLE_SCALE 1200
+static const Retina::Rect RECTS_320[] = { RETINA_RECTS(RETINA_RECT_ROW) };
+static const short SIZES_320[] = { RETINA_SIZES(RETINA_SIZE_ROW) };
+#undef RETINA_TABLE_SCALE
+
+#define RETINA_TABLE_SCALE 2000
+static const Retina::Rect RECTS_480[] = { RETINA_RECTS(RETINA_RECT_ROW) };
+static const short SIZES_480[] = { RETINA_SIZES(RETINA_SIZE_ROW) };
+#undef RETINA_TABLE_SCALE
+
+struct Density {
+	int width;
+	int scale;
+	const Retina::Rect* pRects;
+	const short* pSizes;
+};
+
+// By width; the art was drawn for these scales, not for the width ratio
+static const Density DENSITIES[] = {
+	{ 240, 1000, RECTS_240, SIZES_240 },
+	{ 320, 1200, RECTS_320, SIZES_320 },
+	{ 480, 2000, RECTS_480, SIZES_480 }
+};
+static const int DENSITY_COUNT = sizeof(DENSITIES) / sizeof(DENSITIES[0]);
+
+int Retina::__scale = Retina::SCALE_ONE;
+const Retina::Rect* Retina::__pRects = RECTS_240;
+const short* Retina::__pSizes = SIZES_240;
+Retina::Rect Retina::__scaledRects[RECT_COUNT];
+short Retina::__scaledSizes[SIZE_COUNT];
+
+void
+Retina::Setup(void)
+{
+	Frame *pFrame = Application::GetInstance()->GetAppFrame()->GetFrame();
+	Setup(pFrame->GetWidth());
+}
+
+void
+Retina::Setup(int width)
+{
+	for(int i = 0; i < DENSITY_COUNT; i++) {
+		if(DENSITIES[i].width == width) {
+			__scale = DENSITIES[i].scale;
+			__pRects = DENSITIES[i].pRects;
+			__pSizes = DENSITIES[i].pSizes;
+			return;
+		}
+	}
+
+	// In proportion to the width beyond the ends, on the line between the neighbours in between
+	const Density& first = DENSITIES[0];
+	const Density& last = DENSITIES[DENSITY_COUNT - 1];
+	if(width < first.width) {
+		__scale = first.scale * width / first.width;
+	} else if(width > last.width) {
+		__scale = last.scale * width / last.width;
+	} else {
+		int upper = 1;
+		while(DENSITIES[upper].width < width) {
+			upper++;
+		}
+		const Density& low = DENSITIES[upper - 1];
+		const Density& high = DENSITIES[upper];
+		__scale = low.scale + (high.scale - low.scale) * (width - low.width) / (high.width - low.width);
+	}
+	AppLog("No layout for width %d, scaled by %d/%d", width, __scale, SCALE_ONE);
+
+	for(int i = 0; i < RECT_COUNT; i++) {
+		__scaledRects[i].x = RECTS_240[i].x * __scale / SCALE_ONE;
+		__scaledRects[i].y = RECTS_240[i].y * __scale / SCALE_ONE;
+		__scaledRects[i].width = RECTS_240[i].width * __scale / SCALE_ONE;
+		__scaledRects[i].height = RECTS_240[i].height * __scale / SCALE_ONE;
+	}
+	for(int i = 0; i < SIZE_COUNT; i++) {
+		__scaledSizes[i] = SIZES_240[i] * __scale / SCALE_ONE;
+	}
+	__pRects = __scaledRects;
+	__pSizes = __scaledSizes;
+}
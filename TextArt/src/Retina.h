@@ -1,3 +1,6 @@
+#ifndef RETINA_H_
+#define RETINA_H_
+
 #include <FBase.h>
 #include <FUi.h>
 #include <FApp.h>
@@ -7,31 +10,104 @@ using namespace Osp::Graphics;
 using namespace Osp::Ui::Controls;
 using namespace Osp::App;
 
+// Rectangles of the forms in points of the 240 wide screen: id, x, y, width, height;
+// the art of an item takes the height of its lines
+#define RETINA_RECTS(RECT) \
+	RECT(RECT_RESULT_TITLE, 5, 5, 230, 20) \
+	RECT(RECT_RESULT_CATEGORY, 5, 27, 230, 15) \
+	RECT(RECT_CATEGORY_ART, 5, 5, 100, 65) \
+	RECT(RECT_CATEGORY_TITLE, 105, 5, 130, 20) \
+	RECT(RECT_CATEGORY_DESC, 105, 30, 130, 45) \
+	RECT(RECT_INFO_IMAGE, 5, 5, 65, 65) \
+	RECT(RECT_INFO_DESC, 75, 5, 180, 120) \
+	RECT(RECT_ITEM_TITLE, 10, 5, 220, 20) \
+	RECT(RECT_ITEM_ART, 10, 30, 230, 0) \
+	RECT(RECT_POPUP_SEND, 40, 5, 65, 65) \
+	RECT(RECT_POPUP_COPY, 40, 75, 65, 65) \
+	RECT(RECT_POPUP_MAIL, 110, 5, 65, 65) \
+	RECT(RECT_POPUP_FAVOURITE, 110, 75, 65, 65) \
+	RECT(RECT_POPUP_SIMILAR, 40, 145, 65, 28) \
+	RECT(RECT_POPUP_VIEW, 110, 145, 65, 28) \
+	RECT(RECT_POPUP_CANCEL, 180, 145, 28, 28)
+
+// Row heights, font sizes and other lengths, same units: id, value
+#define RETINA_SIZES(SIZE) \
+	SIZE(SIZE_SEARCH_BAR, 36) \
+	SIZE(SIZE_RESULT_ROW, 47) \
+	SIZE(SIZE_RESULT_TITLE_FONT, 18) \
+	SIZE(SIZE_RESULT_CATEGORY_FONT, 12) \
+	SIZE(SIZE_CATEGORY_ROW, 75) \
+	SIZE(SIZE_CATEGORY_TITLE_FONT, 20) \
+	SIZE(SIZE_CATEGORY_DESC_FONT, 12) \
+	SIZE(SIZE_CATEGORY_PREVIEW_FONT, 13) \
+	SIZE(SIZE_INFO_ROW, 75) \
+	SIZE(SIZE_INFO_DESC_FONT, 12) \
+	SIZE(SIZE_ITEM_TITLE_FONT, 20) \
+	SIZE(SIZE_ITEM_ART_FONT, 16) \
+	SIZE(SIZE_ITEM_PADDING, 40) \
+	SIZE(SIZE_POPUP, 222)
+
+#define RETINA_ENUM_RECT(id, x, y, width, height) id,
+#define RETINA_ENUM_SIZE(id, value) id,
+
+/**
+ * Layout of the forms for the screen the application runs on. Every
+ * length is declared once above, the tables of the 240, 320 and 480 wide
+ * screens are expanded by the compiler. Setup() picks one by the frame
+ * width, or scales the 240 table once by a scale interpolated between
+ * them for any other width, so rows and popups are built from table
+ * lookups and integer math. Scales are in thousandths.
+ */
 class Retina {
 public:
-		static void Setup() {
-			Frame *pFrame = Application::GetInstance()->GetAppFrame()->GetFrame();
-
-			M = 1.0f;
-			switch (pFrame->GetWidth())
-			{
-				case 320:
-					M=1.2f;
-					break;
-				case 480:
-					M=2.0f;
-					break;
-			}
-			/*if(pFrame->GetWidth() > 240) {
-				M = 1.2f;
-			}*/
-
-		}
-
-		static int GetInt(int value)
-		{
-			return (int) (M * value);
-		}
+	enum RectId {
+		RETINA_RECTS(RETINA_ENUM_RECT)
+		RECT_COUNT
+	};
+
+	enum SizeId {
+		RETINA_SIZES(RETINA_ENUM_SIZE)
+		SIZE_COUNT
+	};
+
+	struct Rect {
+		short x;
+		short y;
+		short width;
+		short height;
+	};
+
+	static const int SCALE_ONE = 1000;
+
+	// Picks the tables for the width of the frame
+	static void Setup(void);
+	static void Setup(int width);
+
+	static Rectangle GetRect(RectId id) {
+		const Rect& rect = __pRects[id];
+		return Rectangle(rect.x, rect.y, rect.width, rect.height);
+	}
+
+	static int GetSize(SizeId id) {
+		return __pSizes[id];
+	}
+
+	// For lengths known at run time only, such as the height of some lines of art
+	static int GetInt(int value) {
+		return value * __scale / SCALE_ONE;
+	}
+
+	static int GetScale(void) {
+		return __scale;
+	}
+
 private:
-		static float M;
+	static int __scale;
+	static const Rect* __pRects;
+	static const short* __pSizes;
+	// Tables of a width that has none of its own
+	static Rect __scaledRects[RECT_COUNT];
+	static short __scaledSizes[SIZE_COUNT];
 };
+
+#endif
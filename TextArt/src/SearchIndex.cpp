@@ -0,0 +1,962 @@
+#include "SearchIndex.h"
+
+#include "Debug.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+using namespace Osp::Io;
+
+static const wchar_t* INDEX_PATH = L"/Home/catalog/search.idx";
+
+static const int INDEX_MAGIC = 0x58495354;	// "TSIX"
+static const int INDEX_VERSION = 1;
+
+static const int MIN_TEXT_CAPACITY = 4096;
+static const int MIN_POSTING_CAPACITY = 8;
+
+// Ranking, a title hit always beats an art hit and shorter titles come first
+static const int SCORE_PREFIX = 4000;
+static const int SCORE_TITLE = 3000;
+static const int SCORE_OTHER_TITLE = 2000;
+static const int SCORE_ART = 1000;
+static const int MAX_LENGTH_PENALTY = 999;
+
+// Postings and candidates carry one bit per language whose title holds the trigram
+static const int LANGUAGE_BITS = Catalog::LANGUAGE_COUNT;
+static const int LANGUAGE_MASK = (1 << LANGUAGE_BITS) - 1;
+
+struct IndexHeader {
+	int magic;
+	int version;
+	int textLength;
+	int itemCount;
+	int categoryCount;
+	int trigramCount;
+	int postingLength;
+};
+
+// Case folding for the scripts of the catalog: Latin, Latin-1 and Cyrillic
+static inline mchar
+Fold(mchar c)
+{
+	if(c >= L'A' && c <= L'Z') {
+		return c + 32;
+	}
+	if(c < 0xC0) {
+		return c;
+	}
+	if(c <= 0xDE && c != 0xD7) {
+		return c + 32;
+	}
+	if(c >= 0x410 && c <= 0x42F) {
+		return c + 0x20;
+	}
+	if(c >= 0x400 && c <= 0x40F) {
+		return c + 0x50;
+	}
+	return c;
+}
+
+static inline bool
+IsBlank(mchar c)
+{
+	return c == L' ' || c == L'\t';
+}
+
+// Folded trigram at p, or -1 for one that spans a line break or holds only blanks
+static inline long long
+GetKey(const mchar* p)
+{
+	for(int i = 0; i < 3; i++) {
+		if(p[i] == L'\n' || p[i] == L'\r') {
+			return -1;
+		}
+	}
+	if(IsBlank(p[0]) && IsBlank(p[1]) && IsBlank(p[2])) {
+		return -1;
+	}
+	return ((long long)(Fold(p[0]) & 0xFFFF) << 32) | ((long long)(Fold(p[1]) & 0xFFFF) << 16) | (Fold(p[2]) & 0xFFFF);
+}
+
+static int
+CompareKeys(const void* pLeft, const void* pRight)
+{
+	long long left = *static_cast<const long long*>(pLeft);
+	long long right = *static_cast<const long long*>(pRight);
+	return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+static int
+CompareTrigrams(const void* pLeft, const void* pRight)
+{
+	// key is the first member
+	return CompareKeys(pLeft, pRight);
+}
+
+// Position of the folded query in the text, -1 if it does not occur
+static int
+Find(const mchar* pText, const mchar* pQuery, int length)
+{
+	for(const mchar* p = pText; *p != 0; p++) {
+		int matched = 0;
+		while(matched < length && p[matched] != 0 && Fold(p[matched]) == pQuery[matched]) {
+			matched++;
+		}
+		if(matched == length) {
+			return p - pText;
+		}
+	}
+	return -1;
+}
+
+SearchIndex::SearchIndex():
+	__pText(null),
+	__textLength(0),
+	__textCapacity(0),
+	__pItems(null),
+	__itemCount(0),
+	__itemCapacity(0),
+	__pCategories(null),
+	__categoryCount(0),
+	__categoryCapacity(0),
+	__pPrefixes(null),
+	__pTrigrams(null),
+	__trigramCount(0),
+	__pPostings(null),
+	__postingLength(0),
+	__pPending(null),
+	__pendingCount(0),
+	__pendingCapacity(0),
+	__pSlots(null),
+	__slotCount(0),
+	__pQuery(null),
+	__queryLength(0),
+	__queryCapacity(0),
+	__candidatesValid(false),
+	__pCandidates(null),
+	__candidateCount(0),
+	__appliedCount(0)
+{
+}
+
+SearchIndex::~SearchIndex()
+{
+	Clear();
+	delete[] __pQuery;
+}
+
+void
+SearchIndex::Clear(void)
+{
+	for(int i = 0; i < __pendingCount; i++) {
+		delete[] __pPending[i].pBytes;
+	}
+	delete[] __pPending;
+	delete[] __pSlots;
+	delete[] __pText;
+	delete[] __pItems;
+	delete[] __pCategories;
+	delete[] __pPrefixes;
+	delete[] __pTrigrams;
+	delete[] __pPostings;
+	delete[] __pCandidates;
+
+	__pPending = null;
+	__pendingCount = 0;
+	__pendingCapacity = 0;
+	__pSlots = null;
+	__slotCount = 0;
+	__pText = null;
+	__textLength = 0;
+	__textCapacity = 0;
+	__pItems = null;
+	__itemCount = 0;
+	__itemCapacity = 0;
+	__pCategories = null;
+	__categoryCount = 0;
+	__categoryCapacity = 0;
+	__pPrefixes = null;
+	__pTrigrams = null;
+	__trigramCount = 0;
+	__pPostings = null;
+	__postingLength = 0;
+	__pCandidates = null;
+	__candidateCount = 0;
+	__candidatesValid = false;
+	__appliedCount = 0;
+}
+
+void
+SearchIndex::GetDefaultPath(String& path)
+{
+	path = INDEX_PATH;
+}
+
+bool
+SearchIndex::ReserveText(int count)
+{
+	if(__textLength + count <= __textCapacity) {
+		return true;
+	}
+	int capacity = __textCapacity > 0 ? __textCapacity : MIN_TEXT_CAPACITY;
+	while(capacity < __textLength + count) {
+		capacity *= 2;
+	}
+	mchar* pText = new mchar[capacity];
+	if(pText == null) {
+		return false;
+	}
+	if(__textLength > 0) {
+		memcpy(pText, __pText, __textLength * sizeof(mchar));
+	}
+	delete[] __pText;
+	__pText = pText;
+	__textCapacity = capacity;
+	return true;
+}
+
+int
+SearchIndex::AddText(const mchar* pValue, int length)
+{
+	int offset = __textLength;
+	if(length > 0) {
+		memcpy(__pText + __textLength, pValue, length * sizeof(mchar));
+	}
+	__pText[__textLength + length] = 0;
+	__textLength += length + 1;
+	return offset;
+}
+
+int
+SearchIndex::CollectTrigrams(const mchar* pValue, int length, int languages, long long* pKeys, int count, int capacity) const
+{
+	for(int i = 0; i + 3 <= length && count < capacity; i++) {
+		long long key = GetKey(pValue + i);
+		if(key >= 0) {
+			pKeys[count++] = (key << LANGUAGE_BITS) | languages;
+		}
+	}
+	return count;
+}
+
+SearchIndex::Pending*
+SearchIndex::FindPending(long long key)
+{
+	if(__pendingCount * 2 >= __slotCount) {
+		int slotCount = __slotCount > 0 ? __slotCount * 2 : 1024;
+		int* pSlots = new int[slotCount];
+		if(pSlots == null) {
+			return null;
+		}
+		memset(pSlots, 0, slotCount * sizeof(int));
+		for(int i = 0; i < __pendingCount; i++) {
+			unsigned int slot = (unsigned int)(((unsigned long long)__pPending[i].key * 0x9E3779B97F4A7C15ULL) >> 32) & (slotCount - 1);
+			while(pSlots[slot] != 0) {
+				slot = (slot + 1) & (slotCount - 1);
+			}
+			pSlots[slot] = i + 1;
+		}
+		delete[] __pSlots;
+		__pSlots = pSlots;
+		__slotCount = slotCount;
+	}
+
+	unsigned int slot = (unsigned int)(((unsigned long long)key * 0x9E3779B97F4A7C15ULL) >> 32) & (__slotCount - 1);
+	while(__pSlots[slot] != 0) {
+		Pending& pending = __pPending[__pSlots[slot] - 1];
+		if(pending.key == key) {
+			return &pending;
+		}
+		slot = (slot + 1) & (__slotCount - 1);
+	}
+
+	if(__pendingCount == __pendingCapacity) {
+		int capacity = __pendingCapacity > 0 ? __pendingCapacity * 2 : 1024;
+		Pending* pPending = new Pending[capacity];
+		if(pPending == null) {
+			return null;
+		}
+		if(__pendingCount > 0) {
+			memcpy(pPending, __pPending, __pendingCount * sizeof(Pending));
+		}
+		delete[] __pPending;
+		__pPending = pPending;
+		__pendingCapacity = capacity;
+	}
+	Pending& pending = __pPending[__pendingCount];
+	pending.key = key;
+	pending.pBytes = null;
+	pending.length = 0;
+	pending.capacity = 0;
+	pending.last = -1;
+	pending.count = 0;
+	__pSlots[slot] = ++__pendingCount;
+	return &pending;
+}
+
+result
+SearchIndex::AddItem(int category, const String& path, const String* pTitles, const String& art)
+{
+	const mchar* pPath = path.GetPointer();
+	int slash = path.GetLength();
+	while(slash > 0 && pPath[slash - 1] != L'/') {
+		slash--;
+	}
+
+	int textLength = path.GetLength() - slash + 1;
+	for(int language = 0; language < Catalog::LANGUAGE_COUNT; language++) {
+		if(pTitles[language].GetLength() > 0xFFFF) {
+			return E_INVALID_ARG;
+		}
+		textLength += pTitles[language].GetLength() + 1;
+	}
+	if(!ReserveText(textLength)) {
+		return E_OUT_OF_MEMORY;
+	}
+	if(__itemCount == __itemCapacity) {
+		int capacity = __itemCapacity > 0 ? __itemCapacity * 2 : 256;
+		Item* pItems = new Item[capacity];
+		if(pItems == null) {
+			return E_OUT_OF_MEMORY;
+		}
+		if(__itemCount > 0) {
+			memcpy(pItems, __pItems, __itemCount * sizeof(Item));
+		}
+		delete[] __pItems;
+		__pItems = pItems;
+		__itemCapacity = capacity;
+	}
+
+	int item = __itemCount;
+	Item& entry = __pItems[item];
+	entry.category = category;
+	entry.name = AddText(pPath + slash, path.GetLength() - slash);
+	for(int language = 0; language < Catalog::LANGUAGE_COUNT; language++) {
+		entry.titles[language] = AddText(pTitles[language].GetPointer(), pTitles[language].GetLength());
+		entry.lengths[language] = (unsigned short)pTitles[language].GetLength();
+	}
+	__itemCount++;
+
+	// Distinct trigrams of the item with the languages of the titles holding them
+	int capacity = art.GetLength();
+	for(int language = 0; language < Catalog::LANGUAGE_COUNT; language++) {
+		capacity += pTitles[language].GetLength();
+	}
+	if(capacity == 0) {
+		return E_SUCCESS;
+	}
+	long long* pKeys = new long long[capacity];
+	if(pKeys == null) {
+		return E_OUT_OF_MEMORY;
+	}
+	int count = 0;
+	for(int language = 0; language < Catalog::LANGUAGE_COUNT; language++) {
+		count = CollectTrigrams(pTitles[language].GetPointer(), pTitles[language].GetLength(), 1 << language, pKeys, count, capacity);
+	}
+	count = CollectTrigrams(art.GetPointer(), art.GetLength(), 0, pKeys, count, capacity);
+	qsort(pKeys, count, sizeof(long long), CompareKeys);
+
+	result r = E_SUCCESS;
+	for(int i = 0; i < count && !IsFailed(r); i++) {
+		long long key = pKeys[i] >> LANGUAGE_BITS;
+		int languages = (int)(pKeys[i] & LANGUAGE_MASK);
+		while(i + 1 < count && (pKeys[i + 1] >> LANGUAGE_BITS) == key) {
+			languages |= (int)(pKeys[++i] & LANGUAGE_MASK);
+		}
+
+		Pending* pPending = FindPending(key);
+		if(pPending == null) {
+			r = E_OUT_OF_MEMORY;
+			break;
+		}
+		// room for one more varint
+		if(pPending->length + 5 > pPending->capacity) {
+			int bytesCapacity = pPending->capacity > 0 ? pPending->capacity * 2 : MIN_POSTING_CAPACITY;
+			byte* pBytes = new byte[bytesCapacity];
+			if(pBytes == null) {
+				r = E_OUT_OF_MEMORY;
+				break;
+			}
+			if(pPending->length > 0) {
+				memcpy(pBytes, pPending->pBytes, pPending->length);
+			}
+			delete[] pPending->pBytes;
+			pPending->pBytes = pBytes;
+			pPending->capacity = bytesCapacity;
+		}
+
+		// varint of the distance to the previous item, the title languages in the low bits
+		unsigned int value = ((unsigned int)(item - pPending->last) << LANGUAGE_BITS) | languages;
+		while(value >= 0x80) {
+			pPending->pBytes[pPending->length++] = (byte)(value | 0x80);
+			value >>= 7;
+		}
+		pPending->pBytes[pPending->length++] = (byte)value;
+		pPending->last = item;
+		pPending->count++;
+	}
+	delete[] pKeys;
+	return r;
+}
+
+result
+SearchIndex::Finish(void)
+{
+	__pTrigrams = new Trigram[__pendingCount > 0 ? __pendingCount : 1];
+	__pCandidates = new int[__itemCount > 0 ? __itemCount : 1];
+	if(__pTrigrams == null || __pCandidates == null) {
+		return E_OUT_OF_MEMORY;
+	}
+	__trigramCount = __pendingCount;
+	__postingLength = 0;
+	for(int i = 0; i < __pendingCount; i++) {
+		__pTrigrams[i].key = __pPending[i].key;
+		__pTrigrams[i].postings = i;
+		__pTrigrams[i].count = __pPending[i].count;
+		__postingLength += __pPending[i].length;
+	}
+	qsort(__pTrigrams, __trigramCount, sizeof(Trigram), CompareTrigrams);
+
+	__pPostings = new byte[__postingLength > 0 ? __postingLength : 1];
+	if(__pPostings == null) {
+		return E_OUT_OF_MEMORY;
+	}
+	int offset = 0;
+	for(int i = 0; i < __trigramCount; i++) {
+		Pending& pending = __pPending[__pTrigrams[i].postings];
+		memcpy(__pPostings + offset, pending.pBytes, pending.length);
+		__pTrigrams[i].postings = offset;
+		offset += pending.length;
+		delete[] pending.pBytes;
+		pending.pBytes = null;
+	}
+
+	delete[] __pPending;
+	delete[] __pSlots;
+	__pPending = null;
+	__pendingCount = 0;
+	__pendingCapacity = 0;
+	__pSlots = null;
+	__slotCount = 0;
+	return BuildPrefixes();
+}
+
+result
+SearchIndex::BuildPrefixes(void)
+{
+	__pPrefixes = new unsigned int[__itemCount > 0 ? __itemCount * Catalog::LANGUAGE_COUNT : 1];
+	if(__pPrefixes == null) {
+		return E_OUT_OF_MEMORY;
+	}
+	unsigned int* pPrefix = __pPrefixes;
+	for(int item = 0; item < __itemCount; item++) {
+		for(int language = 0; language < Catalog::LANGUAGE_COUNT; language++) {
+			const mchar* pTitle = __pText + __pItems[item].titles[language];
+			unsigned int first = pTitle[0] != 0 ? Fold(pTitle[0]) & 0xFFFF : 0;
+			unsigned int second = pTitle[0] != 0 && pTitle[1] != 0 ? Fold(pTitle[1]) & 0xFFFF : 0;
+			*pPrefix++ = (first << 16) | second;
+		}
+	}
+	return E_SUCCESS;
+}
+
+result
+SearchIndex::Build(void)
+{
+	PROFILE_SCOPE("SearchIndex::Build");
+	Clear();
+
+	ArrayList names;
+	names.Construct();
+	result r = Catalog::GetCategories(names);
+	if(IsFailed(r)) {
+		return r;
+	}
+	__pCategories = new int[names.GetCount() > 0 ? names.GetCount() : 1];
+	__categoryCapacity = names.GetCount();
+
+	for(int n = 0; n < names.GetCount() && !IsFailed(r); n++) {
+		const String& name = *static_cast<String*>(names.GetAt(n));
+		if(!ReserveText(name.GetLength() + 1)) {
+			r = E_OUT_OF_MEMORY;
+			break;
+		}
+		__pCategories[__categoryCount] = AddText(name.GetPointer(), name.GetLength());
+
+		ArrayList paths;
+		paths.Construct();
+		Catalog::GetItems(name, paths);
+		for(int i = 0; i < paths.GetCount() && !IsFailed(r); i++) {
+			const String& path = *static_cast<String*>(paths.GetAt(i));
+			String titles[Catalog::LANGUAGE_COUNT];
+			String art;
+			int linecount = 0;
+			if(IsFailed(Catalog::ReadItem(path, titles, art, linecount))) {
+				continue;
+			}
+			r = AddItem(__categoryCount, path, titles, art);
+		}
+		paths.RemoveAll(true);
+		__categoryCount++;
+	}
+	names.RemoveAll(true);
+
+	if(!IsFailed(r)) {
+		r = Finish();
+	}
+	if(IsFailed(r)) {
+		Clear();
+	}
+	PROFILE_COUNT("items", __itemCount);
+	return r;
+}
+
+result
+SearchIndex::Save(const String& path) const
+{
+	File file;
+	result r = file.Construct(path, L"w", true);
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	IndexHeader header;
+	header.magic = INDEX_MAGIC;
+	header.version = INDEX_VERSION;
+	header.textLength = __textLength;
+	header.itemCount = __itemCount;
+	header.categoryCount = __categoryCount;
+	header.trigramCount = __trigramCount;
+	header.postingLength = __postingLength;
+	r = file.Write(&header, sizeof(header));
+
+	// Text is stored as UTF-16 whatever the width of mchar
+	unsigned short chunk[1024];
+	for(int start = 0; start < __textLength && !IsFailed(r); start += 1024) {
+		int length = __textLength - start < 1024 ? __textLength - start : 1024;
+		for(int i = 0; i < length; i++) {
+			chunk[i] = (unsigned short)__pText[start + i];
+		}
+		r = file.Write(chunk, length * sizeof(unsigned short));
+	}
+	if(!IsFailed(r)) {
+		r = file.Write(__pItems, __itemCount * sizeof(Item));
+	}
+	if(!IsFailed(r)) {
+		r = file.Write(__pCategories, __categoryCount * sizeof(int));
+	}
+	if(!IsFailed(r)) {
+		r = file.Write(__pTrigrams, __trigramCount * sizeof(Trigram));
+	}
+	if(!IsFailed(r)) {
+		r = file.Write(__pPostings, __postingLength);
+	}
+	if(IsFailed(r)) {
+		AppLog("Search index not saved by %s", GetErrorMessage(r));
+		return r;
+	}
+	return file.Flush();
+}
+
+result
+SearchIndex::Load(const String& path)
+{
+	PROFILE_SCOPE("SearchIndex::Load");
+	Clear();
+
+	File file;
+	result r = file.Construct(path, L"r");
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	IndexHeader header;
+	if(file.Read(&header, sizeof(header)) != (int)sizeof(header) || header.magic != INDEX_MAGIC
+			|| header.version != INDEX_VERSION || header.textLength < 0 || header.itemCount < 0
+			|| header.categoryCount < 0 || header.trigramCount < 0 || header.postingLength < 0) {
+		return E_INVALID_FORMAT;
+	}
+
+	__pText = new mchar[header.textLength > 0 ? header.textLength : 1];
+	__pItems = new Item[header.itemCount > 0 ? header.itemCount : 1];
+	__pCategories = new int[header.categoryCount > 0 ? header.categoryCount : 1];
+	__pTrigrams = new Trigram[header.trigramCount > 0 ? header.trigramCount : 1];
+	__pPostings = new byte[header.postingLength > 0 ? header.postingLength : 1];
+	__pCandidates = new int[header.itemCount > 0 ? header.itemCount : 1];
+	if(__pText == null || __pItems == null || __pCategories == null || __pTrigrams == null || __pPostings == null
+			|| __pCandidates == null) {
+		Clear();
+		return E_OUT_OF_MEMORY;
+	}
+
+	bool complete = true;
+	unsigned short chunk[1024];
+	for(int start = 0; start < header.textLength && complete; start += 1024) {
+		int length = header.textLength - start < 1024 ? header.textLength - start : 1024;
+		complete = file.Read(chunk, length * sizeof(unsigned short)) == (int)(length * sizeof(unsigned short));
+		for(int i = 0; i < length; i++) {
+			__pText[start + i] = chunk[i];
+		}
+	}
+	complete = complete && file.Read(__pItems, header.itemCount * sizeof(Item)) == (int)(header.itemCount * sizeof(Item));
+	complete = complete && file.Read(__pCategories, header.categoryCount * sizeof(int)) == (int)(header.categoryCount * sizeof(int));
+	complete = complete && file.Read(__pTrigrams, header.trigramCount * sizeof(Trigram)) == (int)(header.trigramCount * sizeof(Trigram));
+	complete = complete && file.Read(__pPostings, header.postingLength) == header.postingLength;
+	if(!complete) {
+		Clear();
+		return E_INVALID_FORMAT;
+	}
+
+	__textLength = __textCapacity = header.textLength;
+	__itemCount = __itemCapacity = header.itemCount;
+	__categoryCount = __categoryCapacity = header.categoryCount;
+	__trigramCount = header.trigramCount;
+	__postingLength = header.postingLength;
+	if(!IsConsistent()) {
+		Clear();
+		return E_INVALID_FORMAT;
+	}
+	r = BuildPrefixes();
+	if(IsFailed(r)) {
+		Clear();
+		return r;
+	}
+	PROFILE_COUNT("items", __itemCount);
+	return E_SUCCESS;
+}
+
+bool
+SearchIndex::IsConsistent(void) const
+{
+	// every string ends in the buffer
+	if(__textLength > 0 && __pText[__textLength - 1] != 0) {
+		return false;
+	}
+	for(int i = 0; i < __categoryCount; i++) {
+		if(__pCategories[i] < 0 || __pCategories[i] >= __textLength) {
+			return false;
+		}
+	}
+	for(int item = 0; item < __itemCount; item++) {
+		const Item& record = __pItems[item];
+		bool inside = record.name >= 0 && record.name < __textLength && record.category >= 0 && record.category < __categoryCount;
+		for(int language = 0; language < Catalog::LANGUAGE_COUNT && inside; language++) {
+			inside = record.titles[language] >= 0 && record.titles[language] < __textLength;
+		}
+		if(!inside) {
+			return false;
+		}
+	}
+
+	// Lists are read without checks at search time, so each is decoded once here
+	for(int i = 0; i < __trigramCount; i++) {
+		const Trigram& trigram = __pTrigrams[i];
+		if(trigram.count < 0 || trigram.count > __itemCount || trigram.postings < 0 || trigram.postings > __postingLength
+				|| (i > 0 && __pTrigrams[i - 1].key >= trigram.key)) {
+			return false;
+		}
+		int position = trigram.postings;
+		int item = -1;
+		for(int n = 0; n < trigram.count; n++) {
+			unsigned int value = 0;
+			int shift = 0;
+			while(position < __postingLength && (__pPostings[position] & 0x80) && shift < 28) {
+				value |= (unsigned int)(__pPostings[position++] & 0x7F) << shift;
+				shift += 7;
+			}
+			if(position >= __postingLength || (__pPostings[position] & 0x80)) {
+				return false;
+			}
+			value |= (unsigned int)__pPostings[position++] << shift;
+			int delta = (int)(value >> LANGUAGE_BITS);
+			if(delta <= 0 || delta > __itemCount - 1 - item) {
+				return false;
+			}
+			item += delta;
+		}
+	}
+	return true;
+}
+
+int
+SearchIndex::GetMemoryUsage(void) const
+{
+	return __textCapacity * sizeof(mchar) + __itemCapacity * sizeof(Item) + __categoryCapacity * sizeof(int)
+			+ __itemCount * Catalog::LANGUAGE_COUNT * sizeof(unsigned int) + __trigramCount * sizeof(Trigram) + __postingLength + __itemCount * sizeof(int);
+}
+
+const mchar*
+SearchIndex::GetTitle(int item, int language) const
+{
+	if(item < 0 || item >= __itemCount || language < 0 || language >= Catalog::LANGUAGE_COUNT) {
+		return null;
+	}
+	return __pText + __pItems[item].titles[language];
+}
+
+const mchar*
+SearchIndex::GetCategory(int item) const
+{
+	if(item < 0 || item >= __itemCount) {
+		return null;
+	}
+	return __pText + __pCategories[__pItems[item].category];
+}
+
+result
+SearchIndex::GetPath(int item, String& path) const
+{
+	if(item < 0 || item >= __itemCount) {
+		return E_OUT_OF_RANGE;
+	}
+	Catalog::GetCategoryPath(__pText + __pCategories[__pItems[item].category], path);
+	path.Append(__pText + __pItems[item].name);
+	return E_SUCCESS;
+}
+
+const SearchIndex::Trigram*
+SearchIndex::FindTrigram(long long key) const
+{
+	int low = 0;
+	int high = __trigramCount - 1;
+	while(low <= high) {
+		int middle = (low + high) / 2;
+		if(__pTrigrams[middle].key < key) {
+			low = middle + 1;
+		} else if(__pTrigrams[middle].key > key) {
+			high = middle - 1;
+		} else {
+			return &__pTrigrams[middle];
+		}
+	}
+	return null;
+}
+
+int
+SearchIndex::DecodePostings(const Trigram& trigram, int* pCandidates) const
+{
+	const byte* p = __pPostings + trigram.postings;
+	int item = -1;
+	for(int i = 0; i < trigram.count; i++) {
+		unsigned int value = 0;
+		int shift = 0;
+		while(*p & 0x80) {
+			value |= (unsigned int)(*p++ & 0x7F) << shift;
+			shift += 7;
+		}
+		value |= (unsigned int)*p++ << shift;
+		item += (int)(value >> LANGUAGE_BITS);
+		pCandidates[i] = (item << LANGUAGE_BITS) | (int)(value & LANGUAGE_MASK);
+	}
+	return trigram.count;
+}
+
+// Keeps the candidates found in the list; both are sorted, the result is written in place.
+// A candidate keeps a title language only while every list has it in that title.
+int
+SearchIndex::Intersect(const Trigram& trigram)
+{
+	const byte* p = __pPostings + trigram.postings;
+	int item = -1;
+	int read = 0;
+	int written = 0;
+	for(int i = 0; i < trigram.count && read < __candidateCount; i++) {
+		unsigned int value = 0;
+		int shift = 0;
+		while(*p & 0x80) {
+			value |= (unsigned int)(*p++ & 0x7F) << shift;
+			shift += 7;
+		}
+		value |= (unsigned int)*p++ << shift;
+		item += (int)(value >> LANGUAGE_BITS);
+
+		while(read < __candidateCount && (__pCandidates[read] >> LANGUAGE_BITS) < item) {
+			read++;
+		}
+		if(read < __candidateCount && (__pCandidates[read] >> LANGUAGE_BITS) == item) {
+			__pCandidates[written++] = __pCandidates[read] & ((item << LANGUAGE_BITS) | (int)(value & LANGUAGE_MASK));
+			read++;
+		}
+	}
+	__candidateCount = written;
+	return written;
+}
+
+int
+SearchIndex::Score(int item, int languages, const mchar* pQuery, int length, int language) const
+{
+	const Item& entry = __pItems[item];
+	int score = SCORE_ART;
+	// only titles holding every applied trigram are scanned
+	if(languages & (1 << language)) {
+		int position = Find(__pText + entry.titles[language], pQuery, length);
+		if(position >= 0) {
+			score = position == 0 ? SCORE_PREFIX : SCORE_TITLE;
+		}
+	}
+	for(int i = 0; i < Catalog::LANGUAGE_COUNT && score == SCORE_ART; i++) {
+		if(i != language && (languages & (1 << i)) && Find(__pText + entry.titles[i], pQuery, length) >= 0) {
+			score = SCORE_OTHER_TITLE;
+		}
+	}
+	return score - (entry.lengths[language] < MAX_LENGTH_PENALTY ? entry.lengths[language] : MAX_LENGTH_PENALTY);
+}
+
+void
+SearchIndex::Insert(int item, int score, Result* pResults, int& count, int maxCount)
+{
+	if(count == maxCount && score <= pResults[count - 1].score) {
+		return;
+	}
+	int i = count < maxCount ? count++ : count - 1;
+	while(i > 0 && pResults[i - 1].score < score) {
+		pResults[i] = pResults[i - 1];
+		i--;
+	}
+	pResults[i].item = item;
+	pResults[i].score = score;
+}
+
+int
+SearchIndex::SearchPrefix(const mchar* pQuery, int length, int language, Result* pResults, int maxCount)
+{
+	unsigned int prefix = (unsigned int)(pQuery[0] & 0xFFFF) << 16;
+	unsigned int mask = 0xFFFF0000;
+	if(length > 1) {
+		prefix |= pQuery[1] & 0xFFFF;
+		mask = 0xFFFFFFFF;
+	}
+
+	int count = 0;
+	const unsigned int* pPrefix = __pPrefixes;
+	for(int item = 0; item < __itemCount; item++, pPrefix += Catalog::LANGUAGE_COUNT) {
+		int score = 0;
+		for(int i = 0; i < Catalog::LANGUAGE_COUNT; i++) {
+			if((pPrefix[i] & mask) == prefix) {
+				int titleScore = i == language ? SCORE_PREFIX : SCORE_OTHER_TITLE;
+				score = titleScore > score ? titleScore : score;
+			}
+		}
+		if(score > 0) {
+			int titleLength = __pItems[item].lengths[language];
+			Insert(item, score - (titleLength < MAX_LENGTH_PENALTY ? titleLength : MAX_LENGTH_PENALTY), pResults, count, maxCount);
+		}
+	}
+	return count;
+}
+
+int
+SearchIndex::Search(const String& query, int language, Result* pResults, int maxCount)
+{
+	int length = query.GetLength();
+	if(maxCount <= 0 || length == 0 || __itemCount == 0 || language < 0 || language >= Catalog::LANGUAGE_COUNT) {
+		__candidatesValid = false;
+		return 0;
+	}
+
+	// The new query narrows the last one when it starts with it
+	const mchar* pValue = query.GetPointer();
+	bool narrows = __candidatesValid && __queryLength >= 3 && length >= __queryLength;
+	for(int i = 0; narrows && i < __queryLength; i++) {
+		narrows = Fold(pValue[i]) == __pQuery[i];
+	}
+
+	if(length + 1 > __queryCapacity) {
+		mchar* pQuery = new mchar[length + 1];
+		if(pQuery == null) {
+			return 0;
+		}
+		delete[] __pQuery;
+		__pQuery = pQuery;
+		__queryCapacity = length + 1;
+	}
+	for(int i = 0; i < length; i++) {
+		__pQuery[i] = Fold(pValue[i]);
+	}
+	__pQuery[length] = 0;
+	__queryLength = length;
+
+	if(length < 3) {
+		__candidatesValid = false;
+		return SearchPrefix(__pQuery, length, language, pResults, maxCount);
+	}
+
+	// Lists of the query trigrams, rarest first; a missing one means no match
+	const Trigram** ppTrigrams = new const Trigram*[length - 2];
+	if(ppTrigrams == null) {
+		return 0;
+	}
+	int trigramCount = 0;
+	bool missing = false;
+	for(int i = 0; i + 3 <= length && !missing; i++) {
+		long long key = GetKey(__pQuery + i);
+		if(key < 0) {
+			continue;
+		}
+		const Trigram* pTrigram = FindTrigram(key);
+		if(pTrigram == null) {
+			missing = true;
+			break;
+		}
+		int position = trigramCount;
+		while(position > 0 && ppTrigrams[position - 1]->count > pTrigram->count) {
+			ppTrigrams[position] = ppTrigrams[position - 1];
+			position--;
+		}
+		ppTrigrams[position] = pTrigram;
+		trigramCount++;
+	}
+
+	if(!narrows) {
+		__candidateCount = 0;
+		__appliedCount = 0;
+	}
+	if(missing) {
+		__candidateCount = 0;
+		__appliedCount = MAX_QUERY_TRIGRAMS;
+	}
+	for(int i = 0; i < trigramCount && __appliedCount < MAX_QUERY_TRIGRAMS; i++) {
+		const Trigram& trigram = *ppTrigrams[i];
+		bool applied = false;
+		for(int k = 0; k < __appliedCount && !applied; k++) {
+			applied = __applied[k] == trigram.key;
+		}
+		if(applied) {
+			continue;
+		}
+		if(__appliedCount == 0) {
+			__candidateCount = DecodePostings(trigram, __pCandidates);
+		} else {
+			Intersect(trigram);
+		}
+		__applied[__appliedCount++] = trigram.key;
+	}
+	delete[] ppTrigrams;
+	// with nothing indexable, such as only blanks, the next query starts over rather than narrowing nothing
+	__candidatesValid = missing || trigramCount > 0;
+
+	// Once the list is full a candidate is scanned only if its best possible score could still enter it
+	unsigned int prefix = ((unsigned int)(__pQuery[0] & 0xFFFF) << 16) | (__pQuery[1] & 0xFFFF);
+	int count = 0;
+	for(int i = 0; i < __candidateCount; i++) {
+		int item = __pCandidates[i] >> LANGUAGE_BITS;
+		int languages = __pCandidates[i] & LANGUAGE_MASK;
+		if(count == maxCount) {
+			int best = SCORE_ART;
+			if(languages & (1 << language)) {
+				best = __pPrefixes[item * Catalog::LANGUAGE_COUNT + language] == prefix ? SCORE_PREFIX : SCORE_TITLE;
+			} else if(languages != 0) {
+				best = SCORE_OTHER_TITLE;
+			}
+			int titleLength = __pItems[item].lengths[language];
+			if(best - (titleLength < MAX_LENGTH_PENALTY ? titleLength : MAX_LENGTH_PENALTY) <= pResults[count - 1].score) {
+				continue;
+			}
+		}
+		Insert(item, Score(item, languages, __pQuery, length, language), pResults, count, maxCount);
+	}
+	return count;
+}
@@ -0,0 +1,137 @@
+#ifndef SEARCHINDEX_H_
+#define SEARCHINDEX_H_
+
+#include "Catalog.h"
+#include "Port.h"
+
+using namespace Osp::Base;
+
+/**
+ * Trigram index over the titles in every language and the art of all
+ * catalog items. Every trigram of the case folded text keeps a sorted list of
+ * the items holding it, delta coded, with the languages whose title holds
+ * it. A query intersects the lists of its rarest trigrams and ranks the
+ * candidates by where the query occurs in their titles; typing one more
+ * character only narrows the previous candidates. Queries shorter than a
+ * trigram match title prefixes. Built once from the catalog and kept in a
+ * binary file next to it.
+ */
+class SearchIndex {
+public:
+	struct Result {
+		int item;
+		int score;
+	};
+
+	// Lists intersected per query, rarest first; longer queries are checked against the titles only
+	static const int MAX_QUERY_TRIGRAMS = 8;
+
+	SearchIndex();
+	~SearchIndex();
+
+	// Reads every category and item of the catalog
+	result Build(void);
+	result Load(const String& path);
+	result Save(const String& path) const;
+
+	// The index file inside the catalog root
+	static void GetDefaultPath(String& path);
+
+	int GetCount(void) const { return __itemCount; }
+	int GetTrigramCount(void) const { return __trigramCount; }
+	// Heap bytes held by the index, candidates included
+	int GetMemoryUsage(void) const;
+
+	// Null terminated, empty where untranslated
+	const mchar* GetTitle(int item, int language) const;
+	const mchar* GetCategory(int item) const;
+	result GetPath(int item, String& path) const;
+
+	// Fills results best first, returns their number
+	int Search(const String& query, int language, Result* pResults, int maxCount);
+
+private:
+	struct Item {
+		int name;
+		int titles[Catalog::LANGUAGE_COUNT];
+		unsigned short lengths[Catalog::LANGUAGE_COUNT];
+		int category;
+	};
+
+	struct Trigram {
+		long long key;
+		int postings;
+		int count;
+	};
+
+	// Trigram under construction, postings appended item by item
+	struct Pending {
+		long long key;
+		byte* pBytes;
+		int length;
+		int capacity;
+		int last;
+		int count;
+	};
+
+	void Clear(void);
+
+	int AddText(const mchar* pValue, int length);
+	bool ReserveText(int count);
+	result AddItem(int category, const String& path, const String* pTitles, const String& art);
+	int CollectTrigrams(const mchar* pValue, int length, int languages, long long* pKeys, int count, int capacity) const;
+	Pending* FindPending(long long key);
+	result Finish(void);
+	result BuildPrefixes(void);
+	// Offsets of a loaded file stay in their buffers and the lists decode to stored items
+	bool IsConsistent(void) const;
+
+	const Trigram* FindTrigram(long long key) const;
+	int DecodePostings(const Trigram& trigram, int* pCandidates) const;
+	int Intersect(const Trigram& trigram);
+	int Score(int item, int languages, const mchar* pQuery, int length, int language) const;
+	int SearchPrefix(const mchar* pQuery, int length, int language, Result* pResults, int maxCount);
+	static void Insert(int item, int score, Result* pResults, int& count, int maxCount);
+
+	SearchIndex(const SearchIndex& index);
+	SearchIndex& operator =(const SearchIndex& index);
+
+	mchar* __pText;
+	int __textLength;
+	int __textCapacity;
+
+	Item* __pItems;
+	int __itemCount;
+	int __itemCapacity;
+
+	int* __pCategories;
+	int __categoryCount;
+	int __categoryCapacity;
+
+	// First two folded characters of every title, item by item, so short queries scan one array
+	unsigned int* __pPrefixes;
+
+	Trigram* __pTrigrams;
+	int __trigramCount;
+	byte* __pPostings;
+	int __postingLength;
+
+	// Build only: open addressing table of pending trigram indexes plus one
+	Pending* __pPending;
+	int __pendingCount;
+	int __pendingCapacity;
+	int* __pSlots;
+	int __slotCount;
+
+	// Candidates of the last query with their title languages in the low bits, and the trigrams applied to them
+	mchar* __pQuery;
+	int __queryLength;
+	int __queryCapacity;
+	bool __candidatesValid;
+	int* __pCandidates;
+	int __candidateCount;
+	long long __applied[MAX_QUERY_TRIGRAMS];
+	int __appliedCount;
+};
+
+#endif
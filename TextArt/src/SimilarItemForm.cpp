@@ -0,0 +1,179 @@
+#include "SimilarItemForm.h"
+
+#include "Catalog.h"
+#include "FormManager.h"
+#include "Helper.h"
+#include "SimilarityIndex.h"
+#include "Debug.h"
+
+#include <FApp.h>
+
+using namespace Osp::Ui::Controls;
+using namespace Osp::Base;
+using namespace Osp::App;
+
+// Reads the similarity index on a worker, or builds it from the catalog when there is none
+class SimilarIndexTask :
+	public ITask
+{
+public:
+	SimilarIndexTask(SimilarItemForm& form):
+		__form(form),
+		__pIndex(new SimilarityIndex())
+	{
+	}
+
+	~SimilarIndexTask()
+	{
+		delete __pIndex;
+	}
+
+	result Run(const CancelToken& token)
+	{
+		PROFILE_SCOPE("SimilarIndexTask::Run");
+		String path;
+		SimilarityIndex::GetDefaultPath(path);
+		result r = __pIndex->Load(path);
+		if(IsFailed(r) && !token.IsCancelled()) {
+			// first request after installation compares the whole catalog once
+			r = __pIndex->Build();
+			if(!IsFailed(r) && !token.IsCancelled()) {
+				__pIndex->Save(path);
+			}
+		}
+		return r;
+	}
+
+	void OnTaskCompleted(result r)
+	{
+		__form.__indexTask = 0;
+		if(IsFailed(r)) {
+			AppLog("Similarity index not loaded by %s", GetErrorMessage(r));
+		} else {
+			delete __form.__pIndex;
+			__form.__pIndex = __pIndex;
+			__pIndex = null;
+		}
+		// the empty text again when the index failed
+		__form.ShowPending();
+	}
+
+private:
+	SimilarItemForm& __form;
+	SimilarityIndex* __pIndex;
+};
+
+SimilarItemForm::SimilarItemForm():
+	__pIndex(null),
+	__indexTask(0),
+	__pFooter(null)
+{
+}
+
+SimilarItemForm::~SimilarItemForm() {
+}
+
+bool
+SimilarItemForm::Initialize(void)
+{
+	TabsForm::Initialize(FORM_STYLE_INDICATOR | FORM_STYLE_TEXT_TAB | FORM_STYLE_TITLE | FORM_STYLE_FOOTER, TabsForm::CATEGORY_TAB);
+	SetTitleText(Helper::GetTraslation(IDS_SIMILAR));
+
+	__pFooter = TabsForm::GetFooter();
+	__pFooter->SetStyle(FOOTER_STYLE_SEGMENTED_ICON);
+	__pFooter->AddActionEventListener(*this);
+	__pFooter->SetBackButton();
+	SetFormBackEventListener(this);
+	return true;
+}
+
+void
+SimilarItemForm::OnFormBackRequested(Osp::Ui::Controls::Form& form)
+{
+	FormManager::Navigate(FormManager::REQUEST_SIMILARBACK);
+}
+
+result
+SimilarItemForm::OnInitializing(void)
+{
+	return ItemListForm::OnInitializing();
+}
+
+result
+SimilarItemForm::OnTerminating(void)
+{
+	TaskScheduler::Cancel(__indexTask);
+	__indexTask = 0;
+	delete __pIndex;
+	ItemListForm::OnTerminating();
+	return E_SUCCESS;
+}
+
+void
+SimilarItemForm::SetIndex(SimilarityIndex* pIndex)
+{
+	delete __pIndex;
+	__pIndex = pIndex;
+	// a load queued behind the build that made it has nothing left to do
+	if(__indexTask != 0) {
+		TaskScheduler::Cancel(__indexTask);
+		__indexTask = 0;
+		ShowPending();
+	}
+}
+
+result
+SimilarItemForm::ShowSimilar(const String& path)
+{
+	ClearList();
+	__pendingPath = path;
+	if(__pIndex != null) {
+		ShowPending();
+		return E_SUCCESS;
+	}
+	SetEmptyText(Helper::GetTraslation(IDS_SEARCHING));
+	if(__indexTask == 0) {
+		__indexTask = TaskScheduler::Post(new SimilarIndexTask(*this), TaskScheduler::LANE_VISIBLE, TaskScheduler::STRAND_INDEX);
+	}
+	return E_SUCCESS;
+}
+
+void
+SimilarItemForm::ShowPending(void)
+{
+	PROFILE_SCOPE("SimilarItemForm::ShowPending");
+	SetEmptyText(Helper::GetTraslation(IDS_EMPTYLIST));
+	if(__pIndex == null || __pendingPath.IsEmpty()) {
+		return;
+	}
+	ClearList();
+	// an item added since the last build has no similar items until the next one is set
+	int item = __pIndex->Find(__pendingPath);
+	__pendingPath.Clear();
+	SimilarityIndex::Match matches[SimilarityIndex::MAX_SIMILAR];
+	int count = __pIndex->GetSimilar(item, matches, SimilarityIndex::MAX_SIMILAR);
+	for(int i = 0; i < count; i++) {
+		String fileName;
+		String titles[Catalog::LANGUAGE_COUNT];
+		String art;
+		int linecount = 0;
+		if(IsFailed(__pIndex->GetPath(matches[i].item, fileName))
+				|| IsFailed(Catalog::ReadItem(fileName, titles, art, linecount))) {
+			continue;
+		}
+		AppendItem(titles, art, fileName, linecount);
+	}
+	PROFILE_COUNT("items", count);
+
+	Form* pForm = Application::GetInstance()->GetAppFrame()->GetFrame()->GetCurrentForm();
+	if(pForm == this) {
+		RequestRedraw(true);
+	}
+}
+
+void
+SimilarItemForm::OnLanguageChanged(void)
+{
+	SetTitleText(Helper::GetTraslation(IDS_SIMILAR));
+	ItemListForm::OnLanguageChanged();
+}
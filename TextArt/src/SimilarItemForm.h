@@ -0,0 +1,49 @@
+#ifndef SIMILARITEMFORM_H_
+#define SIMILARITEMFORM_H_
+
+#include "ItemListForm.h"
+
+#include <FBase.h>
+
+using namespace Osp::Base;
+
+class SimilarityIndex;
+class SimilarIndexTask;
+
+class SimilarItemForm:
+	public ItemListForm,
+	public Osp::Ui::Controls::IFormBackEventListener
+	 {
+public:
+	SimilarItemForm();
+	virtual ~SimilarItemForm();
+
+	bool Initialize(void);
+
+	// Replaces the list with the items most like the one at path, once the index is there
+	result ShowSimilar(const String& path);
+	// Replaces the index by one built after a catalog change and owns it
+	void SetIndex(SimilarityIndex* pIndex);
+
+private:
+	// Read by a task on the first request, built from the catalog if there is no file
+	// yet; the list says searching until then. After a catalog change the old one
+	// answers until the rebuilt one is set
+	SimilarityIndex* __pIndex;
+	TaskScheduler::TaskId __indexTask;
+	friend class SimilarIndexTask;
+	// Item whose similar items wait for the index, empty when none
+	String __pendingPath;
+	Osp::Ui::Controls::Footer* __pFooter;
+
+	void ShowPending(void);
+
+public:
+	virtual result OnInitializing(void);
+	virtual result OnTerminating(void);
+
+	virtual void OnLanguageChanged(void);
+	virtual void OnFormBackRequested(Osp::Ui::Controls::Form& source);
+};
+
+#endif
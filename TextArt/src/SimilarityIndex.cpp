@@ -0,0 +1,593 @@
+#include "SimilarityIndex.h"
+
+#include "Debug.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+using namespace Osp::Io;
+
+static const wchar_t* INDEX_PATH = L"/Home/catalog/similar.idx";
+
+static const int INDEX_MAGIC = 0x584D5354;	// "TSMX"
+static const int INDEX_VERSION = 1;
+
+static const int MIN_TEXT_CAPACITY = 4096;
+
+// Matches below this share are not worth showing
+static const int MIN_SIMILARITY = 20;
+// Items of a crowded bucket are compared with this many neighbours only
+static const int MAX_BUCKET_PAIRS = 64;
+
+static const unsigned int EMPTY_HASH = 0xFFFFFFFF;
+static const unsigned int FNV_OFFSET = 2166136261u;
+static const unsigned int FNV_PRIME = 16777619u;
+
+struct IndexHeader {
+	int magic;
+	int version;
+	int textLength;
+	int itemCount;
+	int categoryCount;
+};
+
+static inline bool
+IsBlank(mchar c)
+{
+	return c == L' ' || c == L'\t';
+}
+
+// Final mix of MurmurHash3, spreads every input bit over the word
+static inline unsigned int
+Mix(unsigned int hash)
+{
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6B;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+static inline unsigned int
+HashText(unsigned int hash, const mchar* pValue, int length)
+{
+	for(int i = 0; i < length; i++) {
+		hash = (hash ^ (pValue[i] & 0xFFFF)) * FNV_PRIME;
+	}
+	return hash;
+}
+
+static inline unsigned int
+HashString(unsigned int hash, const mchar* pValue)
+{
+	for(; *pValue != 0; pValue++) {
+		hash = (hash ^ (*pValue & 0xFFFF)) * FNV_PRIME;
+	}
+	return hash;
+}
+
+static int
+CompareBuckets(const void* pLeft, const void* pRight)
+{
+	// Bucket is key, then item, so a bucket keeps catalog order
+	const unsigned int* pL = static_cast<const unsigned int*>(pLeft);
+	const unsigned int* pR = static_cast<const unsigned int*>(pRight);
+	if(pL[0] != pR[0]) {
+		return pL[0] < pR[0] ? -1 : 1;
+	}
+	return (int)pL[1] - (int)pR[1];
+}
+
+static bool
+Equals(const mchar* pText, const mchar* pValue, int length)
+{
+	for(int i = 0; i < length; i++) {
+		if(pText[i] != pValue[i]) {
+			return false;
+		}
+	}
+	return pText[length] == 0;
+}
+
+SimilarityIndex::SimilarityIndex():
+	__pText(null),
+	__textLength(0),
+	__textCapacity(0),
+	__pItems(null),
+	__itemCount(0),
+	__itemCapacity(0),
+	__pCategories(null),
+	__categoryCount(0),
+	__pMatches(null),
+	__pSlots(null),
+	__slotCount(0),
+	__pSignatures(null)
+{
+}
+
+SimilarityIndex::~SimilarityIndex()
+{
+	Clear();
+}
+
+void
+SimilarityIndex::Clear(void)
+{
+	delete[] __pText;
+	delete[] __pItems;
+	delete[] __pCategories;
+	delete[] __pMatches;
+	delete[] __pSlots;
+	delete[] __pSignatures;
+
+	__pText = null;
+	__textLength = 0;
+	__textCapacity = 0;
+	__pItems = null;
+	__itemCount = 0;
+	__itemCapacity = 0;
+	__pCategories = null;
+	__categoryCount = 0;
+	__pMatches = null;
+	__pSlots = null;
+	__slotCount = 0;
+	__pSignatures = null;
+}
+
+void
+SimilarityIndex::GetDefaultPath(String& path)
+{
+	path = INDEX_PATH;
+}
+
+void
+SimilarityIndex::Sign(const mchar* pArt, int length, unsigned int* pSignature)
+{
+	for(int k = 0; k < SIGNATURE_SIZE; k++) {
+		pSignature[k] = EMPTY_HASH;
+	}
+	for(int i = 0; i + SHINGLE_LENGTH <= length; i++) {
+		const mchar* p = pArt + i;
+		unsigned int hash = FNV_OFFSET;
+		bool blank = true;
+		bool broken = false;
+		for(int c = 0; c < SHINGLE_LENGTH && !broken; c++) {
+			broken = p[c] == L'\n' || p[c] == L'\r';
+			blank = blank && IsBlank(p[c]);
+			hash = (hash ^ (p[c] & 0xFFFF)) * FNV_PRIME;
+		}
+		if(broken || blank) {
+			continue;
+		}
+		// The k-th hash function is first + k * step, two mixes per shingle instead of one per function
+		unsigned int value = Mix(hash);
+		unsigned int step = Mix(hash ^ 0x5BD1E995) | 1;
+		for(int k = 0; k < SIGNATURE_SIZE; k++) {
+			if(value < pSignature[k]) {
+				pSignature[k] = value;
+			}
+			value += step;
+		}
+	}
+}
+
+int
+SimilarityIndex::Compare(const unsigned int* pLeft, const unsigned int* pRight)
+{
+	int equal = 0;
+	for(int k = 0; k < SIGNATURE_SIZE; k++) {
+		equal += pLeft[k] == pRight[k] ? 1 : 0;
+	}
+	return equal * 100 / SIGNATURE_SIZE;
+}
+
+bool
+SimilarityIndex::ReserveText(int count)
+{
+	if(__textLength + count <= __textCapacity) {
+		return true;
+	}
+	int capacity = __textCapacity > 0 ? __textCapacity : MIN_TEXT_CAPACITY;
+	while(capacity < __textLength + count) {
+		capacity *= 2;
+	}
+	mchar* pText = new mchar[capacity];
+	if(pText == null) {
+		return false;
+	}
+	if(__textLength > 0) {
+		memcpy(pText, __pText, __textLength * sizeof(mchar));
+	}
+	delete[] __pText;
+	__pText = pText;
+	__textCapacity = capacity;
+	return true;
+}
+
+int
+SimilarityIndex::AddText(const mchar* pValue, int length)
+{
+	int offset = __textLength;
+	if(length > 0) {
+		memcpy(__pText + __textLength, pValue, length * sizeof(mchar));
+	}
+	__pText[__textLength + length] = 0;
+	__textLength += length + 1;
+	return offset;
+}
+
+result
+SimilarityIndex::AddItem(int category, const String& path, const String& art)
+{
+	const mchar* pPath = path.GetPointer();
+	int slash = path.GetLength();
+	while(slash > 0 && pPath[slash - 1] != L'/') {
+		slash--;
+	}
+
+	if(!ReserveText(path.GetLength() - slash + 1)) {
+		return E_OUT_OF_MEMORY;
+	}
+	if(__itemCount == __itemCapacity) {
+		int capacity = __itemCapacity > 0 ? __itemCapacity * 2 : 256;
+		Item* pItems = new Item[capacity];
+		unsigned int* pSignatures = new unsigned int[capacity * SIGNATURE_SIZE];
+		if(pItems == null || pSignatures == null) {
+			delete[] pItems;
+			delete[] pSignatures;
+			return E_OUT_OF_MEMORY;
+		}
+		if(__itemCount > 0) {
+			memcpy(pItems, __pItems, __itemCount * sizeof(Item));
+			memcpy(pSignatures, __pSignatures, __itemCount * SIGNATURE_SIZE * sizeof(unsigned int));
+		}
+		delete[] __pItems;
+		delete[] __pSignatures;
+		__pItems = pItems;
+		__pSignatures = pSignatures;
+		__itemCapacity = capacity;
+	}
+
+	Item& item = __pItems[__itemCount];
+	item.name = AddText(pPath + slash, path.GetLength() - slash);
+	item.category = category;
+	Sign(art.GetPointer(), art.GetLength(), __pSignatures + __itemCount * SIGNATURE_SIZE);
+	__itemCount++;
+	return E_SUCCESS;
+}
+
+void
+SimilarityIndex::Offer(int item, int other, int similarity)
+{
+	Match* pMatches = __pMatches + item * MAX_SIMILAR;
+	int position = MAX_SIMILAR;
+	for(int i = 0; i < MAX_SIMILAR && pMatches[i].item >= 0; i++) {
+		// a pair sharing several bands comes again
+		if(pMatches[i].item == other) {
+			return;
+		}
+		if(position == MAX_SIMILAR && pMatches[i].similarity < similarity) {
+			position = i;
+		}
+	}
+	if(position == MAX_SIMILAR) {
+		for(position = 0; position < MAX_SIMILAR && pMatches[position].item >= 0; position++) {
+		}
+		if(position == MAX_SIMILAR) {
+			return;
+		}
+	}
+	for(int i = MAX_SIMILAR - 1; i > position; i--) {
+		pMatches[i] = pMatches[i - 1];
+	}
+	pMatches[position].item = other;
+	pMatches[position].similarity = similarity;
+}
+
+void
+SimilarityIndex::CollectMatches(void)
+{
+	static const int BAND_ROWS = SIGNATURE_SIZE / BAND_COUNT;
+
+	Bucket* pBuckets = new Bucket[__itemCount > 0 ? __itemCount : 1];
+	for(int band = 0; band < BAND_COUNT; band++) {
+		int count = 0;
+		for(int item = 0; item < __itemCount; item++) {
+			const unsigned int* pSignature = __pSignatures + item * SIGNATURE_SIZE;
+			if(pSignature[0] == EMPTY_HASH) {
+				continue;
+			}
+			unsigned int key = FNV_OFFSET ^ band;
+			for(int row = 0; row < BAND_ROWS; row++) {
+				key = (key ^ pSignature[band * BAND_ROWS + row]) * FNV_PRIME;
+			}
+			pBuckets[count].key = Mix(key);
+			pBuckets[count].item = item;
+			count++;
+		}
+		qsort(pBuckets, count, sizeof(Bucket), CompareBuckets);
+
+		for(int start = 0; start < count; ) {
+			int end = start + 1;
+			while(end < count && pBuckets[end].key == pBuckets[start].key) {
+				end++;
+			}
+			for(int i = start; i < end; i++) {
+				int item = pBuckets[i].item;
+				int last = end < i + 1 + MAX_BUCKET_PAIRS ? end : i + 1 + MAX_BUCKET_PAIRS;
+				for(int j = i + 1; j < last; j++) {
+					int other = pBuckets[j].item;
+					int similarity = Compare(__pSignatures + item * SIGNATURE_SIZE, __pSignatures + other * SIGNATURE_SIZE);
+					if(similarity >= MIN_SIMILARITY) {
+						Offer(item, other, similarity);
+						Offer(other, item, similarity);
+					}
+				}
+			}
+			start = end;
+		}
+	}
+	delete[] pBuckets;
+}
+
+unsigned int
+SimilarityIndex::HashItem(int item) const
+{
+	const mchar* pCategory = __pText + __pCategories[__pItems[item].category];
+	const mchar* pName = __pText + __pItems[item].name;
+	static const mchar SEPARATOR = L'/';
+	unsigned int hash = HashString(FNV_OFFSET, pCategory);
+	hash = HashText(hash, &SEPARATOR, 1);
+	return HashString(hash, pName);
+}
+
+result
+SimilarityIndex::BuildSlots(void)
+{
+	__slotCount = 16;
+	while(__slotCount < __itemCount * 2) {
+		__slotCount *= 2;
+	}
+	__pSlots = new int[__slotCount];
+	if(__pSlots == null) {
+		return E_OUT_OF_MEMORY;
+	}
+	memset(__pSlots, 0, __slotCount * sizeof(int));
+	for(int item = 0; item < __itemCount; item++) {
+		unsigned int slot = HashItem(item) & (__slotCount - 1);
+		while(__pSlots[slot] != 0) {
+			slot = (slot + 1) & (__slotCount - 1);
+		}
+		__pSlots[slot] = item + 1;
+	}
+	return E_SUCCESS;
+}
+
+result
+SimilarityIndex::Build(void)
+{
+	PROFILE_SCOPE("SimilarityIndex::Build");
+	Clear();
+
+	ArrayList names;
+	names.Construct();
+	result r = Catalog::GetCategories(names);
+	if(IsFailed(r)) {
+		return r;
+	}
+	__pCategories = new int[names.GetCount() > 0 ? names.GetCount() : 1];
+
+	for(int n = 0; n < names.GetCount() && !IsFailed(r); n++) {
+		const String& name = *static_cast<String*>(names.GetAt(n));
+		if(!ReserveText(name.GetLength() + 1)) {
+			r = E_OUT_OF_MEMORY;
+			break;
+		}
+		__pCategories[__categoryCount] = AddText(name.GetPointer(), name.GetLength());
+
+		ArrayList paths;
+		paths.Construct();
+		Catalog::GetItems(name, paths);
+		for(int i = 0; i < paths.GetCount() && !IsFailed(r); i++) {
+			const String& path = *static_cast<String*>(paths.GetAt(i));
+			String titles[Catalog::LANGUAGE_COUNT];
+			String art;
+			int linecount = 0;
+			if(IsFailed(Catalog::ReadItem(path, titles, art, linecount))) {
+				continue;
+			}
+			r = AddItem(__categoryCount, path, art);
+		}
+		paths.RemoveAll(true);
+		__categoryCount++;
+	}
+	names.RemoveAll(true);
+
+	if(!IsFailed(r)) {
+		__pMatches = new Match[__itemCount > 0 ? __itemCount * MAX_SIMILAR : 1];
+		if(__pMatches == null) {
+			r = E_OUT_OF_MEMORY;
+		}
+	}
+	if(!IsFailed(r)) {
+		for(int i = 0; i < __itemCount * MAX_SIMILAR; i++) {
+			__pMatches[i].item = -1;
+			__pMatches[i].similarity = 0;
+		}
+		CollectMatches();
+		delete[] __pSignatures;
+		__pSignatures = null;
+		r = BuildSlots();
+	}
+	if(IsFailed(r)) {
+		Clear();
+	}
+	PROFILE_COUNT("items", __itemCount);
+	return r;
+}
+
+result
+SimilarityIndex::Save(const String& path) const
+{
+	File file;
+	result r = file.Construct(path, L"w", true);
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	IndexHeader header;
+	header.magic = INDEX_MAGIC;
+	header.version = INDEX_VERSION;
+	header.textLength = __textLength;
+	header.itemCount = __itemCount;
+	header.categoryCount = __categoryCount;
+	r = file.Write(&header, sizeof(header));
+
+	// Text is stored as UTF-16 whatever the width of mchar
+	unsigned short chunk[1024];
+	for(int start = 0; start < __textLength && !IsFailed(r); start += 1024) {
+		int length = __textLength - start < 1024 ? __textLength - start : 1024;
+		for(int i = 0; i < length; i++) {
+			chunk[i] = (unsigned short)__pText[start + i];
+		}
+		r = file.Write(chunk, length * sizeof(unsigned short));
+	}
+	if(!IsFailed(r)) {
+		r = file.Write(__pItems, __itemCount * sizeof(Item));
+	}
+	if(!IsFailed(r)) {
+		r = file.Write(__pCategories, __categoryCount * sizeof(int));
+	}
+	if(!IsFailed(r)) {
+		r = file.Write(__pMatches, __itemCount * MAX_SIMILAR * sizeof(Match));
+	}
+	if(IsFailed(r)) {
+		AppLog("Similarity index not saved by %s", GetErrorMessage(r));
+		return r;
+	}
+	return file.Flush();
+}
+
+result
+SimilarityIndex::Load(const String& path)
+{
+	PROFILE_SCOPE("SimilarityIndex::Load");
+	Clear();
+
+	File file;
+	result r = file.Construct(path, L"r");
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	IndexHeader header;
+	if(file.Read(&header, sizeof(header)) != (int)sizeof(header) || header.magic != INDEX_MAGIC
+			|| header.version != INDEX_VERSION || header.textLength < 0 || header.itemCount < 0 || header.categoryCount < 0) {
+		return E_INVALID_FORMAT;
+	}
+
+	__pText = new mchar[header.textLength > 0 ? header.textLength : 1];
+	__pItems = new Item[header.itemCount > 0 ? header.itemCount : 1];
+	__pCategories = new int[header.categoryCount > 0 ? header.categoryCount : 1];
+	__pMatches = new Match[header.itemCount > 0 ? header.itemCount * MAX_SIMILAR : 1];
+	if(__pText == null || __pItems == null || __pCategories == null || __pMatches == null) {
+		Clear();
+		return E_OUT_OF_MEMORY;
+	}
+
+	bool complete = true;
+	unsigned short chunk[1024];
+	for(int start = 0; start < header.textLength && complete; start += 1024) {
+		int length = header.textLength - start < 1024 ? header.textLength - start : 1024;
+		complete = file.Read(chunk, length * sizeof(unsigned short)) == (int)(length * sizeof(unsigned short));
+		for(int i = 0; i < length; i++) {
+			__pText[start + i] = chunk[i];
+		}
+	}
+	int matchBytes = header.itemCount * MAX_SIMILAR * sizeof(Match);
+	complete = complete && file.Read(__pItems, header.itemCount * sizeof(Item)) == (int)(header.itemCount * sizeof(Item));
+	complete = complete && file.Read(__pCategories, header.categoryCount * sizeof(int)) == (int)(header.categoryCount * sizeof(int));
+	complete = complete && file.Read(__pMatches, matchBytes) == matchBytes;
+	if(!complete) {
+		Clear();
+		return E_INVALID_FORMAT;
+	}
+
+	__textLength = __textCapacity = header.textLength;
+	__itemCount = __itemCapacity = header.itemCount;
+	__categoryCount = header.categoryCount;
+	r = BuildSlots();
+	if(IsFailed(r)) {
+		Clear();
+		return r;
+	}
+	PROFILE_COUNT("items", __itemCount);
+	return E_SUCCESS;
+}
+
+int
+SimilarityIndex::GetMemoryUsage(void) const
+{
+	return __textCapacity * sizeof(mchar) + __itemCapacity * sizeof(Item) + __categoryCount * sizeof(int)
+			+ __itemCount * MAX_SIMILAR * sizeof(Match) + __slotCount * sizeof(int);
+}
+
+int
+SimilarityIndex::Find(const String& path) const
+{
+	if(__slotCount == 0) {
+		return -1;
+	}
+	// .../category/name, hashed the way HashItem joins them
+	const mchar* pPath = path.GetPointer();
+	int slash = path.GetLength();
+	while(slash > 0 && pPath[slash - 1] != L'/') {
+		slash--;
+	}
+	int start = slash - 1;
+	while(start > 0 && pPath[start - 1] != L'/') {
+		start--;
+	}
+	if(start < 0) {
+		return -1;
+	}
+
+	unsigned int hash = HashText(FNV_OFFSET, pPath + start, path.GetLength() - start);
+	for(unsigned int slot = hash & (__slotCount - 1); __pSlots[slot] != 0; slot = (slot + 1) & (__slotCount - 1)) {
+		int item = __pSlots[slot] - 1;
+		if(Equals(__pText + __pItems[item].name, pPath + slash, path.GetLength() - slash)
+				&& Equals(__pText + __pCategories[__pItems[item].category], pPath + start, slash - 1 - start)) {
+			return item;
+		}
+	}
+	return -1;
+}
+
+result
+SimilarityIndex::GetPath(int item, String& path) const
+{
+	if(item < 0 || item >= __itemCount) {
+		return E_OUT_OF_RANGE;
+	}
+	Catalog::GetCategoryPath(__pText + __pCategories[__pItems[item].category], path);
+	path.Append(__pText + __pItems[item].name);
+	return E_SUCCESS;
+}
+
+int
+SimilarityIndex::GetSimilar(int item, Match* pMatches, int maxCount) const
+{
+	if(item < 0 || item >= __itemCount) {
+		return 0;
+	}
+	const Match* pStored = __pMatches + item * MAX_SIMILAR;
+	int count = 0;
+	while(count < maxCount && count < MAX_SIMILAR && pStored[count].item >= 0) {
+		pMatches[count] = pStored[count];
+		count++;
+	}
+	return count;
+}
@@ -0,0 +1,106 @@
+#ifndef SIMILARITYINDEX_H_
+#define SIMILARITYINDEX_H_
+
+#include "Catalog.h"
+#include "Port.h"
+
+using namespace Osp::Base;
+
+/**
+ * "More like this" for catalog items. Every art body is reduced to a MinHash
+ * signature over its character shingles, the signatures are cut into LSH
+ * bands and items sharing a band bucket are compared. The best matches of
+ * every item are kept, so a lookup is a table read. Built once from the
+ * catalog and kept in a binary file next to it, the signatures are only
+ * needed while building.
+ */
+class SimilarityIndex {
+public:
+	struct Match {
+		int item;
+		// Estimated share of common shingles in percent
+		int similarity;
+	};
+
+	// Characters per shingle, shingles stay within a line
+	static const int SHINGLE_LENGTH = 4;
+	static const int SIGNATURE_SIZE = 32;
+	// Bands of SIGNATURE_SIZE / BAND_COUNT rows, items sharing one band are compared
+	static const int BAND_COUNT = 16;
+	static const int MAX_SIMILAR = 10;
+
+	SimilarityIndex();
+	~SimilarityIndex();
+
+	// Reads every category and item of the catalog
+	result Build(void);
+	result Load(const String& path);
+	result Save(const String& path) const;
+
+	// The index file inside the catalog root
+	static void GetDefaultPath(String& path);
+
+	int GetCount(void) const { return __itemCount; }
+	// Heap bytes held by the index
+	int GetMemoryUsage(void) const;
+
+	// Item of a catalog file path, -1 if the index does not know it
+	int Find(const String& path) const;
+	result GetPath(int item, String& path) const;
+
+	// Fills the best matches of the item, best first, returns their number
+	int GetSimilar(int item, Match* pMatches, int maxCount) const;
+
+	// MinHash of the shingles of the art, all ones for art without a shingle
+	static void Sign(const mchar* pArt, int length, unsigned int* pSignature);
+	// Percent of equal signature values
+	static int Compare(const unsigned int* pLeft, const unsigned int* pRight);
+
+private:
+	struct Item {
+		int name;
+		int category;
+	};
+
+	// Band hash of one item while building
+	struct Bucket {
+		unsigned int key;
+		int item;
+	};
+
+	void Clear(void);
+
+	bool ReserveText(int count);
+	int AddText(const mchar* pValue, int length);
+	result AddItem(int category, const String& path, const String& art);
+	void CollectMatches(void);
+	void Offer(int item, int other, int similarity);
+	result BuildSlots(void);
+	unsigned int HashItem(int item) const;
+
+	SimilarityIndex(const SimilarityIndex& index);
+	SimilarityIndex& operator =(const SimilarityIndex& index);
+
+	mchar* __pText;
+	int __textLength;
+	int __textCapacity;
+
+	Item* __pItems;
+	int __itemCount;
+	int __itemCapacity;
+
+	int* __pCategories;
+	int __categoryCount;
+
+	// MAX_SIMILAR entries per item, unused ones hold item -1
+	Match* __pMatches;
+
+	// Open addressing table of item + 1 by path hash, for Find()
+	int* __pSlots;
+	int __slotCount;
+
+	// Build only: SIGNATURE_SIZE values per item
+	unsigned int* __pSignatures;
+};
+
+#endif
@@ -0,0 +1,223 @@
+#include "SmsSegmenter.h"
+
+using namespace Osp::Base;
+
+static const int GSM7_SINGLE = 160;
+static const int GSM7_PART = 153;
+static const int UCS2_SINGLE = 70;
+static const int UCS2_PART = 67;
+
+// Septets per character for U+0000..U+00FF (see SmsSegmenter::GetSeptets)
+static const byte GSM7_LATIN1[256] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 2, 1, 0, 0,	// 0x00
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 0x10
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,	// 0x20
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,	// 0x30
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,	// 0x40
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 1,	// 0x50
+	0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,	// 0x60
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 0,	// 0x70
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 0x80
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,	// 0x90
+	0, 1, 0, 1, 1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0,	// 0xA0
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,	// 0xB0
+	0, 0, 0, 0, 1, 1, 1, 1, 0, 1, 0, 0, 0, 0, 0, 0,	// 0xC0
+	0, 1, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 1, 0, 0, 1,	// 0xD0
+	1, 0, 0, 0, 1, 1, 1, 0, 1, 1, 0, 0, 1, 0, 0, 0,	// 0xE0
+	0, 1, 1, 0, 0, 0, 1, 0, 1, 1, 0, 0, 1, 0, 0, 0,	// 0xF0
+};
+
+struct Transliteration {
+	mchar from;
+	mchar to;
+};
+
+// Sorted by 'from'. Replacements are one character wide so the art keeps its columns.
+static const Transliteration TRANSLITERATIONS[] = {
+	{ 0x0060, L'\'' },	// `
+	{ 0x00A0, L' ' },	// no-break space
+	{ 0x00A8, L'"' },	// diaeresis
+	{ 0x00AB, L'"' },	// <<
+	{ 0x00AC, L'-' },	// not sign
+	{ 0x00AF, L'-' },	// macron
+	{ 0x00B0, L'o' },	// degree
+	{ 0x00B4, L'\'' },	// acute accent
+	{ 0x00B7, L'.' },	// middle dot
+	{ 0x00B8, L',' },	// cedilla
+	{ 0x00BB, L'"' },	// >>
+	{ 0x00C0, L'A' }, { 0x00C1, L'A' }, { 0x00C2, L'A' }, { 0x00C3, L'A' },
+	{ 0x00C8, L'E' }, { 0x00CA, L'E' }, { 0x00CB, L'E' },
+	{ 0x00CC, L'I' }, { 0x00CD, L'I' }, { 0x00CE, L'I' }, { 0x00CF, L'I' },
+	{ 0x00D2, L'O' }, { 0x00D3, L'O' }, { 0x00D4, L'O' }, { 0x00D5, L'O' },
+	{ 0x00D7, L'x' },	// multiplication sign
+	{ 0x00D9, L'U' }, { 0x00DA, L'U' }, { 0x00DB, L'U' },
+	{ 0x00E1, L'a' }, { 0x00E2, L'a' }, { 0x00E3, L'a' },
+	{ 0x00E7, L'c' },
+	{ 0x00EA, L'e' }, { 0x00EB, L'e' },
+	{ 0x00ED, L'i' }, { 0x00EE, L'i' }, { 0x00EF, L'i' },
+	{ 0x00F3, L'o' }, { 0x00F4, L'o' }, { 0x00F5, L'o' },
+	{ 0x00FA, L'u' }, { 0x00FB, L'u' },
+	{ 0x02DC, L'~' },	// small tilde
+	// Cyrillic letters that look exactly like Latin ones
+	{ 0x0410, L'A' }, { 0x0412, L'B' }, { 0x0415, L'E' }, { 0x041A, L'K' },
+	{ 0x041C, L'M' }, { 0x041D, L'H' }, { 0x041E, L'O' }, { 0x0420, L'P' },
+	{ 0x0421, L'C' }, { 0x0422, L'T' }, { 0x0425, L'X' },
+	{ 0x0430, L'a' }, { 0x0435, L'e' }, { 0x043E, L'o' }, { 0x0440, L'p' },
+	{ 0x0441, L'c' }, { 0x0443, L'y' }, { 0x0445, L'x' },
+	// Punctuation
+	{ 0x2010, L'-' }, { 0x2011, L'-' }, { 0x2012, L'-' }, { 0x2013, L'-' },
+	{ 0x2014, L'-' }, { 0x2015, L'-' },
+	{ 0x2017, L'_' },	// double low line
+	{ 0x2018, L'\'' }, { 0x2019, L'\'' }, { 0x201A, L',' },
+	{ 0x201C, L'"' }, { 0x201D, L'"' }, { 0x201E, L'"' },
+	{ 0x2022, L'.' },	// bullet
+	{ 0x2026, L'.' },	// ellipsis
+	{ 0x2032, L'\'' }, { 0x2033, L'"' },
+	// Box drawing
+	{ 0x2500, L'-' }, { 0x2502, L'|' },
+	{ 0x250C, L'+' }, { 0x2510, L'+' }, { 0x2514, L'+' }, { 0x2518, L'+' },
+	{ 0x251C, L'+' }, { 0x2524, L'+' }, { 0x252C, L'+' }, { 0x2534, L'+' },
+	{ 0x253C, L'+' },
+	{ 0x2550, L'=' }, { 0x2551, L'|' },
+	{ 0x2571, L'/' }, { 0x2572, L'\\' },
+	{ 0x2588, L'#' },	// full block
+};
+
+static const int TRANSLITERATION_COUNT = sizeof(TRANSLITERATIONS) / sizeof(TRANSLITERATIONS[0]);
+
+int
+SmsSegmenter::GetSeptets(mchar ch)
+{
+	unsigned int c = (unsigned int)ch;
+	if(c < 0x100) {
+		return GSM7_LATIN1[c];
+	}
+
+	switch(c) {
+	// Greek capitals of the basic table
+	case 0x0393: case 0x0394: case 0x0398: case 0x039B: case 0x039E:
+	case 0x03A0: case 0x03A3: case 0x03A6: case 0x03A8: case 0x03A9:
+		return 1;
+	case 0x20AC:	// euro sign, extension table
+		return 2;
+	default:
+		return 0;
+	}
+}
+
+void
+SmsSegmenter::Classify(const String& text, Info& info)
+{
+	const mchar* p = text.GetPointer();
+	int length = text.GetLength();
+
+	// Septets in total and the parts they need, counted together so the
+	// text is walked once. An escape pair may not be split across parts.
+	bool gsm = true;
+	int septets = 0;
+	int parts = 1;
+	int used = 0;
+	for(int i = 0; i < length; i++) {
+		int cost = GetSeptets(p[i]);
+		if(cost == 0) {
+			gsm = false;
+			break;
+		}
+		septets += cost;
+		if(used + cost > GSM7_PART) {
+			parts++;
+			used = 0;
+		}
+		used += cost;
+	}
+
+	if(gsm) {
+		info.encoding = ENCODING_GSM7;
+		info.units = septets;
+		info.segments = (septets <= GSM7_SINGLE) ? 1 : parts;
+		return;
+	}
+
+	// UCS-2: one unit per UTF-16 code unit, surrogate pairs stay together
+	int units = 0;
+	parts = 1;
+	used = 0;
+	for(int i = 0; i < length; i++) {
+		unsigned int c = (unsigned int)p[i];
+		int cost = 1;
+		if(c > 0xFFFF) {
+			// wchar_t is 32 bit, the character becomes a surrogate pair
+			cost = 2;
+		} else if(c >= 0xD800 && c <= 0xDBFF && i + 1 < length) {
+			cost = 2;
+			i++;
+		}
+		if(used + cost > UCS2_PART) {
+			parts++;
+			used = 0;
+		}
+		used += cost;
+		units += cost;
+	}
+
+	info.encoding = ENCODING_UCS2;
+	info.units = units;
+	info.segments = (units <= UCS2_SINGLE) ? 1 : parts;
+}
+
+bool
+SmsSegmenter::Transliterate(const String& text, String& out)
+{
+	out = text;
+
+	bool gsm = true;
+	int length = out.GetLength();
+	for(int i = 0; i < length; i++) {
+		mchar ch;
+		out.GetCharAt(i, ch);
+		if(GetSeptets(ch) != 0) {
+			continue;
+		}
+
+		int low = 0;
+		int high = TRANSLITERATION_COUNT - 1;
+		bool found = false;
+		while(low <= high) {
+			int mid = (low + high) / 2;
+			if(TRANSLITERATIONS[mid].from == ch) {
+				out.SetCharAt(TRANSLITERATIONS[mid].to, i);
+				found = true;
+				break;
+			} else if(TRANSLITERATIONS[mid].from < ch) {
+				low = mid + 1;
+			} else {
+				high = mid - 1;
+			}
+		}
+		if(!found) {
+			gsm = false;
+		}
+	}
+	return gsm;
+}
+
+bool
+SmsSegmenter::Prepare(const String& text, String& out, Info& info)
+{
+	Classify(text, info);
+	out = text;
+
+	if(info.encoding == ENCODING_UCS2) {
+		String transliterated;
+		if(Transliterate(text, transliterated)) {
+			Info gsmInfo;
+			Classify(transliterated, gsmInfo);
+			if(gsmInfo.segments <= info.segments) {
+				out = transliterated;
+				info = gsmInfo;
+			}
+		}
+	}
+
+	return info.segments <= MAX_SEGMENTS;
+}
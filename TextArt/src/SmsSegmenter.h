@@ -0,0 +1,46 @@
+#ifndef SMSSEGMENTER_H_
+#define SMSSEGMENTER_H_
+
+#include "Port.h"
+
+using namespace Osp::Base;
+
+/**
+ * Works out how a text is sent as SMS: GSM 03.38 7-bit (160 septets, 153 per
+ * part when concatenated) when every character is in the GSM alphabet or its
+ * extension table, UCS-2 (70 units, 67 per part) otherwise.
+ */
+class SmsSegmenter {
+public:
+	enum Encoding {
+		ENCODING_GSM7 = 0,
+		ENCODING_UCS2 = 1
+	};
+
+	struct Info {
+		Encoding encoding;
+		// septets for GSM-7, UTF-16 code units for UCS-2
+		int units;
+		int segments;
+	};
+
+	// Largest message still offered for sending as SMS
+	static const int MAX_SEGMENTS = 4;
+
+	static void Classify(const String& text, Info& info);
+
+	// Replaces characters outside the GSM alphabet by look-alikes (Cyrillic
+	// homoglyphs, typographic quotes and dashes, box drawing, ...).
+	// Returns true when the result is pure GSM-7.
+	static bool Transliterate(const String& text, String& out);
+
+	// Picks the cheaper of the text and its transliteration.
+	// Returns false when neither fits into MAX_SEGMENTS.
+	static bool Prepare(const String& text, String& out, Info& info);
+
+private:
+	// 0 - not in GSM-7, 1 - basic table, 2 - extension table (escape + char)
+	static int GetSeptets(mchar ch);
+};
+
+#endif
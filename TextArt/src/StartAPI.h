@@ -1,18 +1,25 @@
 #ifndef STARTAPI_H_
 #define STARTAPI_H_
 
-#include <FApp.h>
-#include <FBase.h>
-#include <FSystem.h>
-#include <FNet.h>
-#include <FSecurity.h>
-#include <FText.h>
-#include <FUi.h>
+#include "Port.h"
+#include "JsonWriter.h"
 
 using namespace Osp::Base;
 using namespace Osp::System;
 using namespace Osp::Net::Http;
 
+// Receives the outcome of StartAPI::POST.
+class IStartAPIListener
+{
+public:
+	virtual ~IStartAPIListener() {}
+
+	// The server answered; statusCode is the HTTP status.
+	virtual void OnPostCompleted(int statusCode) = 0;
+	// The transaction could not be sent or was aborted.
+	virtual void OnPostFailed(result r) = 0;
+};
+
 class StartAPI :
 	public Osp::Net::Http::IHttpTransactionEventListener,
 	public Osp::Net::Wifi::IWifiManagerEventListener
@@ -28,13 +35,18 @@ public:
 	};
 	StartAPI();
 	~StartAPI();
+
+	// hostAddr/uri are configurable so the client can be pointed at a local stand-in server.
+	result Construct(const String& hostAddr, const String& uri, IStartAPIListener& listener);
+
 public:
 	String body[8][2];
-	String _Body;
 
 	void CreateBody(void);
-	void MD5(Osp::Base::String mac);
-	void POST(void);
+	// Writes the device fields collected by CreateBody() as members of the current object.
+	void WriteBody(JsonWriter& writer) const;
+	result POST(const byte* pPayload, int length);
+	bool IsBusy(void) const;
 
 private:
 	void OnWifiActivated(result r);
@@ -44,16 +56,20 @@ private:
 	void OnWifiRssiChanged(long rssi);
 	void OnWifiScanCompletedN(const Osp::Base::Collection::IList* pWifiBssInfoList, result r);
 	void OnTransactionReadyToRead(Osp::Net::Http::HttpSession& httpSession, Osp::Net::Http::HttpTransaction& httpTransaction, int availableBodyLen);
-	void OnTransactionAborted(Osp::Net::Http::HttpSession& httpSession, Osp::Net::Http::HttpTransaction& httpTransaction, result r) {}
-	void OnTransactionReadyToWrite(Osp::Net::Http::HttpSession& httpSession, Osp::Net::Http::HttpTransaction& httpTransaction, int recommendedChunkSize);
+	void OnTransactionAborted(Osp::Net::Http::HttpSession& httpSession, Osp::Net::Http::HttpTransaction& httpTransaction, result r);
+	void OnTransactionReadyToWrite(Osp::Net::Http::HttpSession& httpSession, Osp::Net::Http::HttpTransaction& httpTransaction, int recommendedChunkSize) {}
 	void OnTransactionHeaderCompleted(Osp::Net::Http::HttpSession& httpSession, Osp::Net::Http::HttpTransaction& httpTransaction, int headerLen, bool bAuthRequired) {}
 	void OnTransactionCompleted(Osp::Net::Http::HttpSession& httpSession, Osp::Net::Http::HttpTransaction& httpTransaction);
 	void OnTransactionCertVerificationRequiredN(Osp::Net::Http::HttpSession& httpSession, Osp::Net::Http::HttpTransaction& httpTransaction, Osp::Base::String* pCert) {}
 
+	result OpenSession(void);
+	void CloseSession(void);
+
 private:
 	Osp::Net::Http::HttpSession* 	__pHttpSession;
-	bool		 					__isLastData;
+	Osp::Net::Http::HttpTransaction* __pHttpTransaction;
+	IStartAPIListener*				__pListener;
+	String							__hostAddr;
+	String							__uri;
 };
 #endif
-
-
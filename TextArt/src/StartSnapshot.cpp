@@ -0,0 +1,115 @@
+#include "StartSnapshot.h"
+
+#include <FApp.h>
+#include <FIo.h>
+
+#include "BitmapCache.h"
+#include "Catalog.h"
+#include "Debug.h"
+#include "TextPic.h"
+
+using namespace Osp::App;
+using namespace Osp::Base;
+using namespace Osp::Graphics;
+using namespace Osp::Io;
+using namespace Osp::Ui;
+using namespace Osp::Ui::Controls;
+
+static const mchar SNAPSHOT_PATH[] = L"/Home/start.snapshot";
+
+static unsigned int
+HashBytes(unsigned int hash, const void* pData, int length)
+{
+	const byte* pBytes = static_cast<const byte*>(pData);
+	for(int i = 0; i < length; i++) {
+		hash = (hash ^ pBytes[i]) * 16777619u;
+	}
+	return hash;
+}
+
+unsigned int
+StartSnapshot::GetKey(void)
+{
+	unsigned int hash = 2166136261u;
+	String version = Application::GetInstance()->GetAppVersion();
+	hash = HashBytes(hash, version.GetPointer(), version.GetLength() * sizeof(mchar));
+
+	Rectangle bounds = Application::GetInstance()->GetAppFrame()->GetFrame()->GetBounds();
+	int screen[3] = { TextPic::__InternalAppLanguageIndex, bounds.width, bounds.height };
+	hash = HashBytes(hash, screen, sizeof(screen));
+
+	// categories added or removed while the application was not running
+	String root;
+	Catalog::GetCategoryPath(L"", root);
+	FileAttributes attributes;
+	if(!IsFailed(File::GetAttributes(root, attributes))) {
+		long long modified = attributes.GetLastModifiedTime().GetTime().GetTicks();
+		hash = HashBytes(hash, &modified, sizeof(modified));
+	}
+	return hash;
+}
+
+Bitmap*
+StartSnapshot::ReadN(void)
+{
+	PROFILE_SCOPE("StartSnapshot::ReadN");
+	return BitmapCache::ReadN(SNAPSHOT_PATH, GetKey());
+}
+
+result
+StartSnapshot::Capture(const Control& form)
+{
+	PROFILE_SCOPE("StartSnapshot::Capture");
+	Canvas* pCanvas = form.GetCanvasN();
+	if(pCanvas == null) {
+		return GetLastResult();
+	}
+	Rectangle bounds = form.GetBounds();
+	Bitmap snapshot;
+	result r = snapshot.Construct(*pCanvas, Rectangle(0, 0, bounds.width, bounds.height));
+	delete pCanvas;
+	if(!IsFailed(r)) {
+		r = BitmapCache::Write(SNAPSHOT_PATH, GetKey(), snapshot);
+	}
+	if(IsFailed(r)) {
+		AppLog("Start snapshot not captured: %s", GetErrorMessage(r));
+	}
+	return r;
+}
+
+void
+StartSnapshot::Invalidate(void)
+{
+	BitmapCache::Remove(SNAPSHOT_PATH);
+}
+
+SnapshotForm::SnapshotForm(Bitmap* pSnapshot):
+	__pSnapshot(pSnapshot)
+{
+}
+
+SnapshotForm::~SnapshotForm(void)
+{
+	delete __pSnapshot;
+}
+
+bool
+SnapshotForm::Initialize(void)
+{
+	// the indicator is drawn over the snapshot as over the live form
+	result r = Form::Construct(FORM_STYLE_INDICATOR);
+	SetName(L"SnapshotForm");
+	return !IsFailed(r);
+}
+
+result
+SnapshotForm::OnDraw(void)
+{
+	Canvas* pCanvas = GetCanvasN();
+	if(pCanvas == null) {
+		return GetLastResult();
+	}
+	result r = pCanvas->DrawBitmap(Point(0, 0), *__pSnapshot);
+	delete pCanvas;
+	return r;
+}
@@ -0,0 +1,47 @@
+#ifndef STARTSNAPSHOT_H_
+#define STARTSNAPSHOT_H_
+
+#include <FBase.h>
+#include <FGraphics.h>
+#include <FUi.h>
+
+/**
+ * The category screen as it was first shown, kept in /Home/start.snapshot
+ * through BitmapCache. The next start paints it before the catalog is read
+ * and swaps the live list in once it is built. The snapshot is keyed by the
+ * version of the application, the language, the frame size and the time the
+ * catalog directory changed, so any of them moving makes it miss; changes
+ * inside the categories remove it.
+ */
+class StartSnapshot {
+public:
+	// null when there is no snapshot for this start
+	static Osp::Graphics::Bitmap* ReadN(void);
+	// Copies what the form shows now and writes it behind the UI thread
+	static result Capture(const Osp::Ui::Control& form);
+	static void Invalidate(void);
+
+private:
+	static unsigned int GetKey(void);
+};
+
+/**
+ * Shows a start snapshot until FormManager switches to the live form.
+ */
+class SnapshotForm :
+	public Osp::Ui::Controls::Form
+{
+public:
+	// Takes the snapshot
+	SnapshotForm(Osp::Graphics::Bitmap* pSnapshot);
+	virtual ~SnapshotForm(void);
+
+	bool Initialize(void);
+
+	virtual result OnDraw(void);
+
+private:
+	Osp::Graphics::Bitmap* __pSnapshot;
+};
+
+#endif
@@ -0,0 +1,39 @@
+// Generated by tools/StringTableGen from Res/*.xml - do not modify by hand.
+
+#ifndef STRINGIDS_H_
+#define STRINGIDS_H_
+
+enum StringId {
+	IDS_ADDTOFAVOURITES = 0,
+	IDS_BACK = 1,
+	IDS_CANCEL = 2,
+	IDS_CATALOG = 3,
+	IDS_COPY = 4,
+	IDS_EMPTY = 5,
+	IDS_EMPTYLIST = 6,
+	IDS_FAVOURITES = 7,
+	IDS_FROMPHOTO = 8,
+	IDS_FROMPHOTODESC = 9,
+	IDS_INFO = 10,
+	IDS_RECENT = 11,
+	IDS_REMOVEFROMFAVOURITES = 12,
+	IDS_SEARCH = 13,
+	IDS_SEARCHING = 14,
+	IDS_SENDEMAIL = 15,
+	IDS_SENDSMS = 16,
+	IDS_SIMILAR = 17,
+	IDS_SPACESHUFFLE = 18,
+	IDS_TITLE = 19,
+	IDS_TOOLONG = 20,
+	IDS_UCONVERTOR = 21,
+	IDS_UPDATE = 22,
+	IDS_UPDATED = 23,
+	IDS_UPDATEDESC = 24,
+	IDS_UPDATEFAILED = 25,
+	IDS_UPDATING = 26,
+	IDS_VIEW = 27,
+	IDS_sCalc = 28,
+	STRING_COUNT = 29
+};
+
+#endif
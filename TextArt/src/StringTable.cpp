@@ -0,0 +1,31 @@
+#include "StringTable.h"
+
+using namespace Osp::Base;
+
+#include "StringTableData.h"
+
+static const int LANGUAGE_COUNT = sizeof(LANGUAGES) / sizeof(LANGUAGES[0]);
+
+const StringTable::Language* StringTable::__pLanguage = &LANGUAGES[0];
+
+result
+StringTable::Setup(const String& language)
+{
+	for(int i = 0; i < LANGUAGE_COUNT; i++) {
+		if(language == LANGUAGES[i].pName) {
+			__pLanguage = &LANGUAGES[i];
+			return E_SUCCESS;
+		}
+	}
+	__pLanguage = &LANGUAGES[0];
+	return E_OBJ_NOT_FOUND;
+}
+
+const mchar*
+StringTable::Get(StringId id)
+{
+	if(id < 0 || id >= STRING_COUNT) {
+		return L"";
+	}
+	return __pLanguage->pText + __pLanguage->pOffsets[id];
+}
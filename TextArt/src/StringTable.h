@@ -0,0 +1,32 @@
+#ifndef STRINGTABLE_H_
+#define STRINGTABLE_H_
+
+#include "Port.h"
+#include "StringIds.h"
+
+using namespace Osp::Base;
+
+/**
+ * UI strings compiled from the Res string tables by tools/StringTableGen.
+ * Every language is one packed text blob with an offset per StringId, so a
+ * lookup is an array index. Setup() picks the language once at startup.
+ */
+class StringTable {
+public:
+	struct Language {
+		const mchar* pName;
+		const mchar* pText;
+		const unsigned short* pOffsets;
+	};
+
+	// Res file name like L"eng-GB", falls back to the first table when unknown
+	static result Setup(const String& language);
+
+	// Null terminated, valid for the lifetime of the application
+	static const mchar* Get(StringId id);
+
+private:
+	static const Language* __pLanguage;
+};
+
+#endif
@@ -0,0 +1,81 @@
+// Generated by tools/StringTableGen from Res/*.xml - do not modify by hand.
+// Included by StringTable.cpp only.
+
+static const mchar ENG_GB_TEXT[] =
+	L"Add to favourites\0"
+	L"Back\0"
+	L"Cancel\0"
+	L"Catalog\0"
+	L"Copy to clipboard\0"
+	L"Empty catalog\0"
+	L"Empty list\0"
+	L"Favourites\0"
+	L"Art from a photo\0"
+	L"Pick a picture from the gallery\0"
+	L"Our App\0"
+	L"Recent\0"
+	L"Remove from favourites\0"
+	L"Search titles and art\0"
+	L"Searching...\0"
+	L"Send E-mail\0"
+	L"Send SMS\0"
+	L"Similar\0"
+	L"A unique adventure in outer space! Collect all the crystals to save our planet from energy collapse.\0"
+	L"TextArt\0"
+	L"Text too long. Please use \"Copy to clipboard\"\0"
+	L"Universal Converter - a versatile program for converting currencies, the size of the adult and children's clothing and shoes, and measures of physical quantities.\0"
+	L"Update the catalog\0"
+	L"Files updated: \0"
+	L"Download new and changed art\0"
+	L"Update failed, try again later\0"
+	L"Checking for new art...\0"
+	L"Zoom\0"
+	L"This simple \"Calculator\" application allows you to save your private contacts in secret.\0";
+
+static const unsigned short ENG_GB_OFFSETS[STRING_COUNT] = {
+	0, 18, 23, 30, 38, 56, 70, 81, 92, 109, 141, 149,
+	156, 179, 201, 214, 226, 235, 243, 344, 352, 398, 561, 580,
+	596, 625, 656, 680, 685
+};
+
+static const mchar RUS_RU_TEXT[] =
+	L"\u0414\u043E\u0431\u0430\u0432\u0438\u0442\u044C \u0432 \u0437\u0430\u043A\u043B\u0430\u0434\u043A\u0438\0"
+	L"\u041D\u0430\u0437\u0430\u0434\0"
+	L"\u041E\u0442\u043C\u0435\u043D\u0430\0"
+	L"\u041A\u0430\u0442\u0430\u043B\u043E\u0433\0"
+	L"\u041A\u043E\u043F\u0438\u0440\u043E\u0432\u0430\u0442\u044C \u0432 \u0431\u0443\u0444\u0435\u0440\0"
+	L"\u041A\u0430\u0442\u0430\u043B\u043E\u0433 \u043F\u0443\u0441\u0442\u043E\u0439\0"
+	L"\u0421\u043F\u0438\u0441\u043E\u043A \u043F\u0443\u0441\u0442\u043E\u0439\0"
+	L"\u0418\u0437\u0431\u0440\u0430\u043D\u043D\u043E\u0435\0"
+	L"\u0410\u0440\u0442 \u0438\u0437 \u0444\u043E\u0442\u043E\0"
+	L"\u0412\u044B\u0431\u0435\u0440\u0438\u0442\u0435 \u0441\u043D\u0438\u043C\u043E\u043A \u0432 \u0433\u0430\u043B\u0435\u0440\u0435\u0435\0"
+	L"\u041D\u0430\u0448\u0438 \u043F\u0440\u0438\u043B\u043E\u0436\u0435\u043D\u0438\u044F\0"
+	L"\u041F\u043E\u0441\u043B\u0435\u0434\u043D\u0438\u0435\0"
+	L"\u0423\u0434\u0430\u043B\u0438\u0442\u044C \u0438\u0437 \u0437\u0430\u043A\u043B\u0430\u0434\u043E\u043A\0"
+	L"\u041F\u043E\u0438\u0441\u043A \u043F\u043E \u043D\u0430\u0437\u0432\u0430\u043D\u0438\u044F\u043C \u0438 \u0430\u0440\u0442\u0443\0"
+	L"\u041F\u043E\u0438\u0441\u043A...\0"
+	L"\u041E\u0442\u043F\u0440\u0430\u0432\u0438\u0442\u044C E-mail\0"
+	L"\u041E\u0442\u043F\u0440\u0430\u0432\u0438\u0442\u044C SMS\0"
+	L"\u041F\u043E\u0445\u043E\u0436\u0438\u0435\0"
+	L"\u0423\u043D\u0438\u043A\u0430\u043B\u044C\u043D\u043E\u0435 \u043F\u0440\u0438\u043A\u043B\u044E\u0447\u0435\u043D\u0438\u0435 \u0432 \u043E\u0442\u043A\u0440\u044B\u0442\u043E\u043C \u043A\u043E\u0441\u043C\u043E\u0441\u0435! \u0421\u043E\u0431\u0435\u0440\u0438\u0442\u0435 \u0432\u0441\u0435 \u043A\u0440\u0438\u0441\u0442\u0430\u043B\u043B\u044B, \u0447\u0442\u043E\u0431\u044B \u0441\u043F\u0430\u0441\u0442\u0438 \u043D\u0430\u0448\u0443 \u043F\u043B\u0430\u043D\u0435\u0442\u0443 \u043E\u0442 \u044D\u043D\u0435\u0440\u0433\u0435\u0442\u0438\u0447\u0435\u0441\u043A\u043E\u0433\u043E \u043A\u043E\u043B\u043B\u0430\u043F\u0441\u0430.\0"
+	L"\u0422\u0435\u043A\u0441\u0442\u043E\u0432\u044B\u0435 \u043A\u0430\u0440\u0442\u0438\u043D\u043A\u0438\0"
+	L"\u0422\u0435\u043A\u0441\u0442 \u0441\u043B\u0438\u0448\u043A\u043E\u043C \u0434\u043B\u0438\u043D\u043D\u044B\u0439. \u041F\u043E\u0436\u0430\u043B\u0443\u0439\u0441\u0442\u0430, \u0438\u0441\u043F\u043E\u043B\u044C\u0437\u0443\u0439\u0442\u0435 \u0444\u0443\u043D\u043A\u0446\u0438\u044E \"\u041A\u043E\u043F\u0438\u0440\u043E\u0432\u0430\u0442\u044C \u0432 \u0431\u0443\u0444\u0435\u0440\"\0"
+	L"Universal Converter - \u0443\u043D\u0438\u0432\u0435\u0440\u0441\u0430\u043B\u044C\u043D\u0430\u044F \u043F\u0440\u043E\u0433\u0440\u0430\u043C\u043C\u0430 \u0434\u043B\u044F \u043A\u043E\u043D\u0432\u0435\u0440\u0442\u0430\u0446\u0438\u0438 \u043A\u0443\u0440\u0441\u043E\u0432 \u0432\u0430\u043B\u044E\u0442, \u0440\u0430\u0437\u043C\u0435\u0440\u043E\u0432 \u0432\u0437\u0440\u043E\u0441\u043B\u043E\u0439 \u0438 \u0434\u0435\u0442\u0441\u043A\u043E\u0439 \u043E\u0434\u0435\u0436\u0434\u044B \u0438 \u043E\u0431\u0443\u0432\u0438, \u0444\u0438\u0437\u0438\u0447\u0435\u0441\u043A\u0438\u0445 \u0432\u0435\u043B\u0438\u0447\u0438\u043D \u0438 \u043C\u0435\u0440.\0"
+	L"\u041E\u0431\u043D\u043E\u0432\u0438\u0442\u044C \u043A\u0430\u0442\u0430\u043B\u043E\u0433\0"
+	L"\u041E\u0431\u043D\u043E\u0432\u043B\u0435\u043D\u043E \u0444\u0430\u0439\u043B\u043E\u0432: \0"
+	L"\u0417\u0430\u0433\u0440\u0443\u0437\u0438\u0442\u044C \u043D\u043E\u0432\u044B\u0435 \u0438 \u0438\u0437\u043C\u0435\u043D\u0435\u043D\u043D\u044B\u0435 \u0430\u0440\u0442\u044B\0"
+	L"\u041D\u0435 \u0443\u0434\u0430\u043B\u043E\u0441\u044C \u043E\u0431\u043D\u043E\u0432\u0438\u0442\u044C, \u043F\u043E\u043F\u0440\u043E\u0431\u0443\u0439\u0442\u0435 \u043F\u043E\u0437\u0436\u0435\0"
+	L"\u041F\u043E\u0438\u0441\u043A \u043D\u043E\u0432\u044B\u0445 \u0430\u0440\u0442\u043E\u0432...\0"
+	L"\u041A\u0440\u0443\u043F\u043D\u043E\0"
+	L"\u042D\u0442\u043E\u0442 \u043F\u0440\u043E\u0441\u0442\u043E\u0439 \"\u041A\u0430\u043B\u044C\u043A\u0443\u043B\u044F\u0442\u043E\u0440\" \u043F\u043E\u0437\u0432\u043E\u043B\u044F\u0435\u0442 \u0441\u043E\u0445\u0440\u0430\u043D\u0438\u0442\u044C \u043B\u0438\u0447\u043D\u044B\u0435 \u043A\u043E\u043D\u0442\u0430\u043A\u0442\u044B \u0432 \u0442\u0430\u0439\u043D\u0435.\0";
+
+static const unsigned short RUS_RU_OFFSETS[STRING_COUNT] = {
+	0, 20, 26, 33, 41, 60, 75, 89, 99, 111, 137, 153,
+	163, 183, 209, 218, 235, 249, 257, 379, 398, 474, 620, 637,
+	656, 690, 728, 749, 756
+};
+
+static const StringTable::Language LANGUAGES[] = {
+	{ L"eng-GB", ENG_GB_TEXT, ENG_GB_OFFSETS },
+	{ L"rus-RU", RUS_RU_TEXT, RUS_RU_OFFSETS }
+};
@@ -37,45 +37,9 @@ TabsForm::OnInitializing(void)
 	tab_->SetCompositeMode(COMPOSITE_MODE_CHROMA_KEY);
 
 
-	if(Retina::GetInt(1) == 2) {
-		tab_->AddItem(Helper::GetTraslation("IDS_CATALOG"), CATEGORY_TAB);
-	}
-	else {
-		String val = Helper::GetTraslation("IDS_CATALOG");
-		if(val.GetLength() > 7) {
-			val.SubString(0,7,val);
-			val.Append("...");
-		}
-
-		tab_->AddItem(val, CATEGORY_TAB);
-	}
-	//
-	if(Retina::GetInt(1) == 2) {
-		tab_->AddItem(Helper::GetTraslation("IDS_RECENT"), RECENT_TAB);
-	}
-	else {
-		String val = Helper::GetTraslation("IDS_RECENT");
-		if(val.GetLength() > 7) {
-			val.SubString(0,7,val);
-			val.Append("...");
-		}
-
-		tab_->AddItem(val, RECENT_TAB);
-	}
-	//
-
-	if(Retina::GetInt(1) == 2) {
-		tab_->AddItem(Helper::GetTraslation("IDS_FAVOURITES"), FAVOURITES_TAB);
-	}
-	else {
-		String val = Helper::GetTraslation("IDS_FAVOURITES");
-		if(val.GetLength() > 7) {
-			val.SubString(0,7,val);
-			val.Append("...");
-		}
-
-		tab_->AddItem(val, FAVOURITES_TAB);
-	}
+	tab_->AddItem(GetTabText(IDS_CATALOG), CATEGORY_TAB);
+	tab_->AddItem(GetTabText(IDS_RECENT), RECENT_TAB);
+	tab_->AddItem(GetTabText(IDS_FAVOURITES), FAVOURITES_TAB);
 	tab_->SetSelectedItem(tab_index_);
 	tab_->AddActionEventListener(*this);
 
@@ -85,6 +49,28 @@ TabsForm::OnInitializing(void)
 		return E_INVALID_STATE;
 }
 
+String
+TabsForm::GetTabText(StringId id)
+{
+	String val = Helper::GetTraslation(id);
+	// Tabs of the small screens fit seven characters
+	if(Retina::GetScale() < 2 * Retina::SCALE_ONE && val.GetLength() > 7) {
+		val.SubString(0,7,val);
+		val.Append("...");
+	}
+	return val;
+}
+
+void
+TabsForm::OnLanguageChanged(void)
+{
+	if(tab_ != null) {
+		tab_->SetItemAt(CATEGORY_TAB, GetTabText(IDS_CATALOG), CATEGORY_TAB);
+		tab_->SetItemAt(RECENT_TAB, GetTabText(IDS_RECENT), RECENT_TAB);
+		tab_->SetItemAt(FAVOURITES_TAB, GetTabText(IDS_FAVOURITES), FAVOURITES_TAB);
+	}
+}
+
 result
 TabsForm::OnTerminating(void)
 {
@@ -96,10 +82,6 @@ TabsForm::OnActionPerformed(const Osp::Ui::Control& source, int actionId)
 {
 	tab_->SetSelectedItem(tab_index_);
 	if(tab_index_ != actionId) {
-		Frame *pFrame = Application::GetInstance()->GetAppFrame()->GetFrame();
-		FormManager *pFormMgr = static_cast<FormManager *>(pFrame->GetControl("FormManager"));
-		if (pFormMgr != null) {
-			pFormMgr->SendUserEvent(FormManager::REQUEST_TAB+actionId+1, null);
-		}
+		FormManager::Navigate(FormManager::REQUEST_TAB+actionId+1);
 	}
 }
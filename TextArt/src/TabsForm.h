@@ -4,6 +4,8 @@
 #include <FBase.h>
 #include <FUi.h>
 
+#include "StringIds.h"
+
 class TabsForm :
  public Osp::Ui::Controls::Form,
  public Osp::Ui::IActionEventListener
@@ -22,11 +24,16 @@ protected:
  Osp::Ui::Controls::Tab * tab_;
  int tab_index_;
 
+ static Osp::Base::String GetTabText(StringId id);
+
 // Callbacks
 public:
  virtual result OnInitializing(void);
  result OnTerminating(void);
  void OnActionPerformed(const Osp::Ui::Control& source, int actionId);
+
+ // Called by FormManager after the language changed, texts are reloaded from memory
+ virtual void OnLanguageChanged(void);
 };
 
 #endif
@@ -0,0 +1,424 @@
+#include "TaskScheduler.h"
+
+using namespace Osp::Base;
+using namespace Osp::Base::Runtime;
+
+// Background work leaves the other workers to what is on screen
+static const int MAX_BACKGROUND_WORKERS = 1;
+
+class TaskScheduler::Worker :
+	public Thread
+{
+public:
+	Worker(TaskScheduler& scheduler, int index):
+		__scheduler(scheduler),
+		__index(index)
+	{
+	}
+
+	Object* Run(void)
+	{
+		Entry* pEntry = null;
+		while((pEntry = __scheduler.Take(__index)) != null) {
+			// cancelled between Take and here, nobody is waiting for it
+			pEntry->r = pEntry->token.IsCancelled() ? E_SUCCESS : pEntry->pTask->Run(pEntry->token);
+			__scheduler.Complete(__index, pEntry);
+		}
+		return null;
+	}
+
+private:
+	TaskScheduler& __scheduler;
+	int __index;
+};
+
+TaskScheduler* TaskScheduler::__pInstance = null;
+
+TaskScheduler::TaskScheduler(ITaskCompletionPoster& poster):
+	__poster(poster),
+	__ppWorkers(null),
+	__ppRunning(null),
+	__workerCount(0),
+	__backgroundRunning(0),
+	__pCompleted(null),
+	__pCompletedTail(null),
+	__pDelivering(null),
+	__lastId(0),
+	__pending(0),
+	__stopping(false)
+{
+	for(int lane = 0; lane < LANE_COUNT; lane++) {
+		__pQueues[lane] = null;
+	}
+}
+
+TaskScheduler::~TaskScheduler(void)
+{
+	for(int i = 0; i < __workerCount; i++) {
+		delete __ppWorkers[i];
+	}
+	delete[] __ppWorkers;
+	delete[] __ppRunning;
+}
+
+result
+TaskScheduler::Setup(ITaskCompletionPoster& poster, int workerCount)
+{
+	if(__pInstance != null) {
+		return E_SUCCESS;
+	}
+	__pInstance = new TaskScheduler(poster);
+	result r = __pInstance->Construct(workerCount > 0 ? workerCount : 1);
+	if(IsFailed(r)) {
+		AppLog("Task scheduler not started by %s, tasks run on the caller", GetErrorMessage(r));
+		__pInstance->Stop();
+		delete __pInstance;
+		__pInstance = null;
+	}
+	return r;
+}
+
+result
+TaskScheduler::Construct(int workerCount)
+{
+	result r = __monitor.Construct();
+	if(IsFailed(r)) {
+		return r;
+	}
+	__ppWorkers = new Worker*[workerCount];
+	__ppRunning = new Entry*[workerCount];
+	for(int i = 0; i < workerCount; i++) {
+		__ppRunning[i] = null;
+		__ppWorkers[i] = new Worker(*this, i);
+		// The UI thread keeps the processor while it draws
+		r = __ppWorkers[i]->Construct(THREAD_TYPE_WORKER, Thread::DEFAULT_STACK_SIZE, THREAD_PRIORITY_LOW);
+		if(!IsFailed(r)) {
+			r = __ppWorkers[i]->Start();
+		}
+		if(IsFailed(r)) {
+			delete __ppWorkers[i];
+			return r;
+		}
+		__workerCount++;
+	}
+	return E_SUCCESS;
+}
+
+void
+TaskScheduler::Shutdown(void)
+{
+	if(__pInstance == null) {
+		return;
+	}
+	TaskScheduler* pScheduler = __pInstance;
+	pScheduler->Stop();
+	// whatever the completions post from here on runs on the caller
+	__pInstance = null;
+
+	Entry* pEntry = pScheduler->DetachCompleted();
+	while(pEntry != null) {
+		Entry* pNext = pEntry->pNext;
+		if(!pEntry->token.IsCancelled()) {
+			pEntry->pTask->OnTaskCompleted(pEntry->r);
+		}
+		Release(pEntry);
+		pEntry = pNext;
+	}
+	delete pScheduler;
+}
+
+void
+TaskScheduler::Stop(void)
+{
+	Entry* pDropped = null;
+	if(__workerCount > 0) {
+		__monitor.Enter();
+		__stopping = true;
+		// Loads for forms about to close are not worth the wait, writes are
+		for(int lane = LANE_VISIBLE; lane < LANE_BACKGROUND; lane++) {
+			while(__pQueues[lane] != null) {
+				Entry* pEntry = __pQueues[lane];
+				__pQueues[lane] = pEntry->pNext;
+				pEntry->pNext = pDropped;
+				pDropped = pEntry;
+				__pending--;
+			}
+		}
+		for(int i = 0; i < __workerCount; i++) {
+			if(__ppRunning[i] != null && __ppRunning[i]->lane != LANE_BACKGROUND) {
+				__ppRunning[i]->token.__cancelled = true;
+			}
+		}
+		__monitor.NotifyAll();
+		__monitor.Exit();
+	}
+
+	while(pDropped != null) {
+		Entry* pNext = pDropped->pNext;
+		Release(pDropped);
+		pDropped = pNext;
+	}
+	for(int i = 0; i < __workerCount; i++) {
+		__ppWorkers[i]->Join();
+	}
+}
+
+TaskScheduler::TaskId
+TaskScheduler::Post(ITask* pTask, Lane lane, Strand strand)
+{
+	if(pTask == null) {
+		return 0;
+	}
+	if(__pInstance == null) {
+		RunInline(pTask);
+		return 0;
+	}
+	return __pInstance->Enqueue(pTask, lane, strand);
+}
+
+void
+TaskScheduler::RunInline(ITask* pTask)
+{
+	CancelToken token;
+	result r = pTask->Run(token);
+	pTask->OnTaskCompleted(r);
+	delete pTask;
+}
+
+TaskScheduler::TaskId
+TaskScheduler::Enqueue(ITask* pTask, Lane lane, Strand strand)
+{
+	Entry* pEntry = new Entry();
+	pEntry->pTask = pTask;
+	pEntry->lane = lane;
+	pEntry->strand = strand;
+	pEntry->r = E_SUCCESS;
+	pEntry->pNext = null;
+
+	__monitor.Enter();
+	pEntry->id = ++__lastId;
+	// ids rise in posting order, which is the order of a strand
+	Entry** ppTail = &__pQueues[lane];
+	while(*ppTail != null) {
+		ppTail = &(*ppTail)->pNext;
+	}
+	*ppTail = pEntry;
+	__pending++;
+	__monitor.Notify();
+	__monitor.Exit();
+	return pEntry->id;
+}
+
+void
+TaskScheduler::Cancel(TaskId id)
+{
+	if(__pInstance == null || id == 0) {
+		return;
+	}
+	__pInstance->Remove(id);
+}
+
+void
+TaskScheduler::Remove(TaskId id)
+{
+	// picked up by DeliverCompleted and not handed out yet
+	for(Entry* pEntry = __pDelivering; pEntry != null; pEntry = pEntry->pNext) {
+		if(pEntry->id == id) {
+			pEntry->token.__cancelled = true;
+			return;
+		}
+	}
+
+	Entry* pDropped = null;
+	__monitor.Enter();
+	for(int lane = 0; lane < LANE_COUNT && pDropped == null; lane++) {
+		for(Entry* pEntry = __pQueues[lane]; pEntry != null; pEntry = pEntry->pNext) {
+			if(pEntry->id == id) {
+				Unlink(pEntry);
+				__pending--;
+				pDropped = pEntry;
+				break;
+			}
+		}
+	}
+	if(pDropped == null) {
+		for(int i = 0; i < __workerCount; i++) {
+			if(__ppRunning[i] != null && __ppRunning[i]->id == id) {
+				__ppRunning[i]->token.__cancelled = true;
+			}
+		}
+		for(Entry* pEntry = __pCompleted; pEntry != null; pEntry = pEntry->pNext) {
+			if(pEntry->id == id) {
+				pEntry->token.__cancelled = true;
+			}
+		}
+	}
+	__monitor.Exit();
+
+	// the task is deleted on the UI thread, like every other
+	if(pDropped != null) {
+		Release(pDropped);
+	}
+}
+
+void
+TaskScheduler::DeliverCompleted(void)
+{
+	if(__pInstance == null) {
+		return;
+	}
+	TaskScheduler* pScheduler = __pInstance;
+	pScheduler->__pDelivering = pScheduler->DetachCompleted();
+	while(pScheduler->__pDelivering != null) {
+		Entry* pEntry = pScheduler->__pDelivering;
+		pScheduler->__pDelivering = pEntry->pNext;
+		if(!pEntry->token.IsCancelled()) {
+			pEntry->pTask->OnTaskCompleted(pEntry->r);
+		}
+		Release(pEntry);
+	}
+}
+
+int
+TaskScheduler::GetPendingCount(void)
+{
+	if(__pInstance == null) {
+		return 0;
+	}
+	__pInstance->__monitor.Enter();
+	int pending = __pInstance->__pending;
+	__pInstance->__monitor.Exit();
+	return pending;
+}
+
+TaskScheduler::Entry*
+TaskScheduler::DetachCompleted(void)
+{
+	__monitor.Enter();
+	Entry* pEntry = __pCompleted;
+	__pCompleted = null;
+	__pCompletedTail = null;
+	__monitor.Exit();
+	return pEntry;
+}
+
+TaskScheduler::Entry*
+TaskScheduler::Take(int worker)
+{
+	__monitor.Enter();
+	Entry* pEntry = null;
+	while(true) {
+		pEntry = FindRunnable();
+		if(pEntry != null) {
+			break;
+		}
+		bool queued = false;
+		for(int lane = 0; lane < LANE_COUNT; lane++) {
+			queued = queued || __pQueues[lane] != null;
+		}
+		if(__stopping && !queued) {
+			break;
+		}
+		__monitor.Wait();
+	}
+	if(pEntry != null) {
+		Unlink(pEntry);
+		__ppRunning[worker] = pEntry;
+		if(pEntry->lane == LANE_BACKGROUND) {
+			__backgroundRunning++;
+		}
+	}
+	__monitor.Exit();
+	return pEntry;
+}
+
+void
+TaskScheduler::Complete(int worker, Entry* pEntry)
+{
+	__monitor.Enter();
+	__ppRunning[worker] = null;
+	if(pEntry->lane == LANE_BACKGROUND) {
+		__backgroundRunning--;
+	}
+	__pending--;
+	pEntry->pNext = null;
+	bool wake = __pCompleted == null;
+	if(__pCompletedTail != null) {
+		__pCompletedTail->pNext = pEntry;
+	} else {
+		__pCompleted = pEntry;
+	}
+	__pCompletedTail = pEntry;
+	// a strand or the background slot may have come free
+	__monitor.NotifyAll();
+	__monitor.Exit();
+
+	// one event for all that complete before the UI thread gets to them
+	if(wake) {
+		__poster.PostTaskCompletion();
+	}
+}
+
+TaskScheduler::Entry*
+TaskScheduler::FindRunnable(void)
+{
+	for(int lane = 0; lane < LANE_COUNT; lane++) {
+		if(lane == LANE_BACKGROUND && __backgroundRunning >= MAX_BACKGROUND_WORKERS) {
+			continue;
+		}
+		for(Entry* pEntry = __pQueues[lane]; pEntry != null; pEntry = pEntry->pNext) {
+			if(pEntry->strand == STRAND_NONE) {
+				return pEntry;
+			}
+			if(IsStrandBusy(pEntry->strand)) {
+				continue;
+			}
+			// the oldest task of the strand goes first, whatever its lane
+			Entry* pOldest = pEntry;
+			for(int other = 0; other < LANE_COUNT; other++) {
+				for(Entry* pOther = __pQueues[other]; pOther != null; pOther = pOther->pNext) {
+					if(pOther->strand == pEntry->strand && pOther->id < pOldest->id) {
+						pOldest = pOther;
+					}
+				}
+			}
+			// a strand waiting on a background task waits for a background slot, like that task
+			if(pOldest->lane == LANE_BACKGROUND && __backgroundRunning >= MAX_BACKGROUND_WORKERS) {
+				continue;
+			}
+			return pOldest;
+		}
+	}
+	return null;
+}
+
+bool
+TaskScheduler::IsStrandBusy(Strand strand) const
+{
+	for(int i = 0; i < __workerCount; i++) {
+		if(__ppRunning[i] != null && __ppRunning[i]->strand == strand) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+TaskScheduler::Unlink(Entry* pEntry)
+{
+	Entry** ppLink = &__pQueues[pEntry->lane];
+	while(*ppLink != null && *ppLink != pEntry) {
+		ppLink = &(*ppLink)->pNext;
+	}
+	if(*ppLink != null) {
+		*ppLink = pEntry->pNext;
+	}
+	pEntry->pNext = null;
+}
+
+void
+TaskScheduler::Release(Entry* pEntry)
+{
+	delete pEntry->pTask;
+	delete pEntry;
+}
@@ -0,0 +1,151 @@
+#ifndef TASKSCHEDULER_H_
+#define TASKSCHEDULER_H_
+
+#include "Port.h"
+
+using namespace Osp::Base;
+
+// Set by TaskScheduler::Cancel, polled by a task that runs long.
+class CancelToken
+{
+public:
+	CancelToken(void): __cancelled(false) {}
+
+	bool IsCancelled(void) const { return __cancelled; }
+
+private:
+	volatile bool __cancelled;
+
+	friend class TaskScheduler;
+};
+
+// Work handed to the TaskScheduler, which owns and deletes it on the UI thread.
+class ITask
+{
+public:
+	virtual ~ITask() {}
+
+	// On a worker thread, must not touch controls or state the UI thread writes.
+	virtual result Run(const CancelToken& token) = 0;
+	// On the UI thread with the result of Run, not called once the task is cancelled.
+	virtual void OnTaskCompleted(result r) = 0;
+};
+
+// Wakes the UI thread to call TaskScheduler::DeliverCompleted, called on a worker thread.
+class ITaskCompletionPoster
+{
+public:
+	virtual ~ITaskCompletionPoster() {}
+
+	virtual void PostTaskCompletion(void) = 0;
+};
+
+/**
+ * Runs file, database and network preparation off the UI thread on a fixed
+ * pool of worker threads. Queued tasks are taken by lane, what the user
+ * waits for first, and at most one worker runs background work, so a visible
+ * load never waits behind more than the background task in progress. Tasks
+ * of one strand run one at a time in the order they were posted, a strand
+ * task in a higher lane pulls the older ones of its strand ahead. Completed
+ * tasks are handed back with a single user event per batch and their
+ * OnTaskCompleted() runs on the UI thread in DeliverCompleted().
+ * Post, Cancel and DeliverCompleted are called on the UI thread. Before
+ * Setup() and after Shutdown() a posted task runs right away on the caller.
+ */
+class TaskScheduler
+{
+public:
+	enum Lane {
+		// the form on screen waits for it
+		LANE_VISIBLE = 0,
+		// likely to be shown next
+		LANE_PREFETCH = 1,
+		// writes and uploads nobody waits for
+		LANE_BACKGROUND = 2,
+		LANE_COUNT = 3
+	};
+
+	// Tasks of one strand never overlap, 0 is no strand
+	enum Strand {
+		STRAND_NONE = 0,
+		STRAND_REGISTRY = 1,
+		STRAND_TELEMETRY = 2,
+		// BitmapCache files, so a remove never overtakes a queued write
+		STRAND_CACHE = 3,
+		// search.idx and similar.idx, so a load or a build never meets another writing them
+		STRAND_INDEX = 4
+	};
+
+	// 0 is never issued, so it can mark "no task"
+	typedef int TaskId;
+
+	static const int DEFAULT_WORKER_COUNT = 2;
+
+	static result Setup(ITaskCompletionPoster& poster, int workerCount = DEFAULT_WORKER_COUNT);
+	// Cancels the visible and prefetch lanes, finishes the background work and joins the workers
+	static void Shutdown(void);
+
+	static TaskId Post(ITask* pTask, Lane lane, Strand strand = STRAND_NONE);
+	// A queued task is dropped, a running one sees its token set; OnTaskCompleted is not called either way
+	static void Cancel(TaskId id);
+	// Calls OnTaskCompleted of everything finished since the last call
+	static void DeliverCompleted(void);
+
+	// Queued and running tasks, for the profiler
+	static int GetPendingCount(void);
+
+private:
+	struct Entry {
+		ITask* pTask;
+		TaskId id;
+		Lane lane;
+		Strand strand;
+		CancelToken token;
+		result r;
+		Entry* pNext;
+	};
+
+	class Worker;
+	friend class Worker;
+
+	TaskScheduler(ITaskCompletionPoster& poster);
+	~TaskScheduler(void);
+
+	result Construct(int workerCount);
+	void Stop(void);
+
+	TaskId Enqueue(ITask* pTask, Lane lane, Strand strand);
+	void Remove(TaskId id);
+	Entry* DetachCompleted(void);
+
+	// Worker side, null once stopped and drained
+	Entry* Take(int worker);
+	void Complete(int worker, Entry* pEntry);
+	Entry* FindRunnable(void);
+	bool IsStrandBusy(Strand strand) const;
+	void Unlink(Entry* pEntry);
+
+	static void RunInline(ITask* pTask);
+	static void Release(Entry* pEntry);
+
+	static TaskScheduler* __pInstance;
+
+	ITaskCompletionPoster& __poster;
+	Osp::Base::Runtime::Monitor __monitor;
+	Worker** __ppWorkers;
+	// Entry each worker runs, null when idle
+	Entry** __ppRunning;
+	int __workerCount;
+	int __backgroundRunning;
+
+	Entry* __pQueues[LANE_COUNT];
+	Entry* __pCompleted;
+	Entry* __pCompletedTail;
+	// Taken off __pCompleted by DeliverCompleted, UI thread only
+	Entry* __pDelivering;
+	TaskId __lastId;
+	int __pending;
+	bool __stopping;
+};
+
+#endif
@@ -0,0 +1,465 @@
+#include "Telemetry.h"
+
+using namespace Osp::Base;
+using namespace Osp::Base::Runtime;
+using namespace Osp::Base::Collection;
+using namespace Osp::Io;
+using namespace Osp::System;
+
+static const wchar_t* QUEUE_PATH = L"/Home/telemetry.queue";
+static const wchar_t* QUEUE_TMP_PATH = L"/Home/telemetry.tmp";
+// Optional override of the endpoint: host on the first line, uri on the second.
+static const wchar_t* ENDPOINT_PATH = L"/Home/telemetry.endpoint";
+
+static const wchar_t* EVENT_NAMES[] = { L"start", L"view", L"share", L"favourite" };
+
+// One access to the queue file, the result goes back to the Telemetry on the UI thread
+class Telemetry::QueueTask :
+	public ITask
+{
+public:
+	enum Operation {
+		APPEND,
+		READ_BATCH,
+		REMOVE_SENT
+	};
+
+	QueueTask(Telemetry& telemetry, Operation operation, const String& line = L""):
+		__telemetry(telemetry),
+		__operation(operation),
+		__line(line),
+		__count(0),
+		__queueBytes(0)
+	{
+	}
+
+	result Run(const CancelToken& token)
+	{
+		result r = E_SUCCESS;
+		switch(__operation) {
+		case APPEND:
+			r = __telemetry.AppendLine(__line);
+			break;
+		case READ_BATCH:
+			__count = __telemetry.ReadBatch();
+			r = __telemetry.__writer.GetLastResult();
+			break;
+		case REMOVE_SENT:
+			r = __telemetry.RemoveFirstLines(__telemetry.__inFlight);
+			__telemetry.__inFlight = 0;
+			break;
+		}
+		__queueBytes = GetQueueBytes();
+		return r;
+	}
+
+	void OnTaskCompleted(result r)
+	{
+		__telemetry.__queueBytes = __queueBytes;
+		switch(__operation) {
+		case APPEND:
+			__telemetry.ScheduleFlush(FLUSH_DELAY);
+			break;
+		case READ_BATCH:
+			__telemetry.OnBatchRead(r, __count);
+			break;
+		case REMOVE_SENT:
+			__telemetry.__sending = false;
+			// Continue draining a longer queue right away
+			__telemetry.ScheduleFlush(0);
+			break;
+		}
+	}
+
+private:
+	Telemetry& __telemetry;
+	Operation __operation;
+	String __line;
+	int __count;
+	int __queueBytes;
+};
+
+Telemetry* Telemetry::__pInstance = null;
+
+Telemetry::Telemetry():
+	__timerPending(false),
+	__sending(false),
+	__queueBytes(0),
+	__retries(0),
+	__inFlight(0)
+{
+}
+
+Telemetry::~Telemetry()
+{
+	__timer.Cancel();
+}
+
+result
+Telemetry::Setup(void)
+{
+	if(__pInstance != null) {
+		return E_SUCCESS;
+	}
+
+	String hostAddr(L"api.mobigear.ru");
+	String uri(L"api.mobigear.ru/stats");
+
+	if(File::IsFileExist(ENDPOINT_PATH)) {
+		File file;
+		if(!IsFailed(file.Construct(ENDPOINT_PATH, L"r"))) {
+			file.Read(hostAddr);
+			file.Read(uri);
+			hostAddr.Replace("\n", "");
+			uri.Replace("\n", "");
+			AppLog("Telemetry endpoint: %ls %ls", hostAddr.GetPointer(), uri.GetPointer());
+		}
+	}
+
+	__pInstance = new Telemetry();
+	result r = __pInstance->Construct(hostAddr, uri);
+	if(IsFailed(r)) {
+		delete __pInstance;
+		__pInstance = null;
+	}
+	return r;
+}
+
+void
+Telemetry::Shutdown(void)
+{
+	// Unsent events stay in the queue file for the next run
+	delete __pInstance;
+	__pInstance = null;
+}
+
+result
+Telemetry::Construct(const String& hostAddr, const String& uri)
+{
+	result r = __timer.Construct(*this);
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	r = __writer.Construct(MAX_BATCH_BYTES);
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	r = __api.Construct(hostAddr, uri, *this);
+	if(IsFailed(r)) {
+		return r;
+	}
+	__api.CreateBody();
+	if(!File::IsFileExist(QUEUE_PATH) && File::IsFileExist(QUEUE_TMP_PATH)) {
+		File::Move(QUEUE_TMP_PATH, QUEUE_PATH);
+	}
+	__queueBytes = GetQueueBytes();
+
+	return E_SUCCESS;
+}
+
+int
+Telemetry::GetQueueBytes(void)
+{
+	FileAttributes attrs;
+	if(File::GetAttributes(QUEUE_PATH, attrs) == E_SUCCESS) {
+		return (int)attrs.GetFileSize();
+	}
+	return 0;
+}
+
+void
+Telemetry::Track(EventType type, const String& item, const String& channel)
+{
+	if(__pInstance == null) {
+		return;
+	}
+	__pInstance->Append(type, item, channel);
+}
+
+void
+Telemetry::Flush(void)
+{
+	if(__pInstance == null) {
+		return;
+	}
+	__pInstance->ScheduleFlush(0);
+}
+
+void
+Telemetry::Append(EventType type, const String& item, const String& channel)
+{
+	long long ticks = 0;
+	SystemTime::GetTicks(ticks);
+
+	// Items are referenced relative to the catalog root
+	String name(item);
+	if(name.StartsWith(L"/Home/catalog/", 0)) {
+		name.Remove(0, 14);
+	}
+
+	String line;
+	line.Append(ticks);
+	line.Append(L'\t');
+	line.Append(EVENT_NAMES[type]);
+	line.Append(L'\t');
+	line.Append(name);
+	line.Append(L'\t');
+	line.Append(channel);
+	line.Append(L'\n');
+
+	TaskScheduler::Post(new QueueTask(*this, QueueTask::APPEND, line), TaskScheduler::LANE_BACKGROUND, TaskScheduler::STRAND_TELEMETRY);
+}
+
+result
+Telemetry::AppendLine(const String& line)
+{
+	File file;
+	result r = file.Construct(QUEUE_PATH, L"a");
+	if(IsFailed(r)) {
+		AppLog("Telemetry queue open failed by %s", GetErrorMessage(r));
+		return r;
+	}
+	r = file.Write(line);
+	if(IsFailed(r)) {
+		AppLog("Telemetry queue write failed by %s", GetErrorMessage(r));
+		return r;
+	}
+	r = file.Flush();
+
+	if(GetQueueBytes() > MAX_QUEUE_BYTES) {
+		Compact();
+	}
+	return r;
+}
+
+void
+Telemetry::Compact(void)
+{
+	// Keep the newest events that fit into half of the cap, drop the rest
+	ArrayList lines;
+	lines.Construct();
+
+	File in;
+	if(IsFailed(in.Construct(QUEUE_PATH, L"r"))) {
+		return;
+	}
+	String line;
+	while(in.Read(line) == E_SUCCESS) {
+		lines.Add(*(new String(line)));
+	}
+
+	int keepBytes = 0;
+	int first = lines.GetCount();
+	while(first > 0) {
+		int len = static_cast<String*>(lines.GetAt(first - 1))->GetLength();
+		if(keepBytes + len > MAX_QUEUE_BYTES / 2) {
+			break;
+		}
+		keepBytes += len;
+		first--;
+	}
+
+	File out;
+	result r = out.Construct(QUEUE_TMP_PATH, L"w");
+	if(!IsFailed(r)) {
+		for(int i = first; i < lines.GetCount(); i++) {
+			out.Write(*static_cast<String*>(lines.GetAt(i)));
+		}
+		out.Flush();
+		r = ReplaceQueue();
+	}
+	lines.RemoveAll(true);
+
+	if(IsFailed(r)) {
+		AppLog("Telemetry compaction failed by %s", GetErrorMessage(r));
+		return;
+	}
+
+	AppLog("Telemetry dropped %d old events", first);
+	// Events of the batch in flight may have been among the dropped ones
+	__inFlight = (__inFlight > first) ? __inFlight - first : 0;
+}
+
+void
+Telemetry::ScheduleFlush(int delay)
+{
+	if(__timerPending || __sending || __queueBytes == 0) {
+		return;
+	}
+	__timerPending = true;
+	// Timer does not accept a zero timeout
+	__timer.Start(delay > 0 ? delay : 1);
+}
+
+void
+Telemetry::OnTimerExpired(Timer& timer)
+{
+	__timerPending = false;
+	SendBatch();
+}
+
+void
+Telemetry::SendBatch(void)
+{
+	if(__sending || __api.IsBusy()) {
+		return;
+	}
+	__sending = true;
+	TaskScheduler::Post(new QueueTask(*this, QueueTask::READ_BATCH), TaskScheduler::LANE_BACKGROUND, TaskScheduler::STRAND_TELEMETRY);
+}
+
+int
+Telemetry::ReadBatch(void)
+{
+	__inFlight = 0;
+	File file;
+	if(IsFailed(file.Construct(QUEUE_PATH, L"r"))) {
+		return 0;
+	}
+
+	// One preallocated writer is reused for every batch
+	__writer.Clear();
+	__writer.BeginObject();
+	__api.WriteBody(__writer);
+	__writer.Key("events");
+	__writer.BeginArray();
+
+	int count = 0;
+	String line;
+	while(count < BATCH_SIZE && file.Read(line) == E_SUCCESS) {
+		line.Replace("\n", "");
+
+		// time \t action \t item \t channel
+		String fields[4];
+		int start = 0;
+		for(int f = 0; f < 4; f++) {
+			int end = -1;
+			if(f < 3 && line.IndexOf(L'\t', start, end) == E_SUCCESS) {
+				line.SubString(start, end - start, fields[f]);
+				start = end + 1;
+			} else {
+				line.SubString(start, fields[f]);
+				start = line.GetLength();
+			}
+		}
+
+		long long ticks = 0;
+		LongLong::Parse(fields[0], ticks);
+
+		JsonWriter::Checkpoint checkpoint = __writer.GetCheckpoint();
+		__writer.BeginObject();
+		__writer.Member("time", ticks);
+		__writer.Member("action", fields[1]);
+		if(fields[2].GetLength() > 0) {
+			__writer.Member("item", fields[2]);
+		}
+		if(fields[3].GetLength() > 0) {
+			__writer.Member("channel", fields[3]);
+		}
+		__writer.EndObject();
+
+		// Leave the event for the next batch when it does not fit
+		if(count > 0 && __writer.GetLength() > MAX_BATCH_BYTES - 2) {
+			__writer.Rollback(checkpoint);
+			break;
+		}
+		count++;
+	}
+	__writer.EndArray();
+	__writer.EndObject();
+
+	__inFlight = count;
+	return count;
+}
+
+void
+Telemetry::OnBatchRead(result r, int count)
+{
+	if(count == 0) {
+		__sending = false;
+		return;
+	}
+	if(IsFailed(r)) {
+		OnPostFailed(r);
+		return;
+	}
+
+	r = __api.POST(__writer.GetPointer(), __writer.GetLength());
+	if(IsFailed(r)) {
+		OnPostFailed(r);
+	}
+}
+
+result
+Telemetry::RemoveFirstLines(int count)
+{
+	File in;
+	result r = in.Construct(QUEUE_PATH, L"r");
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	File out;
+	r = out.Construct(QUEUE_TMP_PATH, L"w");
+	if(IsFailed(r)) {
+		return r;
+	}
+
+	int index = 0;
+	String line;
+	while(in.Read(line) == E_SUCCESS) {
+		if(index++ < count) {
+			continue;
+		}
+		out.Write(line);
+	}
+	out.Flush();
+
+	return ReplaceQueue();
+}
+
+result
+Telemetry::ReplaceQueue(void)
+{
+	// Move does not overwrite; an exit in between leaves the new queue aside, Construct() moves it in
+	File::Remove(QUEUE_PATH);
+	return File::Move(QUEUE_TMP_PATH, QUEUE_PATH);
+}
+
+void
+Telemetry::OnPostCompleted(int statusCode)
+{
+	if(statusCode >= 200 && statusCode < 300) {
+		__retries = 0;
+	} else if(statusCode >= 400 && statusCode < 500) {
+		// The server rejected the batch, resending it would not help
+		AppLog("Telemetry batch rejected with %d", statusCode);
+		__retries = 0;
+	} else {
+		OnPostFailed(E_FAILURE);
+		return;
+	}
+
+	TaskScheduler::Post(new QueueTask(*this, QueueTask::REMOVE_SENT), TaskScheduler::LANE_BACKGROUND, TaskScheduler::STRAND_TELEMETRY);
+}
+
+void
+Telemetry::OnPostFailed(result r)
+{
+	// the batch stays at the head of the queue and is read again
+	__sending = false;
+
+	int delay = BACKOFF_BASE;
+	for(int i = 0; i < __retries && delay < BACKOFF_MAX; i++) {
+		delay *= 2;
+	}
+	if(delay > BACKOFF_MAX) {
+		delay = BACKOFF_MAX;
+	}
+	__retries++;
+
+	AppLog("Telemetry send failed by %s, retry in %d ms", GetErrorMessage(r), delay);
+	ScheduleFlush(delay);
+}
@@ -0,0 +1,86 @@
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include "Port.h"
+#include "JsonWriter.h"
+#include "StartAPI.h"
+#include "TaskScheduler.h"
+
+using namespace Osp::Io;
+using namespace Osp::Base;
+using namespace Osp::Base::Collection;
+
+/**
+ * Usage statistics. Events are appended to a queue file in /Home and sent
+ * in batches over a single StartAPI session; the queue survives restarts and
+ * failed uploads are retried with exponential backoff. Every access to the
+ * queue file runs in a task on the telemetry strand of the TaskScheduler,
+ * the timer and the upload stay on the UI thread.
+ */
+class Telemetry :
+	public IStartAPIListener,
+	public Osp::Base::Runtime::ITimerEventListener
+{
+public:
+	enum EventType {
+		EVENT_START = 0,
+		EVENT_VIEW = 1,
+		EVENT_SHARE = 2,
+		EVENT_FAVOURITE = 3
+	};
+
+	static result Setup(void);
+	static void Shutdown(void);
+
+	static void Track(EventType type, const String& item = L"", const String& channel = L"");
+	static void Flush(void);
+
+private:
+	Telemetry();
+	virtual ~Telemetry();
+
+	result Construct(const String& hostAddr, const String& uri);
+
+	class QueueTask;
+	friend class QueueTask;
+
+	void Append(EventType type, const String& item, const String& channel);
+	void ScheduleFlush(int delay);
+	void SendBatch(void);
+	void OnBatchRead(result r, int count);
+
+	// Queue file work, on the telemetry strand
+	result AppendLine(const String& line);
+	void Compact(void);
+	int ReadBatch(void);
+	result RemoveFirstLines(int count);
+	result ReplaceQueue(void);
+	static int GetQueueBytes(void);
+
+	void OnPostCompleted(int statusCode);
+	void OnPostFailed(result r);
+	void OnTimerExpired(Osp::Base::Runtime::Timer& timer);
+
+	static const int MAX_QUEUE_BYTES = 32 * 1024;
+	static const int BATCH_SIZE = 20;
+	static const int MAX_BATCH_BYTES = 4 * 1024;
+	static const int FLUSH_DELAY = 10 * 1000;
+	static const int BACKOFF_BASE = 30 * 1000;
+	static const int BACKOFF_MAX = 30 * 60 * 1000;
+
+	static Telemetry* __pInstance;
+
+	StartAPI __api;
+	JsonWriter __writer;
+	Osp::Base::Runtime::Timer __timer;
+	bool __timerPending;
+	// a batch is being read, posted or removed
+	bool __sending;
+	// as of the last queue task
+	int __queueBytes;
+	int __retries;
+	// Strand side: events of the batch in flight at the head of the queue, the writer holds the batch
+	int __inFlight;
+};
+
+#endif
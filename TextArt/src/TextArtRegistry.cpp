@@ -1,4 +1,221 @@
 #include "TextArtRegistry.h"
 
+#include "JournalStore.h"
+
+static const mchar STORE_PATH[] = L"/Home/registry";
+static const mchar STORE_SNAPSHOT_PATH[] = L"/Home/registry.snapshot";
+// Of the versions before the store
+static const mchar DATABASE_PATH[] = L"/Home/textart";
+
 bool TextArtRegistry::updaterecent = true;
 bool TextArtRegistry::updatefavourites = true;
+JournalStore* TextArtRegistry::__pStore = null;
+
+// One registry write, nobody waits for its completion
+class RegistryWriteTask :
+	public ITask
+{
+public:
+	enum Operation {
+		OPEN,
+		ADD_RECENT,
+		ADD_FAVOURITE,
+		REMOVE_FAVOURITE
+	};
+
+	RegistryWriteTask(Operation operation, const String& value):
+		__operation(operation),
+		__value(value)
+	{
+	}
+
+	result Run(const CancelToken& token)
+	{
+		switch(__operation) {
+		case OPEN:
+			break;
+		case ADD_RECENT:
+			return TextArtRegistry::WriteRecent(__value);
+		case ADD_FAVOURITE:
+			return TextArtRegistry::WriteFavourite(__value);
+		case REMOVE_FAVOURITE:
+			return TextArtRegistry::EraseFavourite(__value);
+		}
+		return E_SUCCESS;
+	}
+
+	void OnTaskCompleted(result r)
+	{
+		if(IsFailed(r)) {
+			AppLog("Registry write %d failed by %s", __operation, GetErrorMessage(r));
+		}
+	}
+
+private:
+	Operation __operation;
+	String __value;
+};
+
+static void
+PostWrite(RegistryWriteTask::Operation operation, const String& value)
+{
+	TaskScheduler::Post(new RegistryWriteTask(operation, value), TaskScheduler::LANE_BACKGROUND, TaskScheduler::STRAND_REGISTRY);
+}
+
+void
+TextArtRegistry::Setup()
+{
+	updaterecent = true;
+	updatefavourites = true;
+	// opens the store off the UI thread
+	PostWrite(RegistryWriteTask::OPEN, String());
+}
+
+void
+TextArtRegistry::Shutdown()
+{
+	delete __pStore;
+	__pStore = null;
+}
+
+void
+TextArtRegistry::AddRecent(const String& value)
+{
+	updaterecent = true;
+	PostWrite(RegistryWriteTask::ADD_RECENT, value);
+}
+
+void
+TextArtRegistry::AddFavourite(const String& value)
+{
+	updatefavourites = true;
+	PostWrite(RegistryWriteTask::ADD_FAVOURITE, value);
+}
+
+void
+TextArtRegistry::RemoveFavourite(const String& value)
+{
+	updatefavourites = true;
+	PostWrite(RegistryWriteTask::REMOVE_FAVOURITE, value);
+}
+
+ArrayList*
+TextArtRegistry::GetRecent()
+{
+	PROFILE_SCOPE("TextArtRegistry::GetRecent");
+	return GetKeysN(COLLECTION_RECENT);
+}
+
+ArrayList*
+TextArtRegistry::GetFavourites()
+{
+	PROFILE_SCOPE("TextArtRegistry::GetFavourites");
+	return GetKeysN(COLLECTION_FAVOURITES);
+}
+
+result
+TextArtRegistry::WriteRecent(const String& value)
+{
+	JournalStore* pStore = GetStore();
+	return pStore != null ? pStore->Put(COLLECTION_RECENT, value) : E_INVALID_STATE;
+}
+
+result
+TextArtRegistry::WriteFavourite(const String& value)
+{
+	JournalStore* pStore = GetStore();
+	if(pStore == null) {
+		return E_INVALID_STATE;
+	}
+	// the first time counts, as the favourites are shown in the order they were added
+	return pStore->Find(COLLECTION_FAVOURITES, value) < 0 ? pStore->Put(COLLECTION_FAVOURITES, value) : E_SUCCESS;
+}
+
+result
+TextArtRegistry::EraseFavourite(const String& value)
+{
+	JournalStore* pStore = GetStore();
+	if(pStore == null) {
+		return E_INVALID_STATE;
+	}
+	result r = pStore->Remove(COLLECTION_FAVOURITES, value);
+	return r == E_OBJ_NOT_FOUND ? E_SUCCESS : r;
+}
+
+JournalStore*
+TextArtRegistry::GetStore()
+{
+	if(__pStore != null) {
+		return __pStore;
+	}
+	bool migrate = !File::IsFileExist(STORE_SNAPSHOT_PATH) && File::IsFileExist(DATABASE_PATH);
+	JournalStore* pStore = new JournalStore();
+	pStore->SetLimit(COLLECTION_RECENT, MAX_RECENT, JournalStore::LIMIT_DROP_OLDEST);
+	pStore->SetLimit(COLLECTION_FAVOURITES, MAX_FAVOURITES, JournalStore::LIMIT_REFUSE);
+	result r = pStore->Construct(STORE_PATH);
+	if(IsFailed(r)) {
+		AppLog("Registry store not opened: %s", GetErrorMessage(r));
+		delete pStore;
+		return null;
+	}
+	if(migrate) {
+		Migrate(*pStore);
+	}
+	__pStore = pStore;
+	return __pStore;
+}
+
+void
+TextArtRegistry::Migrate(JournalStore& store)
+{
+	PROFILE_SCOPE("TextArtRegistry::Migrate");
+	static const mchar* const QUERIES[] = {
+		L"SELECT ancii FROM recent ORDER BY id ASC",
+		L"SELECT ancii FROM favourites ORDER BY id ASC"
+	};
+	static const StoreCollection COLLECTIONS[] = { COLLECTION_RECENT, COLLECTION_FAVOURITES };
+
+	{
+		Database database;
+		result r = database.Construct(DATABASE_PATH, false);
+		if(IsFailed(r)) {
+			AppLog("Registry database not migrated: %s", GetErrorMessage(r));
+			return;
+		}
+		for(int i = 0; i < 2; i++) {
+			DbStatement* pStmt = database.CreateStatementN(QUERIES[i]);
+			DbEnumerator* pEnum = pStmt != null ? database.ExecuteStatementN(*pStmt) : null;
+			// oldest first, so the store keeps the order
+			while(pEnum != null && pEnum->MoveNext() == E_SUCCESS) {
+				String item;
+				if(!IsFailed(pEnum->GetStringAt(0, item)) && item.GetLength() > 0) {
+					store.Put(COLLECTIONS[i], item);
+				}
+			}
+			delete pEnum;
+			delete pStmt;
+		}
+	}
+	// one snapshot instead of a journal of every row
+	result r = store.Compact();
+	if(!IsFailed(r)) {
+		File::Remove(DATABASE_PATH);
+	}
+	AppLog("Registry migrated %d recent and %d favourites: %s", store.GetCount(COLLECTION_RECENT),
+			store.GetCount(COLLECTION_FAVOURITES), GetErrorMessage(r));
+}
+
+ArrayList*
+TextArtRegistry::GetKeysN(StoreCollection collection)
+{
+	ArrayList* pData = new ArrayList;
+	pData->Construct();
+	JournalStore* pStore = GetStore();
+	if(pStore != null) {
+		int count = pStore->GetCount(collection);
+		for(int i = 0; i < count; i++) {
+			pData->Add(*(new String(pStore->GetKey(collection, i))));
+		}
+	}
+	return pData;
+}
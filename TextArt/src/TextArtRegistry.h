@@ -1,223 +1,64 @@
 #ifndef TEXTARTREGISTRY_H_
 #define TEXTARTREGISTRY_H_
 
-#include <FBase.h>
-#include <FIo.h>
+#include "Port.h"
+
+#include "Debug.h"
+#include "TaskScheduler.h"
 
 using namespace Osp::Io;
 using namespace Osp::Base;
 using namespace Osp::Base::Collection;
 
+class JournalStore;
+
+/**
+ * Recent and favourite items, kept in a JournalStore at /Home/registry so a
+ * change is one appended record. The Add and Remove calls and Setup() queue
+ * their write on the registry strand of the TaskScheduler and return at
+ * once; GetRecent() and GetFavourites() read right away and run in tasks on
+ * the same strand, so they see every write queued before them. The store is
+ * opened by the first of them, taking over the lists of the SQLite
+ * /Home/textart of earlier versions. The update flags are set by the writes
+ * and cleared by the forms, on the UI thread.
+ */
 class TextArtRegistry {
 public:
+	static const int MAX_RECENT = 9;
+	// Further favourites are refused until some are removed
+	static const int MAX_FAVOURITES = 500;
 
 	static bool updaterecent;
 	static bool updatefavourites;
 
-	static result Setup() {
-		updaterecent = true;
-		updatefavourites = true;
-
-		Database database;
-
-		String dbName(L"/Home/textart");
-		String sql, sql2;
-
-		result r = E_SUCCESS;
-
-		r = database.Construct(dbName, true);
-
-		// create database table
-		sql.Append(L"CREATE TABLE IF NOT EXISTS recent ( id INTEGER PRIMARY KEY AUTOINCREMENT, ancii TEXT )");
-		sql2.Append(L"CREATE TABLE IF NOT EXISTS favourites ( id INTEGER PRIMARY KEY AUTOINCREMENT, ancii TEXT UNIQUE )");
-		r = database.ExecuteSql(sql, true);
-		r = database.ExecuteSql(sql2, true);
-
-		return r;
-	}
-
-	static void AddRecent(String value) {
-		updaterecent = true;
-
-		Database database;
-
-		String dbName(L"/Home/textart");
-		String statement, sql2, sql3;
-		DbStatement* pStmt;
-		DbEnumerator* pEnum;
-
-		result r = E_SUCCESS;
-
-		r = database.Construct(dbName, true);
-
-		// DELETE
-		database.BeginTransaction();
-		sql2.Append(L"DELETE FROM recent WHERE ancii = ?");
-		pStmt = database.CreateStatementN(sql2);
-		pStmt->BindString(0, value);
-		pEnum = database.ExecuteStatementN(*pStmt);
-		database.CommitTransaction();
-
-		// INSERT
-		database.BeginTransaction();
-		statement.Append(L"INSERT INTO recent (ancii) VALUES (?)");
-		pStmt = database.CreateStatementN(statement);
-		pStmt->BindString(0, value);
-		pEnum = database.ExecuteStatementN(*pStmt);
-		database.CommitTransaction();
-
-		// DELETE
-		database.BeginTransaction();
-		sql3.Append(L"DELETE FROM recent WHERE id in (SELECT id FROM recent ORDER BY id DESC LIMIT 9, 1)");
-		r = database.ExecuteSql(sql3, true);
-		database.CommitTransaction();
-
-		delete pStmt;
-		delete pEnum;
-	}
-
-	static ArrayList* GetRecent() {
-		ArrayList *data = new ArrayList;
-		data->Construct();
-
-		result r = E_SUCCESS;
-
-		if(updaterecent) {
-
-			Database database;
-
-			String dbName(L"/Home/textart");
-			String sql;
-
-
-			r = database.Construct(dbName, true);
-
-			sql.Append(L"SELECT ancii FROM recent ORDER BY id DESC");
-
-			DbStatement* pStmt;
-			pStmt = database.CreateStatementN(sql);
-
-			DbEnumerator* pEnum;
-			pEnum = database.ExecuteStatementN(*pStmt);
-			if(pEnum) {
-				updaterecent = false;
-				pEnum->Reset();
-				r = pEnum->MoveNext();
-				while(r != E_OUT_OF_RANGE) {
-					String item;
-					pEnum->GetStringAt(0, item);
-					data->Add(*(new String(item)));
-					r = pEnum->MoveNext();
-				}
-
-				delete pEnum;
-			}
-
-			delete pStmt;
-
-		}
-
-		return data;
-	}
-
-
-	static void AddFavourite(String value) {
-		updatefavourites = true;
-
-		Database database;
-
-		String dbName(L"/Home/textart");
-		String statement, sql2;
-		DbStatement* pStmt;
-		DbEnumerator* pEnum;
-
-		result r = E_SUCCESS;
-
-		r = database.Construct(dbName, true);
-
-		// DELETE
-
-		// INSERT
-		database.BeginTransaction();
-		statement.Append(L"INSERT OR IGNORE INTO favourites (ancii) VALUES (?)");
-		pStmt = database.CreateStatementN(statement);
-		pStmt->BindString(0, value);
-		pEnum = database.ExecuteStatementN(*pStmt);
-		database.CommitTransaction();
-
-		delete pStmt;
-		delete pEnum;
-	}
-
-
-	static ArrayList* GetFavourites() {
-		ArrayList *data = new ArrayList;
-		data->Construct();
-
-		result r = E_SUCCESS;
-
-		if(updatefavourites) {
-
-			Database database;
-
-			String dbName(L"/Home/textart");
-			String sql;
-
-
-			r = database.Construct(dbName, true);
-
-			sql.Append(L"SELECT ancii FROM favourites ORDER BY id DESC");
-
-			DbStatement* pStmt;
-			pStmt = database.CreateStatementN(sql);
-
-			DbEnumerator* pEnum;
-			pEnum = database.ExecuteStatementN(*pStmt);
-			if(pEnum) {
-				updatefavourites = false;
-				pEnum->Reset();
-				r = pEnum->MoveNext();
-				while(r != E_OUT_OF_RANGE) {
-					String item;
-					pEnum->GetStringAt(0, item);
-					data->Add(*(new String(item)));
-					r = pEnum->MoveNext();
-				}
-				delete pEnum;
-			}
-
-			delete pStmt;
-
-		}
-
-		return data;
-	}
-
-	static void RemoveFavourite(String value) {
-		updatefavourites = true;
-		Database database;
-
-		String dbName(L"/Home/textart");
-		String sql;
-		DbStatement* pStmt;
-		DbEnumerator* pEnum;
-
-		result r = E_SUCCESS;
-
-		r = database.Construct(dbName, true);
-
-		// DELETE
-		database.BeginTransaction();
-		sql.Append(L"DELETE FROM favourites WHERE ancii = ?");
-		pStmt = database.CreateStatementN(sql);
-		pStmt->BindString(0, value);
-		pEnum = database.ExecuteStatementN(*pStmt);
-		database.CommitTransaction();
-
-		delete pStmt;
-		delete pEnum;
-	}
-
+	static void Setup();
+	// After TaskScheduler::Shutdown(), which runs the queued writes
+	static void Shutdown();
+	static void AddRecent(const String& value);
+	static void AddFavourite(const String& value);
+	static void RemoveFavourite(const String& value);
+
+	// Newest first, run in tasks on TaskScheduler::STRAND_REGISTRY
+	static ArrayList* GetRecent();
+	static ArrayList* GetFavourites();
+
+	// The writes themselves, on the same strand
+	static result WriteRecent(const String& value);
+	static result WriteFavourite(const String& value);
+	static result EraseFavourite(const String& value);
+
+private:
+	enum StoreCollection {
+		COLLECTION_RECENT = 0,
+		COLLECTION_FAVOURITES = 1
+	};
+
+	// Opens the store on first use, null when it could not be
+	static JournalStore* GetStore();
+	static void Migrate(JournalStore& store);
+	static ArrayList* GetKeysN(StoreCollection collection);
+
+	static JournalStore* __pStore;
 };
 
 #endif
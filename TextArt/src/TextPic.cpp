@@ -8,10 +8,19 @@
 
 #include "TextPic.h"
 #include "FormManager.h"
+#include "FrameMonitor.h"
+#include "ArtExporter.h"
+#include "Atlas.h"
 
+#include "Catalog.h"
+#include "ContentSync.h"
 #include "Retina.h"
+#include "StartSnapshot.h"
+#include "StringTable.h"
+#include "TaskScheduler.h"
 #include "TextArtRegistry.h"
-#include "StartAPI.h"
+#include "Telemetry.h"
+#include "Debug.h"
 
 #include <FLocales.h>
 
@@ -88,12 +97,21 @@ TextPic::OnAppInitializing(AppRegistry& appRegistry)
 	} else if (lc == LANGUAGE_FRM || lc == LANGUAGE_FRO || lc == LANGUAGE_FRA) {
 		TextPic::__InternalAppLanguageIndex = TextPic::EInternalAppLanguage_FR;
 	}
+	SetLanguage(TextPic::__InternalAppLanguageIndex);
 
 	Retina::Setup();
+	// a content update cut short by an exit is finished before the catalog is read
+	if(ContentSync::IsInterrupted()) {
+		StartSnapshot::Invalidate();
+		ContentSync::Recover();
+	}
+	TaskScheduler::Setup(*this);
 	TextArtRegistry::Setup();
+	ArtExporter::PruneCache();
 
-	StartAPI* _pStartAPI = new StartAPI();
-	_pStartAPI->CreateBody();
+	Telemetry::Setup();
+	Telemetry::Track(Telemetry::EVENT_START);
+	FrameMonitor::Setup();
 
 
 	FormManager *pFormMgr = new FormManager();
@@ -110,6 +128,13 @@ TextPic::OnAppTerminating(AppRegistry& appRegistry, bool forcedTermination)
 	// TODO:
 	// Deallocate resources allocated by this application for termination.
 	// The application's permanent data and context can be saved via appRegistry.
+	// queued registry writes and telemetry events are written before the queue goes
+	TaskScheduler::Shutdown();
+	TextArtRegistry::Shutdown();
+	Telemetry::Shutdown();
+	FrameMonitor::Shutdown();
+	Atlas::Shutdown();
+	PROFILE_EXPORT();
 	return true;
 }
 
@@ -118,6 +143,8 @@ TextPic::OnForeground(void)
 {
 	// TODO:
 	// Start or resume drawing when the application is moved to the foreground.
+	Telemetry::Flush();
+	SendCatalogRequest(FormManager::REQUEST_CATALOGSCAN);
 }
 
 void
@@ -125,6 +152,38 @@ TextPic::OnBackground(void)
 {
 	// TODO:
 	// Stop drawing when the application is moved to the background.
+	PROFILE_EXPORT();
+	FrameMonitor::Dump();
+	// content packs copied while away show up on return
+	SendCatalogRequest(FormManager::REQUEST_CATALOGRECORD);
+}
+
+void
+TextPic::SendCatalogRequest(RequestId requestId)
+{
+	Frame* pFrame = GetAppFrame()->GetFrame();
+	FormManager* pFormMgr = static_cast<FormManager*>(pFrame->GetControl("FormManager"));
+	if(pFormMgr != null) {
+		pFormMgr->SendUserEvent(requestId, null);
+	}
+}
+
+void
+TextPic::PostTaskCompletion(void)
+{
+	SendUserEvent(REQUEST_TASKSCOMPLETED, null);
+}
+
+void
+TextPic::OnUserEventReceivedN(RequestId requestId, Osp::Base::Collection::IList* pArgs)
+{
+	if(requestId == REQUEST_TASKSCOMPLETED) {
+		TaskScheduler::DeliverCompleted();
+	}
+	if(pArgs != null) {
+		pArgs->RemoveAll(true);
+		delete pArgs;
+	}
 }
 
 void
@@ -159,29 +218,13 @@ TextPic::OnScreenOff (void)
 }
 
 result TextPic::GetTranslated(String& fullString) {
-	int i = -1;
-	int cursor = 0;
-	while (cursor != TextPic::__InternalAppLanguageIndex && fullString.IndexOf('|', i + 1, i) == E_SUCCESS) {
-		cursor++;
-	}
+	return Catalog::GetTranslated(fullString, TextPic::__InternalAppLanguageIndex);
+}
 
-	int end = -1;
-	if (fullString.IndexOf('|', i + 1, end) == E_SUCCESS) { //start or in the line
-		if (cursor == 0 && end == 1) { //first language is empty
-			return E_FAILURE;
-		}
-
-		result r = fullString.SubString(i + 1, end - i - 1, fullString);
-		if (IsFailed(r) || fullString.GetLength() == 0) {
-			return E_FAILURE;
-		}
-		return E_SUCCESS;
-	} else if (i + 1 + 1 < fullString.GetLength()) { //at the end of line; +1 '\n'
-		result r = fullString.SubString(i + 1, fullString.GetLength() - i - 1, fullString);
-		if (IsFailed(r) || fullString.GetLength() == 0) {
-			return E_FAILURE;
-		}
-		return E_SUCCESS;
-	}
-	return E_FAILURE;//finished
+void
+TextPic::SetLanguage(InternalAppLanguageEnum language)
+{
+	__InternalAppLanguageIndex = language;
+	// Only Russian and English are translated, AppResource fell back to English too
+	StringTable::Setup(language == EInternalAppLanguage_RU ? L"rus-RU" : L"eng-GB");
 }
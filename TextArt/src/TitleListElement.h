@@ -1,6 +1,10 @@
 #include <FBase.h>
 #include <FUi.h>
 
+#include "Debug.h"
+#include "FrameMonitor.h"
+#include "ItemStore.h"
+
 using namespace Osp::Base;
 using namespace Osp::Graphics;
 using namespace Osp::Ui::Controls;
@@ -11,6 +15,9 @@ private:
 	Font* __pFont;
 	String pic;
 	int fontsize;
+	bool __ownFont;
+	const ItemStore* __pStore;
+	int __index;
 
 public:
 	TitleListElement(String picture, int fs) {
@@ -18,13 +25,28 @@ public:
 		fontsize = fs;
 		__pFont = new Font();
 		__pFont->Construct(FONT_STYLE_PLAIN, fontsize);
+		__ownFont = true;
+		__pStore = null;
+		__index = 0;
+	}
+	// text is read from the store when drawn, store and font must outlive the element
+	TitleListElement(const ItemStore& store, int index, Font& font) {
+		__pStore = &store;
+		__index = index;
+		fontsize = font.GetSize();
+		__pFont = &font;
+		__ownFont = false;
 	}
 
 	~TitleListElement() {
-		delete __pFont;
+		if(__ownFont) {
+			delete __pFont;
+		}
 	}
 
 	result DrawElement(const Osp::Graphics::Canvas& canvas, const Osp::Graphics::Rectangle& rect, CustomListItemStatus itemStatus) {
+		PROFILE_SCOPE("TitleListElement::DrawElement");
+		FRAME_ELEMENT(FrameMonitor::ELEMENT_TITLE, __pStore, __index);
 		result r = E_SUCCESS;
 		Canvas* pCanvas = const_cast<Canvas*> (&canvas);
 
@@ -34,7 +56,13 @@ public:
 		titleText.SetHorizontalAlignment(TEXT_ALIGNMENT_RIGHT);
 
 		TextElement titleTextElement;
-		titleTextElement.Construct(pic);
+		if(__pStore != null) {
+			String title;
+			__pStore->GetTitle(__index, title);
+			titleTextElement.Construct(title);
+		} else {
+			titleTextElement.Construct(pic);
+		}
 		if (itemStatus == CUSTOM_LIST_ITEM_STATUS_SELECTED) {
 			titleTextElement.SetTextColor(Osp::Ui::Controls::SYSTEM_COLOR_LIST_ITEM_PRESSED_TEXT);
 		} else {
@@ -0,0 +1,315 @@
+/**
+ * Packs the UI images listed in tools/atlas/atlas.txt into one atlas for
+ * Res/ScreenDensity-High/atlas.png. Every image is scaled down to the size
+ * it is shown at on the 480 wide screen, then placed on shelves by height.
+ * Writes src/AtlasIds.h (one enum constant per image) and src/AtlasData.h
+ * (the rectangle of every image and a hash of the atlas pixels, which
+ * tells Atlas a cached decoded atlas is out of date). Ids follow the list,
+ * so the output is stable.
+ *
+ *   make atlas
+ *   ./atlas-gen atlas/atlas.txt ../Res/ScreenDensity-High/atlas.png ../src
+ */
+
+#include <png.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// The atlas is for the 480 wide screen, sizes in atlas.txt are for the 240 wide one
+static const int ATLAS_SCALE = 2;
+
+struct Image {
+	std::string file;
+	std::string id;
+	int width;
+	int height;
+	// RGBA, 4 bytes per pixel
+	std::vector<unsigned char> pixels;
+	int x;
+	int y;
+};
+
+static std::string
+ToIdentifier(const std::string& name)
+{
+	std::string identifier = "ATLAS_";
+	for(size_t i = 0; i < name.size() && name.compare(i, std::string::npos, ".png") != 0; i++) {
+		char c = name[i];
+		if(c >= 'a' && c <= 'z') {
+			identifier.push_back((char)(c - 'a' + 'A'));
+		} else if((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+			identifier.push_back(c);
+		} else {
+			identifier.push_back('_');
+		}
+	}
+	return identifier;
+}
+
+static bool
+ReadPng(const std::string& path, int& width, int& height, std::vector<unsigned char>& pixels)
+{
+	png_image image;
+	memset(&image, 0, sizeof(image));
+	image.version = PNG_IMAGE_VERSION;
+	if(!png_image_begin_read_from_file(&image, path.c_str())) {
+		fprintf(stderr, "%s: %s\n", path.c_str(), image.message);
+		return false;
+	}
+	image.format = PNG_FORMAT_RGBA;
+	width = image.width;
+	height = image.height;
+	pixels.resize(PNG_IMAGE_SIZE(image));
+	if(!png_image_finish_read(&image, NULL, &pixels[0], 0, NULL)) {
+		fprintf(stderr, "%s: %s\n", path.c_str(), image.message);
+		return false;
+	}
+	return true;
+}
+
+static bool
+WritePng(const std::string& path, int width, int height, const std::vector<unsigned char>& pixels)
+{
+	png_image image;
+	memset(&image, 0, sizeof(image));
+	image.version = PNG_IMAGE_VERSION;
+	image.width = width;
+	image.height = height;
+	image.format = PNG_FORMAT_RGBA;
+	if(!png_image_write_to_file(&image, path.c_str(), 0, &pixels[0], 0, NULL)) {
+		fprintf(stderr, "%s: %s\n", path.c_str(), image.message);
+		return false;
+	}
+	return true;
+}
+
+// Box filter over premultiplied colour, so transparent pixels do not darken the edges
+static void
+Scale(int width, int height, const std::vector<unsigned char>& pixels, int toWidth, int toHeight, std::vector<unsigned char>& scaled)
+{
+	scaled.assign(toWidth * toHeight * 4, 0);
+	for(int y = 0; y < toHeight; y++) {
+		int y0 = y * height / toHeight;
+		int y1 = std::max(y0 + 1, (y + 1) * height / toHeight);
+		for(int x = 0; x < toWidth; x++) {
+			int x0 = x * width / toWidth;
+			int x1 = std::max(x0 + 1, (x + 1) * width / toWidth);
+			double sum[4] = { 0, 0, 0, 0 };
+			for(int sy = y0; sy < y1; sy++) {
+				for(int sx = x0; sx < x1; sx++) {
+					const unsigned char* pPixel = &pixels[(sy * width + sx) * 4];
+					double alpha = pPixel[3];
+					sum[0] += pPixel[0] * alpha;
+					sum[1] += pPixel[1] * alpha;
+					sum[2] += pPixel[2] * alpha;
+					sum[3] += alpha;
+				}
+			}
+			int count = (x1 - x0) * (y1 - y0);
+			unsigned char* pOut = &scaled[(y * toWidth + x) * 4];
+			for(int c = 0; c < 3; c++) {
+				pOut[c] = sum[3] > 0 ? (unsigned char)(sum[c] / sum[3] + 0.5) : 0;
+			}
+			pOut[3] = (unsigned char)(sum[3] / count + 0.5);
+		}
+	}
+}
+
+static bool
+ReadList(const std::string& path, std::vector<Image>& images)
+{
+	FILE* pFile = fopen(path.c_str(), "r");
+	if(pFile == NULL) {
+		fprintf(stderr, "cannot read %s\n", path.c_str());
+		return false;
+	}
+	std::string dir = path.substr(0, path.find_last_of('/') + 1);
+	char line[512];
+	bool ok = true;
+	while(ok && fgets(line, sizeof(line), pFile) != NULL) {
+		char file[256];
+		int points = 0;
+		if(line[0] == '#' || sscanf(line, "%255s %d", file, &points) != 2) {
+			continue;
+		}
+		Image image;
+		image.file = file;
+		image.id = ToIdentifier(file);
+		image.x = 0;
+		image.y = 0;
+		int width = 0;
+		int height = 0;
+		std::vector<unsigned char> pixels;
+		ok = ReadPng(dir + file, width, height, pixels);
+		if(ok) {
+			// the longer side gets the size, the other one keeps the aspect
+			int size = points * ATLAS_SCALE;
+			image.width = width >= height ? size : std::max(1, width * size / height);
+			image.height = height >= width ? size : std::max(1, height * size / width);
+			Scale(width, height, pixels, image.width, image.height, image.pixels);
+			images.push_back(image);
+		}
+	}
+	fclose(pFile);
+	return ok;
+}
+
+static bool
+TallerFirst(const Image* pLeft, const Image* pRight)
+{
+	if(pLeft->height != pRight->height) {
+		return pLeft->height > pRight->height;
+	}
+	return pLeft->width > pRight->width;
+}
+
+// Shelves of images sorted by height, returns the height for the width
+static int
+Pack(std::vector<Image*>& order, int width)
+{
+	int x = 0;
+	int y = 0;
+	int shelf = 0;
+	for(size_t i = 0; i < order.size(); i++) {
+		Image& image = *order[i];
+		if(x + image.width > width) {
+			x = 0;
+			y += shelf;
+			shelf = 0;
+		}
+		image.x = x;
+		image.y = y;
+		x += image.width;
+		shelf = std::max(shelf, image.height);
+	}
+	return y + shelf;
+}
+
+static unsigned int
+Hash(int width, int height, const std::vector<unsigned char>& pixels)
+{
+	unsigned int hash = 2166136261u;
+	int header[2] = { width, height };
+	const unsigned char* pHeader = (const unsigned char*)header;
+	for(size_t i = 0; i < sizeof(header); i++) {
+		hash = (hash ^ pHeader[i]) * 16777619u;
+	}
+	for(size_t i = 0; i < pixels.size(); i++) {
+		hash = (hash ^ pixels[i]) * 16777619u;
+	}
+	return hash;
+}
+
+static bool
+WriteIds(const std::string& path, const std::vector<Image>& images)
+{
+	FILE* pFile = fopen(path.c_str(), "w");
+	if(pFile == NULL) {
+		return false;
+	}
+	fprintf(pFile, "// Generated by tools/AtlasGen from tools/atlas/atlas.txt - do not modify by hand.\n\n");
+	fprintf(pFile, "#ifndef ATLASIDS_H_\n#define ATLASIDS_H_\n\n");
+	fprintf(pFile, "enum AtlasImage {\n");
+	for(size_t i = 0; i < images.size(); i++) {
+		fprintf(pFile, "\t%s = %lu,\n", images[i].id.c_str(), (unsigned long)i);
+	}
+	fprintf(pFile, "\tATLAS_IMAGE_COUNT = %lu\n};\n\n#endif\n", (unsigned long)images.size());
+	return fclose(pFile) == 0;
+}
+
+static bool
+WriteData(const std::string& path, const std::string& file, const std::vector<Image>& images, int width, int height, unsigned int hash)
+{
+	FILE* pFile = fopen(path.c_str(), "w");
+	if(pFile == NULL) {
+		return false;
+	}
+	fprintf(pFile, "// Generated by tools/AtlasGen from tools/atlas/atlas.txt - do not modify by hand.\n");
+	fprintf(pFile, "// Included by Atlas.cpp only.\n\n");
+	fprintf(pFile, "static const mchar ATLAS_FILE[] = L\"%s\";\n", file.c_str());
+	fprintf(pFile, "static const int ATLAS_WIDTH = %d;\n", width);
+	fprintf(pFile, "static const int ATLAS_HEIGHT = %d;\n", height);
+	fprintf(pFile, "static const unsigned int ATLAS_HASH = 0x%08Xu;\n\n", hash);
+	fprintf(pFile, "// x, y, width and height of every AtlasImage\n");
+	fprintf(pFile, "static const short ATLAS_RECTS[ATLAS_IMAGE_COUNT][4] = {\n");
+	for(size_t i = 0; i < images.size(); i++) {
+		const Image& image = images[i];
+		fprintf(pFile, "\t{ %d, %d, %d, %d }%s\t// %s\n", image.x, image.y, image.width, image.height,
+				i + 1 < images.size() ? "," : "", image.file.c_str());
+	}
+	fprintf(pFile, "};\n");
+	return fclose(pFile) == 0;
+}
+
+int
+main(int argc, char** argv)
+{
+	if(argc != 4) {
+		fprintf(stderr, "usage: %s <atlas.txt> <atlas.png> <output dir>\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<Image> images;
+	if(!ReadList(argv[1], images)) {
+		return 1;
+	}
+	if(images.empty()) {
+		fprintf(stderr, "no images in %s\n", argv[1]);
+		return 1;
+	}
+
+	// the squarest atlas, bitmaps are limited in either side, then the smallest
+	std::vector<Image*> order;
+	int widest = 0;
+	for(size_t i = 0; i < images.size(); i++) {
+		order.push_back(&images[i]);
+		widest = std::max(widest, images[i].width);
+	}
+	std::stable_sort(order.begin(), order.end(), TallerFirst);
+	int bestWidth = 0;
+	int bestSide = 0;
+	int bestArea = 0;
+	for(int width = widest; width <= 2048; width++) {
+		int height = Pack(order, width);
+		int side = std::max(width, height);
+		int area = width * height;
+		if(bestWidth == 0 || side < bestSide || (side == bestSide && area < bestArea)) {
+			bestWidth = width;
+			bestSide = side;
+			bestArea = area;
+		}
+	}
+	int width = bestWidth;
+	int height = Pack(order, width);
+
+	std::vector<unsigned char> atlas(width * height * 4, 0);
+	for(size_t i = 0; i < images.size(); i++) {
+		const Image& image = images[i];
+		for(int y = 0; y < image.height; y++) {
+			memcpy(&atlas[((image.y + y) * width + image.x) * 4], &image.pixels[y * image.width * 4], image.width * 4);
+		}
+	}
+	unsigned int hash = Hash(width, height, atlas);
+
+	std::string output = argv[3];
+	std::string file = argv[2];
+	file = file.substr(file.find_last_of('/') + 1);
+	if(!WritePng(argv[2], width, height, atlas)) {
+		return 1;
+	}
+	if(!WriteIds(output + "/AtlasIds.h", images) || !WriteData(output + "/AtlasData.h", file, images, width, height, hash)) {
+		fprintf(stderr, "cannot write to %s\n", output.c_str());
+		return 1;
+	}
+	int used = 0;
+	for(size_t i = 0; i < images.size(); i++) {
+		used += images[i].width * images[i].height;
+	}
+	printf("%lu images in a %dx%d atlas, %d%% used\n", (unsigned long)images.size(), width, height, used * 100 / (width * height));
+	return 0;
+}
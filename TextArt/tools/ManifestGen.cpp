@@ -0,0 +1,127 @@
+/**
+ * Writes the content manifest of a catalog directory for the delta sync
+ * (see src/ContentManifest.h): the content hash of every file, the release
+ * serial and, given the PEM private key of the release, the signature the
+ * device checks against src/ContentKey.h. The manifest and the catalog
+ * files are what the content server hands out.
+ *
+ *   make manifest-gen
+ *   ./manifest-gen -catalog DIR -serial N [-key release.pem] [-out manifest.txt]
+ */
+
+#include "ContentManifest.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+
+#include <string>
+
+using namespace Osp::Base;
+
+static bool
+Sign(const std::string& keyPath, const unsigned char* pData, size_t length, std::string& hex)
+{
+	FILE* pFile = fopen(keyPath.c_str(), "r");
+	if(pFile == NULL) {
+		return false;
+	}
+	EVP_PKEY* pKey = PEM_read_PrivateKey(pFile, NULL, NULL, NULL);
+	fclose(pFile);
+	if(pKey == NULL) {
+		return false;
+	}
+
+	bool signedText = false;
+	EVP_MD_CTX* pContext = EVP_MD_CTX_new();
+	size_t signatureLength = 0;
+	if(pContext != NULL && EVP_DigestSignInit(pContext, NULL, EVP_sha1(), NULL, pKey) == 1
+			&& EVP_DigestSign(pContext, NULL, &signatureLength, pData, length) == 1) {
+		unsigned char* pSignature = new unsigned char[signatureLength];
+		if(EVP_DigestSign(pContext, pSignature, &signatureLength, pData, length) == 1) {
+			static const char HEX_DIGITS[] = "0123456789abcdef";
+			for(size_t i = 0; i < signatureLength; i++) {
+				hex.push_back(HEX_DIGITS[pSignature[i] >> 4]);
+				hex.push_back(HEX_DIGITS[pSignature[i] & 0x0F]);
+			}
+			signedText = true;
+		}
+		delete[] pSignature;
+	}
+	EVP_MD_CTX_free(pContext);
+	EVP_PKEY_free(pKey);
+	return signedText;
+}
+
+int
+main(int argc, char** argv)
+{
+	std::string catalog;
+	std::string key;
+	std::string out;
+	int serial = -1;
+
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-catalog") == 0 && i + 1 < argc) {
+			catalog = argv[++i];
+		} else if(strcmp(argv[i], "-serial") == 0 && i + 1 < argc) {
+			serial = atoi(argv[++i]);
+		} else if(strcmp(argv[i], "-key") == 0 && i + 1 < argc) {
+			key = argv[++i];
+		} else if(strcmp(argv[i], "-out") == 0 && i + 1 < argc) {
+			out = argv[++i];
+		} else {
+			catalog.clear();
+			break;
+		}
+	}
+	if(catalog.empty() || serial < 0) {
+		fprintf(stderr, "usage: %s -catalog DIR -serial N [-key release.pem] [-out manifest.txt]\n", argv[0]);
+		return 1;
+	}
+
+	HostFileSystem::Mount("/Home/catalog", catalog.c_str());
+	ContentManifest manifest;
+	result r = manifest.Scan();
+	if(IsFailed(r)) {
+		fprintf(stderr, "scanning %s failed by %s\n", catalog.c_str(), GetErrorMessage(r));
+		return 1;
+	}
+	manifest.SetSerial(serial);
+	ByteBuffer* pText = manifest.FormatN();
+	if(pText == NULL) {
+		fprintf(stderr, "formatting the manifest failed\n");
+		return 1;
+	}
+
+	const unsigned char* pData = pText->GetPointer();
+	size_t length = pText->GetRemaining();
+	std::string signature;
+	if(!key.empty() && !Sign(key, pData, length, signature)) {
+		fprintf(stderr, "signing with %s failed\n", key.c_str());
+		delete pText;
+		return 1;
+	}
+
+	FILE* pFile = out.empty() ? stdout : fopen(out.c_str(), "wb");
+	if(pFile == NULL) {
+		fprintf(stderr, "cannot write %s\n", out.c_str());
+		delete pText;
+		return 1;
+	}
+	bool written = fwrite(pData, 1, length, pFile) == length;
+	if(!signature.empty()) {
+		written = fprintf(pFile, "signature %s\n", signature.c_str()) > 0 && written;
+	}
+	written = (pFile == stdout ? fflush(pFile) : fclose(pFile)) == 0 && written;
+	delete pText;
+	if(!written) {
+		fprintf(stderr, "cannot write %s\n", out.c_str());
+		return 1;
+	}
+	fprintf(stderr, "%d files, serial %d%s\n", manifest.GetCount(), serial, signature.empty() ? ", unsigned" : "");
+	return 0;
+}
@@ -0,0 +1,278 @@
+/**
+ * Compiles the UiBuilder string tables in Res, one XML file per language,
+ * into src/StringIds.h (one enum constant per text id) and
+ * src/StringTableData.h (per language one packed UTF-16 text blob and an
+ * offset array indexed by the enum). Ids are
+ * sorted so the output is stable; an id missing from a language falls back
+ * to the id itself, as AppResource::GetString did.
+ *
+ *   make strings
+ *   ./stringtable-gen ../src ../Res/eng-GB.xml ../Res/rus-RU.xml
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+struct Language {
+	std::string name;
+	std::map<std::string, std::string> texts;
+};
+
+static bool
+ReadFile(const std::string& path, std::string& data)
+{
+	FILE* pFile = fopen(path.c_str(), "rb");
+	if(pFile == NULL) {
+		return false;
+	}
+	char buffer[4096];
+	size_t read;
+	while((read = fread(buffer, 1, sizeof(buffer), pFile)) > 0) {
+		data.append(buffer, read);
+	}
+	fclose(pFile);
+	return true;
+}
+
+static void
+AppendUtf8(unsigned int code, std::string& out)
+{
+	if(code < 0x80) {
+		out.push_back((char)code);
+	} else if(code < 0x800) {
+		out.push_back((char)(0xC0 | (code >> 6)));
+		out.push_back((char)(0x80 | (code & 0x3F)));
+	} else {
+		out.push_back((char)(0xE0 | (code >> 12)));
+		out.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+		out.push_back((char)(0x80 | (code & 0x3F)));
+	}
+}
+
+static std::string
+DecodeEntities(const std::string& text)
+{
+	std::string out;
+	for(size_t i = 0; i < text.size(); i++) {
+		if(text[i] != '&') {
+			out.push_back(text[i]);
+			continue;
+		}
+		size_t end = text.find(';', i);
+		if(end == std::string::npos) {
+			out.push_back(text[i]);
+			continue;
+		}
+		std::string entity = text.substr(i + 1, end - i - 1);
+		if(entity == "amp") {
+			out.push_back('&');
+		} else if(entity == "lt") {
+			out.push_back('<');
+		} else if(entity == "gt") {
+			out.push_back('>');
+		} else if(entity == "quot") {
+			out.push_back('"');
+		} else if(entity == "apos") {
+			out.push_back('\'');
+		} else if(entity.size() > 1 && entity[0] == '#') {
+			bool hex = entity[1] == 'x';
+			AppendUtf8((unsigned int)strtoul(entity.c_str() + (hex ? 2 : 1), NULL, hex ? 16 : 10), out);
+		} else {
+			out.append(text, i, end - i + 1);
+		}
+		i = end;
+	}
+	return out;
+}
+
+// Picks every <text id="...">...</text> out of a UiBuilder string table
+static bool
+ParseTable(const std::string& path, Language& language)
+{
+	std::string data;
+	if(!ReadFile(path, data)) {
+		fprintf(stderr, "cannot read %s\n", path.c_str());
+		return false;
+	}
+
+	size_t slash = path.find_last_of('/');
+	size_t dot = path.rfind(".xml");
+	language.name = path.substr(slash == std::string::npos ? 0 : slash + 1, dot - (slash == std::string::npos ? 0 : slash + 1));
+
+	size_t position = 0;
+	while((position = data.find("<text id=\"", position)) != std::string::npos) {
+		size_t idStart = position + 10;
+		size_t idEnd = data.find('"', idStart);
+		size_t valueStart = data.find('>', idEnd);
+		size_t valueEnd = data.find("</text>", valueStart);
+		if(idEnd == std::string::npos || valueStart == std::string::npos || valueEnd == std::string::npos) {
+			fprintf(stderr, "%s: malformed <text> at byte %lu\n", path.c_str(), (unsigned long)position);
+			return false;
+		}
+		language.texts[data.substr(idStart, idEnd - idStart)] = DecodeEntities(data.substr(valueStart + 1, valueEnd - valueStart - 1));
+		position = valueEnd;
+	}
+	return true;
+}
+
+// UTF-8 to UTF-16 units, texts are BMP only
+static void
+DecodeUtf8(const std::string& text, std::vector<unsigned int>& out)
+{
+	for(size_t i = 0; i < text.size();) {
+		unsigned char c = (unsigned char)text[i];
+		int extra = c < 0x80 ? 0 : (c < 0xE0 ? 1 : (c < 0xF0 ? 2 : 3));
+		unsigned int code = extra == 0 ? c : (c & (0x3F >> extra));
+		for(int k = 1; k <= extra && i + k < text.size(); k++) {
+			code = (code << 6) | ((unsigned char)text[i + k] & 0x3F);
+		}
+		out.push_back(code);
+		i += extra + 1;
+	}
+}
+
+// One wide literal per text, universal character names keep the output ASCII
+static std::string
+ToLiteral(const std::vector<unsigned int>& units)
+{
+	std::string literal = "L\"";
+	char escape[16];
+	for(size_t i = 0; i < units.size(); i++) {
+		unsigned int c = units[i];
+		if(c == '"' || c == '\\') {
+			literal.push_back('\\');
+			literal.push_back((char)c);
+		} else if(c >= 0x20 && c < 0x7F) {
+			literal.push_back((char)c);
+		} else if(c < 0xA0) {
+			snprintf(escape, sizeof(escape), "\\%03o", c);
+			literal += escape;
+		} else {
+			snprintf(escape, sizeof(escape), "\\u%04X", c);
+			literal += escape;
+		}
+	}
+	literal += "\\0\"";
+	return literal;
+}
+
+static std::string
+ToIdentifier(const std::string& name)
+{
+	std::string identifier;
+	for(size_t i = 0; i < name.size(); i++) {
+		char c = name[i];
+		if(c >= 'a' && c <= 'z') {
+			identifier.push_back((char)(c - 'a' + 'A'));
+		} else if((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+			identifier.push_back(c);
+		} else {
+			identifier.push_back('_');
+		}
+	}
+	return identifier;
+}
+
+static bool
+WriteIds(const std::string& path, const std::vector<std::string>& ids)
+{
+	FILE* pFile = fopen(path.c_str(), "w");
+	if(pFile == NULL) {
+		return false;
+	}
+	fprintf(pFile, "// Generated by tools/StringTableGen from Res/*.xml - do not modify by hand.\n\n");
+	fprintf(pFile, "#ifndef STRINGIDS_H_\n#define STRINGIDS_H_\n\n");
+	fprintf(pFile, "enum StringId {\n");
+	for(size_t i = 0; i < ids.size(); i++) {
+		fprintf(pFile, "\t%s = %lu,\n", ids[i].c_str(), (unsigned long)i);
+	}
+	fprintf(pFile, "\tSTRING_COUNT = %lu\n};\n\n#endif\n", (unsigned long)ids.size());
+	return fclose(pFile) == 0;
+}
+
+static bool
+WriteData(const std::string& path, const std::vector<std::string>& ids, const std::vector<Language>& languages)
+{
+	FILE* pFile = fopen(path.c_str(), "w");
+	if(pFile == NULL) {
+		return false;
+	}
+	fprintf(pFile, "// Generated by tools/StringTableGen from Res/*.xml - do not modify by hand.\n");
+	fprintf(pFile, "// Included by StringTable.cpp only.\n\n");
+
+	for(size_t l = 0; l < languages.size(); l++) {
+		const Language& language = languages[l];
+		std::string identifier = ToIdentifier(language.name);
+		std::vector<unsigned int> offsets;
+		unsigned int offset = 0;
+
+		fprintf(pFile, "static const mchar %s_TEXT[] =\n", identifier.c_str());
+		for(size_t i = 0; i < ids.size(); i++) {
+			std::map<std::string, std::string>::const_iterator text = language.texts.find(ids[i]);
+			std::vector<unsigned int> units;
+			DecodeUtf8(text != language.texts.end() ? text->second : ids[i], units);
+			fprintf(pFile, "\t%s%s\n", ToLiteral(units).c_str(), i + 1 < ids.size() ? "" : ";");
+			offsets.push_back(offset);
+			offset += units.size() + 1;
+		}
+		if(offset > 0xFFFF) {
+			fprintf(stderr, "%s: %u characters do not fit 16 bit offsets\n", language.name.c_str(), offset);
+			fclose(pFile);
+			return false;
+		}
+
+		fprintf(pFile, "\nstatic const unsigned short %s_OFFSETS[STRING_COUNT] = {", identifier.c_str());
+		for(size_t i = 0; i < offsets.size(); i++) {
+			fprintf(pFile, "%s%u", i % 12 == 0 ? "\n\t" : " ", offsets[i]);
+			if(i + 1 < offsets.size()) {
+				fprintf(pFile, ",");
+			}
+		}
+		fprintf(pFile, "\n};\n\n");
+	}
+
+	fprintf(pFile, "static const StringTable::Language LANGUAGES[] = {\n");
+	for(size_t l = 0; l < languages.size(); l++) {
+		std::string identifier = ToIdentifier(languages[l].name);
+		fprintf(pFile, "\t{ L\"%s\", %s_TEXT, %s_OFFSETS }%s\n", languages[l].name.c_str(), identifier.c_str(),
+				identifier.c_str(), l + 1 < languages.size() ? "," : "");
+	}
+	fprintf(pFile, "};\n");
+	return fclose(pFile) == 0;
+}
+
+int
+main(int argc, char** argv)
+{
+	if(argc < 3) {
+		fprintf(stderr, "usage: %s <output dir> <table.xml>...\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<Language> languages(argc - 2);
+	std::set<std::string> idSet;
+	for(int i = 2; i < argc; i++) {
+		if(!ParseTable(argv[i], languages[i - 2])) {
+			return 1;
+		}
+		const std::map<std::string, std::string>& texts = languages[i - 2].texts;
+		for(std::map<std::string, std::string>::const_iterator text = texts.begin(); text != texts.end(); ++text) {
+			idSet.insert(text->first);
+		}
+	}
+	std::vector<std::string> ids(idSet.begin(), idSet.end());
+
+	std::string output = argv[1];
+	if(!WriteIds(output + "/StringIds.h", ids) || !WriteData(output + "/StringTableData.h", ids, languages)) {
+		fprintf(stderr, "cannot write to %s\n", output.c_str());
+		return 1;
+	}
+	printf("%lu ids in %lu languages\n", (unsigned long)ids.size(), (unsigned long)languages.size());
+	return 0;
+}